@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+
+#include "../Threading/TaskQueue.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Execution policy which runs the algorithm on the calling thread
+ *
+ */
+struct SequencedPolicy {};
+
+inline constexpr SequencedPolicy kSequenced{};
+
+/**
+ * @brief Execution policy which splits the algorithm into tasks executed on a TaskQueue. The calling thread
+ *        blocks till all the tasks have finished. The algorithm runs sequentially if the queue is not running,
+ *        if it is called from one of the worker threads of the queue or if the range is not larger than the
+ *        grain size.
+ *
+ */
+class ParallelPolicy {
+public:
+    static constexpr std::size_t kDefaultGrainSize = 1 << 14;
+
+    /**
+     * @brief Construct a new Parallel Policy object
+     *
+     * @param task_queue Queue on which the tasks are scheduled
+     * @param grain_size Number of elements below which a range is processed by a single task
+     */
+    explicit ParallelPolicy(TaskQueue& task_queue, std::size_t grain_size = kDefaultGrainSize) noexcept
+        : task_queue_(&task_queue)
+        , grain_size_(grain_size > 0 ? grain_size : 1) {}
+
+    [[nodiscard]] TaskQueue& getTaskQueue() const noexcept {
+        return *task_queue_;
+    }
+
+    [[nodiscard]] std::size_t getGrainSize() const noexcept {
+        return grain_size_;
+    }
+
+    /**
+     * @brief Check if a range of the given size should be split into tasks
+     *
+     * @param count Number of elements in the range
+     */
+    [[nodiscard]] bool shouldRunParallel(std::size_t count) const noexcept {
+        return count > grain_size_ && task_queue_->isRunning() && !task_queue_->isWorkerThread();
+    }
+
+private:
+    TaskQueue* task_queue_;
+    std::size_t grain_size_;
+};
+
+/**
+ * @brief Keeps the first exception thrown by the tasks of a parallel algorithm so that it can be rethrown on
+ *        the calling thread once all the tasks have finished
+ *
+ */
+class ParallelExceptionHolder {
+public:
+    ParallelExceptionHolder()
+        : failed_(false) {}
+
+    /**
+     * @brief Store the exception currently being handled. Must be called from inside a catch block
+     */
+    void capture() noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!exception_) {
+            exception_ = std::current_exception();
+        }
+        failed_.store(true, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool hasFailed() const noexcept {
+        return failed_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Rethrow the stored exception if any of the tasks failed
+     */
+    void rethrow() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+private:
+    std::atomic<bool> failed_;
+    mutable std::mutex mutex_;
+    std::exception_ptr exception_;
+};
+
+template<typename T>
+struct IsExecutionPolicy : std::false_type {};
+
+template<>
+struct IsExecutionPolicy<SequencedPolicy> : std::true_type {};
+
+template<>
+struct IsExecutionPolicy<ParallelPolicy> : std::true_type {};
+
+template<typename T>
+constexpr auto IsExecutionPolicyV = IsExecutionPolicy<std::decay_t<T>>::value;
+
+}  // namespace nxt::core
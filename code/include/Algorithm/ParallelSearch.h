@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "../Threading/TaskGraph.h"
+#include "ExecutionPolicy.h"
+#include "Search.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Split [0, count) into chunks of roughly grain size elements and run func(chunk_first, chunk_last) for
+ *        every chunk on the task queue of the policy. Blocks till all the chunks are processed and rethrows the
+ *        first exception thrown by func.
+ */
+template<typename Difference, typename Func>
+void
+parallelForChunks(const ParallelPolicy& policy, Difference count, Func func) {
+    auto grain_size = static_cast<Difference>(policy.getGrainSize());
+    auto chunk_count = (count + grain_size - 1) / grain_size;
+    auto exception_holder = std::make_shared<ParallelExceptionHolder>();
+
+    TaskGraph graph(policy.getTaskQueue().getTaskPool());
+    for (Difference i = 0; i < chunk_count; ++i) {
+        auto chunk_first = count * i / chunk_count;
+        auto chunk_last = count * (i + 1) / chunk_count;
+        graph.emplaceTask([func, exception_holder, chunk_first, chunk_last]() {
+            try {
+                func(chunk_first, chunk_last);
+            } catch (...) {
+                exception_holder->capture();
+            }
+        });
+    }
+
+    graph.submit(policy.getTaskQueue());
+    graph.wait();
+    exception_holder->rethrow();
+}
+
+template<typename InputIter, typename T, typename = std::enable_if_t<IsInputIteratorV<InputIter>>>
+[[nodiscard]] InputIter
+find(const SequencedPolicy&, InputIter first, InputIter last, const T& value) {
+    return nxt::core::find(first, last, value);
+}
+
+template<typename RandomAccessIter, typename T, typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+[[nodiscard]] RandomAccessIter
+find(const ParallelPolicy& policy, RandomAccessIter first, RandomAccessIter last, const T& value) {
+    using difference_type = IteratorDifferenceTypeT<RandomAccessIter>;
+
+    auto count = last - first;
+    if (!policy.shouldRunParallel(static_cast<std::size_t>(count))) {
+        return nxt::core::find(first, last, value);
+    }
+
+    // index of the first match found so far, chunks after it are skipped and chunks before it stop
+    // scanning once they pass it
+    static constexpr difference_type kCheckInterval = 1024;
+    auto found_index = std::make_shared<std::atomic<difference_type>>(count);
+
+    auto find_in_chunk = [first, &value, found_index](difference_type chunk_first, difference_type chunk_last) {
+        for (auto index = chunk_first; index < chunk_last; index += kCheckInterval) {
+            if (found_index->load(std::memory_order_relaxed) <= index) {
+                return;
+            }
+
+            auto block_last = std::min(index + kCheckInterval, chunk_last);
+            auto result = nxt::core::find(first + index, first + block_last, value);
+            if (result != first + block_last) {
+                auto result_index = result - first;
+                auto current = found_index->load(std::memory_order_relaxed);
+                while (result_index < current &&
+                       !found_index->compare_exchange_weak(current, result_index, std::memory_order_relaxed)) {
+                }
+                return;
+            }
+        }
+    };
+
+    parallelForChunks(policy, count, find_in_chunk);
+    return first + found_index->load(std::memory_order_relaxed);
+}
+
+template<typename InputIter, typename T, typename = std::enable_if_t<IsInputIteratorV<InputIter>>>
+[[nodiscard]] IteratorDifferenceTypeT<InputIter>
+count(const SequencedPolicy&, InputIter first, InputIter last, const T& value) {
+    return nxt::core::count(first, last, value);
+}
+
+template<typename RandomAccessIter, typename T, typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+[[nodiscard]] IteratorDifferenceTypeT<RandomAccessIter>
+count(const ParallelPolicy& policy, RandomAccessIter first, RandomAccessIter last, const T& value) {
+    using difference_type = IteratorDifferenceTypeT<RandomAccessIter>;
+
+    auto element_count = last - first;
+    if (!policy.shouldRunParallel(static_cast<std::size_t>(element_count))) {
+        return nxt::core::count(first, last, value);
+    }
+
+    auto total = std::make_shared<std::atomic<difference_type>>(0);
+    auto count_in_chunk = [first, &value, total](difference_type chunk_first, difference_type chunk_last) {
+        total->fetch_add(nxt::core::count(first + chunk_first, first + chunk_last, value), std::memory_order_relaxed);
+    };
+
+    parallelForChunks(policy, element_count, count_in_chunk);
+
+    return total->load(std::memory_order_relaxed);
+}
+
+}  // namespace nxt::core
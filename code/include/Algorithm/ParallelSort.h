@@ -0,0 +1,587 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <tuple>
+
+#include "../Container/Vector.h"
+#include "../Threading/GenericTask.h"
+#include "../Threading/Latch.h"
+#include "../Threading/TaskGraph.h"
+#include "ExecutionPolicy.h"
+#include "Sort.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Parallel quick sort. Every partition step runs in its own task and spawns the tasks for the
+ *        sub ranges, large ranges are partitioned by several tasks at once. A latch counts the elements which
+ *        have reached their final place so the caller knows when the whole range is sorted.
+ *
+ */
+template<typename RandomAccessIter, typename Compare>
+class ParallelQuickSort : public std::enable_shared_from_this<ParallelQuickSort<RandomAccessIter, Compare>> {
+public:
+    using difference_type = IteratorDifferenceTypeT<RandomAccessIter>;
+
+    ParallelQuickSort(const ParallelPolicy& policy, difference_type count, Compare comp)
+        : task_queue_(policy.getTaskQueue())
+        , grain_size_(static_cast<difference_type>(policy.getGrainSize()))
+        , comp_(comp)
+        , latch_(count) {}
+
+    /**
+     * @brief Sort the range on the task queue of the policy and block till it is sorted
+     */
+    static void sort(const ParallelPolicy& policy, RandomAccessIter first, RandomAccessIter last, Compare comp) {
+        auto sorter = std::make_shared<ParallelQuickSort>(policy, last - first, comp);
+        sorter->spawnSort(first, last);
+        sorter->latch_.wait();
+        sorter->exception_holder_.rethrow();
+    }
+
+private:
+    // ranges larger than grain size times this factor are partitioned by multiple tasks
+    static constexpr difference_type kParallelPartitionFactor = 8;
+
+    // number of partition blocks created per worker thread
+    static constexpr difference_type kBlocksPerThread = 4;
+
+    struct PartitionBlock {
+        RandomAccessIter first;
+        RandomAccessIter mid;
+        RandomAccessIter last;
+    };
+
+    struct PartitionState {
+        Vector<PartitionBlock> blocks;
+        std::atomic<bool> failed{false};
+    };
+
+    void spawnSort(RandomAccessIter first, RandomAccessIter last) {
+        auto sorter = this->shared_from_this();
+        task_queue_.addTask(task_queue_.makeTask([sorter, first, last]() { sorter->sortRange(first, last); }));
+    }
+
+    void sortOrSpawn(RandomAccessIter first, RandomAccessIter last) {
+        if (last - first > grain_size_) {
+            spawnSort(first, last);
+        } else if (first != last) {
+            sortRange(first, last);
+        }
+    }
+
+    void sortRange(RandomAccessIter first, RandomAccessIter last) {
+        auto count = last - first;
+        RandomAccessIter pivot_first;
+        RandomAccessIter pivot_last;
+        bool partition_in_parallel = false;
+
+        try {
+            if (count <= grain_size_) {
+                nxt::core::quickSort(first, last, comp_);
+                latch_.countDown(count);
+                return;
+            }
+
+            movePivotToFront(first, last);
+            partition_in_parallel = count > grain_size_ * kParallelPartitionFactor && task_queue_.getMaxThreads() > 1;
+            if (!partition_in_parallel) {
+                // elements less than the pivot are placed before the elements not less than the pivot
+                auto is_not_less = [this, first](const auto& value) { return !comp_(value, *first); };
+                auto mid = nxt::core::partition(first + 1, last, is_not_less);
+                std::tie(pivot_first, pivot_last) = placePivot(first, mid, last);
+            }
+        } catch (...) {
+            exception_holder_.capture();
+            latch_.countDown(count);
+            return;
+        }
+
+        if (partition_in_parallel) {
+            partitionInParallel(first, last);
+        } else {
+            finishPartition(first, pivot_first, pivot_last, last);
+        }
+    }
+
+    void movePivotToFront(RandomAccessIter first, RandomAccessIter last) {
+        using std::swap;
+        auto last_element = last - 1;
+        auto mid = first + (last - first) / 2;
+
+        // do swaps to place the median of 3 in the middle
+        if (comp_(*mid, *first)) {
+            swap(*mid, *first);
+        }
+
+        if (comp_(*last_element, *mid)) {
+            swap(*mid, *last_element);
+        }
+
+        if (comp_(*mid, *first)) {
+            swap(*mid, *first);
+        }
+
+        swap(*mid, *first);
+    }
+
+    std::tuple<RandomAccessIter, RandomAccessIter> placePivot(RandomAccessIter first,
+                                                              RandomAccessIter mid,
+                                                              RandomAccessIter last) {
+        using std::swap;
+
+        // pivot is at first and [first + 1, mid) is less than the pivot
+        auto pivot = mid - 1;
+        swap(*first, *pivot);
+
+        auto pivot_last = mid;
+        if (pivot == first) {
+            // pivot is the smallest element, so gather the elements equal to it to avoid quadratic time on
+            // ranges with a lot of duplicates
+            auto is_greater = [this, pivot](const auto& value) { return comp_(*pivot, value); };
+            pivot_last = nxt::core::partition(mid, last, is_greater);
+        }
+
+        return {pivot, pivot_last};
+    }
+
+    void finishPartition(RandomAccessIter first,
+                         RandomAccessIter pivot_first,
+                         RandomAccessIter pivot_last,
+                         RandomAccessIter last) {
+        // elements equal to the pivot are in their final place
+        latch_.countDown(pivot_last - pivot_first);
+        sortOrSpawn(first, pivot_first);
+        sortOrSpawn(pivot_last, last);
+    }
+
+    void partitionInParallel(RandomAccessIter first, RandomAccessIter last) {
+        auto data_first = first + 1;
+        auto count = last - data_first;
+        auto block_count = std::min(count / grain_size_,
+                                    static_cast<difference_type>(task_queue_.getMaxThreads()) * kBlocksPerThread);
+
+        auto state = std::make_shared<PartitionState>();
+        state->blocks.reserve(static_cast<std::size_t>(block_count));
+        for (difference_type i = 0; i < block_count; ++i) {
+            auto block_first = data_first + count * i / block_count;
+            auto block_last = data_first + count * (i + 1) / block_count;
+            state->blocks.pushBack({block_first, block_first, block_last});
+        }
+
+        auto sorter = this->shared_from_this();
+        auto merge_task = task_queue_.makeTask([sorter, state, first, last]() { sorter->mergeBlocks(*state, first, last); });
+
+        Vector<std::shared_ptr<Task>> block_tasks;
+        block_tasks.reserve(static_cast<std::size_t>(block_count));
+        for (std::size_t i = 0; i < state->blocks.size(); ++i) {
+            auto block_task = task_queue_.makeTask([sorter, state, first, i]() {
+                auto& block = state->blocks[i];
+                auto is_not_less = [&sorter, first](const auto& value) { return !sorter->comp_(value, *first); };
+                try {
+                    block.mid = nxt::core::partition(block.first, block.last, is_not_less);
+                } catch (...) {
+                    sorter->exception_holder_.capture();
+                    state->failed.store(true, std::memory_order_release);
+                }
+            });
+            block_task->precede(merge_task);
+            block_tasks.pushBack(block_task);
+        }
+
+        task_queue_.addTasks(block_tasks);
+    }
+
+    void mergeBlocks(PartitionState& state, RandomAccessIter first, RandomAccessIter last) {
+        if (state.failed.load(std::memory_order_acquire)) {
+            latch_.countDown(last - first);
+            return;
+        }
+
+        // every block is partitioned on its own, so all the elements less than the pivot end before split once
+        // the elements not less than the pivot in front of split are swapped with the elements less than the
+        // pivot after split
+        auto split = first + 1;
+        for (const auto& block : state.blocks) {
+            split += block.mid - block.first;
+        }
+
+        Vector<std::tuple<RandomAccessIter, RandomAccessIter>> high_ranges;
+        Vector<std::tuple<RandomAccessIter, RandomAccessIter>> low_ranges;
+        for (const auto& block : state.blocks) {
+            auto high_first = block.mid;
+            auto high_last = std::min(block.last, split);
+            if (high_first < high_last) {
+                high_ranges.pushBack({high_first, high_last});
+            }
+
+            auto low_first = std::max(block.first, split);
+            auto low_last = block.mid;
+            if (low_first < low_last) {
+                low_ranges.pushBack({low_first, low_last});
+            }
+        }
+
+        std::size_t low_index = 0;
+        auto low_iter = low_ranges.empty() ? split : std::get<0>(low_ranges[0]);
+        for (const auto& [high_first, high_last] : high_ranges) {
+            for (auto high_iter = high_first; high_iter != high_last; ++high_iter) {
+                if (low_iter == std::get<1>(low_ranges[low_index])) {
+                    ++low_index;
+                    low_iter = std::get<0>(low_ranges[low_index]);
+                }
+
+                using std::swap;
+                swap(*high_iter, *low_iter);
+                ++low_iter;
+            }
+        }
+
+        RandomAccessIter pivot_first;
+        RandomAccessIter pivot_last;
+        try {
+            std::tie(pivot_first, pivot_last) = placePivot(first, split, last);
+        } catch (...) {
+            exception_holder_.capture();
+            latch_.countDown(last - first);
+            return;
+        }
+
+        finishPartition(first, pivot_first, pivot_last, last);
+    }
+
+    TaskQueue& task_queue_;
+    difference_type grain_size_;
+    Compare comp_;
+    Latch latch_;
+    ParallelExceptionHolder exception_holder_;
+};
+
+/**
+ * @brief Stable merge sort using a buffer of the same size as the range. In parallel mode the range is split
+ *        into a power of 2 number of leaves which are sorted independently, after which every level of the
+ *        merge tree is split into pieces of roughly grain size elements using merge path partitioning. The
+ *        whole tree is built upfront as a TaskGraph and the levels alternate between the range and the buffer.
+ *
+ */
+template<typename RandomAccessIter, typename Compare>
+class ParallelMergeSort {
+public:
+    using difference_type = IteratorDifferenceTypeT<RandomAccessIter>;
+    using value_type = IteratorValueTypeT<RandomAccessIter>;
+
+    static void sort(RandomAccessIter first, RandomAccessIter last, Compare comp) {
+        auto count = last - first;
+        if (count < 2) {
+            return;
+        }
+
+        Vector<value_type> buffer(static_cast<std::size_t>(count));
+        sortLeaf(first, last, buffer.data(), false, comp);
+    }
+
+    static void sort(const ParallelPolicy& policy, RandomAccessIter first, RandomAccessIter last, Compare comp) {
+        auto count = last - first;
+        auto grain_size = static_cast<difference_type>(policy.getGrainSize());
+
+        difference_type leaf_count = 1;
+        difference_type depth = 0;
+        while (count / leaf_count > grain_size) {
+            leaf_count *= 2;
+            ++depth;
+        }
+
+        auto state = std::make_shared<State>(first, count, comp);
+        auto bound = [count, leaf_count](difference_type leaf) { return count * leaf / leaf_count; };
+
+        TaskGraph graph(policy.getTaskQueue().getTaskPool());
+        Vector<std::shared_ptr<Task>> level_tasks;
+        level_tasks.reserve(static_cast<std::size_t>(leaf_count));
+
+        // leaves end up in the buffer if there is an odd number of merge levels, so the last level writes
+        // back to the range
+        bool leaf_in_buffer = depth % 2 == 1;
+        for (difference_type i = 0; i < leaf_count; ++i) {
+            auto leaf_first = bound(i);
+            auto leaf_last = bound(i + 1);
+            level_tasks.pushBack(graph.emplaceTask([state, leaf_first, leaf_last, leaf_in_buffer]() {
+                try {
+                    sortLeaf(state->first + leaf_first,
+                             state->first + leaf_last,
+                             state->buffer.data() + leaf_first,
+                             leaf_in_buffer,
+                             state->comp);
+                } catch (...) {
+                    state->exception_holder.capture();
+                }
+            }));
+        }
+
+        for (difference_type level = 1; level <= depth; ++level) {
+            bool to_buffer = (depth - level) % 2 == 1;
+            auto node_count = leaf_count >> level;
+            auto node_leaves = difference_type(1) << level;
+
+            Vector<std::shared_ptr<Task>> next_level_tasks;
+            next_level_tasks.reserve(static_cast<std::size_t>(node_count));
+            for (difference_type node = 0; node < node_count; ++node) {
+                auto node_first = bound(node * node_leaves);
+                auto node_mid = bound(node * node_leaves + node_leaves / 2);
+                auto node_last = bound((node + 1) * node_leaves);
+                auto& left = level_tasks[static_cast<std::size_t>(2 * node)];
+                auto& right = level_tasks[static_cast<std::size_t>(2 * node + 1)];
+
+                auto node_count_elements = node_last - node_first;
+                auto piece_count = std::max(node_count_elements / grain_size, difference_type(1));
+
+                // join node so that the next level depends on one task instead of every piece
+                std::shared_ptr<Task> join;
+                if (piece_count > 1) {
+                    join = graph.emplaceTask([]() {});
+                }
+
+                for (difference_type piece = 0; piece < piece_count; ++piece) {
+                    auto diagonal_first = node_count_elements * piece / piece_count;
+                    auto diagonal_last = node_count_elements * (piece + 1) / piece_count;
+                    auto task = graph.emplaceTask(
+                        [state, node_first, node_mid, node_last, diagonal_first, diagonal_last, to_buffer]() {
+                            if (state->exception_holder.hasFailed()) {
+                                return;
+                            }
+
+                            try {
+                                auto data = state->first;
+                                auto buffer = state->buffer.data();
+                                if (to_buffer) {
+                                    mergePiece(data + node_first,
+                                               data + node_mid,
+                                               data + node_last,
+                                               buffer + node_first,
+                                               diagonal_first,
+                                               diagonal_last,
+                                               state->comp);
+                                } else {
+                                    mergePiece(buffer + node_first,
+                                               buffer + node_mid,
+                                               buffer + node_last,
+                                               data + node_first,
+                                               diagonal_first,
+                                               diagonal_last,
+                                               state->comp);
+                                }
+                            } catch (...) {
+                                state->exception_holder.capture();
+                            }
+                        });
+
+                    graph.addDependency(left, task);
+                    graph.addDependency(right, task);
+                    if (piece_count > 1) {
+                        graph.addDependency(task, join);
+                    } else {
+                        join = task;
+                    }
+                }
+
+                next_level_tasks.pushBack(join);
+            }
+
+            level_tasks = std::move(next_level_tasks);
+        }
+
+        graph.submit(policy.getTaskQueue());
+        graph.wait();
+        state->exception_holder.rethrow();
+    }
+
+private:
+    // size of the runs sorted with insertion sort before merging
+    static constexpr difference_type kRunSize = 32;
+
+    struct State {
+        State(RandomAccessIter data_first, difference_type count, Compare compare)
+            : first(data_first)
+            , buffer(static_cast<std::size_t>(count))
+            , comp(compare) {}
+
+        RandomAccessIter first;
+        Vector<value_type> buffer;
+        Compare comp;
+        ParallelExceptionHolder exception_holder;
+    };
+
+    static void sortLeaf(RandomAccessIter first,
+                         RandomAccessIter last,
+                         value_type* buffer,
+                         bool result_in_buffer,
+                         Compare& comp) {
+        auto count = last - first;
+        for (difference_type i = 0; i < count; i += kRunSize) {
+            nxt::core::insertionSort(first + i, first + std::min(i + kRunSize, count), comp);
+        }
+
+        bool in_buffer = false;
+        for (auto width = kRunSize; width < count; width *= 2) {
+            if (in_buffer) {
+                mergePass(buffer, first, count, width, comp);
+            } else {
+                mergePass(first, buffer, count, width, comp);
+            }
+            in_buffer = !in_buffer;
+        }
+
+        if (in_buffer != result_in_buffer) {
+            if (in_buffer) {
+                std::move(buffer, buffer + count, first);
+            } else {
+                std::move(first, last, buffer);
+            }
+        }
+    }
+
+    template<typename SourceIter, typename DestinationIter>
+    static void mergePass(SourceIter source,
+                          DestinationIter destination,
+                          difference_type count,
+                          difference_type width,
+                          Compare& comp) {
+        for (difference_type i = 0; i < count; i += 2 * width) {
+            auto mid = std::min(i + width, count);
+            auto last = std::min(i + 2 * width, count);
+            nxt::core::merge(std::make_move_iterator(source + i),
+                  std::make_move_iterator(source + mid),
+                  std::make_move_iterator(source + mid),
+                  std::make_move_iterator(source + last),
+                  destination + i,
+                  comp);
+        }
+    }
+
+    /**
+     * @brief Number of elements taken from the first range among the first diagonal elements of the stable
+     *        merge of the two ranges
+     */
+    template<typename SourceIter>
+    static difference_type coRank(SourceIter first1,
+                                  difference_type count1,
+                                  SourceIter first2,
+                                  difference_type count2,
+                                  difference_type diagonal,
+                                  Compare& comp) {
+        auto low = std::max(difference_type(0), diagonal - count2);
+        auto high = std::min(diagonal, count1);
+        while (low < high) {
+            auto mid = low + (high - low) / 2;
+            // elements of the first range win ties, so it is taken if it is not greater than its counterpart
+            if (!comp(*(first2 + (diagonal - mid - 1)), *(first1 + mid))) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    template<typename SourceIter, typename DestinationIter>
+    static void mergePiece(SourceIter first,
+                           SourceIter mid,
+                           SourceIter last,
+                           DestinationIter destination,
+                           difference_type diagonal_first,
+                           difference_type diagonal_last,
+                           Compare& comp) {
+        auto count1 = mid - first;
+        auto count2 = last - mid;
+        auto rank_first = coRank(first, count1, mid, count2, diagonal_first, comp);
+        auto rank_last = coRank(first, count1, mid, count2, diagonal_last, comp);
+
+        nxt::core::merge(std::make_move_iterator(first + rank_first),
+              std::make_move_iterator(first + rank_last),
+              std::make_move_iterator(mid + (diagonal_first - rank_first)),
+              std::make_move_iterator(mid + (diagonal_last - rank_last)),
+              destination + diagonal_first,
+              comp);
+    }
+};
+
+template<typename RandomAccessIter,
+         typename Compare,
+         typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+quickSort(const SequencedPolicy&, RandomAccessIter first, RandomAccessIter last, Compare comp) {
+    nxt::core::quickSort(first, last, comp);
+}
+
+template<typename RandomAccessIter, typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+quickSort(const SequencedPolicy& policy, RandomAccessIter first, RandomAccessIter last) {
+    nxt::core::quickSort(policy, first, last, std::less<>());
+}
+
+template<typename RandomAccessIter,
+         typename Compare,
+         typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+quickSort(const ParallelPolicy& policy, RandomAccessIter first, RandomAccessIter last, Compare comp) {
+    if (policy.shouldRunParallel(static_cast<std::size_t>(last - first))) {
+        ParallelQuickSort<RandomAccessIter, Compare>::sort(policy, first, last, comp);
+    } else {
+        nxt::core::quickSort(first, last, comp);
+    }
+}
+
+template<typename RandomAccessIter, typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+quickSort(const ParallelPolicy& policy, RandomAccessIter first, RandomAccessIter last) {
+    nxt::core::quickSort(policy, first, last, std::less<>());
+}
+
+template<typename RandomAccessIter,
+         typename Compare,
+         typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+mergeSort(RandomAccessIter first, RandomAccessIter last, Compare comp) {
+    ParallelMergeSort<RandomAccessIter, Compare>::sort(first, last, comp);
+}
+
+template<typename RandomAccessIter, typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+mergeSort(RandomAccessIter first, RandomAccessIter last) {
+    nxt::core::mergeSort(first, last, std::less<>());
+}
+
+template<typename RandomAccessIter,
+         typename Compare,
+         typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+mergeSort(const SequencedPolicy&, RandomAccessIter first, RandomAccessIter last, Compare comp) {
+    nxt::core::mergeSort(first, last, comp);
+}
+
+template<typename RandomAccessIter, typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+mergeSort(const SequencedPolicy& policy, RandomAccessIter first, RandomAccessIter last) {
+    nxt::core::mergeSort(policy, first, last, std::less<>());
+}
+
+template<typename RandomAccessIter,
+         typename Compare,
+         typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+mergeSort(const ParallelPolicy& policy, RandomAccessIter first, RandomAccessIter last, Compare comp) {
+    if (policy.shouldRunParallel(static_cast<std::size_t>(last - first))) {
+        ParallelMergeSort<RandomAccessIter, Compare>::sort(policy, first, last, comp);
+    } else {
+        nxt::core::mergeSort(first, last, comp);
+    }
+}
+
+template<typename RandomAccessIter, typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
+void
+mergeSort(const ParallelPolicy& policy, RandomAccessIter first, RandomAccessIter last) {
+    nxt::core::mergeSort(policy, first, last, std::less<>());
+}
+
+}  // namespace nxt::core
@@ -13,6 +13,20 @@ template<typename ForwardIter,
 lowerBound(ForwardIter first, ForwardIter last, const T& value, Compare comp) {
     auto distance = std::distance(first, last);
 
+    if constexpr (IsRandomAccessIteratorV<ForwardIter>) {
+        // halve the range without branching on the comparison, the result of the comparison scales the step so
+        // the search doesn't pay for the mispredicted branches when the range is in the cache
+        if (distance == 0) {
+            return first;
+        }
+        while (distance > 1) {
+            auto half = distance / 2;
+            first += static_cast<decltype(half)>(comp(first[half - 1], value)) * half;
+            distance -= half;
+        }
+        return comp(*first, value) ? first + 1 : first;
+    }
+
     while (distance > 0) {
         auto step = distance / 2;
         auto mid = std::next(first, step);
@@ -42,6 +56,18 @@ template<typename ForwardIter,
 upperBound(ForwardIter first, ForwardIter last, const T& value, Compare comp) {
     auto distance = std::distance(first, last);
 
+    if constexpr (IsRandomAccessIteratorV<ForwardIter>) {
+        if (distance == 0) {
+            return first;
+        }
+        while (distance > 1) {
+            auto half = distance / 2;
+            first += static_cast<decltype(half)>(!comp(value, first[half - 1])) * half;
+            distance -= half;
+        }
+        return comp(value, *first) ? first : first + 1;
+    }
+
     while (distance > 0) {
         auto step = distance / 2;
         auto mid = std::next(first, step);
@@ -2,7 +2,7 @@
 
 #include <memory>
 
-#include "../Container/Vector.h"
+#include "../Container/SmallVector.h"
 #include "Command.h"
 
 namespace nxt::core {
@@ -38,7 +38,10 @@ private:
     bool mergeWith(Command* command) noexcept override;
     bool supportsUndo() const noexcept override;
 
-    Vector<std::unique_ptr<Command>> child_commands_;
+    //! Groups usually hold a handful of commands, so they are stored inline
+    static constexpr std::size_t kInlineCommandCount = 4;
+
+    SmallVector<std::unique_ptr<Command>, kInlineCommandCount> child_commands_;
     bool has_executed_once_;
 };
 }  // namespace nxt::core
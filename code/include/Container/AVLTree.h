@@ -1,10 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
 #include "CommonTree.h"
+#include "NodePool.h"
 
 namespace nxt::core {
 
-template<typename TreeTraits>
+/**
+ * @brief Height balanced binary search tree
+ *
+ * @tparam TreeTraits SimpleTraits or MappedTraits describing the values and their keys
+ * @tparam OrderStatistics Keep the number of nodes of every subtree to answer select(), rank() and countRange() in
+ *         O(log N), for one more size_type per node
+ */
+template<typename TreeTraits, bool OrderStatistics = false>
 class AVLTree {
 private:
     struct Node;
@@ -22,15 +36,18 @@ public:
     using pointer = typename allocator_traits::pointer;
     using const_pointer = typename allocator_traits::const_pointer;
     using difference_type = typename allocator_traits::difference_type;
-    using const_iterator = TreeConstIterator<AVLTree<TreeTraits>>;
-    using iterator = TreeIterator<AVLTree<TreeTraits>>;
+    using const_iterator = TreeConstIterator<AVLTree>;
+    using iterator = TreeIterator<AVLTree>;
 
 protected:
     using node_allocator_type = typename allocator_traits::template rebind_alloc<node_type>;
     using node_allocator_traits = std::allocator_traits<node_allocator_type>;
     using node_pointer = typename node_allocator_traits::pointer;
     using node_const_pointer = typename node_allocator_traits::const_pointer;
+    using node_pool_type = NodePool<node_type, node_allocator_type>;
     using tree_traits = TreeTraits;
+    using tree_operations = TreeOperations<AVLTree>;
+    using insert_position = TreeInsertPosition<node_pointer>;
 
 public:
     AVLTree() noexcept(std::is_nothrow_default_constructible_v<node_allocator_type>&&
@@ -42,6 +59,14 @@ public:
         createHeadNode();
     }
 
+    explicit AVLTree(const allocator_type& alloc)
+        : head_node_()
+        , size_(0)
+        , compare_()
+        , alloc_(alloc) {
+        createHeadNode();
+    }
+
     AVLTree(AVLTree&& rhs)
         : head_node_()
         , size_(0)
@@ -50,6 +75,7 @@ public:
         createHeadNode();
         using std::swap;
         swap(head_node_, rhs.head_node_);
+        pool_.swap(rhs.pool_);
         size_ = rhs.size_;
         rhs.size_ = 0;
     }
@@ -60,50 +86,74 @@ public:
         , compare_(rhs.compare_)
         , alloc_(node_allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
         createHeadNode();
-        if (rhs.size_ > 0) {
-            auto root_node = copyTree(rhs.head_node_->parent);
-            head_node_->parent = root_node;
-            root_node->parent = head_node_;
-
-            auto min_node = root_node;
-            while (min_node->left_child != nullptr) {
-                min_node = min_node->left_child;
-            }
-            head_node_->left_child = min_node;
+        assignSorted(rhs.begin(), rhs.end());
+    }
 
-            auto max_node = root_node;
-            while (max_node->right_child != nullptr) {
-                max_node = max_node->right_child;
+    /**
+     * @brief Construct the tree from a range. Input sorted by strictly increasing keys is linked into a balanced
+     *        tree in O(N), anything else is inserted value by value
+     */
+    template<typename ForwardIt, typename = typename std::iterator_traits<ForwardIt>::iterator_category>
+    AVLTree(ForwardIt first, ForwardIt last, const allocator_type& alloc = allocator_type())
+        : head_node_()
+        , size_(0)
+        , compare_()
+        , alloc_(alloc) {
+        createHeadNode();
+        if (tree_operations::isStrictlySorted(*this, first, last)) {
+            assignSorted(first, last);
+        } else {
+            for (; first != last; ++first) {
+                insert(*first);
             }
-            head_node_->right_child = max_node;
         }
-
-        size_ = rhs.size_;
     }
 
+    /**
+     * @brief Insert the value if its key is not present
+     *
+     * @return Iterator to the inserted value or to the value with the same key, and true if the value was inserted
+     */
     std::pair<iterator, bool> insert(const value_type& value) {
-        auto node = insert(head_node_->parent, head_node_, true, value);
-        return {iterator(this, node), node != head_node_};
+        auto result = tree_operations::insertValue(*this, value);
+        return {iterator(this, result.first), result.second};
     }
 
     std::pair<iterator, bool> insert(value_type&& value) {
-        auto node = insert(head_node_->parent, head_node_, true, std::move(value));
-        return {iterator(this, node), node != head_node_};
+        auto result = tree_operations::insertValue(*this, std::move(value));
+        return {iterator(this, result.first), result.second};
+    }
+
+    /**
+     * @brief Insert the value right before the hint if that is where its key belongs, without searching the tree.
+     *        Inserting keys in increasing order with end() as the hint is amortized O(1). Otherwise this is a normal
+     *        insert
+     *
+     * @return Iterator to the inserted value or to the value with the same key
+     */
+    iterator insert(const_iterator hint, const value_type& value) {
+        return iterator(this, tree_operations::insertValue(*this, hint.node_, value).first);
+    }
+
+    iterator insert(const_iterator hint, value_type&& value) {
+        return iterator(this, tree_operations::insertValue(*this, hint.node_, std::move(value)).first);
     }
 
     template<typename... Args>
     std::pair<iterator, bool> emplace(Args&&... args) {
-        auto node = node_allocator_traits::allocate(alloc_, 1);
-        node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Args>(args)...);
-        node_allocator_traits::construct(alloc_, std::addressof(node->parent));
-        node_allocator_traits::construct(alloc_, std::addressof(node->left_child));
-        node_allocator_traits::construct(alloc_, std::addressof(node->right_child));
-        auto node = emplace(head_node_->parent, head_node_, true, node);
-        return {iterator(this, node), node != head_node_};
+        auto node = createNode(std::forward<Args>(args)...);
+        auto position = tree_operations::findInsertPosition(*this, tree_traits::key(node->value));
+        if (position.node != nullptr) {
+            destroyNode(node);
+            return {iterator(this, position.node), false};
+        }
+
+        insertNode(node, position);
+        return {iterator(this, node), true};
     }
 
     size_type erase(const key_type& key) {
-        auto node = findNode(key);
+        auto node = tree_operations::findNode(*this, key);
         if (node == head_node_) {
             return 0;
         } else {
@@ -112,16 +162,49 @@ public:
         }
     }
 
-    void clear() noexcept {
-        if (head_node_->parent != head_node_) {
-            freeTree(head_node_->parent);
+    template<typename Key, typename = typename compare_type::is_transparent>
+    size_type erase(const Key& key) {
+        auto node = tree_operations::findNode(*this, key);
+        if (node == head_node_) {
+            return 0;
+        } else {
+            eraseNode(node);
+            return 1;
+        }
+    }
+
+    /**
+     * @brief Replace the content of the tree with [first, last), which must be sorted by strictly increasing keys.
+     *        The nodes are linked into a perfectly balanced tree in O(N) instead of N inserts
+     */
+    template<typename ForwardIt>
+    void assignSorted(ForwardIt first, ForwardIt last) {
+        tree_operations::assignSorted(*this, first, last);
+    }
 
-            head_node_->parent = head_node_;
-            head_node_->left_child = nullptr;
-            head_node_->right_child = nullptr;
+    /**
+     * @brief Insert the values of [first, last), sorted by increasing keys. Values whose key is already present are
+     *        skipped. A batch large compared to the tree is merged with the existing nodes and relinked into a
+     *        balanced tree in O(N + M), a small one is inserted value by value
+     *
+     * @return Number of values inserted
+     */
+    template<typename ForwardIt>
+    size_type mergeSorted(ForwardIt first, ForwardIt last) {
+        return tree_operations::mergeSorted(*this, first, last);
+    }
 
-            size_ = 0;
-        }
+    /**
+     * @brief Destroy all the values and give the node slabs back to the allocator at once
+     */
+    void clear() noexcept {
+        tree_operations::destroyValues(*this);
+        pool_.release(alloc_);
+
+        head_node_->parent = nullptr;
+        head_node_->left_child = head_node_;
+        head_node_->right_child = head_node_;
+        size_ = 0;
     }
 
     ~AVLTree() {
@@ -133,25 +216,101 @@ public:
         node_allocator_traits::deallocate(alloc_, head_node_, 1);
     }
 
-    template<typename Key, typename = typename compare_type::is_transparent>
-    iterator erase(const Key& key) {}
-
     [[nodiscard]] const_iterator find(const key_type& value) const {
-        return const_iterator(this, findNode(value));
+        return const_iterator(this, tree_operations::findNode(*this, value));
     }
 
     [[nodiscard]] iterator find(const key_type& value) {
-        return iterator(this, findNode(value));
+        return iterator(this, tree_operations::findNode(*this, value));
     }
 
     template<typename Key, typename = typename compare_type::is_transparent>
     [[nodiscard]] const_iterator find(const Key& value) const {
-        return const_iterator(this, findNode(value));
+        return const_iterator(this, tree_operations::findNode(*this, value));
     }
 
     template<typename Key, typename = typename compare_type::is_transparent>
     [[nodiscard]] iterator find(const Key& value) {
-        return iterator(this, findNode(value));
+        return iterator(this, tree_operations::findNode(*this, value));
+    }
+
+    /**
+     * @brief Get the first value whose key is not less than the key, or end() if there is none
+     */
+    [[nodiscard]] const_iterator lowerBound(const key_type& key) const {
+        return const_iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    [[nodiscard]] iterator lowerBound(const key_type& key) {
+        return iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator lowerBound(const Key& key) const {
+        return const_iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator lowerBound(const Key& key) {
+        return iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    /**
+     * @brief Get the first value whose key is greater than the key, or end() if there is none
+     */
+    [[nodiscard]] const_iterator upperBound(const key_type& key) const {
+        return const_iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    [[nodiscard]] iterator upperBound(const key_type& key) {
+        return iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator upperBound(const Key& key) const {
+        return const_iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator upperBound(const Key& key) {
+        return iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    /**
+     * @brief Get the value at the zero based position in the order of the keys in O(log N), or end() if the position
+     *        is past the last value. Only available when the tree keeps order statistics
+     */
+    [[nodiscard]] const_iterator select(size_type position) const {
+        return const_iterator(this, selectNode(position));
+    }
+
+    [[nodiscard]] iterator select(size_type position) {
+        return iterator(this, selectNode(position));
+    }
+
+    /**
+     * @brief Count the keys less than the key in O(log N), which is the position the key has or would have in the
+     *        tree. Only available when the tree keeps order statistics
+     */
+    [[nodiscard]] size_type rank(const key_type& key) const {
+        return rankOf(key);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] size_type rank(const Key& key) const {
+        return rankOf(key);
+    }
+
+    /**
+     * @brief Count the keys in [lower, upper) in O(log N). Only available when the tree keeps order statistics
+     */
+    [[nodiscard]] size_type countRange(const key_type& lower, const key_type& upper) const {
+        return countRangeOf(lower, upper);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] size_type countRange(const Key& lower, const Key& upper) const {
+        return countRangeOf(lower, upper);
     }
 
     [[nodiscard]] iterator begin() {
@@ -182,8 +341,12 @@ public:
         return size_;
     }
 
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
 private:
-    struct Node {
+    struct Node : TreeNodeCount<size_type, OrderStatistics> {
         value_type value;
         node_pointer parent;
         node_pointer left_child;
@@ -191,199 +354,220 @@ private:
         int32_t height;
     };
 
-    template<typename Arg>
-    node_pointer insert(node_pointer node, node_pointer parent, bool is_left, Arg&& arg) {
-        if (node == head_node_ || node == nullptr) {
-            auto node = node_allocator_traits::allocate(alloc_, 1);
-            node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Arg>(arg));
-
-            node_allocator_traits::construct(alloc_, std::addressof(node->parent), parent);
-            node_allocator_traits::construct(alloc_, std::addressof(node->left_child));
-            node_allocator_traits::construct(alloc_, std::addressof(node->right_child));
-            node->height = 0;
-
-            if (parent == head_node_) {
-                head_node_->parent = node;
+    void insertNode(node_pointer node, const insert_position& position) noexcept {
+        linkNode(node, position.parent, position.is_left);
+        adjustSizes(position.parent, true);
+        rebalanceUpwards(position.parent);
+    }
+
+    /**
+     * @brief Link a new leaf node as a child of parent and update the min and max nodes
+     */
+    node_pointer linkNode(node_pointer node, node_pointer parent, bool is_left) noexcept {
+        node->parent = parent;
+        node->left_child = nullptr;
+        node->right_child = nullptr;
+        node->height = 0;
+        updateSize(node);
+
+        if (parent == head_node_) {
+            head_node_->parent = node;
+            head_node_->left_child = node;
+            head_node_->right_child = node;
+        } else if (is_left) {
+            parent->left_child = node;
+            if (parent == head_node_->left_child)
                 head_node_->left_child = node;
+        } else {
+            parent->right_child = node;
+            if (parent == head_node_->right_child)
                 head_node_->right_child = node;
-            } else if (is_left) {
-                parent->left_child = node;
-                if (parent == head_node_->left_child)
-                    head_node_->left_child = node;
-            } else {
-                parent->right_child = node;
-                if (parent == head_node_->right_child)
-                    head_node_->right_child = node;
-            }
+        }
+
+        ++size_;
 
-            ++size_;
+        return node;
+    }
 
-            return node;
+    /**
+     * @brief Link the sorted nodes into a balanced tree which replaces the current one
+     */
+    void linkSorted(node_pointer* nodes, size_type count) noexcept {
+        auto root_node = linkBalanced(nodes, 0, count, head_node_);
+        head_node_->parent = root_node;
+        head_node_->left_child = nodes[0];
+        head_node_->right_child = nodes[count - 1];
+        size_ = count;
+    }
+
+    /**
+     * @brief Make the middle node of [begin, end) the root of the subtree and recurse on both halves. The recursion
+     *        is only log2(N) deep and the heights of the halves differ by at most one, so the result is balanced
+     */
+    node_pointer linkBalanced(node_pointer* nodes, size_type begin, size_type end, node_pointer parent) noexcept {
+        if (begin == end) {
+            return nullptr;
         }
 
-        if (compare_(tree_traits::key(arg), tree_traits::key(node->value))) {
-            auto result = insert(node->left_child, node, true, std::forward<Arg>(arg));
-            balanceNode(node);
-            return result;
-        } else if (compare_(tree_traits::key(node->value), tree_traits::key(arg))) {
-            auto result = insert(node->right_child, node, false, std::forward<Arg>(arg));
-            balanceNode(node);
-            return result;
-        } else {
-            return head_node_;
+        auto middle = begin + (end - begin) / 2;
+        auto node = nodes[middle];
+        node->parent = parent;
+        node->left_child = linkBalanced(nodes, begin, middle, node);
+        node->right_child = linkBalanced(nodes, middle + 1, end, node);
+        calculateHeight(node);
+        updateSize(node);
+        return node;
+    }
+
+    void createHeadNode() {
+        head_node_ = node_allocator_traits::allocate(alloc_, 1);
+        node_allocator_traits::construct(alloc_, std::addressof(head_node_->parent));
+        node_allocator_traits::construct(alloc_, std::addressof(head_node_->left_child), head_node_);
+        node_allocator_traits::construct(alloc_, std::addressof(head_node_->right_child), head_node_);
+        head_node_->height = -1;
+    }
+
+    template<typename... Args>
+    node_pointer createNode(Args&&... args) {
+        auto node = pool_.allocate(alloc_);
+        try {
+            node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Args>(args)...);
+        } catch (...) {
+            pool_.deallocate(node);
+            throw;
         }
+        node_allocator_traits::construct(alloc_, std::addressof(node->parent));
+        node_allocator_traits::construct(alloc_, std::addressof(node->left_child));
+        node_allocator_traits::construct(alloc_, std::addressof(node->right_child));
+        return node;
     }
 
-    node_pointer emplace(node_pointer node, node_pointer parent, bool is_left, node_pointer node_to_add) {
-        if (node == head_node_ || node == nullptr) {
-            node_to_add->parent = parent;
-            node_to_add->height = 0;
-            node_to_add->left_child = nullptr;
-            node_to_add->right_child = nullptr;
-            node_to_add->parent = parent;
-
-            if (parent == head_node_) {
-                head_node_->parent = node_to_add;
-                head_node_->left_child = node_to_add;
-                head_node_->right_child = node_to_add;
-            } else if (is_left) {
-                parent->left_child = node_to_add;
-                if (parent == head_node_->left_child)
-                    head_node_->left_child = node_to_add;
-            } else {
-                parent->right_child = node_to_add;
-                if (parent == head_node_->right_child)
-                    head_node_->right_child = node_to_add;
-            }
+    void destroyNode(node_pointer node) noexcept {
+        node_allocator_traits::destroy(alloc_, std::addressof(node->value));
+        node_allocator_traits::destroy(alloc_, std::addressof(node->parent));
+        node_allocator_traits::destroy(alloc_, std::addressof(node->left_child));
+        node_allocator_traits::destroy(alloc_, std::addressof(node->right_child));
+        pool_.deallocate(node);
+    }
 
-            ++size_;
+    /**
+     * @brief Parent of the node, used by the iterators which don't know how the node stores it
+     */
+    static node_pointer parentOf(node_pointer node) noexcept {
+        return node->parent;
+    }
 
-            return node_to_add;
-        }
+    //! number of nodes in the subtree of the node, 0 for nullptr
+    static size_type subtreeSize(node_pointer node) noexcept {
+        return node != nullptr ? node->subtree_size : 0;
+    }
 
-        if (compare_(tree_traits::key(node_to_add->value), tree_traits::key(node->value))) {
-            auto result = emplace(node->left_child, node, true, node_to_add);
-            balanceNode(node);
-            return result;
-        } else if (compare_(tree_traits::key(node->value), tree_traits::key(node_to_add->value))) {
-            auto result = emplace(node->right_child, node, false, node_to_add);
-            balanceNode(node);
-            return result;
-        } else {
-            node_allocator_traits::destroy(alloc_, std::addressof(node_to_add->value));
-            node_allocator_traits::destroy(alloc_, std::addressof(node_to_add->parent));
-            node_allocator_traits::destroy(alloc_, std::addressof(node_to_add->left_child));
-            node_allocator_traits::destroy(alloc_, std::addressof(node_to_add->right_child));
-            node_allocator_traits::deallocate(alloc_, node_to_add, 1);
-            return head_node_;
+    static void updateSize(node_pointer node) noexcept {
+        if constexpr (OrderStatistics) {
+            node->subtree_size = subtreeSize(node->left_child) + subtreeSize(node->right_child) + 1;
         }
     }
 
-    template<typename Key>
-    node_pointer lowerBoundNode(const Key& key) const {
-        // intialize with end node
-        node_pointer result = head_node_;
-        node_pointer node = head_node_->parent;
-
-        while (node != nullptr) {
-            if (compare_(tree_traits::key(node->value), key)) {
-                node = node->left_child;
-            } else {
-                // if compare fails, then we update the result with the node
-                // as it points to a value not less than key
-                result = node;
-                node = node->right_child;
+    /**
+     * @brief Add the change to the subtree sizes of the node and its ancestors, once a node is linked or before it
+     *        is unlinked. Rotations only need to recompute the sizes of the nodes they move
+     */
+    void adjustSizes(node_pointer node, bool grows) noexcept {
+        if constexpr (OrderStatistics) {
+            for (; node != head_node_; node = node->parent) {
+                if (grows) {
+                    ++node->subtree_size;
+                } else {
+                    --node->subtree_size;
+                }
             }
         }
-
-        return result;
     }
 
-    template<typename Key>
-    node_pointer upperBoundNode(const Key& key) const {
-        // intialize with end node
-        node_pointer result = head_node_;
-        node_pointer node = head_node_->parent;
+    node_pointer selectNode(size_type position) const noexcept {
+        static_assert(OrderStatistics, "select needs a tree keeping order statistics");
+        if (position >= size_) {
+            return head_node_;
+        }
 
-        while (node != nullptr) {
-            if (compare_(key, tree_traits::key(node->value))) {
-                result = node;
+        auto node = head_node_->parent;
+        while (true) {
+            auto left_size = subtreeSize(node->left_child);
+            if (position < left_size) {
                 node = node->left_child;
-            } else {
+            } else if (position > left_size) {
+                position -= left_size + 1;
                 node = node->right_child;
+            } else {
+                return node;
             }
         }
-
-        return result;
     }
 
     template<typename Key>
-    node_pointer findNode(const Key& key) const {
-        node_pointer node = head_node_->parent;
-
+    size_type rankOf(const Key& key) const {
+        static_assert(OrderStatistics, "rank needs a tree keeping order statistics");
+        size_type result = 0;
+        auto node = head_node_->parent;
         while (node != nullptr) {
-            if (compare_(key, tree_traits::key(node->value))) {
-                node = node->left_child;
-            } else if (compare_(tree_traits::key(node->value), key)) {
+            if (compare_(tree_traits::key(node->value), key)) {
+                result += subtreeSize(node->left_child) + 1;
                 node = node->right_child;
             } else {
-                return node;
+                node = node->left_child;
             }
         }
+        return result;
+    }
 
-        return head_node_;
+    template<typename Key>
+    size_type countRangeOf(const Key& lower, const Key& upper) const {
+        static_assert(OrderStatistics, "countRange needs a tree keeping order statistics");
+        if (!compare_(lower, upper)) {
+            return 0;
+        }
+        return rankOf(upper) - rankOf(lower);
     }
 
-    void createHeadNode() {
-        head_node_ = node_allocator_traits::allocate(alloc_, 1);
-        node_allocator_traits::construct(alloc_, std::addressof(head_node_->parent), head_node_);
-        node_allocator_traits::construct(alloc_, std::addressof(head_node_->left_child));
-        node_allocator_traits::construct(alloc_, std::addressof(head_node_->right_child));
-        head_node_->height = -1;
+    /**
+     * @brief Replace the child of parent, or the root if parent is the head node
+     */
+    void replaceChild(node_pointer parent, node_pointer child, node_pointer new_child) noexcept {
+        if (parent == head_node_) {
+            head_node_->parent = new_child;
+        } else if (parent->left_child == child) {
+            parent->left_child = new_child;
+        } else {
+            parent->right_child = new_child;
+        }
     }
 
     void eraseNode(node_pointer node) {
         auto parent_node = node->parent;
         auto last_affected_node = head_node_;
 
-        if (node->left_child == nullptr && node->right_child == nullptr) {
-            // if the node being removed has no childs, then just remove the link
-            // in the parent node
-            if (parent_node == head_node_) {
-                head_node_->left_child = nullptr;
-                head_node_->right_child = nullptr;
-                head_node_->parent = head_node_;
-            } else if (parent_node->left_child == node) {
-                parent_node->left_child = nullptr;
-            } else {
-                parent_node->right_child = nullptr;
-            }
-            last_affected_node = parent_node;
-        } else if (node->left_child != nullptr && node->right_child == nullptr) {
-            // if node being removed has a left child only, move up the left child so that it
-            // it is child of parent node now
-            auto replace_node = node->left_child;
-            replace_node->parent = parent_node;
-            if (parent_node == head_node_) {
-                head_node_->parent = replace_node;
-            } else if (parent_node->left_child == node) {
-                parent_node->left_child = replace_node;
-            } else {
-                parent_node->right_child = replace_node;
-            }
-            last_affected_node = parent_node;
-        } else if (node->right_child != nullptr && node->left_child == nullptr) {
-            // if node being removed has a right child only, move up the right child so that it
+        // the min node has no left child, so its successor is either in the right subtree or the parent node,
+        // which is the head node when the tree becomes empty. The same goes for the max node the other way round
+        if (node == head_node_->left_child) {
+            head_node_->left_child =
+                node->right_child != nullptr ? tree_operations::minNode(node->right_child) : parent_node;
+        }
+
+        if (node == head_node_->right_child) {
+            head_node_->right_child =
+                node->left_child != nullptr ? tree_operations::maxNode(node->left_child) : parent_node;
+        }
+
+        if (node->left_child == nullptr || node->right_child == nullptr) {
+            adjustSizes(parent_node, false);
+
+            // if node being removed has a single child or none, move up the child so that it
             // it is child of parent node now
-            auto replace_node = node->right_child;
-            replace_node->parent = parent_node;
-            if (parent_node == head_node_) {
-                head_node_->parent = replace_node;
-            } else if (parent_node->left_child == node) {
-                parent_node->left_child = replace_node;
-            } else {
-                parent_node->right_child = replace_node;
+            auto replace_node = node->left_child != nullptr ? node->left_child : node->right_child;
+            if (replace_node != nullptr) {
+                replace_node->parent = parent_node;
             }
+            replaceChild(parent_node, node, replace_node);
             last_affected_node = parent_node;
         } else {
             // if both child are present, find the max element in the left subtree
@@ -393,6 +577,7 @@ private:
             }
 
             auto replace_parent = replace_node->parent;
+            adjustSizes(replace_parent, false);
             if (replace_parent->left_child == replace_node) {
                 replace_parent->left_child = replace_node->left_child;
                 if (replace_parent->left_child != nullptr)
@@ -403,7 +588,6 @@ private:
                     replace_parent->right_child->parent = replace_parent;
             }
 
-            
             replace_node->left_child = node->left_child;
             if (replace_node->left_child != nullptr)
                 replace_node->left_child->parent = replace_node;
@@ -413,86 +597,25 @@ private:
                 replace_node->right_child->parent = replace_node;
 
             replace_node->parent = parent_node;
-            if (parent_node == head_node_) {
-                head_node_->parent = replace_node;
-            } else if (parent_node->left_child == node) {
-                parent_node->left_child = replace_node;
-            } else {
-                parent_node->left_child = replace_node;
+            replace_node->height = node->height;
+            if constexpr (OrderStatistics) {
+                replace_node->subtree_size = node->subtree_size;
             }
+            replaceChild(parent_node, node, replace_node);
 
+            // the replacing node took the place of node, so rebalance from where it was taken
             if (replace_parent == node) {
-                last_affected_node = parent_node;
+                last_affected_node = replace_node;
             } else {
                 last_affected_node = replace_parent;
             }
         }
 
-        if (node == head_node_->left_child) {
-            if (node->parent != head_node_) {
-                head_node_->left_child = node->parent;
-            } else {
-                head_node_->left_child = head_node_->parent;
-            }
-        }
-
-        if (node == head_node_->right_child) {
-            if (node->parent != head_node_) {
-                head_node_->right_child = node->parent;
-            } else {
-                head_node_->right_child = head_node_->parent;
-            }
-        }
-
-
         --size_;
 
-        while (last_affected_node != head_node_) {
-            balanceNode(last_affected_node);
-            last_affected_node = last_affected_node->parent;
-        }
-
-        node_allocator_traits::destroy(alloc_, std::addressof(node->value));
-        node_allocator_traits::destroy(alloc_, std::addressof(node->parent));
-        node_allocator_traits::destroy(alloc_, std::addressof(node->left_child));
-        node_allocator_traits::destroy(alloc_, std::addressof(node->right_child));
-        node_allocator_traits::deallocate(alloc_, node, 1);
-    }
-
-    void freeTree(node_pointer node) noexcept {
-        if (node != nullptr) {
-            freeTree(node->left_child);
-            freeTree(node->right_child);
+        rebalanceUpwards(last_affected_node);
 
-            node_allocator_traits::destroy(alloc_, std::addressof(node->value));
-            node_allocator_traits::destroy(alloc_, std::addressof(node->parent));
-            node_allocator_traits::destroy(alloc_, std::addressof(node->left_child));
-            node_allocator_traits::destroy(alloc_, std::addressof(node->right_child));
-            node_allocator_traits::deallocate(alloc_, node, 1);
-        }
-    }
-
-    node_pointer copyTree(node_pointer node) {
-        auto copy_node = node_allocator_traits::allocate(alloc_, 1);
-        node_allocator_traits::construct(alloc_, std::addressof(copy_node->value), node->value);
-        node_allocator_traits::construct(alloc_, std::addressof(copy_node->parent));
-        node_allocator_traits::construct(alloc_, std::addressof(copy_node->left_child));
-        node_allocator_traits::construct(alloc_, std::addressof(copy_node->right_child));
-        copy_node->height = node->height;
-
-        if (node->left_child != nullptr) {
-            auto left_child = copyTree(node->left_child);
-            copy_node->left_child = left_child;
-            left_child->parent = copy_node;
-        }
-
-        if (node->right_child != nullptr) {
-            auto right_child = copyTree(node->right_child);
-            copy_node->right_child = right_child;
-            right_child->parent = copy_node;
-        }
-
-        return copy_node;
+        destroyNode(node);
     }
 
     int32_t height(node_pointer node) const noexcept {
@@ -507,6 +630,25 @@ private:
         node->height = std::max(height(node->left_child), height(node->right_child)) + 1;
     }
 
+    /**
+     * @brief Rebalance the node and its ancestors with a loop following the parent links. Stops at the first
+     *        subtree whose height didn't change, as the nodes above it are left as they were
+     */
+    void rebalanceUpwards(node_pointer node) noexcept {
+        while (node != head_node_) {
+            auto parent_node = node->parent;
+            auto old_height = node->height;
+            balanceNode(node);
+
+            // a rotation moves the node down, the root of the subtree is then its new parent
+            auto subtree_root = node->parent != parent_node ? node->parent : node;
+            if (subtree_root->height == old_height) {
+                return;
+            }
+            node = parent_node;
+        }
+    }
+
     void balanceNode(node_pointer node) {
         constexpr int32_t max_imbalance = 1;
         if (height(node->left_child) - height(node->right_child) > max_imbalance) {
@@ -530,16 +672,7 @@ private:
         auto parent_node = node->parent;
         auto left_node = node->left_child;
 
-        if (parent_node == head_node_) {
-            parent_node->parent = left_node;
-        } else {
-            auto is_left = parent_node->left_child == node;
-            if (is_left) {
-                parent_node->left_child = left_node;
-            } else {
-                parent_node->right_child = left_node;
-            }
-        }
+        replaceChild(parent_node, node, left_node);
         left_node->parent = parent_node;
 
         node->left_child = left_node->right_child;
@@ -551,24 +684,16 @@ private:
         node->parent = left_node;
 
         calculateHeight(node);
+        updateSize(node);
         calculateHeight(left_node);
+        updateSize(left_node);
     }
 
     void rotateOuterRight(node_pointer node) {
         auto parent_node = node->parent;
         auto right_node = node->right_child;
 
-        if (parent_node == head_node_) {
-            parent_node->parent = right_node;
-        } else {
-            auto is_left = parent_node->left_child == node;
-            if (is_left) {
-                parent_node->left_child = right_node;
-            } else {
-                parent_node->right_child = right_node;
-            }
-        }
-
+        replaceChild(parent_node, node, right_node);
         right_node->parent = parent_node;
 
         node->right_child = right_node->left_child;
@@ -580,7 +705,9 @@ private:
         node->parent = right_node;
 
         calculateHeight(node);
+        updateSize(node);
         calculateHeight(right_node);
+        updateSize(right_node);
     }
 
     void rotateInnerLeft(node_pointer node) {
@@ -588,13 +715,7 @@ private:
         auto left_node = node->left_child;
         auto inner_right_node = left_node->right_child;
 
-        auto is_left = parent_node->left_child == node;
-
-        if (is_left) {
-            parent_node->left_child = inner_right_node;
-        } else {
-            parent_node->right_child = inner_right_node;
-        }
+        replaceChild(parent_node, node, inner_right_node);
         inner_right_node->parent = parent_node;
 
         left_node->right_child = inner_right_node->left_child;
@@ -612,8 +733,11 @@ private:
         node->parent = inner_right_node;
 
         calculateHeight(left_node);
+        updateSize(left_node);
         calculateHeight(node);
+        updateSize(node);
         calculateHeight(inner_right_node);
+        updateSize(inner_right_node);
     }
 
     void rotateInnerRight(node_pointer node) {
@@ -621,18 +745,12 @@ private:
         auto right_node = node->right_child;
         auto inner_left_node = right_node->left_child;
 
-        auto is_left = parent_node->left_child == node;
-
-        if (is_left) {
-            parent_node->left_child = inner_left_node;
-        } else {
-            parent_node->right_child = inner_left_node;
-        }
+        replaceChild(parent_node, node, inner_left_node);
         inner_left_node->parent = parent_node;
 
         right_node->left_child = inner_left_node->right_child;
-        if (right_node->right_child != nullptr)
-            right_node->right_child->parent = right_node;
+        if (right_node->left_child != nullptr)
+            right_node->left_child->parent = right_node;
 
         node->right_child = inner_left_node->left_child;
         if (node->right_child != nullptr)
@@ -645,17 +763,22 @@ private:
         right_node->parent = inner_left_node;
 
         calculateHeight(right_node);
+        updateSize(right_node);
         calculateHeight(node);
+        updateSize(node);
         calculateHeight(inner_left_node);
+        updateSize(inner_left_node);
     }
 
     node_pointer head_node_;
     size_type size_;
     compare_type compare_;
     node_allocator_type alloc_;
+    node_pool_type pool_;
 
     friend iterator;
     friend const_iterator;
+    friend tree_operations;
 };
 
-}  // namespace nxt::core
\ No newline at end of file
+}  // namespace nxt::core
@@ -1,36 +1,1178 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <type_traits>
+#include <utility>
+
 #include "Buffer.h"
 
 namespace nxt::core {
 
+/**
+ * @brief Result of operator-> of the BTree iterators. Keys and values are stored in separate arrays, so the
+ *        iterators can't hand out a pointer to a stored pair and return a pair of references instead
+ */
+template<typename Reference>
+struct BTreeArrowProxy {
+    Reference reference;
+
+    const Reference* operator->() const noexcept {
+        return std::addressof(reference);
+    }
+};
+
+template<typename Tree>
+class BTreeConstIterator {
+public:
+    using value_type = typename Tree::value_type;
+    using difference_type = typename Tree::difference_type;
+    using reference = typename Tree::const_reference;
+    using pointer = BTreeArrowProxy<reference>;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using tree_type = Tree;
+    using size_type = typename Tree::size_type;
+    using key_type = typename Tree::key_type;
+    using mapped_type = typename Tree::mapped_type;
+    using leaf_pointer = typename Tree::leaf_pointer;
+
+    BTreeConstIterator(const tree_type* tree, leaf_pointer leaf, size_type index)
+        : tree_(tree)
+        , leaf_(leaf)
+        , index_(index) {}
+
+    reference operator*() const {
+        return reference(leaf_->keys[index_], leaf_->values[index_]);
+    }
+
+    pointer operator->() const {
+        return pointer{**this};
+    }
+
+    [[nodiscard]] const key_type& key() const {
+        return leaf_->keys[index_];
+    }
+
+    [[nodiscard]] const mapped_type& value() const {
+        return leaf_->values[index_];
+    }
+
+    BTreeConstIterator& operator++() {
+        ++index_;
+        if (index_ == leaf_->count) {
+            leaf_ = leaf_->next;
+            index_ = 0;
+        }
+        return *this;
+    }
+
+    BTreeConstIterator operator++(int) {
+        BTreeConstIterator result(*this);
+        ++(*this);
+        return result;
+    }
+
+    BTreeConstIterator& operator--() {
+        if (leaf_ == nullptr) {
+            leaf_ = tree_->last_leaf_;
+            index_ = leaf_->count - 1;
+        } else if (index_ == 0) {
+            leaf_ = leaf_->previous;
+            index_ = leaf_->count - 1;
+        } else {
+            --index_;
+        }
+        return *this;
+    }
+
+    BTreeConstIterator operator--(int) {
+        BTreeConstIterator result(*this);
+        --(*this);
+        return result;
+    }
+
+    bool operator==(const BTreeConstIterator& rhs) const noexcept {
+        return leaf_ == rhs.leaf_ && index_ == rhs.index_;
+    }
+
+    bool operator!=(const BTreeConstIterator& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+protected:
+    const tree_type* tree_;
+    leaf_pointer leaf_;
+    size_type index_;
+};
+
+template<typename Tree>
+class BTreeIterator : public BTreeConstIterator<Tree> {
+public:
+    using base_type = BTreeConstIterator<Tree>;
+    using value_type = typename Tree::value_type;
+    using difference_type = typename Tree::difference_type;
+    using reference = typename Tree::reference;
+    using pointer = BTreeArrowProxy<reference>;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using tree_type = Tree;
+    using size_type = typename Tree::size_type;
+    using mapped_type = typename Tree::mapped_type;
+    using leaf_pointer = typename Tree::leaf_pointer;
+
+    BTreeIterator(tree_type* tree, leaf_pointer leaf, size_type index)
+        : base_type(tree, leaf, index) {}
+
+    reference operator*() const {
+        return reference(this->leaf_->keys[this->index_], this->leaf_->values[this->index_]);
+    }
+
+    pointer operator->() const {
+        return pointer{**this};
+    }
+
+    [[nodiscard]] mapped_type& value() const {
+        return this->leaf_->values[this->index_];
+    }
+
+    BTreeIterator& operator++() {
+        base_type::operator++();
+        return *this;
+    }
+
+    BTreeIterator operator++(int) {
+        BTreeIterator result(*this);
+        base_type::operator++();
+        return result;
+    }
+
+    BTreeIterator& operator--() {
+        base_type::operator--();
+        return *this;
+    }
+
+    BTreeIterator operator--(int) {
+        BTreeIterator result(*this);
+        base_type::operator--();
+        return result;
+    }
+};
+
+/**
+ * @brief Ordered map stored as an in memory B+tree. Every node takes about BlockSize bytes, so a lookup touches a
+ *        handful of contiguous blocks instead of chasing a pointer per level like AVLTree. Keys and values of a node
+ *        live in separate arrays: the search inside a node only reads keys and, for arithmetic keys, is a branchless
+ *        linear scan the compiler can vectorize. Values are only stored in the leaves, which are linked to each other
+ *        so iterating is a walk over contiguous arrays.
+ *
+ *        Inserting and erasing invalidate all the iterators, as values move between nodes when they split and merge.
+ *
+ * @tparam Key Type of the keys
+ * @tparam Value Type of the mapped values
+ * @tparam BlockSize Target size of a node in bytes, best kept a multiple of the cache line size
+ * @tparam Compare Ordering of the keys
+ * @tparam Allocator Allocator of std::pair<const Key, Value>, rebound to allocate the nodes
+ */
 template<typename Key,
          typename Value,
-         std::size_t BlockSize,
+         std::size_t BlockSize = 256,
          typename Compare = std::less<>,
          typename Allocator = std::allocator<std::pair<const Key, Value>>>
 class BTree {
+    static_assert(BlockSize > 3 * sizeof(void*), "BlockSize must leave room for the node header");
+
+private:
+    struct Node;
+    struct InternalNode;
+    struct LeafNode;
+
 public:
     using key_type = Key;
     using mapped_type = Value;
-    using value_type = std::pair<const key_type, value_type>;
-    using reference = value_type&;
-    using const_reference = const value_type&;
+    using value_type = std::pair<const key_type, mapped_type>;
+    using reference = std::pair<const key_type&, mapped_type&>;
+    using const_reference = std::pair<const key_type&, const mapped_type&>;
     using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
     using allocator_traits = std::allocator_traits<allocator_type>;
+    using size_type = typename allocator_traits::size_type;
+    using difference_type = typename allocator_traits::difference_type;
     using compare_type = Compare;
+    using const_iterator = BTreeConstIterator<BTree>;
+    using iterator = BTreeIterator<BTree>;
+
+    static constexpr size_type block_size = BlockSize;
+
+    //! maximum number of values of a leaf, the node header takes two links and the count
+    static constexpr size_type leaf_capacity =
+        std::max<size_type>(4, (BlockSize - 3 * sizeof(void*)) / (sizeof(key_type) + sizeof(mapped_type)));
+
+    //! maximum number of keys of an internal node, which has one child more than keys
+    static constexpr size_type internal_capacity =
+        std::max<size_type>(4, (BlockSize - 2 * sizeof(void*)) / (sizeof(key_type) + sizeof(void*)));
 
 private:
-    struct InternalNode;
-    struct LeafNode;
+    friend const_iterator;
+    friend iterator;
+
+    using leaf_node_allocator = typename allocator_traits::template rebind_alloc<LeafNode>;
+    using leaf_node_allocator_traits = std::allocator_traits<leaf_node_allocator>;
+    using internal_node_allocator = typename allocator_traits::template rebind_alloc<InternalNode>;
+    using internal_node_allocator_traits = std::allocator_traits<internal_node_allocator>;
+    using node_pointer = Node*;
+    using leaf_pointer = LeafNode*;
+    using internal_pointer = InternalNode*;
+
+    static constexpr size_type kMinLeafCount = leaf_capacity / 2;
+    static constexpr size_type kMinInternalCount = (internal_capacity - 1) / 2;
+
+    //! enough for any tree fitting in memory, the fan out of a node is at least 3
+    static constexpr size_type kMaxHeight = 64;
+
+    static constexpr bool kLinearSearch =
+        std::is_arithmetic_v<key_type> &&
+        (std::is_same_v<compare_type, std::less<>> || std::is_same_v<compare_type, std::less<key_type>> ||
+         std::is_same_v<compare_type, std::greater<>> || std::is_same_v<compare_type, std::greater<key_type>>);
+
+public:
+    BTree() noexcept(std::is_nothrow_default_constructible_v<leaf_node_allocator>&&
+                         std::is_nothrow_default_constructible_v<internal_node_allocator>&&
+                             std::is_nothrow_default_constructible_v<compare_type>)
+        : root_(nullptr)
+        , first_leaf_(nullptr)
+        , last_leaf_(nullptr)
+        , height_(0)
+        , size_(0)
+        , compare_()
+        , internal_node_alloc_()
+        , leaf_node_alloc_() {}
+
+    explicit BTree(const allocator_type& alloc)
+        : root_(nullptr)
+        , first_leaf_(nullptr)
+        , last_leaf_(nullptr)
+        , height_(0)
+        , size_(0)
+        , compare_()
+        , internal_node_alloc_(alloc)
+        , leaf_node_alloc_(alloc) {}
+
+    BTree(BTree&& rhs)
+        : root_(rhs.root_)
+        , first_leaf_(rhs.first_leaf_)
+        , last_leaf_(rhs.last_leaf_)
+        , height_(rhs.height_)
+        , size_(rhs.size_)
+        , compare_(rhs.compare_)
+        , internal_node_alloc_(std::move(rhs.internal_node_alloc_))
+        , leaf_node_alloc_(std::move(rhs.leaf_node_alloc_)) {
+        rhs.root_ = nullptr;
+        rhs.first_leaf_ = nullptr;
+        rhs.last_leaf_ = nullptr;
+        rhs.height_ = 0;
+        rhs.size_ = 0;
+    }
+
+    BTree(const BTree& rhs)
+        : root_(nullptr)
+        , first_leaf_(nullptr)
+        , last_leaf_(nullptr)
+        , height_(0)
+        , size_(0)
+        , compare_(rhs.compare_)
+        , internal_node_alloc_(
+              internal_node_allocator_traits::select_on_container_copy_construction(rhs.internal_node_alloc_))
+        , leaf_node_alloc_(leaf_node_allocator_traits::select_on_container_copy_construction(rhs.leaf_node_alloc_)) {
+        bulkLoad(rhs.begin(), rhs.size_);
+    }
+
+    ~BTree() {
+        clear();
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return insertUnique(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return insertUnique(value.first, std::move(value.second));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        std::pair<key_type, mapped_type> value(std::forward<Args>(args)...);
+        return insertUnique(std::move(value.first), std::move(value.second));
+    }
+
+    /**
+     * @brief Insert a value constructed from args if the key is not present. Nothing is constructed otherwise
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> tryEmplace(const key_type& key, Args&&... args) {
+        return insertUnique(key, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> tryEmplace(key_type&& key, Args&&... args) {
+        return insertUnique(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Replace the content of the tree with the values of [first, first + count), which must be sorted and
+     *        have unique keys. Leaves and internal nodes are filled level by level in O(N) instead of inserting the
+     *        values one by one
+     */
+    template<typename ForwardIt>
+    void assignSorted(ForwardIt first, ForwardIt last) {
+        clear();
+        bulkLoad(first, static_cast<size_type>(std::distance(first, last)));
+    }
+
+    size_type erase(const key_type& key) {
+        return eraseKey(key);
+    }
+
+    template<typename K, typename = typename compare_type::is_transparent>
+    size_type erase(const K& key) {
+        return eraseKey(key);
+    }
+
+    /**
+     * @brief Destroy all the values and free all the nodes
+     */
+    void clear() noexcept {
+        if (root_ != nullptr) {
+            destroySubtree(root_, 0);
+        }
+
+        root_ = nullptr;
+        first_leaf_ = nullptr;
+        last_leaf_ = nullptr;
+        height_ = 0;
+        size_ = 0;
+    }
+
+    void swap(BTree& rhs) noexcept {
+        using std::swap;
+        swap(root_, rhs.root_);
+        swap(first_leaf_, rhs.first_leaf_);
+        swap(last_leaf_, rhs.last_leaf_);
+        swap(height_, rhs.height_);
+        swap(size_, rhs.size_);
+        swap(compare_, rhs.compare_);
+        swap(internal_node_alloc_, rhs.internal_node_alloc_);
+        swap(leaf_node_alloc_, rhs.leaf_node_alloc_);
+    }
+
+    [[nodiscard]] const_iterator find(const key_type& key) const {
+        return findEntry<const_iterator>(this, key);
+    }
+
+    [[nodiscard]] iterator find(const key_type& key) {
+        return findEntry<iterator>(this, key);
+    }
+
+    template<typename K, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator find(const K& key) const {
+        return findEntry<const_iterator>(this, key);
+    }
+
+    template<typename K, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator find(const K& key) {
+        return findEntry<iterator>(this, key);
+    }
+
+    [[nodiscard]] bool contains(const key_type& key) const {
+        return find(key) != end();
+    }
+
+    template<typename K, typename = typename compare_type::is_transparent>
+    [[nodiscard]] bool contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    /**
+     * @brief Get the first value whose key is not less than the key, or end() if there is none
+     */
+    [[nodiscard]] const_iterator lowerBound(const key_type& key) const {
+        return boundEntry<const_iterator, false>(this, key);
+    }
+
+    [[nodiscard]] iterator lowerBound(const key_type& key) {
+        return boundEntry<iterator, false>(this, key);
+    }
+
+    template<typename K, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator lowerBound(const K& key) const {
+        return boundEntry<const_iterator, false>(this, key);
+    }
+
+    template<typename K, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator lowerBound(const K& key) {
+        return boundEntry<iterator, false>(this, key);
+    }
+
+    /**
+     * @brief Get the first value whose key is greater than the key, or end() if there is none
+     */
+    [[nodiscard]] const_iterator upperBound(const key_type& key) const {
+        return boundEntry<const_iterator, true>(this, key);
+    }
+
+    [[nodiscard]] iterator upperBound(const key_type& key) {
+        return boundEntry<iterator, true>(this, key);
+    }
+
+    template<typename K, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator upperBound(const K& key) const {
+        return boundEntry<const_iterator, true>(this, key);
+    }
+
+    template<typename K, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator upperBound(const K& key) {
+        return boundEntry<iterator, true>(this, key);
+    }
+
+    [[nodiscard]] iterator begin() {
+        return iterator(this, first_leaf_, 0);
+    }
+
+    [[nodiscard]] const_iterator begin() const {
+        return const_iterator(this, first_leaf_, 0);
+    }
+
+    [[nodiscard]] const_iterator cbegin() const {
+        return const_iterator(this, first_leaf_, 0);
+    }
+
+    [[nodiscard]] iterator end() {
+        return iterator(this, nullptr, 0);
+    }
 
-    struct InternalNode {
-        Buffer<key_type>
+    [[nodiscard]] const_iterator end() const {
+        return const_iterator(this, nullptr, 0);
+    }
+
+    [[nodiscard]] const_iterator cend() const {
+        return const_iterator(this, nullptr, 0);
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /**
+     * @brief Number of internal levels above the leaves
+     */
+    [[nodiscard]] size_type height() const noexcept {
+        return height_;
+    }
+
+private:
+    struct Node {
+        size_type count;
+    };
+
+    struct LeafNode : Node {
+        LeafNode() noexcept
+            : Node{0}
+            , previous(nullptr)
+            , next(nullptr) {}
+
+        leaf_pointer previous;
+        leaf_pointer next;
+        Buffer<key_type, leaf_capacity> keys;
+        Buffer<mapped_type, leaf_capacity> values;
+    };
+
+    struct InternalNode : Node {
+        InternalNode() noexcept
+            : Node{0} {}
+
+        Buffer<key_type, internal_capacity> keys;
+        node_pointer children[internal_capacity + 1];
+    };
+
+    //! internal nodes visited from the root to a leaf and the index of the child taken in each of them
+    struct Path {
+        internal_pointer nodes[kMaxHeight];
+        size_type indices[kMaxHeight];
+    };
+
+    /**
+     * @brief Number of keys of the node less than the key, which is the index of the lower bound
+     */
+    template<std::size_t Capacity, typename K>
+    size_type lowerBoundIndex(const Buffer<key_type, Capacity>& keys, size_type count, const K& key) const {
+        if constexpr (kLinearSearch) {
+            size_type index = 0;
+            for (size_type i = 0; i < count; ++i) {
+                index += compare_(keys[i], key) ? 1 : 0;
+            }
+            return index;
+        } else {
+            size_type low = 0;
+            size_type high = count;
+            while (low < high) {
+                auto middle = low + (high - low) / 2;
+                if (compare_(keys[middle], key)) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            return low;
+        }
+    }
+
+    /**
+     * @brief Number of keys of the node not greater than the key, which is the index of the upper bound
+     */
+    template<std::size_t Capacity, typename K>
+    size_type upperBoundIndex(const Buffer<key_type, Capacity>& keys, size_type count, const K& key) const {
+        if constexpr (kLinearSearch) {
+            size_type index = 0;
+            for (size_type i = 0; i < count; ++i) {
+                index += compare_(key, keys[i]) ? 0 : 1;
+            }
+            return index;
+        } else {
+            size_type low = 0;
+            size_type high = count;
+            while (low < high) {
+                auto middle = low + (high - low) / 2;
+                if (compare_(key, keys[middle])) {
+                    high = middle;
+                } else {
+                    low = middle + 1;
+                }
+            }
+            return low;
+        }
+    }
+
+    /**
+     * @brief Walk down to the leaf which holds the key if present. Child i of an internal node holds the keys in
+     *        [keys[i - 1], keys[i]), so the child taken is the upper bound of the key
+     */
+    template<typename K>
+    leaf_pointer findLeaf(const K& key, Path* path) const {
+        auto node = root_;
+        for (size_type level = 0; level < height_; ++level) {
+            auto internal = static_cast<internal_pointer>(node);
+            auto index = upperBoundIndex(internal->keys, internal->count, key);
+            if (path != nullptr) {
+                path->nodes[level] = internal;
+                path->indices[level] = index;
+            }
+            node = internal->children[index];
+        }
+        return static_cast<leaf_pointer>(node);
+    }
+
+    template<typename Iterator, typename TreePointer, typename K>
+    static Iterator findEntry(TreePointer tree, const K& key) {
+        if (tree->root_ == nullptr) {
+            return Iterator(tree, nullptr, 0);
+        }
+
+        auto leaf = tree->findLeaf(key, nullptr);
+        auto index = tree->lowerBoundIndex(leaf->keys, leaf->count, key);
+        if (index < leaf->count && !tree->compare_(key, leaf->keys[index])) {
+            return Iterator(tree, leaf, index);
+        }
+        return Iterator(tree, nullptr, 0);
+    }
+
+    template<typename Iterator, bool Upper, typename TreePointer, typename K>
+    static Iterator boundEntry(TreePointer tree, const K& key) {
+        if (tree->root_ == nullptr) {
+            return Iterator(tree, nullptr, 0);
+        }
+
+        auto leaf = tree->findLeaf(key, nullptr);
+        size_type index;
+        if constexpr (Upper) {
+            index = tree->upperBoundIndex(leaf->keys, leaf->count, key);
+        } else {
+            index = tree->lowerBoundIndex(leaf->keys, leaf->count, key);
+        }
+
+        if (index == leaf->count) {
+            return Iterator(tree, leaf->next, 0);
+        }
+        return Iterator(tree, leaf, index);
+    }
+
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> insertUnique(K&& key, Args&&... args) {
+        if (root_ == nullptr) {
+            auto leaf = createLeaf();
+            try {
+                insertIntoLeaf(leaf, 0, std::forward<K>(key), std::forward<Args>(args)...);
+            } catch (...) {
+                destroyLeaf(leaf);
+                throw;
+            }
+            root_ = leaf;
+            first_leaf_ = leaf;
+            last_leaf_ = leaf;
+            size_ = 1;
+            return {iterator(this, leaf, 0), true};
+        }
+
+        Path path;
+        auto leaf = findLeaf(key, &path);
+        auto index = lowerBoundIndex(leaf->keys, leaf->count, key);
+        if (index < leaf->count && !compare_(key, leaf->keys[index])) {
+            return {iterator(this, leaf, index), false};
+        }
+
+        if (leaf->count == leaf_capacity) {
+            // the separator and every node the split needs are created before touching the tree, so that a throw
+            // leaves it as it was. Splitting before the insert keeps the tree valid if constructing the value throws
+            key_type separator(leaf->keys[leaf_capacity / 2]);
+            SpareNodes spare_nodes(*this);
+            spare_nodes.allocate(countSplitNodes(path));
+            auto right = splitLeaf(leaf);
+            insertIntoParent(path, height_, std::move(separator), right, spare_nodes);
+            if (index > leaf->count) {
+                index -= leaf->count;
+                leaf = right;
+            }
+        }
+
+        insertIntoLeaf(leaf, index, std::forward<K>(key), std::forward<Args>(args)...);
+        ++size_;
+        return {iterator(this, leaf, index), true};
+    }
+
+    template<typename K, typename... Args>
+    void insertIntoLeaf(leaf_pointer leaf, size_type index, K&& key, Args&&... args) {
+        insertAt(leaf->keys, leaf->count, index, std::forward<K>(key));
+        try {
+            insertAt(leaf->values, leaf->count, index, std::forward<Args>(args)...);
+        } catch (...) {
+            eraseAt(leaf->keys, leaf->count + 1, index);
+            throw;
+        }
+        ++leaf->count;
+    }
+
+    /**
+     * @brief Move the upper half of a full leaf to a new leaf linked after it
+     */
+    leaf_pointer splitLeaf(leaf_pointer leaf) {
+        auto right = createLeaf();
+        auto middle = leaf_capacity / 2;
+        for (size_type i = middle; i < leaf_capacity; ++i) {
+            right->keys.construct(i - middle, std::move(leaf->keys[i]));
+            right->values.construct(i - middle, std::move(leaf->values[i]));
+            leaf->keys.destroy(i);
+            leaf->values.destroy(i);
+        }
+        right->count = leaf_capacity - middle;
+        leaf->count = middle;
+
+        right->previous = leaf;
+        right->next = leaf->next;
+        if (leaf->next != nullptr) {
+            leaf->next->previous = right;
+        } else {
+            last_leaf_ = right;
+        }
+        leaf->next = right;
+        return right;
+    }
+
+    /**
+     * @brief Internal nodes allocated before a split, the ones left unused are freed again
+     */
+    struct SpareNodes {
+        explicit SpareNodes(BTree& tree) noexcept
+            : tree(tree)
+            , count(0) {}
+
+        SpareNodes(const SpareNodes&) = delete;
+        SpareNodes& operator=(const SpareNodes&) = delete;
+
+        ~SpareNodes() {
+            while (count > 0) {
+                tree.destroyInternal(nodes[--count]);
+            }
+        }
+
+        void allocate(size_type node_count) {
+            while (count < node_count) {
+                nodes[count] = tree.createInternal();
+                ++count;
+            }
+        }
+
+        [[nodiscard]] internal_pointer take() noexcept {
+            return nodes[--count];
+        }
+
+        BTree& tree;
+        internal_pointer nodes[kMaxHeight + 1];
+        size_type count;
     };
 
+    /**
+     * @brief Number of internal nodes created by splitting the leaf at the end of the path, one for every full
+     *        internal node above it and a new root if all of them are full
+     */
+    [[nodiscard]] size_type countSplitNodes(const Path& path) const noexcept {
+        size_type count = 0;
+        auto level = height_;
+        while (level > 0 && path.nodes[level - 1]->count == internal_capacity) {
+            ++count;
+            --level;
+        }
+        return level == 0 ? count + 1 : count;
+    }
+
+    /**
+     * @brief Add the separator and the new right child created by splitting the child taken at the level of the
+     *        path. Full internal nodes are split on the way up, splitting the root adds a level. The new internal
+     *        nodes are taken from spare_nodes, which must hold countSplitNodes(path) nodes
+     */
+    void insertIntoParent(
+        Path& path, size_type level, key_type separator, node_pointer right_child, SpareNodes& spare_nodes) {
+        while (level > 0) {
+            auto parent = path.nodes[level - 1];
+            auto index = path.indices[level - 1];
+            if (parent->count < internal_capacity) {
+                insertIntoInternal(parent, index, std::move(separator), right_child);
+                return;
+            }
+
+            auto middle = internal_capacity / 2;
+            auto right = spare_nodes.take();
+            key_type promoted(std::move(parent->keys[middle]));
+            for (size_type i = middle + 1; i < internal_capacity; ++i) {
+                right->keys.construct(i - middle - 1, std::move(parent->keys[i]));
+                right->children[i - middle - 1] = parent->children[i];
+            }
+            right->children[internal_capacity - middle - 1] = parent->children[internal_capacity];
+            for (size_type i = middle; i < internal_capacity; ++i) {
+                parent->keys.destroy(i);
+            }
+            right->count = internal_capacity - middle - 1;
+            parent->count = middle;
+
+            if (index <= middle) {
+                insertIntoInternal(parent, index, std::move(separator), right_child);
+            } else {
+                insertIntoInternal(right, index - middle - 1, std::move(separator), right_child);
+            }
+
+            separator = std::move(promoted);
+            right_child = right;
+            --level;
+        }
+
+        auto root = spare_nodes.take();
+        root->keys.construct(0, std::move(separator));
+        root->children[0] = root_;
+        root->children[1] = right_child;
+        root->count = 1;
+        root_ = root;
+        ++height_;
+    }
+
+    static void insertIntoInternal(internal_pointer node, size_type index, key_type&& key, node_pointer child) {
+        insertAt(node->keys, node->count, index, std::move(key));
+        for (auto i = node->count + 1; i > index + 1; --i) {
+            node->children[i] = node->children[i - 1];
+        }
+        node->children[index + 1] = child;
+        ++node->count;
+    }
+
+    template<typename K>
+    size_type eraseKey(const K& key) {
+        if (root_ == nullptr) {
+            return 0;
+        }
+
+        Path path;
+        auto leaf = findLeaf(key, &path);
+        auto index = lowerBoundIndex(leaf->keys, leaf->count, key);
+        if (index == leaf->count || compare_(key, leaf->keys[index])) {
+            return 0;
+        }
+
+        eraseAt(leaf->keys, leaf->count, index);
+        eraseAt(leaf->values, leaf->count, index);
+        --leaf->count;
+        --size_;
+        rebalanceLeaf(path, leaf);
+        return 1;
+    }
+
+    /**
+     * @brief Refill a leaf left with less than the minimum count by borrowing from a sibling, or merge it with one.
+     *        Separators equal to erased keys are left in place, they still split the keys correctly
+     */
+    void rebalanceLeaf(Path& path, leaf_pointer leaf) {
+        if (height_ == 0) {
+            if (leaf->count == 0) {
+                destroyLeaf(leaf);
+                root_ = nullptr;
+                first_leaf_ = nullptr;
+                last_leaf_ = nullptr;
+            }
+            return;
+        }
+
+        if (leaf->count >= kMinLeafCount) {
+            return;
+        }
+
+        auto parent = path.nodes[height_ - 1];
+        auto index = path.indices[height_ - 1];
+        auto left = index > 0 ? static_cast<leaf_pointer>(parent->children[index - 1]) : nullptr;
+        auto right = index < parent->count ? static_cast<leaf_pointer>(parent->children[index + 1]) : nullptr;
+
+        if (left != nullptr && left->count > kMinLeafCount) {
+            auto last = left->count - 1;
+            insertAt(leaf->keys, leaf->count, 0, std::move(left->keys[last]));
+            insertAt(leaf->values, leaf->count, 0, std::move(left->values[last]));
+            ++leaf->count;
+            left->keys.destroy(last);
+            left->values.destroy(last);
+            --left->count;
+            parent->keys[index - 1] = leaf->keys[0];
+            return;
+        }
+
+        if (right != nullptr && right->count > kMinLeafCount) {
+            leaf->keys.construct(leaf->count, std::move(right->keys[0]));
+            leaf->values.construct(leaf->count, std::move(right->values[0]));
+            ++leaf->count;
+            eraseAt(right->keys, right->count, 0);
+            eraseAt(right->values, right->count, 0);
+            --right->count;
+            parent->keys[index] = right->keys[0];
+            return;
+        }
+
+        if (left != nullptr) {
+            mergeLeaves(left, leaf);
+            eraseFromInternal(parent, index - 1);
+        } else {
+            mergeLeaves(leaf, right);
+            eraseFromInternal(parent, index);
+        }
+        rebalanceInternal(path, height_ - 1);
+    }
+
+    /**
+     * @brief Move all the values of right to the end of left and free right
+     */
+    void mergeLeaves(leaf_pointer left, leaf_pointer right) noexcept {
+        for (size_type i = 0; i < right->count; ++i) {
+            left->keys.construct(left->count + i, std::move(right->keys[i]));
+            left->values.construct(left->count + i, std::move(right->values[i]));
+        }
+        left->count += right->count;
+        destroyEntries(right);
+        right->count = 0;
+
+        left->next = right->next;
+        if (right->next != nullptr) {
+            right->next->previous = left;
+        } else {
+            last_leaf_ = left;
+        }
+        destroyLeaf(right);
+    }
+
+    /**
+     * @brief Same as rebalanceLeaf() for the internal node at the level of the path, going up as long as merging
+     *        leaves a parent with too few keys. An empty root is replaced by its only child
+     */
+    void rebalanceInternal(Path& path, size_type level) {
+        while (true) {
+            auto node = path.nodes[level];
+            if (level == 0) {
+                if (node->count == 0) {
+                    root_ = node->children[0];
+                    destroyInternal(node);
+                    --height_;
+                }
+                return;
+            }
+
+            if (node->count >= kMinInternalCount) {
+                return;
+            }
+
+            auto parent = path.nodes[level - 1];
+            auto index = path.indices[level - 1];
+            auto left = index > 0 ? static_cast<internal_pointer>(parent->children[index - 1]) : nullptr;
+            auto right = index < parent->count ? static_cast<internal_pointer>(parent->children[index + 1]) : nullptr;
+
+            if (left != nullptr && left->count > kMinInternalCount) {
+                // rotate the last key of left through the parent
+                insertAt(node->keys, node->count, 0, std::move(parent->keys[index - 1]));
+                for (auto i = node->count + 1; i > 0; --i) {
+                    node->children[i] = node->children[i - 1];
+                }
+                node->children[0] = left->children[left->count];
+                ++node->count;
+                parent->keys[index - 1] = std::move(left->keys[left->count - 1]);
+                left->keys.destroy(left->count - 1);
+                --left->count;
+                return;
+            }
+
+            if (right != nullptr && right->count > kMinInternalCount) {
+                node->keys.construct(node->count, std::move(parent->keys[index]));
+                node->children[node->count + 1] = right->children[0];
+                ++node->count;
+                parent->keys[index] = std::move(right->keys[0]);
+                eraseAt(right->keys, right->count, 0);
+                for (size_type i = 0; i < right->count; ++i) {
+                    right->children[i] = right->children[i + 1];
+                }
+                --right->count;
+                return;
+            }
+
+            if (left != nullptr) {
+                mergeInternals(left, std::move(parent->keys[index - 1]), node);
+                eraseFromInternal(parent, index - 1);
+            } else {
+                mergeInternals(node, std::move(parent->keys[index]), right);
+                eraseFromInternal(parent, index);
+            }
+            --level;
+        }
+    }
+
+    /**
+     * @brief Append the separator, the keys and the children of right to left and free right
+     */
+    void mergeInternals(internal_pointer left, key_type&& separator, internal_pointer right) noexcept {
+        left->keys.construct(left->count, std::move(separator));
+        for (size_type i = 0; i < right->count; ++i) {
+            left->keys.construct(left->count + 1 + i, std::move(right->keys[i]));
+        }
+        for (size_type i = 0; i <= right->count; ++i) {
+            left->children[left->count + 1 + i] = right->children[i];
+        }
+        left->count += right->count + 1;
+        for (size_type i = 0; i < right->count; ++i) {
+            right->keys.destroy(i);
+        }
+        destroyInternal(right);
+    }
+
+    /**
+     * @brief Remove the key at the index and the child after it
+     */
+    static void eraseFromInternal(internal_pointer node, size_type index) noexcept {
+        eraseAt(node->keys, node->count, index);
+        for (auto i = index + 1; i < node->count; ++i) {
+            node->children[i] = node->children[i + 1];
+        }
+        --node->count;
+    }
+
+    /**
+     * @brief Construct an element at the index of a buffer holding count elements, shifting the following ones
+     */
+    template<typename T, std::size_t Capacity, typename... Args>
+    static void insertAt(Buffer<T, Capacity>& buffer, size_type count, size_type index, Args&&... args) {
+        if (index == count) {
+            buffer.construct(count, std::forward<Args>(args)...);
+            return;
+        }
+
+        T value(std::forward<Args>(args)...);
+        buffer.construct(count, std::move(buffer[count - 1]));
+        for (auto i = count - 1; i > index; --i) {
+            buffer[i] = std::move(buffer[i - 1]);
+        }
+        buffer[index] = std::move(value);
+    }
+
+    /**
+     * @brief Remove the element at the index of a buffer holding count elements, shifting the following ones
+     */
+    template<typename T, std::size_t Capacity>
+    static void eraseAt(Buffer<T, Capacity>& buffer, size_type count, size_type index) noexcept {
+        for (auto i = index + 1; i < count; ++i) {
+            buffer[i - 1] = std::move(buffer[i]);
+        }
+        buffer.destroy(count - 1);
+    }
+
+    template<typename ForwardIt>
+    void bulkLoad(ForwardIt first, size_type count) {
+        if (count == 0) {
+            return;
+        }
+
+        // spread the values evenly so that no leaf ends up under the minimum count
+        auto leaf_count = (count + leaf_capacity - 1) / leaf_capacity;
+        auto nodes = std::make_unique<node_pointer[]>(leaf_count);
+        auto min_keys = std::make_unique<const key_type*[]>(leaf_count);
+        leaf_pointer previous = nullptr;
+        try {
+            for (size_type i = 0; i < leaf_count; ++i) {
+                auto leaf = createLeaf();
+                leaf->previous = previous;
+                if (previous != nullptr) {
+                    previous->next = leaf;
+                } else {
+                    first_leaf_ = leaf;
+                }
+                last_leaf_ = leaf;
+                previous = leaf;
+                nodes[i] = leaf;
+
+                auto leaf_size = count / leaf_count + (i < count % leaf_count ? 1 : 0);
+                for (; leaf->count < leaf_size; ++first) {
+                    auto&& value = *first;
+                    leaf->keys.construct(leaf->count, std::forward<decltype(value)>(value).first);
+                    try {
+                        leaf->values.construct(leaf->count, std::forward<decltype(value)>(value).second);
+                    } catch (...) {
+                        leaf->keys.destroy(leaf->count);
+                        throw;
+                    }
+                    ++leaf->count;
+                    ++size_;
+                }
+                min_keys[i] = leaf->keys.pointerAt(0);
+            }
+        } catch (...) {
+            clearLoadedLeaves();
+            throw;
+        }
+
+        // there are less internal nodes than leaves, they are tracked to be freed if copying a key throws
+        auto internal_nodes = std::make_unique<internal_pointer[]>(leaf_count);
+        size_type internal_count = 0;
+        try {
+            auto node_count = leaf_count;
+            while (node_count > 1) {
+                auto parent_count = (node_count + internal_capacity) / (internal_capacity + 1);
+                size_type child = 0;
+                for (size_type i = 0; i < parent_count; ++i) {
+                    auto parent = createInternal();
+                    internal_nodes[internal_count++] = parent;
+                    auto child_count = node_count / parent_count + (i < node_count % parent_count ? 1 : 0);
+                    auto first_child = child;
+                    parent->children[0] = nodes[child++];
+                    for (size_type j = 1; j < child_count; ++j) {
+                        parent->keys.construct(j - 1, *min_keys[child]);
+                        parent->children[j] = nodes[child++];
+                        ++parent->count;
+                    }
+                    nodes[i] = parent;
+                    min_keys[i] = min_keys[first_child];
+                }
+                node_count = parent_count;
+                ++height_;
+            }
+            root_ = nodes[0];
+        } catch (...) {
+            for (size_type i = 0; i < internal_count; ++i) {
+                for (size_type j = 0; j < internal_nodes[i]->count; ++j) {
+                    internal_nodes[i]->keys.destroy(j);
+                }
+                destroyInternal(internal_nodes[i]);
+            }
+            height_ = 0;
+            clearLoadedLeaves();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Free the leaves linked from first_leaf_ when bulkLoad() fails
+     */
+    void clearLoadedLeaves() noexcept {
+        auto leaf = first_leaf_;
+        while (leaf != nullptr) {
+            auto next = leaf->next;
+            destroyEntries(leaf);
+            destroyLeaf(leaf);
+            leaf = next;
+        }
+        root_ = nullptr;
+        first_leaf_ = nullptr;
+        last_leaf_ = nullptr;
+        size_ = 0;
+    }
+
+    void destroySubtree(node_pointer node, size_type level) noexcept {
+        if (level == height_) {
+            auto leaf = static_cast<leaf_pointer>(node);
+            destroyEntries(leaf);
+            destroyLeaf(leaf);
+            return;
+        }
+
+        auto internal = static_cast<internal_pointer>(node);
+        for (size_type i = 0; i <= internal->count; ++i) {
+            destroySubtree(internal->children[i], level + 1);
+        }
+        for (size_type i = 0; i < internal->count; ++i) {
+            internal->keys.destroy(i);
+        }
+        destroyInternal(internal);
+    }
+
+    static void destroyEntries(leaf_pointer leaf) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<key_type> || !std::is_trivially_destructible_v<mapped_type>) {
+            for (size_type i = 0; i < leaf->count; ++i) {
+                leaf->keys.destroy(i);
+                leaf->values.destroy(i);
+            }
+        }
+    }
+
+    leaf_pointer createLeaf() {
+        auto leaf = leaf_node_allocator_traits::allocate(leaf_node_alloc_, 1);
+        leaf_node_allocator_traits::construct(leaf_node_alloc_, leaf);
+        return leaf;
+    }
+
+    void destroyLeaf(leaf_pointer leaf) noexcept {
+        leaf_node_allocator_traits::destroy(leaf_node_alloc_, leaf);
+        leaf_node_allocator_traits::deallocate(leaf_node_alloc_, leaf, 1);
+    }
+
+    internal_pointer createInternal() {
+        auto node = internal_node_allocator_traits::allocate(internal_node_alloc_, 1);
+        internal_node_allocator_traits::construct(internal_node_alloc_, node);
+        return node;
+    }
+
+    void destroyInternal(internal_pointer node) noexcept {
+        internal_node_allocator_traits::destroy(internal_node_alloc_, node);
+        internal_node_allocator_traits::deallocate(internal_node_alloc_, node, 1);
+    }
+
+    node_pointer root_;
+    leaf_pointer first_leaf_;
+    leaf_pointer last_leaf_;
+    size_type height_;
+    size_type size_;
+    compare_type compare_;
     internal_node_allocator internal_node_alloc_;
     leaf_node_allocator leaf_node_alloc_;
-
 };
+
 }  // namespace nxt::core
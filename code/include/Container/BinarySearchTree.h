@@ -1,6 +1,11 @@
 #pragma once
 
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
 #include "CommonTree.h"
+#include "NodePool.h"
 
 namespace nxt::core {
 
@@ -30,11 +35,14 @@ protected:
     using node_allocator_traits = std::allocator_traits<node_allocator_type>;
     using node_pointer = typename node_allocator_traits::pointer;
     using node_const_pointer = typename node_allocator_traits::const_pointer;
+    using node_pool_type = NodePool<node_type, node_allocator_type>;
     using tree_traits = TreeTraits;
+    using tree_operations = TreeOperations<BinarySearchTree<TreeTraits>>;
+    using insert_position = TreeInsertPosition<node_pointer>;
 
 public:
     BinarySearchTree() noexcept(std::is_nothrow_default_constructible_v<node_allocator_type>&&
-                                    std::is_nothrow_default_constructible_v<compare_type>)
+                           std::is_nothrow_default_constructible_v<compare_type>)
         : head_node_()
         , size_(0)
         , compare_()
@@ -42,6 +50,14 @@ public:
         createHeadNode();
     }
 
+    explicit BinarySearchTree(const allocator_type& alloc)
+        : head_node_()
+        , size_(0)
+        , compare_()
+        , alloc_(alloc) {
+        createHeadNode();
+    }
+
     BinarySearchTree(BinarySearchTree&& rhs)
         : head_node_()
         , size_(0)
@@ -50,6 +66,7 @@ public:
         createHeadNode();
         using std::swap;
         swap(head_node_, rhs.head_node_);
+        pool_.swap(rhs.pool_);
         size_ = rhs.size_;
         rhs.size_ = 0;
     }
@@ -60,48 +77,74 @@ public:
         , compare_(rhs.compare_)
         , alloc_(node_allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
         createHeadNode();
-        if (rhs.size_ > 0) {
-            auto root_node = copyTree(rhs.head_node_->parent);
-            head_node_->parent = root_node;
-            root_node->parent = head_node_;
-
-            auto min_node = root_node;
-            while (min_node->left_child != nullptr) {
-                min_node = min_node->left_child;
-            }
-            head_node_->left_child = min_node;
+        assignSorted(rhs.begin(), rhs.end());
+    }
 
-            auto max_node = root_node;
-            while (max_node->right_child != nullptr) {
-                max_node = max_node->right_child;
+    /**
+     * @brief Construct the tree from a range. Input sorted by strictly increasing keys is linked into a balanced
+     *        tree in O(N), anything else is inserted value by value
+     */
+    template<typename ForwardIt, typename = typename std::iterator_traits<ForwardIt>::iterator_category>
+    BinarySearchTree(ForwardIt first, ForwardIt last, const allocator_type& alloc = allocator_type())
+        : head_node_()
+        , size_(0)
+        , compare_()
+        , alloc_(alloc) {
+        createHeadNode();
+        if (tree_operations::isStrictlySorted(*this, first, last)) {
+            assignSorted(first, last);
+        } else {
+            for (; first != last; ++first) {
+                insert(*first);
             }
-            head_node_->right_child = max_node;
         }
-
-        size_ = rhs.size_;
     }
 
+    /**
+     * @brief Insert the value if its key is not present
+     *
+     * @return Iterator to the inserted value or to the value with the same key, and true if the value was inserted
+     */
     std::pair<iterator, bool> insert(const value_type& value) {
-        return insert(head_node_->parent, head_node_, true, value);
+        auto result = tree_operations::insertValue(*this, value);
+        return {iterator(this, result.first), result.second};
     }
 
     std::pair<iterator, bool> insert(value_type&& value) {
-        return insert(head_node_->parent, head_node_, true, std::move(value));
+        auto result = tree_operations::insertValue(*this, std::move(value));
+        return {iterator(this, result.first), result.second};
+    }
+
+    /**
+     * @brief Insert the value right before the hint if that is where its key belongs, without searching the tree.
+     *        Inserting keys in increasing order with end() as the hint is amortized O(1). Otherwise this is a normal
+     *        insert
+     *
+     * @return Iterator to the inserted value or to the value with the same key
+     */
+    iterator insert(const_iterator hint, const value_type& value) {
+        return iterator(this, tree_operations::insertValue(*this, hint.node_, value).first);
+    }
+
+    iterator insert(const_iterator hint, value_type&& value) {
+        return iterator(this, tree_operations::insertValue(*this, hint.node_, std::move(value)).first);
     }
 
     template<typename... Args>
     std::pair<iterator, bool> emplace(Args&&... args) {
-        auto node = node_allocator_traits::allocate(alloc_, 1);
-        node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Args>(args)...);
-        node_allocator_traits::construct(alloc_, std::addressof(node->parent));
-        node_allocator_traits::construct(alloc_, std::addressof(node->left_child));
-        node_allocator_traits::construct(alloc_, std::addressof(node->right_child));
+        auto node = createNode(std::forward<Args>(args)...);
+        auto position = tree_operations::findInsertPosition(*this, tree_traits::key(node->value));
+        if (position.node != nullptr) {
+            destroyNode(node);
+            return {iterator(this, position.node), false};
+        }
 
-        return emplace(head_node_->parent, head_node_, true, node);
+        insertNode(node, position);
+        return {iterator(this, node), true};
     }
 
     size_type erase(const key_type& key) {
-        auto node = findNode(key);
+        auto node = tree_operations::findNode(*this, key);
         if (node == head_node_) {
             return 0;
         } else {
@@ -110,16 +153,49 @@ public:
         }
     }
 
-    void clear() noexcept {
-        if (head_node_->parent != head_node_) {
-            freeTree(head_node_->parent);
+    template<typename Key, typename = typename compare_type::is_transparent>
+    size_type erase(const Key& key) {
+        auto node = tree_operations::findNode(*this, key);
+        if (node == head_node_) {
+            return 0;
+        } else {
+            eraseNode(node);
+            return 1;
+        }
+    }
 
-            head_node_->parent = head_node_;
-            head_node_->left_child = nullptr;
-            head_node_->right_child = nullptr;
+    /**
+     * @brief Replace the content of the tree with [first, last), which must be sorted by strictly increasing keys.
+     *        The nodes are linked into a perfectly balanced tree in O(N) instead of N inserts
+     */
+    template<typename ForwardIt>
+    void assignSorted(ForwardIt first, ForwardIt last) {
+        tree_operations::assignSorted(*this, first, last);
+    }
 
-            size_ = 0;
-        }
+    /**
+     * @brief Insert the values of [first, last), sorted by increasing keys. Values whose key is already present are
+     *        skipped. A batch large compared to the tree is merged with the existing nodes and relinked into a
+     *        balanced tree in O(N + M), a small one is inserted value by value
+     *
+     * @return Number of values inserted
+     */
+    template<typename ForwardIt>
+    size_type mergeSorted(ForwardIt first, ForwardIt last) {
+        return tree_operations::mergeSorted(*this, first, last);
+    }
+
+    /**
+     * @brief Destroy all the values and give the node slabs back to the allocator at once
+     */
+    void clear() noexcept {
+        tree_operations::destroyValues(*this);
+        pool_.release(alloc_);
+
+        head_node_->parent = nullptr;
+        head_node_->left_child = head_node_;
+        head_node_->right_child = head_node_;
+        size_ = 0;
     }
 
     ~BinarySearchTree() {
@@ -131,25 +207,64 @@ public:
         node_allocator_traits::deallocate(alloc_, head_node_, 1);
     }
 
-    template<typename Key, typename = typename compare_type::is_transparent>
-    iterator erase(const Key& key) {}
-
     [[nodiscard]] const_iterator find(const key_type& value) const {
-        return const_iterator(this, findNode(value));
+        return const_iterator(this, tree_operations::findNode(*this, value));
     }
 
     [[nodiscard]] iterator find(const key_type& value) {
-        return iterator(this, findNode(value));
+        return iterator(this, tree_operations::findNode(*this, value));
     }
 
     template<typename Key, typename = typename compare_type::is_transparent>
     [[nodiscard]] const_iterator find(const Key& value) const {
-        return const_iterator(this, findNode(value));
+        return const_iterator(this, tree_operations::findNode(*this, value));
     }
 
     template<typename Key, typename = typename compare_type::is_transparent>
     [[nodiscard]] iterator find(const Key& value) {
-        return iterator(this, findNode(value));
+        return iterator(this, tree_operations::findNode(*this, value));
+    }
+
+    /**
+     * @brief Get the first value whose key is not less than the key, or end() if there is none
+     */
+    [[nodiscard]] const_iterator lowerBound(const key_type& key) const {
+        return const_iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    [[nodiscard]] iterator lowerBound(const key_type& key) {
+        return iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator lowerBound(const Key& key) const {
+        return const_iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator lowerBound(const Key& key) {
+        return iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    /**
+     * @brief Get the first value whose key is greater than the key, or end() if there is none
+     */
+    [[nodiscard]] const_iterator upperBound(const key_type& key) const {
+        return const_iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    [[nodiscard]] iterator upperBound(const key_type& key) {
+        return iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator upperBound(const Key& key) const {
+        return const_iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator upperBound(const Key& key) {
+        return iterator(this, tree_operations::upperBoundNode(*this, key));
     }
 
     [[nodiscard]] iterator begin() {
@@ -180,6 +295,10 @@ public:
         return size_;
     }
 
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
 private:
     struct Node {
         value_type value;
@@ -188,186 +307,138 @@ private:
         node_pointer right_child;
     };
 
-    template<typename Arg>
-    std::pair<iterator, bool> insert(node_pointer node, node_pointer parent, bool is_left, Arg&& arg) {
-        if (node == head_node_ || node == nullptr) {
-            auto node = node_allocator_traits::allocate(alloc_, 1);
-            node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Arg>(arg));
-
-            node_allocator_traits::construct(alloc_, std::addressof(node->parent), parent);
-            node_allocator_traits::construct(alloc_, std::addressof(node->left_child));
-            node_allocator_traits::construct(alloc_, std::addressof(node->right_child));
+    void insertNode(node_pointer node, const insert_position& position) noexcept {
+        linkNode(node, position.parent, position.is_left);
+    }
 
-            if (parent == head_node_) {
-                head_node_->parent = node;
+    /**
+     * @brief Link a new leaf node as a child of parent and update the min and max nodes
+     */
+    node_pointer linkNode(node_pointer node, node_pointer parent, bool is_left) noexcept {
+        node->parent = parent;
+        node->left_child = nullptr;
+        node->right_child = nullptr;
+
+        if (parent == head_node_) {
+            head_node_->parent = node;
+            head_node_->left_child = node;
+            head_node_->right_child = node;
+        } else if (is_left) {
+            parent->left_child = node;
+            if (parent == head_node_->left_child)
                 head_node_->left_child = node;
-                head_node_->right_child = node;
-            } else if (is_left) {
-                parent->left_child = node;
-                if (parent == head_node_->left_child)
-                    head_node_->left_child = node;
-            } else {
-                parent->right_child = node;
-                if (parent == head_node_->right_child)
-                    head_node_->right_child = node;
-            }
-
-            ++size_;
-
-            return {iterator(this, node), true};
-        }
-
-        if (compare_(tree_traits::key(arg), tree_traits::key(node->value))) {
-            return insert(node->left_child, node, true, std::forward<Arg>(arg));
-        } else if (compare_(tree_traits::key(node->value), tree_traits::key(arg))) {
-            return insert(node->right_child, node, false, std::forward<Arg>(arg));
         } else {
-            return {iterator(this, head_node_), false};
-        }
-    }
-
-    std::pair<iterator, bool> emplace(node_pointer node, node_pointer parent, bool is_left, node_pointer node_to_add) {
-        if (node == head_node_ || node == nullptr) {
-            node_to_add->parent = parent;
-            node_to_add->left_child = nullptr;
-            node_to_add->right_child = nullptr;
-            node_to_add->parent = parent;
-
-            if (parent == head_node_) {
-                head_node_->parent = node_to_add;
-                head_node_->left_child = node_to_add;
-                head_node_->right_child = node_to_add;
-            } else if (is_left) {
-                parent->left_child = node_to_add;
-                if (parent == head_node_->left_child)
-                    head_node_->left_child = node_to_add;
-            } else {
-                parent->right_child = node_to_add;
-                if (parent == head_node_->right_child)
-                    head_node_->right_child = node_to_add;
-            }
-
-            ++size_;
-
-            return {iterator(this, node_to_add), true};
+            parent->right_child = node;
+            if (parent == head_node_->right_child)
+                head_node_->right_child = node;
         }
 
-        if (compare_(tree_traits::key(node_to_add->value), tree_traits::key(node->value))) {
-            return emplace(node->left_child, node, true, node_to_add);
-        } else if (compare_(tree_traits::key(node->value), tree_traits::key(node_to_add->value))) {
-            return emplace(node->right_child, node, false, node_to_add);
-        } else {
-            node_allocator_traits::destroy(alloc_, std::addressof(node_to_add->value));
-            node_allocator_traits::destroy(alloc_, std::addressof(node_to_add->parent));
-            node_allocator_traits::destroy(alloc_, std::addressof(node_to_add->left_child));
-            node_allocator_traits::destroy(alloc_, std::addressof(node_to_add->right_child));
+        ++size_;
 
-            node_allocator_traits::deallocate(alloc_, node_to_add, 1);
-            return (iterator(this, head_node_), false);
-        }
+        return node;
     }
 
-    template<typename Key>
-    node_pointer lowerBoundNode(const Key& key) const {
-        // intialize with end node
-        node_pointer result = head_node_;
-        node_pointer node = head_node_->parent;
+    /**
+     * @brief Link the sorted nodes into a balanced tree which replaces the current one
+     */
+    void linkSorted(node_pointer* nodes, size_type count) noexcept {
+        auto root_node = linkBalanced(nodes, 0, count, head_node_);
+        head_node_->parent = root_node;
+        head_node_->left_child = nodes[0];
+        head_node_->right_child = nodes[count - 1];
+        size_ = count;
+    }
 
-        while (node != nullptr) {
-            if (compare_(tree_traits::key(node->value), key)) {
-                node = node->left_child;
-            } else {
-                // if compare fails, then we update the result with the node
-                // as it points to a value not less than key
-                result = node;
-                node = node->right_child;
-            }
+    /**
+     * @brief Make the middle node of [begin, end) the root of the subtree and recurse on both halves. The recursion
+     *        is only log2(N) deep and the depth of the result is log2(N)
+     */
+    node_pointer linkBalanced(node_pointer* nodes, size_type begin, size_type end, node_pointer parent) noexcept {
+        if (begin == end) {
+            return nullptr;
         }
 
-        return result;
+        auto middle = begin + (end - begin) / 2;
+        auto node = nodes[middle];
+        node->parent = parent;
+        node->left_child = linkBalanced(nodes, begin, middle, node);
+        node->right_child = linkBalanced(nodes, middle + 1, end, node);
+        return node;
     }
 
-    template<typename Key>
-    node_pointer upperBoundNode(const Key& key) const {
-        // intialize with end node
-        node_pointer result = head_node_;
-        node_pointer node = head_node_->parent;
+    void createHeadNode() {
+        head_node_ = node_allocator_traits::allocate(alloc_, 1);
+        node_allocator_traits::construct(alloc_, std::addressof(head_node_->parent));
+        node_allocator_traits::construct(alloc_, std::addressof(head_node_->left_child), head_node_);
+        node_allocator_traits::construct(alloc_, std::addressof(head_node_->right_child), head_node_);
+    }
 
-        while (node != nullptr) {
-            if (compare_(key, tree_traits::key(node->value))) {
-                result = node;
-                node = node->left_child;
-            } else {
-                node = node->right_child;
-            }
+    template<typename... Args>
+    node_pointer createNode(Args&&... args) {
+        auto node = pool_.allocate(alloc_);
+        try {
+            node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Args>(args)...);
+        } catch (...) {
+            pool_.deallocate(node);
+            throw;
         }
-
-        return result;
+        node_allocator_traits::construct(alloc_, std::addressof(node->parent));
+        node_allocator_traits::construct(alloc_, std::addressof(node->left_child));
+        node_allocator_traits::construct(alloc_, std::addressof(node->right_child));
+        return node;
     }
 
-    template<typename Key>
-    node_pointer findNode(const Key& key) const {
-        node_pointer node = head_node_->parent;
-
-        while (node != nullptr) {
-            if (compare_(key, tree_traits::key(node->value))) {
-                node = node->left_child;
-            } else if (compare_(tree_traits::key(node->value), key)) {
-                node = node->right_child;
-            } else {
-                return node;
-            }
-        }
+    void destroyNode(node_pointer node) noexcept {
+        node_allocator_traits::destroy(alloc_, std::addressof(node->value));
+        node_allocator_traits::destroy(alloc_, std::addressof(node->parent));
+        node_allocator_traits::destroy(alloc_, std::addressof(node->left_child));
+        node_allocator_traits::destroy(alloc_, std::addressof(node->right_child));
+        pool_.deallocate(node);
+    }
 
-        return head_node_;
+    /**
+     * @brief Parent of the node, used by the iterators which don't know how the node stores it
+     */
+    static node_pointer parentOf(node_pointer node) noexcept {
+        return node->parent;
     }
 
-    void createHeadNode() {
-        head_node_ = node_allocator_traits::allocate(alloc_, 1);
-        node_allocator_traits::construct(alloc_, std::addressof(head_node_->parent), head_node_);
-        node_allocator_traits::construct(alloc_, std::addressof(head_node_->left_child));
-        node_allocator_traits::construct(alloc_, std::addressof(head_node_->right_child));
+    /**
+     * @brief Replace the child of parent, or the root if parent is the head node
+     */
+    void replaceChild(node_pointer parent, node_pointer child, node_pointer new_child) noexcept {
+        if (parent == head_node_) {
+            head_node_->parent = new_child;
+        } else if (parent->left_child == child) {
+            parent->left_child = new_child;
+        } else {
+            parent->right_child = new_child;
+        }
     }
 
     void eraseNode(node_pointer node) {
         auto parent_node = node->parent;
 
-        if (node->left_child == nullptr && node->right_child == nullptr) {
-            // if the node being removed has no childs, then just remove the link
-            // in the parent node
-            if (parent_node == head_node_) {
-                head_node_->left_child = nullptr;
-                head_node_->right_child = nullptr;
-                head_node_->parent = head_node_;
-            } else if (parent_node->left_child == node) {
-                parent_node->left_child = nullptr;
-            } else {
-                parent_node->right_child = nullptr;
-            }
-        } else if (node->left_child != nullptr && node->right_child == nullptr) {
-            // if node being removed has a left child only, move up the left child so that it
-            // it is child of parent node now
-            auto replace_node = node->left_child;
-            replace_node->parent = parent_node;
-            if (parent_node == head_node_) {
-                head_node_->parent = replace_node;
-            } else if (parent_node->left_child == node) {
-                parent_node->left_child = replace_node;
-            } else {
-                parent_node->right_child = replace_node;
-            }
-        } else if (node->right_child != nullptr && node->left_child == nullptr) {
-            // if node being removed has a right child only, move up the right child so that it
+        // the min node has no left child, so its successor is either in the right subtree or the parent node,
+        // which is the head node when the tree becomes empty. The same goes for the max node the other way round
+        if (node == head_node_->left_child) {
+            head_node_->left_child =
+                node->right_child != nullptr ? tree_operations::minNode(node->right_child) : parent_node;
+        }
+
+        if (node == head_node_->right_child) {
+            head_node_->right_child =
+                node->left_child != nullptr ? tree_operations::maxNode(node->left_child) : parent_node;
+        }
+
+        if (node->left_child == nullptr || node->right_child == nullptr) {
+            // if node being removed has a single child or none, move up the child so that it
             // it is child of parent node now
-            auto replace_node = node->right_child;
-            replace_node->parent = parent_node;
-            if (parent_node == head_node_) {
-                head_node_->parent = replace_node;
-            } else if (parent_node->left_child == node) {
-                parent_node->left_child = replace_node;
-            } else {
-                parent_node->right_child = replace_node;
+            auto replace_node = node->left_child != nullptr ? node->left_child : node->right_child;
+            if (replace_node != nullptr) {
+                replace_node->parent = parent_node;
             }
+            replaceChild(parent_node, node, replace_node);
         } else {
             // if both child are present, find the max element in the left subtree
             auto replace_node = node->left_child;
@@ -395,84 +466,23 @@ private:
                 replace_node->right_child->parent = replace_node;
 
             replace_node->parent = parent_node;
-            if (parent_node == head_node_) {
-                head_node_->parent = replace_node;
-            } else if (parent_node->left_child == node) {
-                parent_node->left_child = replace_node;
-            } else {
-                parent_node->left_child = replace_node;
-            }
-        }
-
-        if (node == head_node_->left_child) {
-            if (node->parent != head_node_) {
-                head_node_->left_child = node->parent;
-            } else {
-                head_node_->left_child = head_node_->parent;
-            }
-        }
-
-        if (node == head_node_->right_child) {
-            if (node->parent != head_node_) {
-                head_node_->right_child = node->parent;
-            } else {
-                head_node_->right_child = head_node_->parent;
-            }
+            replaceChild(parent_node, node, replace_node);
         }
 
         --size_;
 
-        node_allocator_traits::destroy(alloc_, std::addressof(node->value));
-        node_allocator_traits::destroy(alloc_, std::addressof(node->parent));
-        node_allocator_traits::destroy(alloc_, std::addressof(node->left_child));
-        node_allocator_traits::destroy(alloc_, std::addressof(node->right_child));
-
-        node_allocator_traits::deallocate(alloc_, node, 1);
-    }
-
-    void freeTree(node_pointer node) noexcept {
-        if (node != nullptr) {
-            freeTree(node->left_child);
-            freeTree(node->right_child);
-
-            node_allocator_traits::destroy(alloc_, std::addressof(node->value));
-            node_allocator_traits::destroy(alloc_, std::addressof(node->parent));
-            node_allocator_traits::destroy(alloc_, std::addressof(node->left_child));
-            node_allocator_traits::destroy(alloc_, std::addressof(node->right_child));
-
-            node_allocator_traits::deallocate(alloc_, node, 1);
-        }
-    }
-
-    node_pointer copyTree(node_pointer node) {
-        auto copy_node = node_allocator_traits::allocate(alloc_, 1);
-        node_allocator_traits::construct(alloc_, std::addressof(copy_node->value), node->value);
-        node_allocator_traits::construct(alloc_, std::addressof(copy_node->parent));
-        node_allocator_traits::construct(alloc_, std::addressof(copy_node->left_child));
-        node_allocator_traits::construct(alloc_, std::addressof(copy_node->right_child));
-
-        if (node->left_child != nullptr) {
-            auto left_child = copyTree(node->left_child);
-            copy_node->left_child = left_child;
-            left_child->parent = copy_node;
-        }
-
-        if (node->right_child != nullptr) {
-            auto right_child = copyTree(node->right_child);
-            copy_node->right_child = right_child;
-            right_child->parent = copy_node;
-        }
-
-        return copy_node;
+        destroyNode(node);
     }
 
     node_pointer head_node_;
     size_type size_;
     compare_type compare_;
     node_allocator_type alloc_;
+    node_pool_type pool_;
 
     friend iterator;
     friend const_iterator;
+    friend tree_operations;
 };
 
-}  // namespace nxt::core
\ No newline at end of file
+}  // namespace nxt::core
@@ -86,6 +86,8 @@ struct Buffer {
         return data() + size;
     }
 
+    Buffer() = default;
+
 	Buffer(const Buffer&) = delete;
     Buffer& operator=(const Buffer&) = delete;
 
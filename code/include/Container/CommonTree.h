@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 namespace nxt::core {
@@ -10,14 +15,13 @@ public:
     using difference_type = typename Tree::difference_type;
     using pointer = typename Tree::const_pointer;
     using reference = typename Tree::const_reference;
-    using difference_type = typename Tree::difference_type;
     using node_type = typename Tree::node_type;
     using node_pointer = typename Tree::node_pointer;
     using node_const_pointer = typename Tree::node_const_pointer;
     using tree_type = Tree;
     using iterator_category = std::bidirectional_iterator_tag;
 
-    TreeConstIterator(tree_type* tree, node_pointer node)
+    TreeConstIterator(const tree_type* tree, node_pointer node)
         : tree_(tree)
         , node_(node) {}
 
@@ -38,10 +42,10 @@ public:
             }
             node_ = min_node;
         } else {
-            auto parent_node = node_->parent;
-            while (parent_node->parent != nullptr && node_ == parent_node->right_child) {
+            auto parent_node = tree_type::parentOf(node_);
+            while (parent_node != tree_->head_node_ && node_ == parent_node->right_child) {
                 node_ = parent_node;
-                parent_node = node_->parent;
+                parent_node = tree_type::parentOf(node_);
             }
 
             node_ = parent_node;
@@ -58,25 +62,25 @@ public:
 
     TreeConstIterator& operator--() {
         if (node_ == tree_->head_node_) {
-            node_ = head_node_->right_child;
+            node_ = tree_->head_node_->right_child;
         } else if (node_->left_child != nullptr) {
             auto max_node = node_->left_child;
             while (max_node->right_child != nullptr) {
-                max_node = result->right_child;
+                max_node = max_node->right_child;
             }
 
             node_ = max_node;
         } else {
-            node_pointer parent_node = node_->parent;
-            while (parent_node != nullptr && node_ == parent_node->left_child) {
+            node_pointer parent_node = tree_type::parentOf(node_);
+            while (parent_node != tree_->head_node_ && node_ == parent_node->left_child) {
                 node_ = parent_node;
-                parent_node = node_->parent;
+                parent_node = tree_type::parentOf(node_);
             }
 
-            if (node_ != head_node_) {
-                node_ = parent_node;
-            }
+            node_ = parent_node;
         }
+
+        return *this;
     }
 
     [[nodiscard]] TreeConstIterator operator--(int) {
@@ -85,16 +89,18 @@ public:
         return result;
     }
 
-    [[nodiscard]] bool operator==(const TreeConstIterator& rhs) {
+    [[nodiscard]] bool operator==(const TreeConstIterator& rhs) const {
         return node_ == rhs.node_;
     }
 
-    [[nodiscard]] bool operator!=(const TreeConstIterator& rhs) {
+    [[nodiscard]] bool operator!=(const TreeConstIterator& rhs) const {
         return node_ != rhs.node_;
     }
 
 protected:
-    tree_type* tree_;
+    friend Tree;
+
+    const tree_type* tree_;
     node_pointer node_;
 };
 
@@ -105,7 +111,6 @@ public:
     using difference_type = typename Tree::difference_type;
     using pointer = typename Tree::pointer;
     using reference = typename Tree::reference;
-    using difference_type = typename Tree::difference_type;
     using node_type = typename Tree::node_type;
     using node_pointer = typename Tree::node_pointer;
     using node_const_pointer = typename Tree::node_const_pointer;
@@ -121,7 +126,7 @@ public:
     }
 
     [[nodiscard]] pointer operator->() const {
-        return std::pointer_traits<pointer>::pointer_to(node_->value);
+        return std::pointer_traits<pointer>::pointer_to(this->node_->value);
     }
 
     TreeIterator& operator++() {
@@ -130,7 +135,7 @@ public:
     }
 
     [[nodiscard]] TreeIterator operator++(int) {
-        TreeIterator result(tree_, node_);
+        TreeIterator result(*this);
         this->operator++();
         return result;
     }
@@ -141,12 +146,326 @@ public:
     }
 
     [[nodiscard]] TreeIterator operator--(int) {
-        TreeIterator result(tree_, node_);
+        TreeIterator result(*this);
         this->operator--();
         return result;
     }
 };
 
+/**
+ * @brief Base of the tree nodes holding the number of nodes in their subtree, empty unless the tree keeps order
+ *        statistics so the other trees don't pay for it
+ */
+template<typename SizeType, bool Enabled>
+struct TreeNodeCount {};
+
+template<typename SizeType>
+struct TreeNodeCount<SizeType, true> {
+    SizeType subtree_size;
+};
+
+//! where a key belongs in a tree: the node holding it, or the parent and side to link a new node to
+template<typename NodePointer>
+struct TreeInsertPosition {
+    NodePointer node;
+    NodePointer parent;
+    bool is_left;
+};
+
+/**
+ * @brief Operations shared by BinarySearchTree, AVLTree and RedBlackTree. They walk the nodes through the head node,
+ *        whose parent is the root and whose children are the min and max nodes, and through Tree::parentOf(), so
+ *        they don't depend on how a tree stores its parent links. Linking and unlinking nodes is left to the tree:
+ *        createNode(), destroyNode(), insertNode() and linkSorted(). The trees befriend it like their iterators
+ */
+template<typename Tree>
+struct TreeOperations {
+    using node_pointer = typename Tree::node_pointer;
+    using node_allocator_traits = typename Tree::node_allocator_traits;
+    using size_type = typename Tree::size_type;
+    using value_type = typename Tree::value_type;
+    using tree_traits = typename Tree::tree_traits;
+    using insert_position = TreeInsertPosition<node_pointer>;
+
+    static node_pointer rootNode(const Tree& tree) noexcept {
+        return Tree::parentOf(tree.head_node_);
+    }
+
+    static node_pointer minNode(node_pointer node) noexcept {
+        while (node->left_child != nullptr) {
+            node = node->left_child;
+        }
+        return node;
+    }
+
+    static node_pointer maxNode(node_pointer node) noexcept {
+        while (node->right_child != nullptr) {
+            node = node->right_child;
+        }
+        return node;
+    }
+
+    /**
+     * @brief In order successor of the node, the head node after the max node
+     */
+    static node_pointer nextNode(const Tree& tree, node_pointer node) noexcept {
+        if (node->right_child != nullptr) {
+            return minNode(node->right_child);
+        }
+
+        auto parent_node = Tree::parentOf(node);
+        while (parent_node != tree.head_node_ && node == parent_node->right_child) {
+            node = parent_node;
+            parent_node = Tree::parentOf(parent_node);
+        }
+        return parent_node;
+    }
+
+    /**
+     * @brief In order predecessor of the node, the max node before the head node
+     */
+    static node_pointer previousNode(const Tree& tree, node_pointer node) noexcept {
+        if (node == tree.head_node_) {
+            return tree.head_node_->right_child;
+        }
+
+        if (node->left_child != nullptr) {
+            return maxNode(node->left_child);
+        }
+
+        auto parent_node = Tree::parentOf(node);
+        while (parent_node != tree.head_node_ && node == parent_node->left_child) {
+            node = parent_node;
+            parent_node = Tree::parentOf(parent_node);
+        }
+        return parent_node;
+    }
+
+    template<typename Key>
+    static insert_position findInsertPosition(const Tree& tree, const Key& key) {
+        insert_position position{nullptr, tree.head_node_, true};
+        auto node = rootNode(tree);
+        while (node != nullptr) {
+            if (tree.compare_(key, tree_traits::key(node->value))) {
+                position.parent = node;
+                position.is_left = true;
+                node = node->left_child;
+            } else if (tree.compare_(tree_traits::key(node->value), key)) {
+                position.parent = node;
+                position.is_left = false;
+                node = node->right_child;
+            } else {
+                position.node = node;
+                break;
+            }
+        }
+        return position;
+    }
+
+    template<typename Key>
+    static node_pointer lowerBoundNode(const Tree& tree, const Key& key) {
+        // intialize with end node
+        node_pointer result = tree.head_node_;
+        node_pointer node = rootNode(tree);
+
+        while (node != nullptr) {
+            if (tree.compare_(tree_traits::key(node->value), key)) {
+                node = node->right_child;
+            } else {
+                // if compare fails, then we update the result with the node
+                // as it points to a value not less than key
+                result = node;
+                node = node->left_child;
+            }
+        }
+
+        return result;
+    }
+
+    template<typename Key>
+    static node_pointer upperBoundNode(const Tree& tree, const Key& key) {
+        // intialize with end node
+        node_pointer result = tree.head_node_;
+        node_pointer node = rootNode(tree);
+
+        while (node != nullptr) {
+            if (tree.compare_(key, tree_traits::key(node->value))) {
+                result = node;
+                node = node->left_child;
+            } else {
+                node = node->right_child;
+            }
+        }
+
+        return result;
+    }
+
+    template<typename Key>
+    static node_pointer findNode(const Tree& tree, const Key& key) {
+        node_pointer node = rootNode(tree);
+
+        while (node != nullptr) {
+            if (tree.compare_(key, tree_traits::key(node->value))) {
+                node = node->left_child;
+            } else if (tree.compare_(tree_traits::key(node->value), key)) {
+                node = node->right_child;
+            } else {
+                return node;
+            }
+        }
+
+        return tree.head_node_;
+    }
+
+    template<typename ForwardIt>
+    static bool isStrictlySorted(const Tree& tree, ForwardIt first, ForwardIt last) {
+        return std::adjacent_find(first, last, [&tree](const auto& lhs, const auto& rhs) {
+                   return !tree.compare_(tree_traits::key(lhs), tree_traits::key(rhs));
+               }) == last;
+    }
+
+    /**
+     * @brief Find where the key of the value belongs with a loop walking down from the root, so the depth of the
+     *        tree doesn't cost any stack
+     */
+    template<typename Arg>
+    static std::pair<node_pointer, bool> insertValue(Tree& tree, Arg&& arg) {
+        auto position = findInsertPosition(tree, tree_traits::key(arg));
+        if (position.node != nullptr) {
+            return {position.node, false};
+        }
+
+        auto node = tree.createNode(std::forward<Arg>(arg));
+        tree.insertNode(node, position);
+        return {node, true};
+    }
+
+    template<typename Arg>
+    static std::pair<node_pointer, bool> insertValue(Tree& tree, node_pointer hint, Arg&& arg) {
+        const auto& key = tree_traits::key(arg);
+        if (tree.size_ == 0) {
+            return insertValue(tree, std::forward<Arg>(arg));
+        }
+
+        // the key belongs right before the hint if it sits between the hint and the node before it
+        auto head_node = tree.head_node_;
+        auto previous = hint == head_node->left_child ? nullptr : previousNode(tree, hint);
+        auto before_hint = hint == head_node || tree.compare_(key, tree_traits::key(hint->value));
+        auto after_previous = previous == nullptr || tree.compare_(tree_traits::key(previous->value), key);
+        if (!before_hint || !after_previous) {
+            return insertValue(tree, std::forward<Arg>(arg));
+        }
+
+        // either the hint has no left child, or the previous node is the max of that subtree and has no right child
+        insert_position position{nullptr, hint, true};
+        if (hint == head_node || hint->left_child != nullptr) {
+            position.parent = previous;
+            position.is_left = false;
+        }
+
+        auto node = tree.createNode(std::forward<Arg>(arg));
+        tree.insertNode(node, position);
+        return {node, true};
+    }
+
+    template<typename ForwardIt>
+    static void assignSorted(Tree& tree, ForwardIt first, ForwardIt last) {
+        tree.clear();
+        auto count = static_cast<size_type>(std::distance(first, last));
+        if (count == 0) {
+            return;
+        }
+
+        auto nodes = std::make_unique<node_pointer[]>(count);
+        size_type created_count = 0;
+        try {
+            for (; first != last; ++first) {
+                nodes[created_count] = tree.createNode(*first);
+                ++created_count;
+            }
+        } catch (...) {
+            for (size_type i = 0; i < created_count; ++i) {
+                tree.destroyNode(nodes[i]);
+            }
+            throw;
+        }
+
+        tree.linkSorted(nodes.get(), count);
+    }
+
+    template<typename ForwardIt>
+    static size_type mergeSorted(Tree& tree, ForwardIt first, ForwardIt last) {
+        auto count = static_cast<size_type>(std::distance(first, last));
+        size_type depth = 1;
+        for (auto total = tree.size_ + count; total > 1; total >>= 1) {
+            ++depth;
+        }
+
+        if (count * depth < tree.size_) {
+            size_type inserted_count = 0;
+            for (; first != last; ++first) {
+                inserted_count += tree.insert(*first).second ? 1 : 0;
+            }
+            return inserted_count;
+        }
+
+        // the tree is left untouched till all the new nodes are created
+        const auto& compare = tree.compare_;
+        auto head_node = tree.head_node_;
+        auto nodes = std::make_unique<node_pointer[]>(tree.size_ + count);
+        auto new_nodes = std::make_unique<node_pointer[]>(count);
+        size_type node_count = 0;
+        size_type new_count = 0;
+        auto node = head_node->left_child;
+        try {
+            for (; first != last; ++first) {
+                while (node != head_node && compare(tree_traits::key(node->value), tree_traits::key(*first))) {
+                    nodes[node_count++] = node;
+                    node = nextNode(tree, node);
+                }
+
+                if (node != head_node && !compare(tree_traits::key(*first), tree_traits::key(node->value))) {
+                    continue;
+                }
+
+                if (node_count > 0 &&
+                    !compare(tree_traits::key(nodes[node_count - 1]->value), tree_traits::key(*first))) {
+                    continue;
+                }
+
+                new_nodes[new_count] = tree.createNode(*first);
+                nodes[node_count++] = new_nodes[new_count++];
+            }
+        } catch (...) {
+            for (size_type i = 0; i < new_count; ++i) {
+                tree.destroyNode(new_nodes[i]);
+            }
+            throw;
+        }
+
+        for (; node != head_node; node = nextNode(tree, node)) {
+            nodes[node_count++] = node;
+        }
+
+        if (node_count > 0) {
+            tree.linkSorted(nodes.get(), node_count);
+        }
+        return new_count;
+    }
+
+    /**
+     * @brief Destroy the values of all the nodes in order. Nodes keep their links, so the walk doesn't depend on the
+     *        depth of the tree and the storage is given back afterwards by the pool
+     */
+    static void destroyValues(Tree& tree) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for (auto node = tree.head_node_->left_child; node != tree.head_node_; node = nextNode(tree, node)) {
+                node_allocator_traits::destroy(tree.alloc_, std::addressof(node->value));
+            }
+        }
+    }
+};
+
 template<typename Key, typename Compare = std::less<>, typename Allocator = std::allocator<Key>>
 struct SimpleTraits {
     using key_type = Key;
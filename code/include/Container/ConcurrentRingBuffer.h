@@ -0,0 +1,535 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "../Maths.h"
+#include "Buffer.h"
+
+namespace nxt::core {
+
+// size used for padding the indices which are written by different threads
+inline constexpr std::size_t kCacheLineSize = 64;
+
+/**
+ * @brief Bounded lock-free multi producer, multi consumer ring buffer based on Dmitry Vyukov's algorithm.
+ *        Every slot carries a sequence number which tells producers and consumers whether the slot is free
+ *        for the current lap, so a push or a pop only needs a single CAS on the shared index. Unlike
+ *        RingBuffer the capacity is fixed, tryPushBack() fails instead of growing when the buffer is full.
+ *
+ * @tparam T Type of the values stored
+ * @tparam Allocator Allocator used for the slots
+ */
+template<typename T, typename Allocator = std::allocator<T>>
+class MPMCRingBuffer {
+    struct Cell;
+
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<Cell>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using size_type = std::size_t;
+
+    /**
+     * @brief Construct a new ring buffer
+     *
+     * @param capacity Max number of values stored at once, rounded up to next power of 2
+     */
+    explicit MPMCRingBuffer(size_type capacity, const Allocator& alloc = Allocator())
+        : head_(0)
+        , tail_(0)
+        , cells_(nullptr)
+        , capacity_(roundCapacity(capacity))
+        , alloc_(alloc) {
+        cells_ = allocator_traits::allocate(alloc_, capacity_);
+        for (size_type i = 0; i < capacity_; ++i) {
+            allocator_traits::construct(alloc_, cells_ + i, i);
+        }
+    }
+
+    MPMCRingBuffer(const MPMCRingBuffer&) = delete;
+    MPMCRingBuffer& operator=(const MPMCRingBuffer&) = delete;
+
+    [[nodiscard]] bool tryPushBack(const T& value) {
+        return tryEmplaceBack(value);
+    }
+
+    [[nodiscard]] bool tryPushBack(T&& value) {
+        return tryEmplaceBack(std::move(value));
+    }
+
+    /**
+     * @brief Construct a value at the back of the buffer. If constructing T from the arguments can throw, the
+     *        value is built before a slot is claimed and moved in, so the arguments are used up even if the
+     *        buffer turns out to be full
+     *
+     * @return true if the value was added
+     * @return false if the buffer was full
+     */
+    template<typename... Args>
+    [[nodiscard]] bool tryEmplaceBack(Args&&... args) {
+        if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+            // a throw after claiming the slot would never publish it and stall every consumer behind it
+            static_assert(std::is_nothrow_move_constructible_v<T>,
+                          "T must be nothrow constructible from the arguments or nothrow move constructible");
+            return tryEmplaceBack(T(std::forward<Args>(args)...));
+        }
+
+        auto position = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = cells_ + mask(position);
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                // slot is free for this lap, claim it
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // slot still holds the value of the previous lap
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->storage.construct(0, std::forward<Args>(args)...);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Move the front value of the buffer to value
+     *
+     * @return true if a value was popped
+     * @return false if the buffer was empty
+     */
+    [[nodiscard]] bool tryPopFront(T& value) {
+        // a throw after claiming the slot would never free it and stall every producer behind it
+        static_assert(std::is_nothrow_move_assignable_v<T>, "T must be nothrow move assignable");
+
+        size_type position;
+        auto cell = claimFront(position);
+        if (cell == nullptr) {
+            return false;
+        }
+
+        value = std::move(cell->storage[0]);
+        releaseFront(cell, position);
+        return true;
+    }
+
+    [[nodiscard]] std::optional<value_type> tryPopFront() {
+        static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow move constructible");
+
+        size_type position;
+        auto cell = claimFront(position);
+        if (cell == nullptr) {
+            return std::nullopt;
+        }
+
+        std::optional<value_type> value(std::in_place, std::move(cell->storage[0]));
+        releaseFront(cell, position);
+        return value;
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept {
+        return capacity_;
+    }
+
+    /**
+     * @brief Approximate number of values in the buffer, can be stale when other threads are pushing or popping
+     */
+    [[nodiscard]] size_type size() const noexcept {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto tail = tail_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    ~MPMCRingBuffer() {
+        // only the values which were pushed and not popped are alive
+        auto head = head_.load(std::memory_order_relaxed);
+        auto tail = tail_.load(std::memory_order_relaxed);
+        for (auto position = head; position != tail; ++position) {
+            cells_[mask(position)].storage.destroy(0);
+        }
+
+        for (size_type i = 0; i < capacity_; ++i) {
+            allocator_traits::destroy(alloc_, cells_ + i);
+        }
+        allocator_traits::deallocate(alloc_, cells_, capacity_);
+    }
+
+private:
+    struct Cell {
+        explicit Cell(size_type initial_sequence)
+            : sequence(initial_sequence) {}
+
+        std::atomic<size_type> sequence;
+        Buffer<T, 1> storage;
+    };
+
+    Cell* claimFront(size_type& position) noexcept {
+        position = head_.load(std::memory_order_relaxed);
+        while (true) {
+            auto cell = cells_ + mask(position);
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (difference == 0) {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return cell;
+                }
+            } else if (difference < 0) {
+                // slot was not written yet in this lap
+                return nullptr;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void releaseFront(Cell* cell, size_type position) noexcept {
+        cell->storage.destroy(0);
+
+        // mark the slot free for the next lap of the producers
+        cell->sequence.store(position + capacity_, std::memory_order_release);
+    }
+
+    [[nodiscard]] static size_type roundCapacity(size_type capacity) noexcept {
+        if (capacity < 2) {
+            return 2;
+        }
+        return isPowerOf2(capacity) ? capacity : getNextPowerOf2(capacity);
+    }
+
+    [[nodiscard]] size_type mask(size_type position) const noexcept {
+        return position & (capacity_ - 1);
+    }
+
+    alignas(kCacheLineSize) std::atomic<size_type> head_;
+    alignas(kCacheLineSize) std::atomic<size_type> tail_;
+    alignas(kCacheLineSize) Cell* cells_;
+    size_type capacity_;
+    allocator_type alloc_;
+};
+
+/**
+ * @brief Bounded lock-free multi producer, single consumer ring buffer. Producers claim slots the same way as
+ *        MPMCRingBuffer, while the single consumer owns the head and doesn't need a CAS. tryPopFront() must only
+ *        be called from one thread at a time.
+ *
+ * @tparam T Type of the values stored
+ * @tparam Allocator Allocator used for the slots
+ */
+template<typename T, typename Allocator = std::allocator<T>>
+class MPSCRingBuffer {
+    struct Cell;
+
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<Cell>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using size_type = std::size_t;
+
+    explicit MPSCRingBuffer(size_type capacity, const Allocator& alloc = Allocator())
+        : head_(0)
+        , tail_(0)
+        , cells_(nullptr)
+        , capacity_(roundCapacity(capacity))
+        , alloc_(alloc) {
+        cells_ = allocator_traits::allocate(alloc_, capacity_);
+        for (size_type i = 0; i < capacity_; ++i) {
+            allocator_traits::construct(alloc_, cells_ + i, i);
+        }
+    }
+
+    MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+    MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+
+    [[nodiscard]] bool tryPushBack(const T& value) {
+        return tryEmplaceBack(value);
+    }
+
+    [[nodiscard]] bool tryPushBack(T&& value) {
+        return tryEmplaceBack(std::move(value));
+    }
+
+    /**
+     * @brief Construct a value at the back of the buffer, see MPMCRingBuffer::tryEmplaceBack()
+     */
+    template<typename... Args>
+    [[nodiscard]] bool tryEmplaceBack(Args&&... args) {
+        if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+            static_assert(std::is_nothrow_move_constructible_v<T>,
+                          "T must be nothrow constructible from the arguments or nothrow move constructible");
+            return tryEmplaceBack(T(std::forward<Args>(args)...));
+        }
+
+        auto position = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = cells_ + mask(position);
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->storage.construct(0, std::forward<Args>(args)...);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Move the front value of the buffer to value. Must only be called by the consumer thread
+     *
+     * @return true if a value was popped
+     * @return false if the buffer was empty or the front value is still being written
+     */
+    [[nodiscard]] bool tryPopFront(T& value) {
+        auto position = head_.load(std::memory_order_relaxed);
+        auto cell = cells_ + mask(position);
+        if (cell->sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+
+        value = std::move(cell->storage[0]);
+        releaseFront(cell, position);
+        return true;
+    }
+
+    [[nodiscard]] std::optional<value_type> tryPopFront() {
+        auto position = head_.load(std::memory_order_relaxed);
+        auto cell = cells_ + mask(position);
+        if (cell->sequence.load(std::memory_order_acquire) != position + 1) {
+            return std::nullopt;
+        }
+
+        std::optional<value_type> value(std::in_place, std::move(cell->storage[0]));
+        releaseFront(cell, position);
+        return value;
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept {
+        return capacity_;
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto tail = tail_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    ~MPSCRingBuffer() {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto tail = tail_.load(std::memory_order_relaxed);
+        for (auto position = head; position != tail; ++position) {
+            cells_[mask(position)].storage.destroy(0);
+        }
+
+        for (size_type i = 0; i < capacity_; ++i) {
+            allocator_traits::destroy(alloc_, cells_ + i);
+        }
+        allocator_traits::deallocate(alloc_, cells_, capacity_);
+    }
+
+private:
+    struct Cell {
+        explicit Cell(size_type initial_sequence)
+            : sequence(initial_sequence) {}
+
+        std::atomic<size_type> sequence;
+        Buffer<T, 1> storage;
+    };
+
+    void releaseFront(Cell* cell, size_type position) noexcept {
+        cell->storage.destroy(0);
+        cell->sequence.store(position + capacity_, std::memory_order_release);
+        head_.store(position + 1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static size_type roundCapacity(size_type capacity) noexcept {
+        if (capacity < 2) {
+            return 2;
+        }
+        return isPowerOf2(capacity) ? capacity : getNextPowerOf2(capacity);
+    }
+
+    [[nodiscard]] size_type mask(size_type position) const noexcept {
+        return position & (capacity_ - 1);
+    }
+
+    alignas(kCacheLineSize) std::atomic<size_type> head_;
+    alignas(kCacheLineSize) std::atomic<size_type> tail_;
+    alignas(kCacheLineSize) Cell* cells_;
+    size_type capacity_;
+    allocator_type alloc_;
+};
+
+/**
+ * @brief Bounded wait-free single producer, single consumer ring buffer. Each side keeps a cached copy of the
+ *        index owned by the other side, so the shared cache lines are only touched when the cached value says
+ *        the buffer looks full or empty.
+ *
+ * @tparam T Type of the values stored
+ * @tparam Allocator Allocator used for the values
+ */
+template<typename T, typename Allocator = std::allocator<T>>
+class SPSCRingBuffer {
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using pointer = typename allocator_traits::pointer;
+    using size_type = std::size_t;
+
+    explicit SPSCRingBuffer(size_type capacity, const Allocator& alloc = Allocator())
+        : head_(0)
+        , cached_tail_(0)
+        , tail_(0)
+        , cached_head_(0)
+        , data_(nullptr)
+        , capacity_(roundCapacity(capacity))
+        , alloc_(alloc) {
+        data_ = allocator_traits::allocate(alloc_, capacity_);
+    }
+
+    SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+    SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+    [[nodiscard]] bool tryPushBack(const T& value) {
+        return tryEmplaceBack(value);
+    }
+
+    [[nodiscard]] bool tryPushBack(T&& value) {
+        return tryEmplaceBack(std::move(value));
+    }
+
+    /**
+     * @brief Construct a value at the back of the buffer. Must only be called by the producer thread
+     */
+    template<typename... Args>
+    [[nodiscard]] bool tryEmplaceBack(Args&&... args) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_) {
+                return false;
+            }
+        }
+
+        allocator_traits::construct(alloc_, data_ + mask(tail), std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Move the front value of the buffer to value. Must only be called by the consumer thread
+     */
+    [[nodiscard]] bool tryPopFront(T& value) {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (!hasFront(head)) {
+            return false;
+        }
+
+        value = std::move(data_[mask(head)]);
+        releaseFront(head);
+        return true;
+    }
+
+    [[nodiscard]] std::optional<value_type> tryPopFront() {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (!hasFront(head)) {
+            return std::nullopt;
+        }
+
+        std::optional<value_type> value(std::in_place, std::move(data_[mask(head)]));
+        releaseFront(head);
+        return value;
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept {
+        return capacity_;
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto tail = tail_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    ~SPSCRingBuffer() {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        for (auto position = head_.load(std::memory_order_relaxed); position != tail; ++position) {
+            allocator_traits::destroy(alloc_, data_ + mask(position));
+        }
+        allocator_traits::deallocate(alloc_, data_, capacity_);
+    }
+
+private:
+    [[nodiscard]] bool hasFront(size_type head) noexcept {
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        return head != cached_tail_;
+    }
+
+    void releaseFront(size_type head) noexcept {
+        allocator_traits::destroy(alloc_, data_ + mask(head));
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    [[nodiscard]] static size_type roundCapacity(size_type capacity) noexcept {
+        if (capacity < 2) {
+            return 2;
+        }
+        return isPowerOf2(capacity) ? capacity : getNextPowerOf2(capacity);
+    }
+
+    [[nodiscard]] size_type mask(size_type position) const noexcept {
+        return position & (capacity_ - 1);
+    }
+
+    // consumer side
+    alignas(kCacheLineSize) std::atomic<size_type> head_;
+    size_type cached_tail_;
+
+    // producer side
+    alignas(kCacheLineSize) std::atomic<size_type> tail_;
+    size_type cached_head_;
+
+    alignas(kCacheLineSize) pointer data_;
+    size_type capacity_;
+    allocator_type alloc_;
+};
+
+}  // namespace nxt::core
@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "../Maths.h"
+#include "SkipList.h"
+
+namespace nxt::core {
+
+template<typename SkipList>
+class ConcurrentSkipListConstIterator {
+public:
+    using value_type = typename SkipList::value_type;
+    using reference = typename SkipList::const_reference;
+    using pointer = const value_type*;
+    using node_pointer = typename SkipList::node_pointer;
+    using difference_type = typename SkipList::difference_type;
+    using iterator_category = std::forward_iterator_tag;
+
+    ConcurrentSkipListConstIterator(const SkipList* list, node_pointer node)
+        : list_(list)
+        , node_(node) {}
+
+    ConcurrentSkipListConstIterator& operator++() noexcept {
+        node_ = SkipList::nextLive(node_);
+        return *this;
+    }
+
+    ConcurrentSkipListConstIterator operator++(int) noexcept {
+        ConcurrentSkipListConstIterator result(list_, node_);
+        node_ = SkipList::nextLive(node_);
+        return result;
+    }
+
+    [[nodiscard]] reference operator*() const noexcept {
+        return node_->value;
+    }
+
+    [[nodiscard]] pointer operator->() const noexcept {
+        return std::addressof(node_->value);
+    }
+
+    [[nodiscard]] bool operator==(const ConcurrentSkipListConstIterator& rhs) const noexcept {
+        return node_ == rhs.node_ && list_ == rhs.list_;
+    }
+
+    [[nodiscard]] bool operator!=(const ConcurrentSkipListConstIterator& rhs) const noexcept {
+        return node_ != rhs.node_ || list_ != rhs.list_;
+    }
+
+protected:
+    const SkipList* list_;
+    node_pointer node_;
+};
+
+/**
+ * @brief Lock-free ordered set or map (depending on the Traits) for multiple writers, based on the skip list of
+ *        Fraser and Herlihy-Shavit. Each link carries a mark in its low bit: a node is logically erased once its
+ *        bottom link is marked, and the searches unlink the marked nodes they walk over with a CAS, so inserts,
+ *        erases and lookups never block each other.
+ *
+ *        Erased nodes are not freed right away since other threads may still be reading them, they are retired on
+ *        a lock-free list and freed by reclaim(), clear() or the destructor, which must not run concurrently with
+ *        any other operation. The values are read-only once inserted, iteration is weakly consistent and skips the
+ *        values erased before it reaches them.
+ *
+ * @tparam Traits SimpleTraits or MappedTraits, the allocator must be thread safe
+ */
+template<typename Traits>
+class ConcurrentSkipList {
+public:
+    using value_type = typename Traits::value_type;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using allocator_type = typename Traits::allocator_type;
+    using key_type = typename Traits::key_type;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using size_type = typename allocator_traits::size_type;
+    using difference_type = typename allocator_traits::difference_type;
+    using compare_type = typename Traits::compare_type;
+    using const_iterator = ConcurrentSkipListConstIterator<ConcurrentSkipList>;
+    using iterator = const_iterator;
+    using traits = Traits;
+
+    //! Maximum number of levels, enough for 2^32 values
+    static constexpr size_type kMaxHeight = 32;
+
+private:
+    struct SkipNode;
+
+    using node_type = SkipNode;
+    using node_pointer = node_type*;
+    using link_type = std::atomic<std::uintptr_t>;
+
+    //! Low bit of a link set once the node owning the link is erased
+    static constexpr std::uintptr_t kMarkBit = 1;
+
+    struct SkipNode {
+        value_type value;
+        size_type height;
+        node_pointer retired_next;
+
+        //! Links are stored inline right after the node
+        [[nodiscard]] link_type* links() noexcept {
+            return reinterpret_cast<link_type*>(reinterpret_cast<unsigned char*>(this) + kLinksOffset);
+        }
+    };
+
+    //! First offset after the node aligned for the links
+    static constexpr size_type kLinksOffset =
+        (sizeof(node_type) + alignof(link_type) - 1) / alignof(link_type) * alignof(link_type);
+
+    //! Allocation unit of the nodes, suitably aligned for both the node and its links
+    struct alignas(node_type) alignas(link_type) NodeBlock {
+        unsigned char bytes[alignof(node_type) > alignof(link_type) ? alignof(node_type) : alignof(link_type)];
+    };
+
+    using node_allocator_type = typename std::allocator_traits<allocator_type>::template rebind_alloc<NodeBlock>;
+    using node_allocator_traits = std::allocator_traits<node_allocator_type>;
+    using block_pointer = typename node_allocator_traits::pointer;
+
+public:
+    ConcurrentSkipList()
+        : height_(1)
+        , size_(0)
+        , retired_nodes_(nullptr)
+        , comp_()
+        , alloc_() {
+        head_node_ = allocateNode(kMaxHeight);
+    }
+
+    explicit ConcurrentSkipList(const allocator_type& alloc)
+        : height_(1)
+        , size_(0)
+        , retired_nodes_(nullptr)
+        , comp_()
+        , alloc_(alloc) {
+        head_node_ = allocateNode(kMaxHeight);
+    }
+
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+    /**
+     * @brief Number of values, only exact when no write is in flight
+     */
+    [[nodiscard]] size_type size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator(this, nextLive(head_node_));
+    }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator(this, nullptr);
+    }
+
+    [[nodiscard]] const_iterator cend() const noexcept {
+        return end();
+    }
+
+    [[nodiscard]] const_iterator find(const key_type& value) const {
+        return const_iterator(this, findNode(value));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator find(const Key& value) const {
+        return const_iterator(this, findNode(value));
+    }
+
+    [[nodiscard]] bool contains(const key_type& value) const {
+        return findNode(value) != nullptr;
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] bool contains(const Key& value) const {
+        return findNode(value) != nullptr;
+    }
+
+    /**
+     * @brief Insert the value unless its key is already present
+     *
+     * @return true if the value was inserted
+     */
+    bool insert(const value_type& value) {
+        return insertNode(value);
+    }
+
+    bool insert(value_type&& value) {
+        return insertNode(std::move(value));
+    }
+
+    /**
+     * @brief Erase the value with the key, of the threads erasing the same value only one succeeds
+     *
+     * @return Number of values erased
+     */
+    size_type erase(const key_type& value) {
+        node_pointer predecessors[kMaxHeight];
+        node_pointer successors[kMaxHeight];
+        if (!findPath(value, predecessors, successors)) {
+            return 0;
+        }
+
+        auto node = successors[0];
+        // the upper links are marked first so that no insert links the node above the bottom level afterwards
+        for (auto i = node->height - 1; i > 0; --i) {
+            auto link = node->links()[i].load();
+            while (!isMarked(link) && !node->links()[i].compare_exchange_weak(link, link | kMarkBit)) {
+            }
+        }
+
+        // marking the bottom link erases the node, which decides between concurrent erases
+        auto link = node->links()[0].load();
+        while (!isMarked(link)) {
+            if (node->links()[0].compare_exchange_weak(link, link | kMarkBit)) {
+                // unlinks the node from every level
+                findPath(traits::key(node->value), predecessors, successors);
+                retireNode(node);
+                size_.fetch_sub(1, std::memory_order_relaxed);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Free the erased values. Must not run concurrently with any other operation on the list
+     */
+    void reclaim() noexcept {
+        auto node = retired_nodes_.exchange(nullptr);
+        while (node != nullptr) {
+            auto next_node = node->retired_next;
+            destroyNode(node);
+            node = next_node;
+        }
+    }
+
+    /**
+     * @brief Erase all the values. Must not run concurrently with any other operation on the list
+     */
+    void clear() noexcept {
+        reclaim();
+        auto node = toNode(head_node_->links()[0].load());
+        while (node != nullptr) {
+            auto next_node = toNode(node->links()[0].load());
+            destroyNode(node);
+            node = next_node;
+        }
+
+        for (size_type i = 0; i < kMaxHeight; ++i) {
+            head_node_->links()[i].store(0);
+        }
+        height_.store(1);
+        size_.store(0);
+    }
+
+    ~ConcurrentSkipList() {
+        clear();
+        deallocateNode(head_node_);
+    }
+
+private:
+    friend const_iterator;
+
+    static bool isMarked(std::uintptr_t link) noexcept {
+        return (link & kMarkBit) != 0;
+    }
+
+    static node_pointer toNode(std::uintptr_t link) noexcept {
+        return reinterpret_cast<node_pointer>(link & ~kMarkBit);
+    }
+
+    static std::uintptr_t toLink(node_pointer node) noexcept {
+        return reinterpret_cast<std::uintptr_t>(node);
+    }
+
+    /**
+     * @brief Next node on the bottom level which is not erased
+     */
+    static node_pointer nextLive(node_pointer node) noexcept {
+        auto next_node = toNode(node->links()[0].load());
+        while (next_node != nullptr && isMarked(next_node->links()[0].load())) {
+            next_node = toNode(next_node->links()[0].load());
+        }
+        return next_node;
+    }
+
+    /**
+     * @brief Level of a new node, drawn from a generator owned by the calling thread
+     */
+    static size_type randomHeight() noexcept {
+        thread_local RandomGenerator random(std::hash<std::thread::id>()(std::this_thread::get_id()) | 1);
+        return random(kMaxHeight);
+    }
+
+    static constexpr size_type blockCount(size_type height) noexcept {
+        return (kLinksOffset + height * sizeof(link_type) + sizeof(NodeBlock) - 1) / sizeof(NodeBlock);
+    }
+
+    /**
+     * @brief Allocate a node with height empty links, its value is left unconstructed
+     */
+    node_pointer allocateNode(size_type height) {
+        auto block = node_allocator_traits::allocate(alloc_, blockCount(height));
+        auto node = reinterpret_cast<node_pointer>(std::addressof(*block));
+        node->height = height;
+        node->retired_next = nullptr;
+        for (size_type i = 0; i < height; ++i) {
+            ::new (static_cast<void*>(node->links() + i)) link_type(0);
+        }
+        return node;
+    }
+
+    void deallocateNode(node_pointer node) noexcept {
+        auto block = std::pointer_traits<block_pointer>::pointer_to(*reinterpret_cast<NodeBlock*>(node));
+        node_allocator_traits::deallocate(alloc_, block, blockCount(node->height));
+    }
+
+    void destroyNode(node_pointer node) noexcept {
+        node_allocator_traits::destroy(alloc_, std::addressof(node->value));
+        deallocateNode(node);
+    }
+
+    template<typename... Args>
+    node_pointer createNode(size_type height, Args&&... args) {
+        auto node = allocateNode(height);
+        try {
+            node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Args>(args)...);
+        } catch (...) {
+            deallocateNode(node);
+            throw;
+        }
+        return node;
+    }
+
+    void retireNode(node_pointer node) noexcept {
+        auto head = retired_nodes_.load(std::memory_order_relaxed);
+        do {
+            node->retired_next = head;
+        } while (!retired_nodes_.compare_exchange_weak(head, node, std::memory_order_release,
+                                                       std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Fill predecessors and successors with the nodes around the key on each level in use, unlinking the
+     *        erased nodes met on the way. Starts over when a predecessor turns out to be erased
+     *
+     * @return true if a node with the key is present, it is then successors[0]
+     */
+    template<typename Key>
+    bool findPath(const Key& value, node_pointer* predecessors, node_pointer* successors) const {
+    retry:
+        auto predecessor = head_node_;
+        for (auto i = static_cast<difference_type>(height_.load()) - 1; i >= 0; --i) {
+            auto current = toNode(predecessor->links()[i].load());
+            while (current != nullptr) {
+                auto link = current->links()[i].load();
+                while (isMarked(link)) {
+                    auto expected = toLink(current);
+                    if (!predecessor->links()[i].compare_exchange_strong(expected, link & ~kMarkBit)) {
+                        goto retry;
+                    }
+                    current = toNode(link);
+                    if (current == nullptr) {
+                        break;
+                    }
+                    link = current->links()[i].load();
+                }
+
+                if (current == nullptr || !comp_(traits::key(current->value), value)) {
+                    break;
+                }
+                predecessor = current;
+                current = toNode(link);
+            }
+            predecessors[i] = predecessor;
+            successors[i] = current;
+        }
+        return successors[0] != nullptr && !comp_(value, traits::key(successors[0]->value));
+    }
+
+    /**
+     * @brief Lookup without unlinking, skips over the erased nodes
+     */
+    template<typename Key>
+    node_pointer findNode(const Key& value) const {
+        auto predecessor = head_node_;
+        node_pointer current = nullptr;
+        for (auto i = static_cast<difference_type>(height_.load()) - 1; i >= 0; --i) {
+            current = toNode(predecessor->links()[i].load());
+            while (current != nullptr) {
+                auto link = current->links()[i].load();
+                if (isMarked(link)) {
+                    current = toNode(link);
+                } else if (comp_(traits::key(current->value), value)) {
+                    predecessor = current;
+                    current = toNode(link);
+                } else {
+                    break;
+                }
+            }
+        }
+
+        if (current != nullptr && !comp_(value, traits::key(current->value))) {
+            return current;
+        }
+        return nullptr;
+    }
+
+    template<typename Arg>
+    bool insertNode(Arg&& value) {
+        auto height = randomHeight();
+        auto current_height = height_.load();
+        while (current_height < height && !height_.compare_exchange_weak(current_height, height)) {
+        }
+
+        node_pointer predecessors[kMaxHeight];
+        node_pointer successors[kMaxHeight];
+        node_pointer new_node = nullptr;
+        while (true) {
+            // value was moved into the node by the first attempt, retries search with the key of the node
+            const auto& key = new_node != nullptr ? traits::key(new_node->value) : traits::key(value);
+            if (findPath(key, predecessors, successors)) {
+                if (new_node != nullptr) {
+                    // the node was never published
+                    destroyNode(new_node);
+                }
+                return false;
+            }
+
+            if (new_node == nullptr) {
+                new_node = createNode(height, std::forward<Arg>(value));
+            }
+
+            for (size_type i = 0; i < height; ++i) {
+                new_node->links()[i].store(toLink(successors[i]), std::memory_order_relaxed);
+            }
+
+            // linking the bottom level publishes the node
+            auto expected = toLink(successors[0]);
+            if (predecessors[0]->links()[0].compare_exchange_strong(expected, toLink(new_node))) {
+                break;
+            }
+        }
+        size_.fetch_add(1, std::memory_order_relaxed);
+
+        const auto& key = traits::key(new_node->value);
+        for (size_type i = 1; i < height; ++i) {
+            while (true) {
+                // only an erase changes the link of a node not linked on the level yet, and it marks it
+                auto link = new_node->links()[i].load();
+                if (isMarked(link)) {
+                    return true;
+                }
+                if (toNode(link) != successors[i] &&
+                    !new_node->links()[i].compare_exchange_strong(link, toLink(successors[i]))) {
+                    return true;
+                }
+
+                auto expected = toLink(successors[i]);
+                if (predecessors[i]->links()[i].compare_exchange_strong(expected, toLink(new_node))) {
+                    break;
+                }
+
+                findPath(key, predecessors, successors);
+                if (successors[0] != new_node) {
+                    // erased meanwhile
+                    return true;
+                }
+            }
+
+            // an erase which marked the node before it was linked here may have missed it, unlink it again
+            if (isMarked(new_node->links()[i].load())) {
+                findPath(key, predecessors, successors);
+                return true;
+            }
+        }
+        return true;
+    }
+
+    node_pointer head_node_;
+    std::atomic<size_type> height_;
+    std::atomic<size_type> size_;
+    std::atomic<node_pointer> retired_nodes_;
+    compare_type comp_;
+    node_allocator_type alloc_;
+};
+
+}  // namespace nxt::core
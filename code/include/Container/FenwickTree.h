@@ -0,0 +1,163 @@
+#pragma once
+
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+
+#include "../TypeTraits.h"
+#include "Vector.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Fenwick tree, also known as binary indexed tree, for prefix sums over values which change. The node k (one
+ *        based) holds the sum of the values (k - lowbit(k), k], so adding to a value and summing a prefix both follow
+ *        O(log N) nodes with nothing more than the values themselves in memory. Use it instead of a SegmentTree when
+ *        the queries are sums and the updates single values.
+ *
+ * @tparam T Type of the values, T() must be zero and the values must support + and -
+ */
+template<typename T, typename Allocator = std::allocator<T>>
+class FenwickTree {
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using size_type = typename allocator_traits::size_type;
+    using difference_type = typename allocator_traits::difference_type;
+
+    FenwickTree() = default;
+
+    /**
+     * @brief Construct a tree with count zero values
+     */
+    explicit FenwickTree(size_type count)
+        : data_(count, value_type()) {}
+
+    FenwickTree(std::initializer_list<value_type> values)
+        : FenwickTree(values.begin(), values.end()) {}
+
+    /**
+     * @brief Construct the tree from the values in O(N), each node adds its sum to its parent once
+     */
+    template<typename ForwardIter, typename = std::enable_if_t<IsForwardIteratorV<ForwardIter>>>
+    FenwickTree(ForwardIter first, ForwardIter last)
+        : data_(first, last) {
+        auto count = data_.size();
+        for (size_type node = 1; node <= count; ++node) {
+            auto parent = node + lowestBit(node);
+            if (parent <= count) {
+                data_[parent - 1] = data_[parent - 1] + data_[node - 1];
+            }
+        }
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return data_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return data_.empty();
+    }
+
+    /**
+     * @brief Add delta to the value at the index
+     */
+    void add(size_type index, const value_type& delta) {
+        auto count = data_.size();
+        for (auto node = index + 1; node <= count; node += lowestBit(node)) {
+            data_[node - 1] = data_[node - 1] + delta;
+        }
+    }
+
+    /**
+     * @brief Replace the value at the index
+     */
+    void set(size_type index, const value_type& value) {
+        add(index, value - get(index));
+    }
+
+    /**
+     * @brief Get the value at the index by removing from its node the nodes summed into it
+     */
+    [[nodiscard]] value_type get(size_type index) const {
+        auto node = index + 1;
+        auto value = data_[node - 1];
+        auto first = node - lowestBit(node);
+        for (auto child = node - 1; child > first; child -= lowestBit(child)) {
+            value = value - data_[child - 1];
+        }
+        return value;
+    }
+
+    /**
+     * @brief Sum of the first count values
+     */
+    [[nodiscard]] value_type prefixSum(size_type count) const {
+        value_type sum = value_type();
+        for (auto node = count; node > 0; node -= lowestBit(node)) {
+            sum = sum + data_[node - 1];
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Sum of the values in [low, high]
+     */
+    [[nodiscard]] value_type rangeSum(size_type low, size_type high) const {
+        return prefixSum(high + 1) - prefixSum(low);
+    }
+
+    /**
+     * @brief Find the first index whose prefix sum, including its own value, is not less than the sum. The values
+     *        must not be negative so that the prefix sums are sorted
+     *
+     * @return Index of the value or size() if the sum of all the values is less than the sum
+     */
+    [[nodiscard]] size_type lowerBound(value_type sum) const {
+        auto count = data_.size();
+        size_type step = 1;
+        while (step <= count / 2) {
+            step *= 2;
+        }
+
+        // walks down the implicit tree, position is the number of values known to sum to less than sum
+        size_type position = 0;
+        for (; step > 0 && count > 0; step /= 2) {
+            auto node = position + step;
+            if (node <= count && data_[node - 1] < sum) {
+                position = node;
+                sum = sum - data_[node - 1];
+            }
+        }
+        return position;
+    }
+
+    /**
+     * @brief Append a value in O(log N), its node sums the nodes before it which it covers
+     */
+    void pushBack(const value_type& value) {
+        auto node = data_.size() + 1;
+        auto sum = value;
+        auto first = node - lowestBit(node);
+        for (auto child = node - 1; child > first; child -= lowestBit(child)) {
+            sum = sum + data_[child - 1];
+        }
+        data_.pushBack(sum);
+    }
+
+    void clear() noexcept {
+        data_.clear();
+    }
+
+private:
+    static size_type lowestBit(size_type node) noexcept {
+        return node & (~node + 1);
+    }
+
+    Vector<value_type, allocator_type> data_;
+};
+
+}  // namespace nxt::core
@@ -0,0 +1,880 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NXT_CORE_HASH_GROUP_SSE2 1
+#endif
+
+#include "../Maths.h"
+#include "../Memory/Relocate.h"
+#include "../TypeTraits.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Group of kWidth control bytes of a FlatHashTable, which are compared all at once with SSE2 where it is
+ *        available. A control byte is kEmpty, kDeleted or, for a full slot, the low 7 bits of the hash of its key.
+ *        The matches are returned as bit masks, bit i standing for the i-th slot of the group
+ */
+class HashGroup {
+public:
+    using control_type = int8_t;
+    using mask_type = uint32_t;
+
+    static constexpr control_type kEmpty = -128;
+    static constexpr control_type kDeleted = -2;
+    static constexpr std::size_t kWidth = 16;
+
+    explicit HashGroup(const control_type* controls) noexcept {
+#ifdef NXT_CORE_HASH_GROUP_SSE2
+        controls_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(controls));
+#else
+        std::memcpy(controls_, controls, kWidth);
+#endif
+    }
+
+    [[nodiscard]] static constexpr bool isFull(control_type control) noexcept {
+        return control >= 0;
+    }
+
+    //! Slots whose control byte is the given one
+    [[nodiscard]] mask_type match(control_type control) const noexcept {
+#ifdef NXT_CORE_HASH_GROUP_SSE2
+        return static_cast<mask_type>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(control), controls_)));
+#else
+        mask_type mask = 0;
+        for (std::size_t i = 0; i < kWidth; ++i) {
+            mask |= static_cast<mask_type>(controls_[i] == control) << i;
+        }
+        return mask;
+#endif
+    }
+
+    [[nodiscard]] mask_type matchEmpty() const noexcept {
+        return match(kEmpty);
+    }
+
+    //! Empty and deleted slots, their control bytes are the negative ones
+    [[nodiscard]] mask_type matchFree() const noexcept {
+#ifdef NXT_CORE_HASH_GROUP_SSE2
+        return static_cast<mask_type>(_mm_movemask_epi8(controls_));
+#else
+        mask_type mask = 0;
+        for (std::size_t i = 0; i < kWidth; ++i) {
+            mask |= static_cast<mask_type>(!isFull(controls_[i])) << i;
+        }
+        return mask;
+#endif
+    }
+
+    [[nodiscard]] mask_type matchFull() const noexcept {
+        return ~matchFree() & ((mask_type(1) << kWidth) - 1);
+    }
+
+private:
+#ifdef NXT_CORE_HASH_GROUP_SSE2
+    __m128i controls_;
+#else
+    control_type controls_[kWidth];
+#endif
+};
+
+/**
+ * @brief Transparent hash of strings, lets the maps keyed by std::string be searched with a std::string_view or a
+ *        string literal without building a std::string
+ */
+struct StringHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view value) const noexcept {
+        return std::hash<std::string_view>()(value);
+    }
+};
+
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Allocator = std::allocator<Key>>
+struct HashSetTraits {
+    using key_type = Key;
+    using value_type = Key;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+
+    static const key_type& key(const value_type& value) {
+        return value;
+    }
+};
+
+template<typename Key, typename MappedType, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Allocator = std::allocator<std::pair<const Key, MappedType>>>
+struct HashMapTraits {
+    using key_type = Key;
+    using mapped_type = MappedType;
+    using value_type = std::pair<const key_type, mapped_type>;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+
+    static const key_type& key(const value_type& value) {
+        return value.first;
+    }
+};
+
+template<typename Table>
+class FlatHashTableConstIterator {
+public:
+    // for Iterator Traits
+    using difference_type = typename Table::difference_type;
+    using value_type = typename Table::value_type;
+    using size_type = typename Table::size_type;
+    using pointer = typename Table::const_pointer;
+    using reference = typename Table::const_reference;
+    using iterator_category = std::forward_iterator_tag;
+
+    FlatHashTableConstIterator() noexcept
+        : table_(nullptr)
+        , index_(0) {}
+
+    FlatHashTableConstIterator(const Table* table, size_type index) noexcept
+        : table_(table)
+        , index_(index) {}
+
+    reference operator*() const noexcept {
+        return table_->slots_[index_];
+    }
+
+    pointer operator->() const noexcept {
+        return table_->slots_ + index_;
+    }
+
+    FlatHashTableConstIterator& operator++() noexcept {
+        index_ = table_->nextFull(index_ + 1);
+        return *this;
+    }
+
+    FlatHashTableConstIterator operator++(int) noexcept {
+        FlatHashTableConstIterator temp(table_, index_);
+        this->operator++();
+        return temp;
+    }
+
+    bool operator==(const FlatHashTableConstIterator& rhs) const noexcept {
+        return table_ == rhs.table_ && index_ == rhs.index_;
+    }
+
+    bool operator!=(const FlatHashTableConstIterator& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+protected:
+    friend Table;
+
+    const Table* table_;
+    size_type index_;
+};
+
+template<typename Table>
+class FlatHashTableIterator : public FlatHashTableConstIterator<Table> {
+public:
+    // for Iterator Traits
+    using difference_type = typename Table::difference_type;
+    using value_type = typename Table::value_type;
+    using size_type = typename Table::size_type;
+    using pointer = typename Table::pointer;
+    using reference = typename Table::reference;
+    using iterator_category = std::forward_iterator_tag;
+    using base_class = FlatHashTableConstIterator<Table>;
+
+    FlatHashTableIterator() noexcept = default;
+
+    FlatHashTableIterator(const Table* table, size_type index) noexcept
+        : base_class(table, index) {}
+
+    reference operator*() const noexcept {
+        return const_cast<reference>(base_class::operator*());
+    }
+
+    pointer operator->() const noexcept {
+        return const_cast<pointer>(base_class::operator->());
+    }
+
+    FlatHashTableIterator& operator++() noexcept {
+        base_class::operator++();
+        return *this;
+    }
+
+    FlatHashTableIterator operator++(int) noexcept {
+        FlatHashTableIterator temp(table_, index_);
+        base_class::operator++();
+        return temp;
+    }
+
+protected:
+    using base_class::index_;
+    using base_class::table_;
+};
+
+/**
+ * @brief Open addressing hash table in the style of the Swiss table. The values are stored in one flat array of
+ *        slots next to an array of one control byte per slot, holding 7 bits of the hash of the key in the slot.
+ *        A lookup probes whole HashGroup's of control bytes at once and only compares the keys of the slots whose
+ *        control byte matches, so it touches no other memory than the two arrays. The capacity is a power of two
+ *        and the table grows once 7/8 of it is used. Erased slots are marked deleted and reused by the inserts,
+ *        the table is rebuilt when they pile up.
+ *
+ *        Unlike std::unordered_map, inserting may move the values and invalidates the iterators, pointers and
+ *        references, reserve the table beforehand when they must stay valid.
+ *
+ *        When both the hasher and the key_equal are transparent the keys can be looked up with other types.
+ *
+ * @tparam Traits Either HashSetTraits or HashMapTraits
+ */
+template<typename Traits>
+class FlatHashTable {
+public:
+    using key_type = typename Traits::key_type;
+    using value_type = typename Traits::value_type;
+    using reference = typename Traits::reference;
+    using const_reference = typename Traits::const_reference;
+    using hasher = typename Traits::hasher;
+    using key_equal = typename Traits::key_equal;
+    using allocator_type = typename Traits::allocator_type;
+    using allocator_traits = typename std::allocator_traits<allocator_type>;
+    using size_type = typename allocator_traits::size_type;
+    using difference_type = typename allocator_traits::difference_type;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = FlatHashTableIterator<FlatHashTable>;
+    using const_iterator = FlatHashTableConstIterator<FlatHashTable>;
+
+    static_assert(std::is_pointer_v<typename allocator_traits::pointer>, "FlatHashTable needs raw pointers");
+
+protected:
+    using control_type = HashGroup::control_type;
+    using control_allocator_type = typename allocator_traits::template rebind_alloc<control_type>;
+    using control_allocator_traits = typename std::allocator_traits<control_allocator_type>;
+
+    //! Whether the keys can be looked up with other types
+    static constexpr bool kTransparent = IsTransparentV<hasher> && IsTransparentV<key_equal>;
+    //! Whether the values are moved with memcpy when the table grows
+    static constexpr bool kRelocatable = CanRelocateV<allocator_type>;
+
+public:
+
+    FlatHashTable() noexcept(std::is_nothrow_default_constructible_v<hasher> &&
+                             std::is_nothrow_default_constructible_v<key_equal> &&
+                             std::is_nothrow_default_constructible_v<allocator_type>)
+        : controls_(nullptr)
+        , slots_(nullptr)
+        , capacity_(0)
+        , size_(0)
+        , growth_left_(0)
+        , hash_()
+        , equal_()
+        , alloc_() {}
+
+    explicit FlatHashTable(size_type count, const hasher& hash = hasher(), const key_equal& equal = key_equal(),
+                           const allocator_type& alloc = allocator_type())
+        : controls_(nullptr)
+        , slots_(nullptr)
+        , capacity_(0)
+        , size_(0)
+        , growth_left_(0)
+        , hash_(hash)
+        , equal_(equal)
+        , alloc_(alloc) {
+        reserve(count);
+    }
+
+    template<typename InputIter, typename = std::enable_if_t<IsInputIteratorV<InputIter>>>
+    FlatHashTable(InputIter first, InputIter last, size_type count = 0, const hasher& hash = hasher(),
+                  const key_equal& equal = key_equal(), const allocator_type& alloc = allocator_type())
+        : FlatHashTable(count, hash, equal, alloc) {
+        insert(first, last);
+    }
+
+    FlatHashTable(std::initializer_list<value_type> values, size_type count = 0, const hasher& hash = hasher(),
+                  const key_equal& equal = key_equal(), const allocator_type& alloc = allocator_type())
+        : FlatHashTable(values.begin(), values.end(), std::max<size_type>(count, values.size()), hash, equal, alloc) {}
+
+    FlatHashTable(const FlatHashTable& rhs)
+        : FlatHashTable(rhs.size_, rhs.hash_, rhs.equal_,
+                        allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
+        copyValues(rhs);
+    }
+
+    FlatHashTable(FlatHashTable&& rhs) noexcept(std::is_nothrow_move_constructible_v<hasher> &&
+                                                std::is_nothrow_move_constructible_v<key_equal>)
+        : controls_(std::exchange(rhs.controls_, nullptr))
+        , slots_(std::exchange(rhs.slots_, nullptr))
+        , capacity_(std::exchange(rhs.capacity_, 0))
+        , size_(std::exchange(rhs.size_, 0))
+        , growth_left_(std::exchange(rhs.growth_left_, 0))
+        , hash_(std::move(rhs.hash_))
+        , equal_(std::move(rhs.equal_))
+        , alloc_(std::move(rhs.alloc_)) {}
+
+    FlatHashTable& operator=(const FlatHashTable& rhs) {
+        if (this != std::addressof(rhs)) {
+            if constexpr (ChoosePOCCA<allocator_type>) {
+                if (alloc_ != rhs.alloc_) {
+                    cleanup();
+                    alloc_ = rhs.alloc_;
+                }
+            }
+            clear();
+            hash_ = rhs.hash_;
+            equal_ = rhs.equal_;
+            reserve(rhs.size_);
+            copyValues(rhs);
+        }
+        return *this;
+    }
+
+    FlatHashTable& operator=(FlatHashTable&& rhs) noexcept(
+        allocator_traits::propagate_on_container_move_assignment::value || allocator_traits::is_always_equal::value) {
+        if (this != std::addressof(rhs)) {
+            cleanup();
+            hash_ = std::move(rhs.hash_);
+            equal_ = std::move(rhs.equal_);
+            if constexpr (ChoosePOCMA<allocator_type>) {
+                alloc_ = std::move(rhs.alloc_);
+            }
+            if (allocator_traits::propagate_on_container_move_assignment::value ||
+                allocator_traits::is_always_equal::value || alloc_ == rhs.alloc_) {
+                controls_ = std::exchange(rhs.controls_, nullptr);
+                slots_ = std::exchange(rhs.slots_, nullptr);
+                capacity_ = std::exchange(rhs.capacity_, 0);
+                size_ = std::exchange(rhs.size_, 0);
+                growth_left_ = std::exchange(rhs.growth_left_, 0);
+            } else {
+                reserve(rhs.size_);
+                for (auto& value : rhs) {
+                    insertUnique(hashOf(Traits::key(value)), std::move(value));
+                }
+                rhs.clear();
+            }
+        }
+        return *this;
+    }
+
+    ~FlatHashTable() {
+        cleanup();
+    }
+
+    template<typename InputIter, typename = std::enable_if_t<IsInputIteratorV<InputIter>>>
+    void insert(InputIter first, InputIter last) {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    void insert(std::initializer_list<value_type> values) {
+        insert(values.begin(), values.end());
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return emplaceKey(Traits::key(value), value);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return emplaceKey(Traits::key(value), std::move(value));
+    }
+
+    /**
+     * @brief Construct a value from the arguments and insert it, the value is thrown away when its key is already
+     *        in the table
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        return emplaceKey(Traits::key(value), std::move(value));
+    }
+
+    [[nodiscard]] iterator find(const key_type& key) {
+        return iterator(this, findIndex(key, hashOf(key)));
+    }
+
+    [[nodiscard]] const_iterator find(const key_type& key) const {
+        return const_iterator(this, findIndex(key, hashOf(key)));
+    }
+
+    template<typename K, bool Transparent = kTransparent, typename = std::enable_if_t<Transparent>>
+    [[nodiscard]] iterator find(const K& key) {
+        return iterator(this, findIndex(key, hashOf(key)));
+    }
+
+    template<typename K, bool Transparent = kTransparent, typename = std::enable_if_t<Transparent>>
+    [[nodiscard]] const_iterator find(const K& key) const {
+        return const_iterator(this, findIndex(key, hashOf(key)));
+    }
+
+    [[nodiscard]] bool contains(const key_type& key) const {
+        return findIndex(key, hashOf(key)) != capacity_;
+    }
+
+    template<typename K, bool Transparent = kTransparent, typename = std::enable_if_t<Transparent>>
+    [[nodiscard]] bool contains(const K& key) const {
+        return findIndex(key, hashOf(key)) != capacity_;
+    }
+
+    [[nodiscard]] size_type count(const key_type& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    template<typename K, bool Transparent = kTransparent, typename = std::enable_if_t<Transparent>>
+    [[nodiscard]] size_type count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    size_type erase(const key_type& key) {
+        auto index = findIndex(key, hashOf(key));
+        if (index == capacity_) {
+            return 0;
+        }
+        eraseIndex(index);
+        return 1;
+    }
+
+    //! Erase the value at position and return the iterator to the next value
+    iterator erase(const_iterator position) {
+        eraseIndex(position.index_);
+        return iterator(this, nextFull(position.index_ + 1));
+    }
+
+    void clear() noexcept {
+        if (capacity_ > 0) {
+            destroyValues();
+            std::memset(controls_, HashGroup::kEmpty, capacity_ + HashGroup::kWidth);
+            size_ = 0;
+        }
+        growth_left_ = maxLoad(capacity_);
+    }
+
+    /**
+     * @brief Make room for count values without growing the table again
+     */
+    void reserve(size_type count) {
+        if (count > size_ + growth_left_) {
+            resizeTable(capacityFor(count));
+        }
+    }
+
+    /**
+     * @brief Rebuild the table with at least count slots and enough of them for the values, which also drops the
+     *        deleted slots. A count of 0 shrinks the table to the values
+     */
+    void rehash(size_type count) {
+        if (count == 0 && size_ == 0) {
+            cleanup();
+            return;
+        }
+        resizeTable(std::max(capacityFor(size_), roundUpCapacity(count)));
+    }
+
+    void swap(FlatHashTable& rhs) noexcept {
+        using std::swap;
+        swap(controls_, rhs.controls_);
+        swap(slots_, rhs.slots_);
+        swap(capacity_, rhs.capacity_);
+        swap(size_, rhs.size_);
+        swap(growth_left_, rhs.growth_left_);
+        swap(hash_, rhs.hash_);
+        swap(equal_, rhs.equal_);
+        if constexpr (allocator_traits::propagate_on_container_swap::value) {
+            swap(alloc_, rhs.alloc_);
+        }
+    }
+
+    [[nodiscard]] iterator begin() noexcept {
+        return iterator(this, nextFull(0));
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator(this, nextFull(0));
+    }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    [[nodiscard]] iterator end() noexcept {
+        return iterator(this, capacity_);
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator(this, capacity_);
+    }
+
+    [[nodiscard]] const_iterator cend() const noexcept {
+        return end();
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    //! Number of slots, the table holds up to 7/8 of them before growing
+    [[nodiscard]] size_type capacity() const noexcept {
+        return capacity_;
+    }
+
+    [[nodiscard]] float loadFactor() const noexcept {
+        return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / static_cast<float>(capacity_);
+    }
+
+    [[nodiscard]] hasher hashFunction() const {
+        return hash_;
+    }
+
+    [[nodiscard]] key_equal keyEq() const {
+        return equal_;
+    }
+
+    [[nodiscard]] allocator_type getAllocator() const noexcept {
+        return alloc_;
+    }
+
+protected:
+    /**
+     * @brief Insert the value built from args unless the key is already in the table, in which case args are left
+     *        untouched
+     */
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> emplaceKey(const K& key, Args&&... args) {
+        auto hash = hashOf(key);
+        auto index = findIndex(key, hash);
+        if (index != capacity_) {
+            return {iterator(this, index), false};
+        }
+        index = insertUnique(hash, std::forward<Args>(args)...);
+        return {iterator(this, index), true};
+    }
+
+    template<typename K>
+    [[nodiscard]] std::size_t hashOf(const K& key) const {
+        return mixHash(hash_(key));
+    }
+
+    //! Index of the slot holding key, or capacity_ when there is none
+    template<typename K>
+    [[nodiscard]] size_type findIndex(const K& key, std::size_t hash) const {
+        auto mask = capacity_ - 1;
+        auto position = probeStart(hash);
+        auto control = controlOf(hash);
+        for (size_type step = HashGroup::kWidth; capacity_ > 0; step += HashGroup::kWidth) {
+            HashGroup group(controls_ + position);
+            for (auto match = group.match(control); match != 0; match &= match - 1) {
+                auto index = (position + countTrailingZeros(match)) & mask;
+                if (equal_(Traits::key(slots_[index]), key)) {
+                    return index;
+                }
+            }
+            if (group.matchEmpty() != 0) {
+                break;
+            }
+            position = (position + step) & mask;
+        }
+        return capacity_;
+    }
+
+    //! Insert a value whose key is known not to be in the table and return its slot
+    template<typename... Args>
+    size_type insertUnique(std::size_t hash, Args&&... args) {
+        if (growth_left_ == 0) {
+            growForInsert();
+        }
+        auto index = findFree(hash);
+        allocator_traits::construct(alloc_, slots_ + index, std::forward<Args>(args)...);
+        if (controls_[index] == HashGroup::kEmpty) {
+            --growth_left_;
+        }
+        setControl(index, controlOf(hash));
+        ++size_;
+        return index;
+    }
+
+    //! First full slot from index on, or capacity_
+    [[nodiscard]] size_type nextFull(size_type index) const noexcept {
+        for (; index < capacity_; index += HashGroup::kWidth) {
+            auto full = HashGroup(controls_ + index).matchFull();
+            if (full != 0) {
+                // the cloned control bytes past the capacity may match, they stand for the end
+                return std::min<size_type>(index + countTrailingZeros(full), capacity_);
+            }
+        }
+        return capacity_;
+    }
+
+    void eraseIndex(size_type index) {
+        allocator_traits::destroy(alloc_, slots_ + index);
+        setControl(index, HashGroup::kDeleted);
+        --size_;
+    }
+
+private:
+    friend const_iterator;
+    friend iterator;
+
+    //! Spread the hash over all the bits, since the std::hash of integers is often the identity
+    [[nodiscard]] static constexpr std::size_t mixHash(std::size_t hash) noexcept {
+        if constexpr (sizeof(std::size_t) == 8) {
+            auto mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(mixed ^ (mixed >> 32));
+        } else {
+            auto mixed = static_cast<uint32_t>(hash) * 0x9E3779B1u;
+            return static_cast<std::size_t>(mixed ^ (mixed >> 16));
+        }
+    }
+
+    [[nodiscard]] static constexpr control_type controlOf(std::size_t hash) noexcept {
+        return static_cast<control_type>(hash & 0x7F);
+    }
+
+    [[nodiscard]] size_type probeStart(std::size_t hash) const noexcept {
+        return static_cast<size_type>(hash >> 7) & (capacity_ - 1);
+    }
+
+    [[nodiscard]] static constexpr size_type maxLoad(size_type capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+
+    [[nodiscard]] static size_type roundUpCapacity(size_type count) noexcept {
+        count = std::max<size_type>(count, HashGroup::kWidth);
+        return isPowerOf2(count) ? count : getNextPowerOf2(count);
+    }
+
+    [[nodiscard]] static size_type capacityFor(size_type count) noexcept {
+        return roundUpCapacity(count + (count + 6) / 7);
+    }
+
+    //! Probe the groups from the start of hash for the first empty or deleted slot
+    [[nodiscard]] size_type findFree(std::size_t hash) const noexcept {
+        auto mask = capacity_ - 1;
+        auto position = probeStart(hash);
+        for (size_type step = HashGroup::kWidth;; step += HashGroup::kWidth) {
+            auto free = HashGroup(controls_ + position).matchFree();
+            if (free != 0) {
+                return (position + countTrailingZeros(free)) & mask;
+            }
+            position = (position + step) & mask;
+        }
+    }
+
+    //! The first kWidth control bytes are cloned past the capacity, so a group can be loaded from any slot
+    void setControl(size_type index, control_type control) noexcept {
+        controls_[index] = control;
+        if (index < HashGroup::kWidth) {
+            controls_[capacity_ + index] = control;
+        }
+    }
+
+    void growForInsert() {
+        if (capacity_ == 0) {
+            resizeTable(HashGroup::kWidth);
+        } else if (size_ < maxLoad(capacity_) / 2) {
+            // mostly deleted slots, rebuilding at the same capacity is enough
+            resizeTable(capacity_);
+        } else {
+            resizeTable(capacity_ * 2);
+        }
+    }
+
+    void resizeTable(size_type new_capacity) {
+        control_allocator_type control_alloc(alloc_);
+        auto new_controls = control_allocator_traits::allocate(control_alloc, new_capacity + HashGroup::kWidth);
+        pointer new_slots;
+        try {
+            new_slots = allocator_traits::allocate(alloc_, new_capacity);
+        } catch (...) {
+            control_allocator_traits::deallocate(control_alloc, new_controls, new_capacity + HashGroup::kWidth);
+            throw;
+        }
+        std::memset(new_controls, HashGroup::kEmpty, new_capacity + HashGroup::kWidth);
+
+        auto old_controls = controls_;
+        auto old_slots = slots_;
+        auto old_capacity = capacity_;
+        controls_ = new_controls;
+        slots_ = new_slots;
+        capacity_ = new_capacity;
+        growth_left_ = maxLoad(new_capacity) - size_;
+
+        for (size_type i = 0; i < old_capacity; ++i) {
+            if (HashGroup::isFull(old_controls[i])) {
+                auto hash = hashOf(Traits::key(old_slots[i]));
+                auto index = findFree(hash);
+                if constexpr (kRelocatable) {
+                    relocate(old_slots + i, 1, slots_ + index);
+                } else {
+                    allocator_traits::construct(alloc_, slots_ + index, std::move_if_noexcept(old_slots[i]));
+                    allocator_traits::destroy(alloc_, old_slots + i);
+                }
+                setControl(index, controlOf(hash));
+            }
+        }
+        releaseTable(old_controls, old_slots, old_capacity);
+    }
+
+    void copyValues(const FlatHashTable& rhs) {
+        for (const auto& value : rhs) {
+            insertUnique(hashOf(Traits::key(value)), value);
+        }
+    }
+
+    void destroyValues() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for (auto index = nextFull(0); index < capacity_; index = nextFull(index + 1)) {
+                allocator_traits::destroy(alloc_, slots_ + index);
+            }
+        }
+    }
+
+    void releaseTable(control_type* controls, pointer slots, size_type capacity) noexcept {
+        if (capacity > 0) {
+            control_allocator_type control_alloc(alloc_);
+            control_allocator_traits::deallocate(control_alloc, controls, capacity + HashGroup::kWidth);
+            allocator_traits::deallocate(alloc_, slots, capacity);
+        }
+    }
+
+    void cleanup() noexcept {
+        destroyValues();
+        releaseTable(controls_, slots_, capacity_);
+        controls_ = nullptr;
+        slots_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+        growth_left_ = 0;
+    }
+
+    control_type* controls_;
+    pointer slots_;
+    size_type capacity_;
+    size_type size_;
+    //! Number of empty slots which can be filled before the table grows
+    size_type growth_left_;
+    hasher hash_;
+    key_equal equal_;
+    allocator_type alloc_;
+};
+
+template<typename Traits>
+bool
+operator==(const FlatHashTable<Traits>& lhs, const FlatHashTable<Traits>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (const auto& value : lhs) {
+        auto iter = rhs.find(Traits::key(value));
+        if (iter == rhs.end() || !(*iter == value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Traits>
+bool
+operator!=(const FlatHashTable<Traits>& lhs, const FlatHashTable<Traits>& rhs) {
+    return !(lhs == rhs);
+}
+
+/**
+ * @brief Hash set over a FlatHashTable
+ */
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Allocator = std::allocator<Key>>
+class FlatHashSet : public FlatHashTable<HashSetTraits<Key, Hash, KeyEqual, Allocator>> {
+public:
+    using base_class = FlatHashTable<HashSetTraits<Key, Hash, KeyEqual, Allocator>>;
+    using base_class::base_class;
+};
+
+/**
+ * @brief Hash map over a FlatHashTable, holding std::pair<const Key, MappedType> values
+ */
+template<typename Key, typename MappedType, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Allocator = std::allocator<std::pair<const Key, MappedType>>>
+class FlatHashMap : public FlatHashTable<HashMapTraits<Key, MappedType, Hash, KeyEqual, Allocator>> {
+public:
+    using base_class = FlatHashTable<HashMapTraits<Key, MappedType, Hash, KeyEqual, Allocator>>;
+    using key_type = typename base_class::key_type;
+    using mapped_type = MappedType;
+    using iterator = typename base_class::iterator;
+    using const_iterator = typename base_class::const_iterator;
+
+    using base_class::base_class;
+
+    /**
+     * @brief Insert a value built from key and args unless key is already in the map, in which case args are left
+     *        untouched
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> tryEmplace(const key_type& key, Args&&... args) {
+        return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> tryEmplace(key_type&& key, Args&&... args) {
+        return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insertOrAssign(const key_type& key, M&& mapped) {
+        auto result = tryEmplace(key, std::forward<M>(mapped));
+        if (!result.second) {
+            result.first->second = std::forward<M>(mapped);
+        }
+        return result;
+    }
+
+    mapped_type& operator[](const key_type& key) {
+        return tryEmplace(key).first->second;
+    }
+
+    mapped_type& operator[](key_type&& key) {
+        return tryEmplace(std::move(key)).first->second;
+    }
+
+    [[nodiscard]] mapped_type& at(const key_type& key) {
+        auto iter = this->find(key);
+        if (iter == this->end()) {
+            throw std::out_of_range("FlatHashMap has no such key");
+        }
+        return iter->second;
+    }
+
+    [[nodiscard]] const mapped_type& at(const key_type& key) const {
+        auto iter = this->find(key);
+        if (iter == this->end()) {
+            throw std::out_of_range("FlatHashMap has no such key");
+        }
+        return iter->second;
+    }
+};
+
+}  // namespace nxt::core
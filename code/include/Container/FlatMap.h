@@ -0,0 +1,542 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "../Algorithm/Search.h"
+#include "../Algorithm/Sort.h"
+#include "CommonTree.h"
+#include "Vector.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Traits of the FlatMap values. Unlike MappedTraits the key of the pair isn't const, since the values are
+ *        moved around the vector when keys are inserted and erased
+ */
+template<typename Key, typename MappedType, typename Compare = std::less<>,
+         typename Allocator = std::allocator<std::pair<Key, MappedType>>>
+struct FlatMappedTraits {
+    using key_type = Key;
+    using mapped_type = MappedType;
+    using value_type = std::pair<key_type, mapped_type>;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using compare_type = Compare;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+
+    static const key_type& key(const value_type& value) {
+        return value.first;
+    }
+};
+
+/**
+ * @brief Ordered unique keys stored in a Vector sorted by key. Lookups are binary searches over contiguous memory,
+ *        inserting and erasing single values is O(N) as the values behind them are moved, so the FlatTree suits
+ *        small maps which are mostly read. Batches are best inserted at once with insertSorted(), which appends
+ *        them and merges them with the values in O(N + M).
+ *
+ *        Inserting and erasing invalidates the iterators. Iterators give mutable access to the values, the keys
+ *        must not be changed through them.
+ *
+ * @tparam TreeTraits SimpleTraits or FlatMappedTraits describing the values and their keys
+ */
+template<typename TreeTraits>
+class FlatTree {
+public:
+    using value_type = typename TreeTraits::value_type;
+    using key_type = typename TreeTraits::key_type;
+    using compare_type = typename TreeTraits::compare_type;
+    using allocator_type = typename TreeTraits::allocator_type;
+    using container_type = Vector<value_type, allocator_type>;
+    using size_type = typename container_type::size_type;
+    using difference_type = typename container_type::difference_type;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename container_type::pointer;
+    using const_pointer = typename container_type::const_pointer;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+protected:
+    using tree_traits = TreeTraits;
+
+public:
+    FlatTree() noexcept(std::is_nothrow_default_constructible_v<container_type> &&
+                        std::is_nothrow_default_constructible_v<compare_type>)
+        : values_()
+        , compare_() {}
+
+    explicit FlatTree(const allocator_type& alloc)
+        : values_(alloc)
+        , compare_() {}
+
+    /**
+     * @brief Construct the tree from a range. Input sorted by increasing keys is copied in O(N), anything else is
+     *        inserted value by value
+     */
+    template<typename ForwardIt, typename = typename std::iterator_traits<ForwardIt>::iterator_category>
+    FlatTree(ForwardIt first, ForwardIt last, const allocator_type& alloc = allocator_type())
+        : values_(alloc)
+        , compare_() {
+        insert(first, last);
+    }
+
+    FlatTree(std::initializer_list<value_type> values, const allocator_type& alloc = allocator_type())
+        : FlatTree(values.begin(), values.end(), alloc) {}
+
+    /**
+     * @brief Insert the value if its key is not present
+     *
+     * @return Iterator to the inserted value or to the value with the same key, and true if the value was inserted
+     */
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return insertValue(tree_traits::key(value), value);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return insertValue(tree_traits::key(value), std::move(value));
+    }
+
+    /**
+     * @brief Insert the values of [first, last), those whose key is already present are skipped. Sorted input goes
+     *        through insertSorted(), anything else is inserted value by value
+     */
+    template<typename ForwardIt, typename = typename std::iterator_traits<ForwardIt>::iterator_category>
+    void insert(ForwardIt first, ForwardIt last) {
+        if (isSorted(first, last, valueCompare())) {
+            insertSorted(first, last);
+        } else {
+            for (; first != last; ++first) {
+                insert(*first);
+            }
+        }
+    }
+
+    void insert(std::initializer_list<value_type> values) {
+        insert(values.begin(), values.end());
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        return insertValue(tree_traits::key(value), std::move(value));
+    }
+
+    /**
+     * @brief Insert the values of [first, last), sorted by increasing keys. Values whose key is already present are
+     *        skipped. The new values are appended behind the current ones and the two sorted runs are merged in
+     *        O(N + M) instead of moving the values behind every inserted one
+     *
+     * @return Number of values inserted
+     */
+    template<typename ForwardIt>
+    size_type insertSorted(ForwardIt first, ForwardIt last) {
+        auto old_size = values_.size();
+        values_.reserve(old_size + static_cast<size_type>(std::distance(first, last)));
+
+        // the current values are searched with a cursor which only moves forward as the input is sorted
+        size_type cursor = 0;
+        try {
+            for (; first != last; ++first) {
+                // binding the value keeps the converted temporary alive when the input holds another type
+                const value_type& value = *first;
+                const auto& key = tree_traits::key(value);
+                if (values_.size() > old_size && !compare_(tree_traits::key(values_.back()), key)) {
+                    continue;
+                }
+
+                cursor = static_cast<size_type>(
+                    nxt::core::lowerBound(values_.begin() + cursor, values_.begin() + old_size, key, keyCompare()) -
+                    values_.begin());
+                if (cursor != old_size && !compare_(key, tree_traits::key(values_[cursor]))) {
+                    continue;
+                }
+                values_.pushBack(*first);
+            }
+        } catch (...) {
+            values_.erase(values_.begin() + old_size, values_.end());
+            throw;
+        }
+
+        auto inserted_count = values_.size() - old_size;
+        if (inserted_count > 0 && old_size > 0 &&
+            compare_(tree_traits::key(values_[old_size]), tree_traits::key(values_[old_size - 1]))) {
+            mergeRuns(old_size);
+        }
+        return inserted_count;
+    }
+
+    /**
+     * @brief Replace the content of the tree with [first, last), which must be sorted by strictly increasing keys
+     */
+    template<typename ForwardIt>
+    void assignSorted(ForwardIt first, ForwardIt last) {
+        values_.assign(first, last);
+    }
+
+    size_type erase(const key_type& key) {
+        return eraseKey(key);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    size_type erase(const Key& key) {
+        return eraseKey(key);
+    }
+
+    iterator erase(iterator position) {
+        return values_.erase(position);
+    }
+
+    iterator erase(const_iterator position) {
+        return values_.erase(position);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return values_.erase(first, last);
+    }
+
+    void clear() noexcept {
+        values_.clear();
+    }
+
+    void reserve(size_type new_capacity) {
+        values_.reserve(new_capacity);
+    }
+
+    void shrinkToFit() {
+        values_.shrinkToFit();
+    }
+
+    [[nodiscard]] const_iterator find(const key_type& key) const {
+        return findValue(key);
+    }
+
+    [[nodiscard]] iterator find(const key_type& key) {
+        return const_cast<iterator>(findValue(key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator find(const Key& key) const {
+        return findValue(key);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator find(const Key& key) {
+        return const_cast<iterator>(findValue(key));
+    }
+
+    [[nodiscard]] bool contains(const key_type& key) const {
+        return findValue(key) != values_.end();
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] bool contains(const Key& key) const {
+        return findValue(key) != values_.end();
+    }
+
+    [[nodiscard]] size_type count(const key_type& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] size_type count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    /**
+     * @brief Returns the iterator to the first value whose key is not less than key
+     */
+    [[nodiscard]] const_iterator lowerBound(const key_type& key) const {
+        return lowerBoundValue(key);
+    }
+
+    [[nodiscard]] iterator lowerBound(const key_type& key) {
+        return const_cast<iterator>(lowerBoundValue(key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator lowerBound(const Key& key) const {
+        return lowerBoundValue(key);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator lowerBound(const Key& key) {
+        return const_cast<iterator>(lowerBoundValue(key));
+    }
+
+    /**
+     * @brief Returns the iterator to the first value whose key is greater than key
+     */
+    [[nodiscard]] const_iterator upperBound(const key_type& key) const {
+        return upperBoundValue(key);
+    }
+
+    [[nodiscard]] iterator upperBound(const key_type& key) {
+        return const_cast<iterator>(upperBoundValue(key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator upperBound(const Key& key) const {
+        return upperBoundValue(key);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator upperBound(const Key& key) {
+        return const_cast<iterator>(upperBoundValue(key));
+    }
+
+    /**
+     * @brief Returns the iterator to the value at position in key order, the vector makes this O(1)
+     */
+    [[nodiscard]] const_iterator select(size_type position) const {
+        return values_.begin() + position;
+    }
+
+    [[nodiscard]] iterator select(size_type position) {
+        return values_.begin() + position;
+    }
+
+    /**
+     * @brief Returns the number of values whose key is less than key
+     */
+    [[nodiscard]] size_type rank(const key_type& key) const {
+        return static_cast<size_type>(lowerBoundValue(key) - values_.begin());
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] size_type rank(const Key& key) const {
+        return static_cast<size_type>(lowerBoundValue(key) - values_.begin());
+    }
+
+    [[nodiscard]] iterator begin() noexcept {
+        return values_.begin();
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return values_.begin();
+    }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept {
+        return values_.cbegin();
+    }
+
+    [[nodiscard]] iterator end() noexcept {
+        return values_.end();
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return values_.end();
+    }
+
+    [[nodiscard]] const_iterator cend() const noexcept {
+        return values_.cend();
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return values_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return values_.empty();
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept {
+        return values_.capacity();
+    }
+
+    //! The sorted values
+    [[nodiscard]] const container_type& values() const noexcept {
+        return values_;
+    }
+
+protected:
+    template<typename Key, typename Arg>
+    std::pair<iterator, bool> insertValue(const Key& key, Arg&& arg) {
+        auto position = lowerBoundValue(key);
+        if (position != values_.end() && !compare_(key, tree_traits::key(*position))) {
+            return {const_cast<iterator>(position), false};
+        }
+        return {values_.insert(position, std::forward<Arg>(arg)), true};
+    }
+
+    template<typename Key, typename... Args>
+    std::pair<iterator, bool> emplaceKey(const Key& key, Args&&... args) {
+        auto position = lowerBoundValue(key);
+        if (position != values_.end() && !compare_(key, tree_traits::key(*position))) {
+            return {const_cast<iterator>(position), false};
+        }
+        return {values_.emplace(position, std::forward<Args>(args)...), true};
+    }
+
+    template<typename Key>
+    const_iterator lowerBoundValue(const Key& key) const {
+        return nxt::core::lowerBound(values_.begin(), values_.end(), key, keyCompare());
+    }
+
+    template<typename Key>
+    const_iterator upperBoundValue(const Key& key) const {
+        return nxt::core::upperBound(values_.begin(), values_.end(), key, [this](const auto& lhs, const auto& value) {
+            return compare_(lhs, tree_traits::key(value));
+        });
+    }
+
+    template<typename Key>
+    const_iterator findValue(const Key& key) const {
+        auto position = lowerBoundValue(key);
+        if (position != values_.end() && !compare_(key, tree_traits::key(*position))) {
+            return position;
+        }
+        return values_.end();
+    }
+
+    template<typename Key>
+    size_type eraseKey(const Key& key) {
+        auto position = findValue(key);
+        if (position == values_.end()) {
+            return 0;
+        }
+        values_.erase(position);
+        return 1;
+    }
+
+private:
+    //! Output iterator move constructing the merged values at the back of a Vector
+    struct AppendIterator {
+        AppendIterator& operator*() noexcept {
+            return *this;
+        }
+
+        AppendIterator& operator++() noexcept {
+            return *this;
+        }
+
+        AppendIterator& operator=(value_type&& value) {
+            values->emplaceBack(std::move(value));
+            return *this;
+        }
+
+        container_type* values;
+    };
+
+    auto keyCompare() const noexcept {
+        return [this](const value_type& value, const auto& key) { return compare_(tree_traits::key(value), key); };
+    }
+
+    auto valueCompare() const noexcept {
+        return [this](const value_type& lhs, const value_type& rhs) {
+            return compare_(tree_traits::key(lhs), tree_traits::key(rhs));
+        };
+    }
+
+    //! Merge the sorted runs [0, middle) and [middle, size) of the values, whose keys are all different
+    void mergeRuns(size_type middle) {
+        container_type merged(values_.getAllocator());
+        merged.reserve(values_.size());
+        nxt::core::merge(std::make_move_iterator(values_.begin()),
+                         std::make_move_iterator(values_.begin() + middle),
+                         std::make_move_iterator(values_.begin() + middle),
+                         std::make_move_iterator(values_.end()),
+                         AppendIterator{&merged},
+                         valueCompare());
+        values_ = std::move(merged);
+    }
+
+    container_type values_;
+    compare_type compare_;
+};
+
+template<typename TreeTraits>
+bool
+operator==(const FlatTree<TreeTraits>& lhs, const FlatTree<TreeTraits>& rhs) {
+    return lhs.values() == rhs.values();
+}
+
+template<typename TreeTraits>
+bool
+operator!=(const FlatTree<TreeTraits>& lhs, const FlatTree<TreeTraits>& rhs) {
+    return !(lhs == rhs);
+}
+
+/**
+ * @brief Ordered set over a FlatTree
+ */
+template<typename Key, typename Compare = std::less<>, typename Allocator = std::allocator<Key>>
+class FlatSet : public FlatTree<SimpleTraits<Key, Compare, Allocator>> {
+public:
+    using base_class = FlatTree<SimpleTraits<Key, Compare, Allocator>>;
+    using base_class::base_class;
+};
+
+/**
+ * @brief Ordered map over a FlatTree, holding std::pair<Key, MappedType> values
+ */
+template<typename Key, typename MappedType, typename Compare = std::less<>,
+         typename Allocator = std::allocator<std::pair<Key, MappedType>>>
+class FlatMap : public FlatTree<FlatMappedTraits<Key, MappedType, Compare, Allocator>> {
+public:
+    using base_class = FlatTree<FlatMappedTraits<Key, MappedType, Compare, Allocator>>;
+    using key_type = typename base_class::key_type;
+    using mapped_type = MappedType;
+    using iterator = typename base_class::iterator;
+    using const_iterator = typename base_class::const_iterator;
+
+    using base_class::base_class;
+
+    /**
+     * @brief Insert a value built from key and args unless key is already in the map, in which case args are left
+     *        untouched
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> tryEmplace(const key_type& key, Args&&... args) {
+        return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> tryEmplace(key_type&& key, Args&&... args) {
+        return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insertOrAssign(const key_type& key, M&& mapped) {
+        auto result = tryEmplace(key, std::forward<M>(mapped));
+        if (!result.second) {
+            result.first->second = std::forward<M>(mapped);
+        }
+        return result;
+    }
+
+    mapped_type& operator[](const key_type& key) {
+        return tryEmplace(key).first->second;
+    }
+
+    mapped_type& operator[](key_type&& key) {
+        return tryEmplace(std::move(key)).first->second;
+    }
+
+    [[nodiscard]] mapped_type& at(const key_type& key) {
+        auto iter = this->find(key);
+        if (iter == this->end()) {
+            throw std::out_of_range("FlatMap has no such key");
+        }
+        return iter->second;
+    }
+
+    [[nodiscard]] const mapped_type& at(const key_type& key) const {
+        auto iter = this->find(key);
+        if (iter == this->end()) {
+            throw std::out_of_range("FlatMap has no such key");
+        }
+        return iter->second;
+    }
+};
+
+}  // namespace nxt::core
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace nxt::core {
+
+/**
+ * @brief Pool of nodes for the node based containers. Nodes are carved out of slabs allocated through the node
+ *        allocator of the container and released nodes are kept in an intrusive free list, so inserting after an
+ *        erase doesn't touch the allocator. All the slabs are returned at once by release(), so a container can drop
+ *        its nodes without deallocating them one by one.
+ *
+ *        The pool doesn't store the allocator, the container passes its own allocator to allocate() and release().
+ *        The pool only deals with raw storage, constructing and destroying the nodes is left to the container.
+ *
+ * @tparam Node Type of node allocated
+ * @tparam NodeAllocator Allocator of Node used for the slabs
+ * @tparam MaxSlabNodeCount Maximum number of nodes in a slab, slabs grow geometrically up to this size
+ */
+template<typename Node, typename NodeAllocator, std::size_t MaxSlabNodeCount = 1024>
+class NodePool {
+public:
+    using allocator_type = NodeAllocator;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using node_pointer = typename allocator_traits::pointer;
+    using size_type = typename allocator_traits::size_type;
+
+    static constexpr size_type kMinSlabNodeCount = 16;
+    static constexpr size_type kMaxSlabNodeCount = MaxSlabNodeCount;
+
+    NodePool() noexcept = default;
+
+    NodePool(NodePool&& rhs) noexcept {
+        swap(rhs);
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() = default;
+
+    /**
+     * @brief Get storage for a node, from the free list if possible
+     */
+    [[nodiscard]] node_pointer allocate(allocator_type& alloc) {
+        if (free_list_ != nullptr) {
+            auto node = reinterpret_cast<node_pointer>(free_list_);
+            free_list_ = free_list_->next;
+            return node;
+        }
+
+        if (slab_current_ == slab_end_) {
+            allocateSlab(alloc);
+        }
+        return slab_current_++;
+    }
+
+    /**
+     * @brief Give the storage of a node back to the pool. The node must have been destroyed already
+     */
+    void deallocate(node_pointer node) noexcept {
+        free_list_ = ::new (static_cast<void*>(node)) FreeNode{free_list_};
+    }
+
+    /**
+     * @brief Return all the slabs to the allocator. Every node of the pool must have been destroyed already
+     */
+    void release(allocator_type& alloc) noexcept {
+        auto slab = slabs_;
+        while (slab != nullptr) {
+            auto next_slab = slab->next;
+            auto node_count = slab->node_count;
+            allocator_traits::deallocate(alloc, reinterpret_cast<node_pointer>(slab), node_count);
+            slab = next_slab;
+        }
+
+        slabs_ = nullptr;
+        free_list_ = nullptr;
+        slab_current_ = nullptr;
+        slab_end_ = nullptr;
+        next_slab_node_count_ = kMinSlabNodeCount;
+    }
+
+    void swap(NodePool& rhs) noexcept {
+        using std::swap;
+        swap(slabs_, rhs.slabs_);
+        swap(free_list_, rhs.free_list_);
+        swap(slab_current_, rhs.slab_current_);
+        swap(slab_end_, rhs.slab_end_);
+        swap(next_slab_node_count_, rhs.next_slab_node_count_);
+    }
+
+    /**
+     * @brief Number of slabs allocated from the allocator
+     */
+    [[nodiscard]] size_type getSlabCount() const noexcept {
+        size_type count = 0;
+        for (auto slab = slabs_; slab != nullptr; slab = slab->next) {
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    // lives in the first node of every slab
+    struct SlabHeader {
+        SlabHeader* next;
+        size_type node_count;
+    };
+
+    static_assert(sizeof(Node) >= sizeof(SlabHeader) && alignof(Node) >= alignof(SlabHeader),
+                  "Node is too small to be pooled");
+    static_assert(kMaxSlabNodeCount >= kMinSlabNodeCount);
+
+    void allocateSlab(allocator_type& alloc) {
+        auto node_count = next_slab_node_count_;
+        auto nodes = allocator_traits::allocate(alloc, node_count);
+        slabs_ = ::new (static_cast<void*>(nodes)) SlabHeader{slabs_, node_count};
+        slab_current_ = nodes + 1;
+        slab_end_ = nodes + node_count;
+
+        next_slab_node_count_ = std::min(next_slab_node_count_ * 2, kMaxSlabNodeCount);
+    }
+
+    SlabHeader* slabs_ = nullptr;
+    FreeNode* free_list_ = nullptr;
+    node_pointer slab_current_ = nullptr;
+    node_pointer slab_end_ = nullptr;
+    size_type next_slab_node_count_ = kMinSlabNodeCount;
+};
+
+}  // namespace nxt::core
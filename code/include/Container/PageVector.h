@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <type_traits>
 
@@ -17,7 +19,6 @@ public:
     using reference = typename PageVector::const_reference;
     using const_reference = typename PageVector::const_reference;
     using size_type = typename PageVector::size_type;
-    using difference_type = typename PageVector::difference_type;
     using iterator_category = std::random_access_iterator_tag;
 
     PageVectorConstIterator(PageVector* vector, size_type index) noexcept
@@ -114,7 +115,6 @@ public:
     using reference = typename PageVector::reference;
     using const_reference = typename PageVector::const_reference;
     using size_type = typename PageVector::size_type;
-    using difference_type = typename PageVector::difference_type;
     using iterator_category = std::random_access_iterator_tag;
     using base_class = PageVectorConstIterator<PageVector>;
 
@@ -201,19 +201,37 @@ private:
     using page_allocator_traits = typename std::allocator_traits<page_allocator>;
     using page_pointer_allocator = typename allocator_traits::template rebind_alloc<Page*>;
 
+    //! Trivially copyable values are copied a page at a time with memcpy
+    static constexpr bool kCopyPages = std::is_trivially_copyable_v<value_type> && std::is_pointer_v<pointer>;
+
 public:
     PageVector() noexcept(
         std::is_nothrow_default_constructible_v<page_allocator>&& std::is_nothrow_constructible_v<decltype(pages_)>)
         : size_(0)
         , alloc_() {}
 
+    explicit PageVector(const allocator_type& alloc)
+        : pages_(page_pointer_allocator(alloc))
+        , size_(0)
+        , alloc_(alloc) {}
+
     PageVector(const PageVector& rhs)
         : size_(0)
         , alloc_(page_allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
         reserve(rhs.capacity());
 
-        for (const auto& value : rhs) {
-            pushBack(value);
+        if constexpr (kCopyPages) {
+            for (size_type first = 0; first < rhs.size_; first += page_size) {
+                auto count = std::min<size_type>(page_size, rhs.size_ - first);
+                std::memcpy(static_cast<void*>(pointerAt(first)),
+                            static_cast<const void*>(rhs.pointerAt(first)),
+                            count * sizeof(value_type));
+            }
+            size_ = rhs.size_;
+        } else {
+            for (const auto& value : rhs) {
+                pushBack(value);
+            }
         }
     }
 
@@ -234,6 +252,7 @@ public:
         }
 
         assign(rhs.begin(), rhs.end());
+        return *this;
     }
 
     PageVector& operator=(PageVector&& rhs) {
@@ -264,13 +283,14 @@ public:
                         }
                     }
                     size_ = rhs.size_;
-                    return;
+                    return *this;
                 } else {
                     cleanup();
                 }
             }
         }
         takeData(std::move(rhs));
+        return *this;
     }
 
     template<typename InputIter, typename = std::enable_if_t<IsInputIteratorV<InputIter>>>
@@ -346,12 +366,12 @@ public:
                 valueAt(i) = value;
             }
 
-            for (size_type i = size_; i < item_count; ++i) {
+            for (size_type i = size_; i < count; ++i) {
                 page_allocator_traits::construct(alloc_, pointerAt(i), value);
             }
         }
 
-        size_ = item_count;
+        size_ = count;
     }
 
     [[nodiscard]] size_type capacity() const noexcept {
@@ -0,0 +1,880 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#include "CommonTree.h"
+#include "NodePool.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Red-black tree sharing the traits and iterators of the other trees. It keeps the black height of every path
+ *        equal and never links two red nodes, so it is at most twice as deep as a perfectly balanced tree. Inserts
+ *        need at most two rotations and erases at most three, which makes it cheaper to update than the AVLTree at
+ *        the cost of slightly deeper lookups. The color is stored in the low bit of the parent pointer, so a node is
+ *        three pointers and the value
+ *
+ * @tparam TreeTraits SimpleTraits or MappedTraits describing the values and their keys
+ * @tparam OrderStatistics Keep the number of nodes of every subtree to answer select(), rank() and countRange() in
+ *         O(log N), for one more size_type per node
+ */
+template<typename TreeTraits, bool OrderStatistics = false>
+class RedBlackTree {
+private:
+    struct Node;
+
+public:
+    using value_type = typename TreeTraits::value_type;
+    using key_type = typename TreeTraits::key_type;
+    using compare_type = typename TreeTraits::compare_type;
+    using allocator_type = typename TreeTraits::allocator_type;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using node_type = Node;
+    using size_type = typename allocator_traits::size_type;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename allocator_traits::pointer;
+    using const_pointer = typename allocator_traits::const_pointer;
+    using difference_type = typename allocator_traits::difference_type;
+    using const_iterator = TreeConstIterator<RedBlackTree>;
+    using iterator = TreeIterator<RedBlackTree>;
+
+protected:
+    using node_allocator_type = typename allocator_traits::template rebind_alloc<node_type>;
+    using node_allocator_traits = std::allocator_traits<node_allocator_type>;
+    using node_pointer = typename node_allocator_traits::pointer;
+    using node_const_pointer = typename node_allocator_traits::const_pointer;
+    using node_pool_type = NodePool<node_type, node_allocator_type>;
+    using tree_traits = TreeTraits;
+    using tree_operations = TreeOperations<RedBlackTree>;
+    using insert_position = TreeInsertPosition<node_pointer>;
+
+public:
+    RedBlackTree() noexcept(std::is_nothrow_default_constructible_v<node_allocator_type>&&
+                           std::is_nothrow_default_constructible_v<compare_type>)
+        : head_node_()
+        , size_(0)
+        , compare_()
+        , alloc_() {
+        createHeadNode();
+    }
+
+    explicit RedBlackTree(const allocator_type& alloc)
+        : head_node_()
+        , size_(0)
+        , compare_()
+        , alloc_(alloc) {
+        createHeadNode();
+    }
+
+    RedBlackTree(RedBlackTree&& rhs)
+        : head_node_()
+        , size_(0)
+        , compare_(rhs.compare_)
+        , alloc_(std::move(rhs.alloc_)) {
+        createHeadNode();
+        using std::swap;
+        swap(head_node_, rhs.head_node_);
+        pool_.swap(rhs.pool_);
+        size_ = rhs.size_;
+        rhs.size_ = 0;
+    }
+
+    RedBlackTree(const RedBlackTree& rhs)
+        : head_node_()
+        , size_(0)
+        , compare_(rhs.compare_)
+        , alloc_(node_allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
+        createHeadNode();
+        assignSorted(rhs.begin(), rhs.end());
+    }
+
+    /**
+     * @brief Construct the tree from a range. Input sorted by strictly increasing keys is linked into a balanced
+     *        tree in O(N), anything else is inserted value by value
+     */
+    template<typename ForwardIt, typename = typename std::iterator_traits<ForwardIt>::iterator_category>
+    RedBlackTree(ForwardIt first, ForwardIt last, const allocator_type& alloc = allocator_type())
+        : head_node_()
+        , size_(0)
+        , compare_()
+        , alloc_(alloc) {
+        createHeadNode();
+        if (tree_operations::isStrictlySorted(*this, first, last)) {
+            assignSorted(first, last);
+        } else {
+            for (; first != last; ++first) {
+                insert(*first);
+            }
+        }
+    }
+
+    /**
+     * @brief Insert the value if its key is not present
+     *
+     * @return Iterator to the inserted value or to the value with the same key, and true if the value was inserted
+     */
+    std::pair<iterator, bool> insert(const value_type& value) {
+        auto result = tree_operations::insertValue(*this, value);
+        return {iterator(this, result.first), result.second};
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        auto result = tree_operations::insertValue(*this, std::move(value));
+        return {iterator(this, result.first), result.second};
+    }
+
+    /**
+     * @brief Insert the value right before the hint if that is where its key belongs, without searching the tree.
+     *        Inserting keys in increasing order with end() as the hint is amortized O(1). Otherwise this is a normal
+     *        insert
+     *
+     * @return Iterator to the inserted value or to the value with the same key
+     */
+    iterator insert(const_iterator hint, const value_type& value) {
+        return iterator(this, tree_operations::insertValue(*this, hint.node_, value).first);
+    }
+
+    iterator insert(const_iterator hint, value_type&& value) {
+        return iterator(this, tree_operations::insertValue(*this, hint.node_, std::move(value)).first);
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        auto node = createNode(std::forward<Args>(args)...);
+        auto position = tree_operations::findInsertPosition(*this, tree_traits::key(node->value));
+        if (position.node != nullptr) {
+            destroyNode(node);
+            return {iterator(this, position.node), false};
+        }
+
+        insertNode(node, position);
+        return {iterator(this, node), true};
+    }
+
+    size_type erase(const key_type& key) {
+        auto node = tree_operations::findNode(*this, key);
+        if (node == head_node_) {
+            return 0;
+        } else {
+            eraseNode(node);
+            return 1;
+        }
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    size_type erase(const Key& key) {
+        auto node = tree_operations::findNode(*this, key);
+        if (node == head_node_) {
+            return 0;
+        } else {
+            eraseNode(node);
+            return 1;
+        }
+    }
+
+    /**
+     * @brief Replace the content of the tree with [first, last), which must be sorted by strictly increasing keys.
+     *        The nodes are linked into a perfectly balanced tree in O(N) instead of N inserts
+     */
+    template<typename ForwardIt>
+    void assignSorted(ForwardIt first, ForwardIt last) {
+        tree_operations::assignSorted(*this, first, last);
+    }
+
+    /**
+     * @brief Insert the values of [first, last), sorted by increasing keys. Values whose key is already present are
+     *        skipped. A batch large compared to the tree is merged with the existing nodes and relinked into a
+     *        balanced tree in O(N + M), a small one is inserted value by value
+     *
+     * @return Number of values inserted
+     */
+    template<typename ForwardIt>
+    size_type mergeSorted(ForwardIt first, ForwardIt last) {
+        return tree_operations::mergeSorted(*this, first, last);
+    }
+
+    /**
+     * @brief Destroy all the values and give the node slabs back to the allocator at once
+     */
+    void clear() noexcept {
+        tree_operations::destroyValues(*this);
+        pool_.release(alloc_);
+
+        setParent(head_node_, nullptr);
+        head_node_->left_child = head_node_;
+        head_node_->right_child = head_node_;
+        size_ = 0;
+    }
+
+    ~RedBlackTree() {
+        clear();
+
+        node_allocator_traits::destroy(alloc_, std::addressof(head_node_->left_child));
+        node_allocator_traits::destroy(alloc_, std::addressof(head_node_->right_child));
+        node_allocator_traits::deallocate(alloc_, head_node_, 1);
+    }
+
+    [[nodiscard]] const_iterator find(const key_type& value) const {
+        return const_iterator(this, tree_operations::findNode(*this, value));
+    }
+
+    [[nodiscard]] iterator find(const key_type& value) {
+        return iterator(this, tree_operations::findNode(*this, value));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator find(const Key& value) const {
+        return const_iterator(this, tree_operations::findNode(*this, value));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator find(const Key& value) {
+        return iterator(this, tree_operations::findNode(*this, value));
+    }
+
+    /**
+     * @brief Get the first value whose key is not less than the key, or end() if there is none
+     */
+    [[nodiscard]] const_iterator lowerBound(const key_type& key) const {
+        return const_iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    [[nodiscard]] iterator lowerBound(const key_type& key) {
+        return iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator lowerBound(const Key& key) const {
+        return const_iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator lowerBound(const Key& key) {
+        return iterator(this, tree_operations::lowerBoundNode(*this, key));
+    }
+
+    /**
+     * @brief Get the first value whose key is greater than the key, or end() if there is none
+     */
+    [[nodiscard]] const_iterator upperBound(const key_type& key) const {
+        return const_iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    [[nodiscard]] iterator upperBound(const key_type& key) {
+        return iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator upperBound(const Key& key) const {
+        return const_iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator upperBound(const Key& key) {
+        return iterator(this, tree_operations::upperBoundNode(*this, key));
+    }
+
+    /**
+     * @brief Get the value at the zero based position in the order of the keys in O(log N), or end() if the position
+     *        is past the last value. Only available when the tree keeps order statistics
+     */
+    [[nodiscard]] const_iterator select(size_type position) const {
+        return const_iterator(this, selectNode(position));
+    }
+
+    [[nodiscard]] iterator select(size_type position) {
+        return iterator(this, selectNode(position));
+    }
+
+    /**
+     * @brief Count the keys less than the key in O(log N), which is the position the key has or would have in the
+     *        tree. Only available when the tree keeps order statistics
+     */
+    [[nodiscard]] size_type rank(const key_type& key) const {
+        return rankOf(key);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] size_type rank(const Key& key) const {
+        return rankOf(key);
+    }
+
+    /**
+     * @brief Count the keys in [lower, upper) in O(log N). Only available when the tree keeps order statistics
+     */
+    [[nodiscard]] size_type countRange(const key_type& lower, const key_type& upper) const {
+        return countRangeOf(lower, upper);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] size_type countRange(const Key& lower, const Key& upper) const {
+        return countRangeOf(lower, upper);
+    }
+
+    [[nodiscard]] iterator begin() {
+        return iterator(this, head_node_->left_child);
+    }
+
+    [[nodiscard]] const_iterator begin() const {
+        return const_iterator(this, head_node_->left_child);
+    }
+
+    [[nodiscard]] const_iterator cbegin() const {
+        return const_iterator(this, head_node_->left_child);
+    }
+
+    [[nodiscard]] iterator end() {
+        return iterator(this, head_node_);
+    }
+
+    [[nodiscard]] const_iterator end() const {
+        return const_iterator(this, head_node_);
+    }
+
+    [[nodiscard]] const_iterator cend() const {
+        return const_iterator(this, head_node_);
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /**
+     * @brief Number of nodes on the longest path from the root to a leaf, 0 for an empty tree. Walks the whole tree,
+     *        so it is meant for tests and diagnostics
+     */
+    [[nodiscard]] size_type height() const noexcept {
+        size_type max_depth = 0;
+        for (auto node = head_node_->left_child; node != head_node_; node = tree_operations::nextNode(*this, node)) {
+            if (node->left_child != nullptr || node->right_child != nullptr) {
+                continue;
+            }
+
+            size_type depth = 0;
+            for (auto ancestor = node; ancestor != head_node_; ancestor = parentOf(ancestor)) {
+                ++depth;
+            }
+            max_depth = std::max(max_depth, depth);
+        }
+        return max_depth;
+    }
+
+    /**
+     * @brief Check the red-black invariants: the root is black, no red node has a red child, every path from the
+     *        root to a missing child has the same number of black nodes and the children link back to their parent.
+     *        Walks the whole tree, so it is meant for tests and diagnostics
+     */
+    [[nodiscard]] bool checkInvariants() const noexcept {
+        if (isRed(rootNode())) {
+            return false;
+        }
+
+        // every path must have the black height of the leftmost one
+        size_type black_height = 0;
+        for (auto node = rootNode(); node != nullptr; node = node->left_child) {
+            black_height += isRed(node) ? 0 : 1;
+        }
+
+        for (auto node = head_node_->left_child; node != head_node_; node = tree_operations::nextNode(*this, node)) {
+            for (auto child : {node->left_child, node->right_child}) {
+                if (child != nullptr && (parentOf(child) != node || (isRed(node) && isRed(child)))) {
+                    return false;
+                }
+            }
+            if (node->left_child != nullptr && node->right_child != nullptr) {
+                continue;
+            }
+
+            size_type path_black_height = 0;
+            for (auto ancestor = node; ancestor != head_node_; ancestor = parentOf(ancestor)) {
+                path_black_height += isRed(ancestor) ? 0 : 1;
+            }
+            if (path_black_height != black_height) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static_assert(std::is_pointer_v<node_pointer>, "the color is packed into the node pointer, it must be a raw one");
+
+    //! low bit of the parent link, set for red nodes
+    static constexpr std::uintptr_t kRedBit = 1;
+
+    struct Node : TreeNodeCount<size_type, OrderStatistics> {
+        value_type value;
+        std::uintptr_t parent_link;
+        node_pointer left_child;
+        node_pointer right_child;
+    };
+
+    static_assert(alignof(Node) > kRedBit, "the low bit of node addresses must be free to store the color");
+
+    /**
+     * @brief Parent of the node, used by the iterators which don't know how the node stores it. The parent of the
+     *        head node is the root
+     */
+    static node_pointer parentOf(node_pointer node) noexcept {
+        return reinterpret_cast<node_pointer>(node->parent_link & ~kRedBit);
+    }
+
+    static void setParent(node_pointer node, node_pointer parent) noexcept {
+        node->parent_link = reinterpret_cast<std::uintptr_t>(parent) | (node->parent_link & kRedBit);
+    }
+
+    //! nullptr children count as black leaves
+    static bool isRed(node_pointer node) noexcept {
+        return node != nullptr && (node->parent_link & kRedBit) != 0;
+    }
+
+    static void setRed(node_pointer node) noexcept {
+        node->parent_link |= kRedBit;
+    }
+
+    static void setBlack(node_pointer node) noexcept {
+        node->parent_link &= ~kRedBit;
+    }
+
+    node_pointer rootNode() const noexcept {
+        return parentOf(head_node_);
+    }
+
+    void insertNode(node_pointer node, const insert_position& position) noexcept {
+        linkNode(node, position.parent, position.is_left);
+        adjustSizes(position.parent, true);
+        rebalanceAfterInsert(node);
+    }
+
+    /**
+     * @brief Link a new red leaf node as a child of parent and update the min and max nodes
+     */
+    node_pointer linkNode(node_pointer node, node_pointer parent, bool is_left) noexcept {
+        node->parent_link = reinterpret_cast<std::uintptr_t>(parent) | kRedBit;
+        node->left_child = nullptr;
+        node->right_child = nullptr;
+        updateSize(node);
+
+        if (parent == head_node_) {
+            setParent(head_node_, node);
+            head_node_->left_child = node;
+            head_node_->right_child = node;
+        } else if (is_left) {
+            parent->left_child = node;
+            if (parent == head_node_->left_child)
+                head_node_->left_child = node;
+        } else {
+            parent->right_child = node;
+            if (parent == head_node_->right_child)
+                head_node_->right_child = node;
+        }
+
+        ++size_;
+
+        return node;
+    }
+
+    /**
+     * @brief Link the sorted nodes into a balanced tree which replaces the current one
+     */
+    void linkSorted(node_pointer* nodes, size_type count) noexcept {
+        size_type red_depth = 0;
+        for (auto remaining = count; remaining > 1; remaining >>= 1) {
+            ++red_depth;
+        }
+
+        auto root_node = linkBalanced(nodes, 0, count, head_node_, 0, red_depth);
+        setBlack(root_node);
+        setParent(head_node_, root_node);
+        head_node_->left_child = nodes[0];
+        head_node_->right_child = nodes[count - 1];
+        size_ = count;
+    }
+
+    /**
+     * @brief Make the middle node of [begin, end) the root of the subtree and recurse on both halves. All the leaves
+     *        end up on the last two levels, so coloring the nodes of the deepest level red and every other node black
+     *        gives each path the same black height
+     */
+    node_pointer linkBalanced(node_pointer* nodes, size_type begin, size_type end, node_pointer parent,
+                              size_type depth, size_type red_depth) noexcept {
+        if (begin == end) {
+            return nullptr;
+        }
+
+        auto middle = begin + (end - begin) / 2;
+        auto node = nodes[middle];
+        node->parent_link = reinterpret_cast<std::uintptr_t>(parent) | (depth == red_depth ? kRedBit : 0);
+        node->left_child = linkBalanced(nodes, begin, middle, node, depth + 1, red_depth);
+        node->right_child = linkBalanced(nodes, middle + 1, end, node, depth + 1, red_depth);
+        updateSize(node);
+        return node;
+    }
+
+    void createHeadNode() {
+        head_node_ = node_allocator_traits::allocate(alloc_, 1);
+        head_node_->parent_link = 0;
+        node_allocator_traits::construct(alloc_, std::addressof(head_node_->left_child), head_node_);
+        node_allocator_traits::construct(alloc_, std::addressof(head_node_->right_child), head_node_);
+    }
+
+    template<typename... Args>
+    node_pointer createNode(Args&&... args) {
+        auto node = pool_.allocate(alloc_);
+        try {
+            node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Args>(args)...);
+        } catch (...) {
+            pool_.deallocate(node);
+            throw;
+        }
+        node->parent_link = 0;
+        node_allocator_traits::construct(alloc_, std::addressof(node->left_child));
+        node_allocator_traits::construct(alloc_, std::addressof(node->right_child));
+        return node;
+    }
+
+    void destroyNode(node_pointer node) noexcept {
+        node_allocator_traits::destroy(alloc_, std::addressof(node->value));
+        node_allocator_traits::destroy(alloc_, std::addressof(node->left_child));
+        node_allocator_traits::destroy(alloc_, std::addressof(node->right_child));
+        pool_.deallocate(node);
+    }
+
+    //! number of nodes in the subtree of the node, 0 for nullptr
+    static size_type subtreeSize(node_pointer node) noexcept {
+        return node != nullptr ? node->subtree_size : 0;
+    }
+
+    static void updateSize(node_pointer node) noexcept {
+        if constexpr (OrderStatistics) {
+            node->subtree_size = subtreeSize(node->left_child) + subtreeSize(node->right_child) + 1;
+        }
+    }
+
+    /**
+     * @brief Add the change to the subtree sizes of the node and its ancestors, once a node is linked or before it
+     *        is unlinked. Rotations only need to recompute the sizes of the nodes they move
+     */
+    void adjustSizes(node_pointer node, bool grows) noexcept {
+        if constexpr (OrderStatistics) {
+            for (; node != head_node_; node = parentOf(node)) {
+                if (grows) {
+                    ++node->subtree_size;
+                } else {
+                    --node->subtree_size;
+                }
+            }
+        }
+    }
+
+    node_pointer selectNode(size_type position) const noexcept {
+        static_assert(OrderStatistics, "select needs a tree keeping order statistics");
+        if (position >= size_) {
+            return head_node_;
+        }
+
+        auto node = rootNode();
+        while (true) {
+            auto left_size = subtreeSize(node->left_child);
+            if (position < left_size) {
+                node = node->left_child;
+            } else if (position > left_size) {
+                position -= left_size + 1;
+                node = node->right_child;
+            } else {
+                return node;
+            }
+        }
+    }
+
+    template<typename Key>
+    size_type rankOf(const Key& key) const {
+        static_assert(OrderStatistics, "rank needs a tree keeping order statistics");
+        size_type result = 0;
+        auto node = rootNode();
+        while (node != nullptr) {
+            if (compare_(tree_traits::key(node->value), key)) {
+                result += subtreeSize(node->left_child) + 1;
+                node = node->right_child;
+            } else {
+                node = node->left_child;
+            }
+        }
+        return result;
+    }
+
+    template<typename Key>
+    size_type countRangeOf(const Key& lower, const Key& upper) const {
+        static_assert(OrderStatistics, "countRange needs a tree keeping order statistics");
+        if (!compare_(lower, upper)) {
+            return 0;
+        }
+        return rankOf(upper) - rankOf(lower);
+    }
+
+    /**
+     * @brief Replace the child of parent, or the root if parent is the head node
+     */
+    void replaceChild(node_pointer parent, node_pointer child, node_pointer new_child) noexcept {
+        if (parent == head_node_) {
+            setParent(head_node_, new_child);
+        } else if (parent->left_child == child) {
+            parent->left_child = new_child;
+        } else {
+            parent->right_child = new_child;
+        }
+    }
+
+    /**
+     * @brief Move the right child of the node up in its place, the node becomes its left child
+     */
+    void rotateLeft(node_pointer node) noexcept {
+        auto parent_node = parentOf(node);
+        auto right_node = node->right_child;
+
+        replaceChild(parent_node, node, right_node);
+        setParent(right_node, parent_node);
+
+        node->right_child = right_node->left_child;
+        if (node->right_child != nullptr) {
+            setParent(node->right_child, node);
+        }
+
+        right_node->left_child = node;
+        setParent(node, right_node);
+
+        updateSize(node);
+        updateSize(right_node);
+    }
+
+    /**
+     * @brief Move the left child of the node up in its place, the node becomes its right child
+     */
+    void rotateRight(node_pointer node) noexcept {
+        auto parent_node = parentOf(node);
+        auto left_node = node->left_child;
+
+        replaceChild(parent_node, node, left_node);
+        setParent(left_node, parent_node);
+
+        node->left_child = left_node->right_child;
+        if (node->left_child != nullptr) {
+            setParent(node->left_child, node);
+        }
+
+        left_node->right_child = node;
+        setParent(node, left_node);
+
+        updateSize(node);
+        updateSize(left_node);
+    }
+
+    /**
+     * @brief Fix a new red node with a red parent. A red uncle is recolored and the violation moves up two levels,
+     *        otherwise one or two rotations end it. The head node is black, so the loop stops at the root
+     */
+    void rebalanceAfterInsert(node_pointer node) noexcept {
+        while (isRed(parentOf(node))) {
+            auto parent_node = parentOf(node);
+            auto grand_parent = parentOf(parent_node);
+            if (parent_node == grand_parent->left_child) {
+                auto uncle = grand_parent->right_child;
+                if (isRed(uncle)) {
+                    setBlack(parent_node);
+                    setBlack(uncle);
+                    setRed(grand_parent);
+                    node = grand_parent;
+                    continue;
+                }
+
+                if (node == parent_node->right_child) {
+                    rotateLeft(parent_node);
+                    parent_node = node;
+                }
+                setBlack(parent_node);
+                setRed(grand_parent);
+                rotateRight(grand_parent);
+                break;
+            } else {
+                auto uncle = grand_parent->left_child;
+                if (isRed(uncle)) {
+                    setBlack(parent_node);
+                    setBlack(uncle);
+                    setRed(grand_parent);
+                    node = grand_parent;
+                    continue;
+                }
+
+                if (node == parent_node->left_child) {
+                    rotateRight(parent_node);
+                    parent_node = node;
+                }
+                setBlack(parent_node);
+                setRed(grand_parent);
+                rotateLeft(grand_parent);
+                break;
+            }
+        }
+
+        setBlack(rootNode());
+    }
+
+    void eraseNode(node_pointer node) noexcept {
+        auto parent_node = parentOf(node);
+
+        // the min node has no left child, so its successor is either in the right subtree or the parent node,
+        // which is the head node when the tree becomes empty. The same goes for the max node the other way round
+        if (node == head_node_->left_child) {
+            head_node_->left_child =
+                node->right_child != nullptr ? tree_operations::minNode(node->right_child) : parent_node;
+        }
+
+        if (node == head_node_->right_child) {
+            head_node_->right_child =
+                node->left_child != nullptr ? tree_operations::maxNode(node->left_child) : parent_node;
+        }
+
+        // the child moving up into the place of the unlinked node may be nullptr, so its parent is kept aside
+        node_pointer child;
+        node_pointer child_parent;
+        bool unlinked_red;
+        if (node->left_child == nullptr || node->right_child == nullptr) {
+            adjustSizes(parent_node, false);
+            child = node->left_child != nullptr ? node->left_child : node->right_child;
+            child_parent = parent_node;
+            unlinked_red = isRed(node);
+            if (child != nullptr) {
+                setParent(child, parent_node);
+            }
+            replaceChild(parent_node, node, child);
+        } else {
+            // the successor has no left child, it is unlinked from its place and takes the place and color of node
+            auto replace_node = tree_operations::minNode(node->right_child);
+            adjustSizes(parentOf(replace_node), false);
+            child = replace_node->right_child;
+            unlinked_red = isRed(replace_node);
+            if (replace_node == node->right_child) {
+                child_parent = replace_node;
+            } else {
+                child_parent = parentOf(replace_node);
+                child_parent->left_child = child;
+                if (child != nullptr) {
+                    setParent(child, child_parent);
+                }
+
+                replace_node->right_child = node->right_child;
+                setParent(replace_node->right_child, replace_node);
+            }
+
+            replace_node->left_child = node->left_child;
+            setParent(replace_node->left_child, replace_node);
+            replace_node->parent_link = node->parent_link;
+            if constexpr (OrderStatistics) {
+                replace_node->subtree_size = node->subtree_size;
+            }
+            replaceChild(parent_node, node, replace_node);
+        }
+
+        --size_;
+
+        // unlinking a red node keeps the black heights
+        if (!unlinked_red) {
+            rebalanceAfterErase(child, child_parent);
+        }
+
+        destroyNode(node);
+    }
+
+    /**
+     * @brief The paths through node miss one black node. A red node takes the missing color, otherwise the sibling
+     *        is recolored or rotated up to give one of its black nodes, moving the deficit up only when the sibling
+     *        and its children are all black
+     */
+    void rebalanceAfterErase(node_pointer node, node_pointer parent_node) noexcept {
+        while (node != rootNode() && !isRed(node)) {
+            if (node == parent_node->left_child) {
+                auto sibling = parent_node->right_child;
+                if (isRed(sibling)) {
+                    setBlack(sibling);
+                    setRed(parent_node);
+                    rotateLeft(parent_node);
+                    sibling = parent_node->right_child;
+                }
+
+                if (!isRed(sibling->left_child) && !isRed(sibling->right_child)) {
+                    setRed(sibling);
+                    node = parent_node;
+                    parent_node = parentOf(parent_node);
+                    continue;
+                }
+
+                if (!isRed(sibling->right_child)) {
+                    setBlack(sibling->left_child);
+                    setRed(sibling);
+                    rotateRight(sibling);
+                    sibling = parent_node->right_child;
+                }
+
+                sibling->parent_link = (sibling->parent_link & ~kRedBit) | (parent_node->parent_link & kRedBit);
+                setBlack(parent_node);
+                setBlack(sibling->right_child);
+                rotateLeft(parent_node);
+                node = rootNode();
+            } else {
+                auto sibling = parent_node->left_child;
+                if (isRed(sibling)) {
+                    setBlack(sibling);
+                    setRed(parent_node);
+                    rotateRight(parent_node);
+                    sibling = parent_node->left_child;
+                }
+
+                if (!isRed(sibling->right_child) && !isRed(sibling->left_child)) {
+                    setRed(sibling);
+                    node = parent_node;
+                    parent_node = parentOf(parent_node);
+                    continue;
+                }
+
+                if (!isRed(sibling->left_child)) {
+                    setBlack(sibling->right_child);
+                    setRed(sibling);
+                    rotateLeft(sibling);
+                    sibling = parent_node->left_child;
+                }
+
+                sibling->parent_link = (sibling->parent_link & ~kRedBit) | (parent_node->parent_link & kRedBit);
+                setBlack(parent_node);
+                setBlack(sibling->left_child);
+                rotateRight(parent_node);
+                node = rootNode();
+            }
+        }
+
+        if (node != nullptr) {
+            setBlack(node);
+        }
+    }
+
+    node_pointer head_node_;
+    size_type size_;
+    compare_type compare_;
+    node_allocator_type alloc_;
+    node_pool_type pool_;
+
+    friend iterator;
+    friend const_iterator;
+    friend tree_operations;
+};
+
+}  // namespace nxt::core
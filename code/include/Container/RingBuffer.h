@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <iterator>
 
 #include "../Maths.h"
+#include "../Memory/Relocate.h"
 
 namespace nxt::core {
 
@@ -29,7 +31,7 @@ public:
         , alloc_() {}
 
     RingBuffer(size_type capacity)
-        : data()
+        : data_()
         , front_(0)
         , back_(0)
         , capacity_(0)
@@ -111,22 +113,34 @@ public:
                 new_capacity = getNextPowerOf2(new_capacity);
             }
 
+            // the capacity at least doubles, so the values keep their index from front_ without wrapping
             auto new_buffer = allocator_traits::allocate(alloc_, new_capacity);
-            auto index = front_;
-            for (size_type start = front_; start != back_; start = getNext(start)) {
-                if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
-                    allocator_traits::construct(alloc_, new_buffer + index, std::move(data_[start]));
-                } else {
-                    allocator_traits::construct(alloc_, new_buffer + start, data_[start]);
+            auto count = size();
+            if constexpr (kRelocatable) {
+                auto first_count = std::min(count, capacity_ - front_);
+                relocate(data_ + front_, first_count, new_buffer + front_);
+                relocate(data_, count - first_count, new_buffer + front_ + first_count);
+            } else {
+                auto index = front_;
+                for (size_type start = front_; start != back_; start = getNext(start)) {
+                    if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
+                        allocator_traits::construct(alloc_, new_buffer + index, std::move(data_[start]));
+                    } else {
+                        allocator_traits::construct(alloc_, new_buffer + index, data_[start]);
+                    }
+                    index = mask(index + 1, new_capacity);
+                }
+
+                for (size_type i = front_; i != back_; i = getNext(i)) {
+                    allocator_traits::destroy(alloc_, data_ + i);
                 }
-                index = mask(index + 1, new_capacity);
             }
 
-            for (size_type i = front_; i != back_; i = getNext(i)) {
-                allocator_traits::destroy(alloc_, data_ + i);
+            if (capacity_ > 0) {
+                allocator_traits::deallocate(alloc_, data_, capacity_);
             }
 
-            back_ = index;
+            back_ = mask(front_ + count, new_capacity);
             data_ = new_buffer;
             capacity_ = new_capacity;
         }
@@ -184,6 +198,9 @@ public:
     }
 
 private:
+    //! Values are moved to a grown buffer with memcpy instead of being moved and destroyed one by one
+    static constexpr bool kRelocatable = CanRelocateV<allocator_type>;
+
     [[nodiscard]] size_type mask(size_type value) const noexcept {
         // since the capacity in our case is always power of 2, 
         // we can express the expression (value % capacity_) as
@@ -1,11 +1,105 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
 
+#include "../Maths.h"
 #include "../TypeTraits.h"
+#include "Vector.h"
 
 namespace nxt::core {
 
+/**
+ * @brief Operation keeping the smallest of two values, to build a SegmentTree answering range minimum queries
+ */
+struct Minimum {
+    template<typename T>
+    constexpr T operator()(const T& lhs, const T& rhs) const {
+        return rhs < lhs ? rhs : lhs;
+    }
+};
+
+/**
+ * @brief Operation keeping the largest of two values, to build a SegmentTree answering range maximum queries
+ */
+struct Maximum {
+    template<typename T>
+    constexpr T operator()(const T& lhs, const T& rhs) const {
+        return lhs < rhs ? rhs : lhs;
+    }
+};
+
+/**
+ * @brief Describes how a range update changes the combined value of count values, for the lazy range updates of
+ *        SegmentTree. add() gives the combined value once delta is added to each value and assign() the combined
+ *        value of count copies of the value. Specialize it to use range updates with other operations
+ */
+template<typename Op>
+struct SegmentUpdateTraits {};
+
+template<typename U>
+struct SegmentUpdateTraits<std::plus<U>> {
+    template<typename T, typename SizeType>
+    static auto add(const T& combined, const T& delta, SizeType count)
+        -> decltype(combined + delta * static_cast<T>(count)) {
+        return combined + delta * static_cast<T>(count);
+    }
+
+    template<typename T, typename SizeType>
+    static auto assign(const T& value, SizeType count) -> decltype(value * static_cast<T>(count)) {
+        return value * static_cast<T>(count);
+    }
+};
+
+template<typename Op, typename T, typename SizeType, typename = void>
+struct HasSegmentUpdates : std::false_type {};
+
+template<typename Op, typename T, typename SizeType>
+struct HasSegmentUpdates<Op,
+                         T,
+                         SizeType,
+                         std::void_t<decltype(SegmentUpdateTraits<Op>::add(
+                                         std::declval<const T&>(), std::declval<const T&>(), SizeType())),
+                                     decltype(SegmentUpdateTraits<Op>::assign(std::declval<const T&>(), SizeType()))>>
+    : std::true_type {};
+
+template<>
+struct SegmentUpdateTraits<Minimum> {
+    template<typename T, typename SizeType>
+    static T add(const T& combined, const T& delta, SizeType) {
+        return combined + delta;
+    }
+
+    template<typename T, typename SizeType>
+    static T assign(const T& value, SizeType) {
+        return value;
+    }
+};
+
+template<>
+struct SegmentUpdateTraits<Maximum> : SegmentUpdateTraits<Minimum> {};
+
+/**
+ * @brief Segment tree combining the values with an associative operation, to query the combined value of any range
+ *        in O(log N). The tree is stored bottom-up in an array: the leaves holding the values start at the power of
+ *        two capacity and node i has the children 2i and 2i + 1, so updates and queries are loops over the indices
+ *        without recursion. The operation doesn't need an identity value, nodes over the unused leaves are skipped.
+ *
+ *        Range updates keep a pending update in the nodes they cover and push it down to the children only when a
+ *        later operation goes through the node, so they are O(log N) too. They need SegmentUpdateTraits<Op>, which is
+ *        provided for std::plus, Minimum and Maximum. The storage for the pending updates is only allocated by the
+ *        first range update
+ *
+ * @tparam T Type of the values
+ * @tparam Op Associative operation combining two values, it doesn't have to be commutative
+ */
 template<typename T, typename Op, typename Allocator = std::allocator<T>>
 class SegmentTree {
 public:
@@ -20,150 +114,464 @@ public:
     using difference_type = typename allocator_traits::difference_type;
 
     SegmentTree(std::initializer_list<value_type> values)
-        : input_size_(0)
-        , data_() {
-        buildTree(values.begin(), values.end());
-    }
+        : SegmentTree(values.begin(), values.end()) {}
 
     template<typename RandomAccessIter, typename = std::enable_if_t<IsRandomAccessIteratorV<RandomAccessIter>>>
     SegmentTree(RandomAccessIter first, RandomAccessIter last)
-        : input_size_(0)
-        , data_(0)
-        , alloc_() {
+        : size_(0)
+        , capacity_(0)
+        , height_(0)
+        , data_()
+        , pending_()
+        , op_() {
         buildTree(first, last);
     }
 
-    SegmentTree(const SegmentTree& rhs)
-        : data_()
-        , input_size_(0)
-        , alloc(allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
-        if (rhs.input_size_ > 0) {
-            auto size = rhs.size();
-            auto buffer = allocator_traits::allocate(alloc_, size);
+    SegmentTree(const SegmentTree& rhs) = default;
 
-            for (size_type i = 0; i < size; ++size) {
-                allocator_traits::construct(alloc_, buffer + i, rhs.data_[i]);
-            }
+    SegmentTree(SegmentTree&& rhs) noexcept
+        : size_(rhs.size_)
+        , capacity_(rhs.capacity_)
+        , height_(rhs.height_)
+        , data_(std::move(rhs.data_))
+        , pending_(std::move(rhs.pending_))
+        , op_(std::move(rhs.op_)) {
+        rhs.size_ = 0;
+        rhs.capacity_ = 0;
+        rhs.height_ = 0;
+    }
 
-            input_size_ = rhs.input_size_;
-            data_ = buffer;
-        }
+    /**
+     * @brief Number of values in the tree
+     */
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
     }
 
-    SegmentTree(SegmentTree&& rhs) noexcept
-        : data_()
-        , input_size_(0)
-        , alloc_(std::move(rhs.alloc_)) {
-        data_ = rhs.data_;
-        input_size_ = rhs.input_size_;
+    /**
+     * @brief Number of values the tree holds before the next push back has to grow it
+     */
+    [[nodiscard]] size_type capacity() const noexcept {
+        return capacity_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /**
+     * @brief Combined value of all the values, the tree must not be empty
+     */
+    [[nodiscard]] const_reference result() const noexcept {
+        return data_[1];
+    }
 
-        rhs.data_ = nullptr;
-        rhs.input_size_ = 0;
+    /**
+     * @brief Replace the value at the index. Does nothing if the index is out of range
+     */
+    void update(size_type index, const value_type& new_value) {
+        if (index < size_) {
+            auto leaf = index + capacity_;
+            pushPath(leaf);
+            data_[leaf] = new_value;
+            pullPath(leaf);
+        }
     }
 
-    size_type inputSize() const noexcept {
-        return input_size_;
+    /**
+     * @brief Combined value of the values in [low, high], with low <= high < size(). The tree isn't modified, the
+     *        pending updates above the nodes covering the range are folded into their values instead of being pushed
+     *        down, so concurrent queries are safe
+     */
+    [[nodiscard]] value_type query(size_type low, size_type high) const {
+        auto first = low + capacity_;
+        auto last = high + capacity_ + 1;
+        if (!pending_.empty()) {
+            return queryPending(first, last);
+        }
+
+        // the nodes covering the range, combined in order: the left ones from the front and the right ones from the
+        // back. There is at least one node as the range isn't empty
+        std::optional<value_type> left_result;
+        std::optional<value_type> right_result;
+        for (; first < last; first >>= 1, last >>= 1) {
+            if (isOdd(first)) {
+                left_result = left_result ? op_(*left_result, data_[first]) : data_[first];
+                ++first;
+            }
+            if (isOdd(last)) {
+                --last;
+                right_result = right_result ? op_(data_[last], *right_result) : data_[last];
+            }
+        }
+        return combineResults(std::move(left_result), std::move(right_result));
     }
 
-    size_type size() const noexcept {
-        return input_size_ > 0 ? 2 * input_size_ - 1 : 0;
+    /**
+     * @brief Add delta to each value in [low, high], with low <= high < size()
+     */
+    void addRange(size_type low, size_type high, const value_type& delta) {
+        updateRange(low, high, UpdateKind::kAdd, delta);
     }
 
-    const_reference result() const noexcept {
-        return data_[0];
+    /**
+     * @brief Set each value in [low, high] to the value, with low <= high < size()
+     */
+    void assignRange(size_type low, size_type high, const value_type& value) {
+        updateRange(low, high, UpdateKind::kAssign, value);
     }
 
-    void update(size_type index, const value_type& new_value) {
-        if (index < input_size_) {
-            updateValue(0, 0, input_size_ - 1, index, new_value);
+    /**
+     * @brief Append a value in O(log N), doubling the capacity when the tree is full
+     */
+    void pushBack(const value_type& value) {
+        if (size_ == capacity_) {
+            reallocate(capacity_ > 0 ? 2 * capacity_ : 1, value);
         }
+
+        // pending updates of the path are pushed down before the new leaf becomes part of their ranges
+        auto leaf = size_ + capacity_;
+        pushPath(leaf);
+        data_[leaf] = value;
+        ++size_;
+        pullPath(leaf);
     }
 
-    value_type query(size_type low, size_type high) const {
-        return queryValue(0, 0, input_size_ - 1, low, high);
+    /**
+     * @brief Insert the value before the index in O(N), as the following values move to the next leaves
+     */
+    void insert(size_type index, const value_type& value) {
+        if (index >= size_) {
+            pushBack(value);
+            return;
+        }
+
+        if (size_ == capacity_) {
+            reallocate(2 * capacity_, value);
+        } else {
+            flushPending();
+        }
+
+        auto leaves = data_.begin() + capacity_;
+        std::move_backward(leaves + index, leaves + size_, leaves + size_ + 1);
+        leaves[index] = value;
+        ++size_;
+        rebuildNodes();
     }
 
-    ~SegmentTree() {
-        if (input_size_ > 0) {
-            auto size = this->size();
-            for (size_type i = 0; i < size; ++i) {
-                allocator_traits::destroy(alloc_, data_ + i);
-            }
+    /**
+     * @brief Resize the tree to count values in O(N), the new values are copies of value
+     */
+    void resize(size_type count, const value_type& value) {
+        if (count > capacity_) {
+            reallocate(isPowerOf2(count) ? count : getNextPowerOf2(count), value);
+        } else {
+            flushPending();
+        }
 
-            allocator_traits::deallocate(alloc_, data_, size);
+        if (count == 0) {
+            size_ = 0;
+            return;
         }
+
+        auto leaves = data_.begin() + capacity_;
+        std::fill(leaves + std::min(size_, count), leaves + count, value);
+        size_ = count;
+        rebuildNodes();
+    }
+
+    void resize(size_type count) {
+        resize(count, value_type());
     }
 
 private:
+    static constexpr size_type kMaxHeight = 64;
+
+    enum class UpdateKind : uint8_t { kNone, kAdd, kAssign };
+
+    //! range update waiting to be pushed down to the children of a node, its own value already includes it
+    struct PendingUpdate {
+        UpdateKind kind;
+        value_type value;
+    };
+
+    using update_traits = SegmentUpdateTraits<Op>;
+    static constexpr bool kRangeUpdates = HasSegmentUpdates<Op, value_type, size_type>::value;
+    using pending_allocator_type = typename allocator_traits::template rebind_alloc<PendingUpdate>;
+    using pending_vector_type = Vector<PendingUpdate, pending_allocator_type>;
+
     template<typename RandomAccessIter>
     void buildTree(RandomAccessIter first, RandomAccessIter last) {
-        size_type input_size = std::distance(first, last);
-        size_type size = 2 * input_size - 1;
-        auto buffer = allocator_traits::allocate(alloc_, size);
-        buildInterval(0, 0, input_size - 1, buffer, first);
+        auto count = static_cast<size_type>(std::distance(first, last));
+        if (count == 0) {
+            return;
+        }
 
-        input_size_ = input_size;
-        data_ = buffer;
+        // every slot is constructed, the ones above no value hold a copy which is never read
+        setCapacity(isPowerOf2(count) ? count : getNextPowerOf2(count));
+        data_ = Vector<value_type, allocator_type>(2 * capacity_, *first);
+        std::copy(first, last, data_.begin() + capacity_);
+        size_ = count;
+        rebuildNodes();
     }
 
-    template<typename RandomAccessIter>
-    void buildInterval(size_type tree_index, size_type low, size_type high, pointer buffer, RandomAccessIter value) {
-        if (low == high) {
-            allocator_traits::construct(alloc_, buffer + tree_index, value[low]);
-        } else {
-            size_type mid = (low + high) / 2;
-            buildInterval(2 * tree_index + 1, low, mid, buffer, value);
-            buildInterval(2 * tree_index + 2, mid + 1, high, buffer, value);
+    void setCapacity(size_type capacity) noexcept {
+        capacity_ = capacity;
+        height_ = 0;
+        while ((size_type(1) << height_) < capacity_) {
+            ++height_;
+        }
+    }
 
-            allocator_traits::construct(
-                alloc_, buffer + tree_index, op_(buffer[2 * tree_index + 1], buffer[2 * tree_index + 2]));
+    /**
+     * @brief Move the values to a tree with the new capacity and rebuild the nodes above them in O(N)
+     */
+    void reallocate(size_type new_capacity, const value_type& fill) {
+        flushPending();
+
+        Vector<value_type, allocator_type> data(2 * new_capacity, fill);
+        std::move(data_.begin() + capacity_, data_.begin() + capacity_ + size_, data.begin() + new_capacity);
+        data_ = std::move(data);
+        if (!pending_.empty()) {
+            pending_ = pending_vector_type(new_capacity, PendingUpdate{UpdateKind::kNone, fill});
         }
+        setCapacity(new_capacity);
+        rebuildNodes();
     }
 
-    void updateValue(size_type tree_index, size_type low, size_type high, size_type index, const value_type& value) {
-        if (low == high) {
-            data_[tree_index] = value;
-        } else {
-            size_type mid = (low + high) / 2;
-            if (index <= mid) {
-                updateValue(2 * tree_index + 1, low, mid, index, value);
-            } else {
-                updateValue(2 * tree_index + 2, mid + 1, high, index, value);
+    void rebuildNodes() {
+        for (size_type height = 1; height <= height_; ++height) {
+            for (auto node = capacity_ >> height; node < (capacity_ >> (height - 1)); ++node) {
+                pullNode(node, height);
             }
-            data_[tree_index] = op_(data_[2 * tree_index + 1], data_[2 * tree_index + 2]);
         }
     }
 
-    value_type queryValue(size_type tree_index,
-                          size_type low,
-                          size_type high,
-                          size_type range_low,
-                          size_type range_high) const {
-        if (low == range_low && high == range_high) {
-            // if query range is equal to interval, return the value
-            return data_[tree_index];
+    /**
+     * @brief Number of values under the node, which is less than the width of the node at the end of the values
+     */
+    size_type valueCount(size_type node, size_type height) const noexcept {
+        auto first_leaf = (node << height) - capacity_;
+        if (first_leaf >= size_) {
+            return 0;
+        }
+        return std::min(size_type(1) << height, size_ - first_leaf);
+    }
+
+    /**
+     * @brief Recompute the value of the node from its children. A right child without values is skipped, which
+     *        makes an identity value unnecessary
+     */
+    void pullNode(size_type node, size_type height) {
+        if (valueCount(2 * node + 1, height - 1) > 0) {
+            data_[node] = op_(data_[2 * node], data_[2 * node + 1]);
         } else {
-            auto mid = (low + high) / 2;
-            if (range_low >= low && range_high <= mid) {
-                // if range lies in the left interval, query left child
-                return queryValue(2 * tree_index + 1, low, mid, range_low, range_high);
-            } else if (range_low >= mid + 1 && range_high <= range_high) {
-                // if range lies in right interval, query right child
-                return queryValue(2 * tree_index + 2, mid + 1, high, range_low, range_high);
+            data_[node] = data_[2 * node];
+        }
+    }
+
+    void applyUpdate(size_type node, size_type height, UpdateKind kind, const value_type& value) {
+        auto count = valueCount(node, height);
+        if (count == 0) {
+            return;
+        }
+
+        // without update traits there is never anything pending
+        if constexpr (kRangeUpdates) {
+            if (kind == UpdateKind::kAdd) {
+                data_[node] = update_traits::add(data_[node], value, count);
+            } else {
+                data_[node] = update_traits::assign(value, count);
+            }
+        }
+
+        if (node < capacity_) {
+            // an assignment replaces anything pending, an addition adds to the pending value
+            auto& pending = pending_[node];
+            if (kind == UpdateKind::kAssign || pending.kind == UpdateKind::kNone) {
+                pending.kind = kind;
+                pending.value = value;
             } else {
-                // else the range lies over both sub-childs, so query both child and apply the operation
-                // note that the range values are modified in case to [range_low, mid] for left child
-                // and [mid + 1,range_high] for right child
-                auto value_low = queryValue(2 * tree_index + 1, low, mid, range_low, mid);
-                auto value_high = queryValue(2 * tree_index + 2, mid + 1, high, mid + 1, range_high);
-                return op_(value_low, value_high);
+                pending.value = pending.value + value;
+            }
+        }
+    }
+
+    void pushNode(size_type node, size_type height) {
+        auto& pending = pending_[node];
+        if (pending.kind != UpdateKind::kNone) {
+            applyUpdate(2 * node, height - 1, pending.kind, pending.value);
+            applyUpdate(2 * node + 1, height - 1, pending.kind, pending.value);
+            pending.kind = UpdateKind::kNone;
+        }
+    }
+
+    //! push the pending updates from the root down to the parent of the leaf
+    void pushPath(size_type leaf) {
+        if (!pending_.empty()) {
+            for (auto height = height_; height > 0; --height) {
+                pushNode(leaf >> height, height);
+            }
+        }
+    }
+
+    void pullPath(size_type leaf) {
+        for (size_type height = 1; height <= height_; ++height) {
+            pullNode(leaf >> height, height);
+        }
+    }
+
+    /**
+     * @brief Push the pending updates of the nodes above the ends of the leaf range [first, last), which are the only
+     *        nodes partially covered by the range
+     */
+    void pushBoundaries(size_type first, size_type last) {
+        if (!pending_.empty()) {
+            for (auto height = height_; height > 0; --height) {
+                if (((first >> height) << height) != first) {
+                    pushNode(first >> height, height);
+                }
+                if (((last >> height) << height) != last) {
+                    pushNode((last - 1) >> height, height);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief query() of the leaves [first, last) with pending updates. Going up, the range at height h is the nodes
+     *        [ceil(first / 2^h), floor(last / 2^h)) and an odd bound is a node covering the range. The nodes are
+     *        visited from the top so that the pending updates of their ancestors, which lie on the paths from the
+     *        root to the leaves first and last - 1, are folded on the way down
+     */
+    [[nodiscard]] value_type queryPending(size_type first, size_type last) const {
+        size_type top_height = 0;
+        while (leftBound(first, top_height) < (last >> top_height)) {
+            ++top_height;
+        }
+
+        std::optional<PendingUpdate> left_update;
+        std::optional<PendingUpdate> right_update;
+        std::optional<value_type> left_result;
+        std::optional<value_type> right_result;
+        for (size_type depth = 0; depth <= height_; ++depth) {
+            auto height = height_ - depth;
+            if (depth > 0) {
+                foldPending(left_update, pending_[first >> (height + 1)]);
+                foldPending(right_update, pending_[(last - 1) >> (height + 1)]);
+            }
+
+            // left nodes come from the front of the range and right nodes from the back as the height decreases
+            if (height < top_height) {
+                auto node = leftBound(first, height);
+                if (isOdd(node)) {
+                    auto value = pendingValue(node, height, left_update);
+                    left_result = left_result ? op_(value, *left_result) : std::move(value);
+                }
+
+                node = last >> height;
+                if (isOdd(node)) {
+                    auto value = pendingValue(node - 1, height, right_update);
+                    right_result = right_result ? op_(*right_result, value) : std::move(value);
+                }
+            }
+        }
+        return combineResults(std::move(left_result), std::move(right_result));
+    }
+
+    //! combined value of the nodes collected on both sides of a query, at least one side is set
+    value_type combineResults(std::optional<value_type>&& left_result, std::optional<value_type>&& right_result) const {
+        if (left_result && right_result) {
+            return op_(*left_result, *right_result);
+        }
+        return left_result ? std::move(*left_result) : std::move(*right_result);
+    }
+
+    //! first node of the range at the height, the leaves [first, ...) rounded up to whole nodes
+    [[nodiscard]] static size_type leftBound(size_type first, size_type height) noexcept {
+        return (first + (size_type(1) << height) - 1) >> height;
+    }
+
+    /**
+     * @brief Fold the pending update of an ancestor into the update collected from the ancestors above it, which
+     *        are newer. Combines them like applyUpdate() does when the update of the ancestor is pushed down
+     */
+    static void foldPending(std::optional<PendingUpdate>& newer, const PendingUpdate& older) {
+        if (older.kind == UpdateKind::kNone) {
+            return;
+        }
+
+        if (!newer) {
+            newer = older;
+        } else if (newer->kind == UpdateKind::kAdd) {
+            // an assignment under an addition is an assignment of the sum
+            newer->kind = older.kind;
+            newer->value = older.value + newer->value;
+        }
+    }
+
+    //! value of the node once the pending updates of its ancestors are applied
+    [[nodiscard]] value_type pendingValue(size_type node,
+                                          size_type height,
+                                          const std::optional<PendingUpdate>& update) const {
+        if constexpr (kRangeUpdates) {
+            if (update) {
+                auto count = valueCount(node, height);
+                if (update->kind == UpdateKind::kAdd) {
+                    return update_traits::add(data_[node], update->value, count);
+                }
+                return update_traits::assign(update->value, count);
+            }
+        }
+        return data_[node];
+    }
+
+    void flushPending() {
+        if (!pending_.empty()) {
+            for (auto height = height_; height > 0; --height) {
+                for (auto node = capacity_ >> height; node < (capacity_ >> (height - 1)); ++node) {
+                    pushNode(node, height);
+                }
+            }
+        }
+    }
+
+    void updateRange(size_type low, size_type high, UpdateKind kind, const value_type& value) {
+        static_assert(kRangeUpdates, "range updates need a SegmentUpdateTraits specialization for the operation");
+        if (pending_.empty()) {
+            pending_ = pending_vector_type(capacity_, PendingUpdate{UpdateKind::kNone, value});
+        }
+
+        auto first = low + capacity_;
+        auto last = high + capacity_ + 1;
+        pushBoundaries(first, last);
+
+        size_type height = 0;
+        for (auto node_first = first, node_last = last; node_first < node_last;
+             node_first >>= 1, node_last >>= 1, ++height) {
+            if (isOdd(node_first)) {
+                applyUpdate(node_first++, height, kind, value);
+            }
+            if (isOdd(node_last)) {
+                applyUpdate(--node_last, height, kind, value);
+            }
+        }
+
+        for (size_type node_height = 1; node_height <= height_; ++node_height) {
+            if (((first >> node_height) << node_height) != first) {
+                pullNode(first >> node_height, node_height);
+            }
+            if (((last >> node_height) << node_height) != last) {
+                pullNode((last - 1) >> node_height, node_height);
             }
         }
     }
 
-    size_type input_size_;
-    pointer data_;
+    size_type size_;
+    size_type capacity_;
+    size_type height_;
+    Vector<value_type, allocator_type> data_;
+    pending_vector_type pending_;
     Op op_;
-    allocator_type alloc_;
 };
 }  // namespace nxt::core
@@ -1,6 +1,12 @@
 #pragma once
 
-#include "Vector.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "../Maths.h"
 
 namespace nxt::core {
 
@@ -12,29 +18,30 @@ public:
     using pointer = typename SkipList::const_pointer;
     using node_type = typename SkipList::node_type;
     using node_pointer = typename SkipList::node_pointer;
+    using difference_type = typename SkipList::difference_type;
     using iterator_category = std::forward_iterator_tag;
 
-    SkipListConstIterator(SkipList* list, node_pointer node)
+    SkipListConstIterator(const SkipList* list, node_pointer node)
         : list_(list)
         , node_(node) {}
 
     SkipListConstIterator& operator++() noexcept {
-        node_ = node_->links[0];
+        node_ = node_->links()[0];
         return *this;
     }
 
-    [[nodiscard]] SkipListConstIterator operator++(int) {
-        SkipListConstIterator result(list, node);
-        node_ = node->links[0];
+    SkipListConstIterator operator++(int) {
+        SkipListConstIterator result(list_, node_);
+        node_ = node_->links()[0];
         return result;
     }
 
     [[nodiscard]] reference operator*() const noexcept {
-        return node->value;
+        return node_->value;
     }
 
     [[nodiscard]] pointer operator->() const noexcept {
-        return std::pointer_traits<pointer>::pointer_to(node->value);
+        return std::pointer_traits<pointer>::pointer_to(node_->value);
     }
 
     [[nodiscard]] bool operator==(const SkipListConstIterator& rhs) const noexcept {
@@ -46,7 +53,7 @@ public:
     }
 
 protected:
-    SkipList* list_;
+    const SkipList* list_;
     node_pointer node_;
 };
 
@@ -58,6 +65,7 @@ public:
     using pointer = typename SkipList::pointer;
     using node_type = typename SkipList::node_type;
     using node_pointer = typename SkipList::node_pointer;
+    using difference_type = typename SkipList::difference_type;
     using iterator_category = std::forward_iterator_tag;
     using base_class = SkipListConstIterator<SkipList>;
 
@@ -65,13 +73,13 @@ public:
         : base_class(list, node) {}
 
     SkipListIterator& operator++() noexcept {
-        node_ = node_->links[0];
+        node_ = node_->links()[0];
         return *this;
     }
 
-    [[nodiscard]] SkipListIterator operator++(int) noexcept {
-        SkipListIterator result(list, node);
-        node_ = node->links[0];
+    SkipListIterator operator++(int) noexcept {
+        SkipListIterator result(*this);
+        node_ = node_->links()[0];
         return result;
     }
 
@@ -88,13 +96,36 @@ protected:
     using base_class::node_;
 };
 
+/**
+ * @brief Level generator for the skip list nodes. The level is 1 + the number of trailing zeros of a xorshift64 draw,
+ *        which is a geometric distribution with p = 1/2, so one draw and one instruction per node
+ */
 class RandomGenerator {
 public:
-    std::size_t operator()(std::size_t max_value) const noexcept {
-        return max_value;
+    explicit RandomGenerator(uint64_t seed = 0x9E3779B97F4A7C15ull) noexcept
+        : state_(seed != 0 ? seed : 1) {}
+
+    /**
+     * @brief Draw a level in [1, max_value], max_value must be in [1, 64]
+     */
+    std::size_t operator()(std::size_t max_value) noexcept {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 7;
+        state_ ^= state_ << 17;
+
+        // the bit at max_value - 1 caps the number of trailing zeros
+        auto bits = state_ | (uint64_t(1) << (max_value - 1));
+        return 1 + countTrailingZeros(bits);
     }
+
+private:
+    uint64_t state_;
 };
 
+/**
+ * @brief Ordered set or map (depending on the Traits) as a skip list. Every node is a single allocation holding the
+ *        value and its links inline, sized to the level of the node.
+ */
 template<typename Traits, typename Random = RandomGenerator>
 class SkipList {
 public:
@@ -114,50 +145,123 @@ public:
     using const_iterator = SkipListConstIterator<SkipList>;
     using traits = Traits;
 
+    //! Maximum number of levels, enough for 2^32 values
+    static constexpr size_type kMaxHeight = 32;
+
 private:
     struct SkipNode;
 
     using node_type = SkipNode;
-    using node_allocator_type = typename std::allocator_traits<allocator_type>::template rebind_alloc<node_type>;
-    using node_allocator_traits = std::allocator_traits<node_allocator_type>;
-    using node_pointer = typename node_allocator_traits::pointer;
-    using node_const_pointer = typename node_allocator_traits::const_pointer;
+    using node_pointer = node_type*;
+    using node_const_pointer = const node_type*;
 
     struct SkipNode {
-        Vector<node_pointer> links;
         value_type value;
+        size_type height;
+
+        //! Links are stored inline right after the node
+        [[nodiscard]] node_pointer* links() noexcept {
+            return reinterpret_cast<node_pointer*>(reinterpret_cast<unsigned char*>(this) + kLinksOffset);
+        }
+    };
+
+    //! First offset after the node aligned for the links
+    static constexpr size_type kLinksOffset =
+        (sizeof(node_type) + alignof(node_pointer) - 1) / alignof(node_pointer) * alignof(node_pointer);
+
+    //! Allocation unit of the nodes, suitably aligned for both the node and its links
+    struct alignas(node_type) alignas(node_pointer) NodeBlock {
+        unsigned char bytes[alignof(node_type) > alignof(node_pointer) ? alignof(node_type) : alignof(node_pointer)];
     };
 
+    using node_allocator_type = typename std::allocator_traits<allocator_type>::template rebind_alloc<NodeBlock>;
+    using node_allocator_traits = std::allocator_traits<node_allocator_type>;
+    using block_pointer = typename node_allocator_traits::pointer;
+
 public:
+    /**
+     * @brief Search position kept between lookups. A lookup through a finger starts from the nodes found by the
+     *        previous one instead of the head, so visiting keys in increasing order walks the list once and costs
+     *        O(log D) per lookup, D being the distance from the previous key. Any insert or erase invalidates it
+     */
+    class Finger {
+    public:
+        Finger() noexcept = default;
+
+    private:
+        friend SkipList;
+
+        explicit Finger(node_pointer head_node) noexcept {
+            std::fill(std::begin(path_), std::end(path_), head_node);
+        }
+
+        //! Last node before the previous key on each level
+        node_pointer path_[kMaxHeight] = {};
+    };
+
     SkipList()
         : size_(0)
+        , height_(0)
         , comp_()
         , random_()
         , alloc_() {
         createHeadNode();
     }
 
+    explicit SkipList(const allocator_type& alloc)
+        : size_(0)
+        , height_(0)
+        , comp_()
+        , random_()
+        , alloc_(alloc) {
+        createHeadNode();
+    }
+
     SkipList(SkipList&& rhs) noexcept
         : size_(0)
+        , height_(0)
         , comp_(rhs.comp_)
         , random_(rhs.random_)
         , alloc_(std::move(rhs.alloc_)) {
         createHeadNode();
         using std::swap;
         swap(head_node_, rhs.head_node_);
+        swap(height_, rhs.height_);
         size_ = rhs.size_;
         rhs.size_ = 0;
     }
 
     SkipList(const SkipList& rhs)
         : size_(0)
+        , height_(0)
         , comp_(rhs.comp_)
         , random_(rhs.random_)
         , alloc_(node_allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
         createHeadNode();
-        using std::swap;
-        for (const value& : rhs) {
-            insert(value);
+        assignSorted(rhs.begin(), rhs.end());
+    }
+
+    /**
+     * @brief Construct the list from a range. Input sorted by strictly increasing keys is linked in O(N) with
+     *        deterministic levels, anything else is inserted value by value
+     */
+    template<typename ForwardIt, typename = typename std::iterator_traits<ForwardIt>::iterator_category>
+    SkipList(ForwardIt first, ForwardIt last, const allocator_type& alloc = allocator_type())
+        : size_(0)
+        , height_(0)
+        , comp_()
+        , random_()
+        , alloc_(alloc) {
+        createHeadNode();
+        auto is_sorted = std::adjacent_find(first, last, [this](const auto& lhs, const auto& rhs) {
+                             return !comp_(traits::key(lhs), traits::key(rhs));
+                         }) == last;
+        if (is_sorted) {
+            assignSorted(first, last);
+        } else {
+            for (; first != last; ++first) {
+                insert(*first);
+            }
         }
     }
 
@@ -169,29 +273,23 @@ public:
         return size_ == 0;
     }
 
+    /**
+     * @brief Number of levels in use, the height of the tallest node
+     */
     [[nodiscard]] size_type height() const noexcept {
-        return head_node_.links.size();
+        return height_;
     }
 
     [[nodiscard]] const_iterator begin() const noexcept {
-        if (size_ > 0)
-            return const_iterator(this, head_node_->links[0]);
-        else
-            return const_iterator(this, nullptr);
+        return const_iterator(this, head_node_->links()[0]);
     }
 
     [[nodiscard]] iterator begin() noexcept {
-        if (size_ > 0)
-            return iterator(this, head_node_->links[0]);
-        else
-            return iterator(this, nullptr);
+        return iterator(this, head_node_->links()[0]);
     }
 
     [[nodiscard]] const_iterator cbegin() const noexcept {
-        if (size_ > 0)
-            return const_iterator(this, head_node_->links[0]);
-        else
-            return const_iterator(this, nullptr);
+        return const_iterator(this, head_node_->links()[0]);
     }
 
     [[nodiscard]] const_iterator end() const noexcept {
@@ -224,6 +322,60 @@ public:
         return const_iterator(this, findNode(value));
     }
 
+    /**
+     * @brief Finger placed at the front of the list, to be passed to the finger lookups
+     */
+    [[nodiscard]] Finger finger() const noexcept {
+        return Finger(head_node_);
+    }
+
+    /**
+     * @brief Find the key starting from the finger, which is moved to the key. Keys may be looked up in any order
+     *        but only increasing keys benefit from the finger, a smaller key restarts from the head
+     */
+    [[nodiscard]] iterator find(Finger& finger, const key_type& value) {
+        return iterator(this, findNode(finger, value));
+    }
+
+    [[nodiscard]] const_iterator find(Finger& finger, const key_type& value) const {
+        return const_iterator(this, findNode(finger, value));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator find(Finger& finger, const Key& value) {
+        return iterator(this, findNode(finger, value));
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator find(Finger& finger, const Key& value) const {
+        return const_iterator(this, findNode(finger, value));
+    }
+
+    /**
+     * @brief First value whose key is not less than the key, starting from the finger which is moved to the key
+     */
+    [[nodiscard]] iterator lowerBound(Finger& finger, const key_type& value) {
+        advanceFinger(finger.path_, value);
+        return iterator(this, finger.path_[0]->links()[0]);
+    }
+
+    [[nodiscard]] const_iterator lowerBound(Finger& finger, const key_type& value) const {
+        advanceFinger(finger.path_, value);
+        return const_iterator(this, finger.path_[0]->links()[0]);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] iterator lowerBound(Finger& finger, const Key& value) {
+        advanceFinger(finger.path_, value);
+        return iterator(this, finger.path_[0]->links()[0]);
+    }
+
+    template<typename Key, typename = typename compare_type::is_transparent>
+    [[nodiscard]] const_iterator lowerBound(Finger& finger, const Key& value) const {
+        advanceFinger(finger.path_, value);
+        return const_iterator(this, finger.path_[0]->links()[0]);
+    }
+
     std::pair<iterator, bool> insert(const value_type& value) {
         auto result = insertNode(value);
         return {iterator(this, result), result != nullptr};
@@ -242,129 +394,272 @@ public:
         return erase(traits::key(*position));
     }
 
-    void clear() noexcept {
-        if (size_ > 0) {
-            auto current_node = head_node_->links[0];
-            while (current_node != nullptr) {
-                auto next_node = current_node->links[0];
-                node_allocator_traits::destroy(alloc_, std::addressof(current_node->value));
-                node_allocator_traits::destroy(alloc_, std::addressof(current_node->links));
-                node_allocator_traits::deallocate(alloc_, current_node, 1);
+    /**
+     * @brief Replace the content of the list with [first, last), which must be sorted by strictly increasing keys.
+     *        The i-th node (counting from 1) gets 1 + ctz(i) levels, which is the shape of a perfectly balanced skip
+     *        list, and the nodes are linked in a single pass in O(N)
+     */
+    template<typename ForwardIt>
+    void assignSorted(ForwardIt first, ForwardIt last) {
+        clear();
+        node_pointer last_nodes[kMaxHeight];
+        std::fill(std::begin(last_nodes), std::end(last_nodes), head_node_);
+        try {
+            for (size_type index = 1; first != last; ++first, ++index) {
+                auto height = std::min<size_type>(1 + countTrailingZeros(index), kMaxHeight);
+                auto node = createNode(height, *first);
+                for (size_type i = 0; i < height; ++i) {
+                    last_nodes[i]->links()[i] = node;
+                    last_nodes[i] = node;
+                }
+                height_ = std::max(height_, height);
+                ++size_;
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
 
-                current_node = next_node;
-            } 
-            size_ = 0;
-            head_node_->links.clear();
+    /**
+     * @brief Insert the values of [first, last), sorted by increasing keys. Values whose key is already present are
+     *        skipped. The search for the insert position resumes from the previous one, so the whole batch is
+     *        inserted in a single forward pass over the list
+     *
+     * @return Number of values inserted
+     */
+    template<typename ForwardIt>
+    size_type mergeSorted(ForwardIt first, ForwardIt last) {
+        size_type inserted_count = 0;
+        auto position = finger();
+        auto& update_links = position.path_;
+        for (; first != last; ++first) {
+            const value_type& value = *first;
+            const auto& key = traits::key(value);
+            advanceFinger(update_links, key);
+
+            auto next_node = update_links[0]->links()[0];
+            if (next_node != nullptr && !comp_(key, traits::key(next_node->value))) {
+                continue;
+            }
+
+            // the new node is the last node before the following keys on all its levels
+            auto new_node = linkNode(update_links, value);
+            for (size_type i = 0; i < new_node->height; ++i) {
+                update_links[i] = new_node;
+            }
+            ++inserted_count;
+        }
+        return inserted_count;
+    }
+
+    void clear() noexcept {
+        auto current_node = head_node_->links()[0];
+        while (current_node != nullptr) {
+            auto next_node = current_node->links()[0];
+            destroyNode(current_node);
+            current_node = next_node;
         }
+
+        std::fill(head_node_->links(), head_node_->links() + kMaxHeight, nullptr);
+        size_ = 0;
+        height_ = 0;
     }
 
     ~SkipList() {
         clear();
-
-        node_allocator_traits::destroy(alloc_, std::addressof(head_node_->links));
-        node_allocator_traits::deallocate(alloc_, head_node_, 1);
+        deallocateNode(head_node_);
     }
 
 private:
+    /**
+     * @brief Number of allocation blocks of a node with height links
+     */
+    static constexpr size_type blockCount(size_type height) noexcept {
+        return (kLinksOffset + height * sizeof(node_pointer) + sizeof(NodeBlock) - 1) / sizeof(NodeBlock);
+    }
+
+    /**
+     * @brief Allocate a node with height links set to nullptr, its value is left unconstructed
+     */
+    node_pointer allocateNode(size_type height) {
+        auto block = node_allocator_traits::allocate(alloc_, blockCount(height));
+        auto node = reinterpret_cast<node_pointer>(std::addressof(*block));
+        node->height = height;
+        std::fill(node->links(), node->links() + height, nullptr);
+        return node;
+    }
+
+    void deallocateNode(node_pointer node) noexcept {
+        auto block = std::pointer_traits<block_pointer>::pointer_to(*reinterpret_cast<NodeBlock*>(node));
+        node_allocator_traits::deallocate(alloc_, block, blockCount(node->height));
+    }
+
+    void destroyNode(node_pointer node) noexcept {
+        node_allocator_traits::destroy(alloc_, std::addressof(node->value));
+        deallocateNode(node);
+    }
+
     void createHeadNode() {
-        head_node_ = node_allocator_traits::allocate(alloc_, 1);
-        node_allocator_traits::construct(alloc_, std::addressof(head_node_->links));
+        head_node_ = allocateNode(kMaxHeight);
+    }
+
+    /**
+     * @brief Allocate a node with height links set to nullptr and construct its value
+     */
+    template<typename... Args>
+    node_pointer createNode(size_type height, Args&&... args) {
+        auto node = allocateNode(height);
+        try {
+            node_allocator_traits::construct(alloc_, std::addressof(node->value), std::forward<Args>(args)...);
+        } catch (...) {
+            deallocateNode(node);
+            throw;
+        }
+        return node;
     }
 
-    template<typename Arg>
-    node_pointer insertNode(Arg&& value) {
-        Vector<node_pointer> update_links(head_node_->links.size(), nullptr);
+    /**
+     * @brief Fill update_links with the last node before the key on each level in use, searching from the head
+     *
+     * @return The node with the key or nullptr
+     */
+    template<typename Key>
+    node_pointer findPath(node_pointer* update_links, const Key& value) const {
+        node_pointer found_node = nullptr;
         auto current_node = head_node_;
-        for (difference_type i = head_node_->links.size() - 1; i >= 0; --i) {
-            while (current_node->links[i] != nullptr) {
-                if (comp_(traits::key(current_node->links[i]->value), traits::key(value))) {
-                    current_node = current_node->links[i];
-                } else if (comp_(traits::key(value), traits::key(current_node->links[i]->value))) {
-                    break;
-                } else {
-                    // found a duplicate
-                    return nullptr;
-                }
+        for (auto i = static_cast<difference_type>(height_) - 1; i >= 0; --i) {
+            auto next_node = current_node->links()[i];
+            while (next_node != nullptr && comp_(traits::key(next_node->value), value)) {
+                current_node = next_node;
+                next_node = current_node->links()[i];
+            }
+            if (next_node != nullptr && !comp_(value, traits::key(next_node->value))) {
+                found_node = next_node;
             }
             update_links[i] = current_node;
         }
+        return found_node;
+    }
+
+    /**
+     * @brief Move the path of a finger to the key. The search climbs from the bottom while the next node of the
+     *        level above is still before the key, then descends as usual, so it only walks the distance between
+     *        the previous key and this one
+     */
+    template<typename Key>
+    void advanceFinger(node_pointer* path, const Key& value) const {
+        // a key which is not past the finger restarts from the head
+        if (path[0] != head_node_ && !comp_(traits::key(path[0]->value), value)) {
+            std::fill(path, path + kMaxHeight, head_node_);
+        }
 
-        difference_type height = random_(head_node_->links.size() + 1);
+        size_type level = 0;
+        while (level + 1 < height_ && isBefore(path[level + 1]->links()[level + 1], value)) {
+            ++level;
+        }
 
-        auto new_node = node_allocator_traits::allocate(alloc_, 1);
-        node_allocator_traits::construct(alloc_, std::addressof(new_node->links), height, nullptr);
-        node_allocator_traits::construct(alloc_, std::addressof(new_node->value), std::forward<Arg>(value));
+        auto current_node = path[level];
+        for (auto i = static_cast<difference_type>(level); i >= 0; --i) {
+            // the finger of a level is only used when it is past the node reached from the level above
+            auto finger = path[i];
+            if (finger != head_node_ && (current_node == head_node_ ||
+                                         comp_(traits::key(current_node->value), traits::key(finger->value)))) {
+                current_node = finger;
+            }
 
-        if (height > head_node_->links.size()) {
-            head_node_->links.resize(height);
-            head_node_->links[height - 1] = new_node;
-            new_node->links[height - 1] = nullptr;
-            --height;
+            while (isBefore(current_node->links()[i], value)) {
+                current_node = current_node->links()[i];
+            }
+            path[i] = current_node;
+        }
+    }
+
+    template<typename Key>
+    bool isBefore(node_pointer node, const Key& value) const {
+        return node != nullptr && comp_(traits::key(node->value), value);
+    }
+
+    /**
+     * @brief Create a node with a random height and link it after the nodes of update_links, which must cover the
+     *        levels in use. The levels added above them start from the head
+     */
+    template<typename Arg>
+    node_pointer linkNode(node_pointer* update_links, Arg&& value) {
+        auto height = random_(std::min(height_ + 1, kMaxHeight));
+        auto new_node = createNode(height, std::forward<Arg>(value));
+        for (; height_ < height; ++height_) {
+            update_links[height_] = head_node_;
         }
 
-        for (difference_type i = height - 1; i >= 0; --i) {
-            new_node->links[i] = update_links[i]->links[i];
-            update_links[i]->links[i] = new_node;
+        for (size_type i = 0; i < height; ++i) {
+            new_node->links()[i] = update_links[i]->links()[i];
+            update_links[i]->links()[i] = new_node;
         }
         ++size_;
         return new_node;
     }
 
+    template<typename Arg>
+    node_pointer insertNode(Arg&& value) {
+        node_pointer update_links[kMaxHeight];
+        if (findPath(update_links, traits::key(value)) != nullptr) {
+            return nullptr;
+        }
+        return linkNode(update_links, std::forward<Arg>(value));
+    }
+
     template<typename Key>
     node_pointer findNode(const Key& value) const {
-        auto height = head_node_->links.size();
         auto current_node = head_node_;
-        for (difference_type i = height - 1; i >= 0; --i) {
-            while (current_node->links[i] != nullptr) {
-                if (comp_(traits::key(value), traits::key(current_node->links[i]->value))) {
+        for (auto i = static_cast<difference_type>(height_) - 1; i >= 0; --i) {
+            auto next_node = current_node->links()[i];
+            while (next_node != nullptr) {
+                if (comp_(value, traits::key(next_node->value))) {
                     break;
-                } else if (comp_(traits::key(current_node->links[i]->value), traits::key(value))) {
-                    current_node = current_node->links[i];
+                } else if (comp_(traits::key(next_node->value), value)) {
+                    current_node = next_node;
+                    next_node = current_node->links()[i];
                 } else {
-                    return current_node->links[i];
+                    return next_node;
                 }
             }
         }
         return nullptr;
     }
 
-    size_t eraseNode(const key_type& value) {
-        node_pointer node = nullptr;
-        Vector<node_pointer> update_links(head_node_->links.size(), nullptr);
-        auto current_node = head_node_;
-        for (difference_type i = head_node_->links.size() - 1; i >= 0; --i) {
-            while (current_node->links[i] != nullptr) {
-                if (comp_(traits::key(current_node->links[i]->value), value)) {
-                    current_node = current_node->links[i];
-                } else if (comp_(value, traits::key(current_node->links[i]->value))) {
-                    break;
-                } else {
-                    // found a duplicate
-                    node = current_node->links[i];
-                    break;
-                }
-            }
-            update_links[i] = current_node;
+    template<typename Key>
+    node_pointer findNode(Finger& finger, const Key& value) const {
+        advanceFinger(finger.path_, value);
+        auto next_node = finger.path_[0]->links()[0];
+        if (next_node != nullptr && !comp_(value, traits::key(next_node->value))) {
+            return next_node;
         }
+        return nullptr;
+    }
 
-        if (node != nullptr) {
-            auto height = node->links.size();
-            for (difference_type i = height - 1; i >= 0; --i) {
-                update_links[i]->links[i] = node->links[i];
-            }
-
-            node_allocator_traits::destroy(alloc_, std::addressof(node->value));
-            node_allocator_traits::destroy(alloc_, std::addressof(node->links));
-            node_allocator_traits::deallocate(alloc_, node, 1);
-            --size_;
-            return 1;
-        } else {
+    size_type eraseNode(const key_type& value) {
+        node_pointer update_links[kMaxHeight];
+        auto node = findPath(update_links, value);
+        if (node == nullptr) {
             return 0;
         }
+
+        for (size_type i = 0; i < node->height; ++i) {
+            update_links[i]->links()[i] = node->links()[i];
+        }
+        while (height_ > 0 && head_node_->links()[height_ - 1] == nullptr) {
+            --height_;
+        }
+
+        destroyNode(node);
+        --size_;
+        return 1;
     }
 
     node_pointer head_node_;
     size_type size_;
+    size_type height_;
     compare_type comp_;
     random_type random_;
     node_allocator_type alloc_;
@@ -372,4 +667,5 @@ private:
     friend iterator;
     friend const_iterator;
 };
+
 }  // namespace nxt::core
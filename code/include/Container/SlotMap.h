@@ -3,7 +3,11 @@
 #include "Key.h"
 #include "PageVector.h"
 #include "Vector.h"
+#include "../Maths.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <type_traits>
 
@@ -34,30 +38,18 @@ public:
     }
 
     SlotMapConstIterator& operator++() noexcept {
-        size_t max_index = slot_map_->maxValidIndex();
-        ++current_index_;
-        while (current_index_ < max_index) {
-            if (slot_map_->valid_list_[current_index_])
-                break;
-            ++current_index_;
-        }
+        current_index_ = slot_map_->nextValid(current_index_ + 1);
         return *this;
     }
 
     SlotMapConstIterator operator++(int) noexcept {
-        SlotMapContIterator temp(slot_map_, current_index_);
+        SlotMapConstIterator temp(slot_map_, current_index_);
         this->operator++();
         return temp;
     }
 
     SlotMapConstIterator& operator--() noexcept {
-        size_t min_index = slot_map_->minValidIndex();
-        --current_index_;
-        while (current_index_ > min_index) {
-            if (slot_map_->valid_list_[current_index_])
-                break;
-            --current_index_;
-        }
+        current_index_ = slot_map_->previousValid(current_index_ - 1);
         return *this;
     }
 
@@ -104,14 +96,8 @@ public:
         return slot_map_->valueAt(current_index_);
     }
 
-    SlotMapIterator& operator++() {
-        auto max_index = slot_map_->maxValidIndex();
-        ++current_index_;
-        while (current_index_ < max_index) {
-            if (slot_map_->valid_list_[current_index_])
-                break;
-            ++current_index_;
-        }
+    SlotMapIterator& operator++() noexcept {
+        current_index_ = slot_map_->nextValid(current_index_ + 1);
         return *this;
     }
 
@@ -122,13 +108,7 @@ public:
     }
 
     SlotMapIterator& operator--() noexcept {
-        size_t min_index = slot_map_->minValidIndex();
-        --current_index_;
-        while (current_index_ > min_index) {
-            if (slot_map_->valid_list_[current_index_])
-                break;
-            --current_index_;
-        }
+        current_index_ = slot_map_->previousValid(current_index_ - 1);
         return *this;
     }
 
@@ -166,13 +146,19 @@ private:
     using page_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<Page>;
     using page_pointer_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<Page*>;
     using page_allocator_traits = std::allocator_traits<page_allocator>;
-    using bool_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<bool>;
+    //! The validity of the slots is kept as a bitset, one bit per slot
+    using word_type = uint64_t;
+    using word_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<word_type>;
+    static constexpr std::size_t kWordBits = sizeof(word_type) * 8;
+
+    //! Trivially copyable values are copied a page at a time with memcpy
+    static constexpr bool kCopyPages = std::is_trivially_copyable_v<value_type> && std::is_pointer_v<pointer>;
 
 public:
     SlotMap(size_type capacity = block_size) noexcept(
         std::is_nothrow_default_constructible_v<page_allocator> &&
         std::is_nothrow_default_constructible_v<PageVector<key_type, block_size, key_type_allocator>> &&
-        std::is_nothrow_default_constructible_v<PageVector<bool, block_size, bool_allocator>>)
+        std::is_nothrow_default_constructible_v<Vector<word_type, word_allocator>>)
         : size_(0)
         , free_index_(0)
         , max_valid_index_(0)
@@ -181,12 +167,45 @@ public:
         reserve(capacity);
     }
 
-    SlotMap(const SlotMap& rhs)
-        : size_(0)
+    explicit SlotMap(const allocator_type& alloc, size_type capacity = block_size)
+        : pages_(page_pointer_allocator(alloc))
+        , next_list_(key_type_allocator(alloc))
+        , valid_words_(word_allocator(alloc))
+        , size_(0)
         , free_index_(0)
         , max_valid_index_(0)
         , min_valid_index_(0)
-        , alloc_() {}
+        , alloc_(alloc) {
+        reserve(capacity);
+    }
+
+    SlotMap(const SlotMap& rhs)
+        : next_list_(rhs.next_list_)
+        , valid_words_(rhs.valid_words_)
+        , size_(rhs.size_)
+        , free_index_(rhs.free_index_)
+        , max_valid_index_(rhs.max_valid_index_)
+        , min_valid_index_(rhs.min_valid_index_)
+        , alloc_(page_allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
+        pages_.reserve(rhs.pages_.size());
+        for (size_type i = 0; i < rhs.pages_.size(); ++i) {
+            pages_.pushBack(page_allocator_traits::allocate(alloc_, 1));
+        }
+
+        if constexpr (kCopyPages) {
+            // the slots past the last valid one are never read, so the pages are copied up to it
+            for (size_type first = 0; first < max_valid_index_; first += block_size) {
+                auto count = std::min<size_type>(block_size, max_valid_index_ - first);
+                std::memcpy(static_cast<void*>(pointerAt(first)),
+                            static_cast<const void*>(rhs.pointerAt(first)),
+                            count * sizeof(value_type));
+            }
+        } else {
+            forEachValidIndex([this, &rhs](size_type index) {
+                page_allocator_traits::construct(alloc_, pointerAt(index), rhs.valueAt(index));
+            });
+        }
+    }
 
     SlotMap(SlotMap&& rhs)
         : size_(0)
@@ -196,12 +215,18 @@ public:
         , alloc_(std::move(rhs.alloc_)) {
         pages_ = std::move(rhs.pages_);
         next_list_ = std::move(rhs.next_list_);
-        valid_list_ = std::move(rhs.valid_list_);
+        valid_words_ = std::move(rhs.valid_words_);
 
         size_ = rhs.size_;
         free_index_ = rhs.free_index_;
         min_valid_index_ = rhs.min_valid_index_;
         max_valid_index_ = rhs.max_valid_index_;
+
+        // rhs has no pages or valid words left, it is empty and grows again on the next emplace
+        rhs.size_ = 0;
+        rhs.free_index_ = 0;
+        rhs.min_valid_index_ = 0;
+        rhs.max_valid_index_ = 0;
     }
 
     key_type insert(const T& value) {
@@ -214,7 +239,8 @@ public:
 
     template<class... Args>
     key_type emplace(Args&&... args) {
-        if (size_ == capacity() - 1) {
+        // also grows a map without pages, as left by a move
+        if (size_ + 1 >= capacity()) {
             reserve(capacity() + block_size);
         }
 
@@ -228,7 +254,7 @@ public:
         key.generation = old_key.generation;
 
         // mark the item valid
-        valid_list_[free_index_] = true;
+        setValid(free_index_);
 
         // since we are storing the next valid
         free_index_ = old_key.index;
@@ -263,7 +289,7 @@ public:
             next_data.index = free_index_;
 
             // mark the item invalid
-            valid_list_[index] = false;
+            resetValid(index);
 
             // increase the generation count for next allocation
             ++next_data.generation;
@@ -277,19 +303,11 @@ public:
             // if the removed item was a either a min_valid_index or max_valid_index,
             // update the values
             if (index == min_valid_index_) {
-                while (min_valid_index_ < max_valid_index_) {
-                    if (valid_list_[min_valid_index_])
-                        break;
-                    ++min_valid_index_;
-                }
+                min_valid_index_ = nextValid(min_valid_index_);
             }
 
-            if (index + 1 == max_valid_index_) {
-                while (max_valid_index_ > min_valid_index_) {
-                    if (valid_list_[max_valid_index_ - 1])
-                        break;
-                    --max_valid_index_;
-                }
+            if (index + 1 == max_valid_index_ && max_valid_index_ > min_valid_index_) {
+                max_valid_index_ = previousValid(max_valid_index_ - 1) + 1;
             }
 
             return true;
@@ -350,22 +368,22 @@ public:
 
         for (size_type i = static_cast<size_type>(next_list_.size()); i < new_capacity; ++i) {
             next_list_.emplaceBack(i + 1, 1);
-            valid_list_.emplaceBack(false);
         }
+        valid_words_.resize((new_capacity + kWordBits - 1) / kWordBits, 0);
     }
 
     void clear() noexcept {
         // destroy items which are valid and increment the generation
-        for (size_type i = 0; i < capacity(); ++i) {
-            if (valid_list_[i]) {
-                page_allocator_traits::destroy(alloc_, pointerAt(i));
-                ++next_list_[i].generation;
-            }
+        forEachValidIndex([this](size_type index) {
+            page_allocator_traits::destroy(alloc_, pointerAt(index));
+            ++next_list_[index].generation;
+        });
 
-            // reset the list to point to next item
+        // reset the list to point to next item
+        for (size_type i = 0; i < capacity(); ++i) {
             next_list_[i].index = i + 1;
-            valid_list_[i] = false;
         }
+        std::fill(valid_words_.begin(), valid_words_.end(), word_type(0));
 
         min_valid_index_ = 0;
         max_valid_index_ = 0;
@@ -373,6 +391,20 @@ public:
         free_index_ = 0;
     }
 
+    /**
+     * @brief Call fn with every valid value in the order of the slots. Faster than iterating since the validity
+     *        bitset is scanned a word at a time, skipping the erased slots 64 at once
+     */
+    template<typename Function>
+    void forEachValid(Function&& fn) {
+        forEachValidIndex([this, &fn](size_type index) { fn(valueAt(index)); });
+    }
+
+    template<typename Function>
+    void forEachValid(Function&& fn) const {
+        forEachValidIndex([this, &fn](size_type index) { fn(valueAt(index)); });
+    }
+
     iterator begin() noexcept {
         return iterator(this, min_valid_index_);
     }
@@ -408,12 +440,68 @@ public:
     }
 
 private:
-    size_type minValidIndex() const noexcept {
-        return min_valid_index_;
+    void setValid(size_type index) noexcept {
+        valid_words_[index / kWordBits] |= word_type(1) << (index % kWordBits);
+    }
+
+    void resetValid(size_type index) noexcept {
+        valid_words_[index / kWordBits] &= ~(word_type(1) << (index % kWordBits));
+    }
+
+    //! First valid index from index on, or max_valid_index_ if there is none
+    [[nodiscard]] size_type nextValid(size_type index) const noexcept {
+        if (index >= max_valid_index_) {
+            return max_valid_index_;
+        }
+
+        // the slots past max_valid_index_ are never valid, so a set bit is always below it
+        std::size_t word_index = index / kWordBits;
+        auto word = valid_words_[word_index] >> (index % kWordBits);
+        // testing the slot itself first keeps the iteration over dense maps free of the count latency
+        if ((word & 1u) != 0) {
+            return index;
+        }
+        if (word != 0) {
+            return index + static_cast<size_type>(countTrailingZeros(word));
+        }
+
+        do {
+            ++word_index;
+            if (word_index * kWordBits >= max_valid_index_) {
+                return max_valid_index_;
+            }
+            word = valid_words_[word_index];
+        } while (word == 0);
+        return static_cast<size_type>(word_index * kWordBits + countTrailingZeros(word));
     }
 
-    size_type maxValidIndex() const noexcept {
-        return max_valid_index_;
+    //! Last valid index up to index, or min_valid_index_ if there is none
+    [[nodiscard]] size_type previousValid(size_type index) const noexcept {
+        if (index <= min_valid_index_) {
+            return min_valid_index_;
+        }
+
+        std::size_t word_index = index / kWordBits;
+        auto word = valid_words_[word_index] & (~word_type(0) >> (kWordBits - 1 - index % kWordBits));
+        while (word == 0) {
+            if (word_index * kWordBits <= min_valid_index_) {
+                return min_valid_index_;
+            }
+            --word_index;
+            word = valid_words_[word_index];
+        }
+        return static_cast<size_type>(word_index * kWordBits + kWordBits - 1 - countLeadingZeros(word));
+    }
+
+    //! Call fn with the index of every valid slot, a word of the bitset at a time
+    template<typename Function>
+    void forEachValidIndex(Function&& fn) const {
+        auto last_word = (static_cast<std::size_t>(max_valid_index_) + kWordBits - 1) / kWordBits;
+        for (std::size_t word_index = min_valid_index_ / kWordBits; word_index < last_word; ++word_index) {
+            for (auto word = valid_words_[word_index]; word != 0; word &= word - 1) {
+                fn(static_cast<size_type>(word_index * kWordBits + countTrailingZeros(word)));
+            }
+        }
     }
 
     reference valueAt(size_type index) {
@@ -434,7 +522,7 @@ private:
 
     Vector<Page*, page_pointer_allocator> pages_;
     PageVector<key_type, block_size, key_type_allocator> next_list_;
-    PageVector<bool, block_size, bool_allocator> valid_list_;
+    Vector<word_type, word_allocator> valid_words_;
     size_type size_;
     size_type free_index_;
     size_type max_valid_index_;
@@ -0,0 +1,496 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "../Algorithm/Sort.h"
+#include "../Memory/Relocate.h"
+#include "../TypeTraits.h"
+#include "Buffer.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Vector which stores up to N values inline and only allocates from the heap beyond that. Meant for the many
+ *        small lists which hold a handful of values, an empty or small SmallVector never allocates. Has the same
+ *        interface as Vector, but moving a SmallVector with inline values moves the values one by one and
+ *        invalidates the iterators.
+ *
+ * @tparam N Number of values stored inline
+ */
+template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class SmallVector {
+public:
+    static_assert(N > 0, "SmallVector needs an inline capacity, use Vector instead");
+
+    using value_type = T;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+    using allocator_traits = typename std::allocator_traits<allocator_type>;
+    using size_type = typename allocator_traits::size_type;
+    using difference_type = typename allocator_traits::difference_type;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+
+    static_assert(std::is_pointer_v<typename allocator_traits::pointer>,
+                  "SmallVector mixes inline and allocated storage, the allocator must use raw pointers");
+
+    //! Number of values stored without allocating
+    static constexpr size_type inline_capacity = N;
+
+    SmallVector() noexcept(std::is_nothrow_default_constructible_v<allocator_type>)
+        : data_(inlineData())
+        , size_(0)
+        , capacity_(N)
+        , alloc_() {}
+
+    explicit SmallVector(const allocator_type& alloc) noexcept
+        : data_(inlineData())
+        , size_(0)
+        , capacity_(N)
+        , alloc_(alloc) {}
+
+    explicit SmallVector(size_type count, const allocator_type& alloc = allocator_type())
+        : SmallVector(alloc) {
+        resize(count);
+    }
+
+    SmallVector(size_type count, const T& value, const allocator_type& alloc = allocator_type())
+        : SmallVector(alloc) {
+        resize(count, value);
+    }
+
+    template<typename InputIter, typename = std::enable_if_t<IsInputIteratorV<InputIter>>>
+    SmallVector(InputIter first, InputIter last, const allocator_type& alloc = allocator_type())
+        : SmallVector(alloc) {
+        assign(first, last);
+    }
+
+    SmallVector(std::initializer_list<value_type> values, const allocator_type& alloc = allocator_type())
+        : SmallVector(values.begin(), values.end(), alloc) {}
+
+    SmallVector(const SmallVector& rhs)
+        : SmallVector(allocator_traits::select_on_container_copy_construction(rhs.alloc_)) {
+        assign(rhs.begin(), rhs.end());
+    }
+
+    SmallVector(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+        : SmallVector(rhs.alloc_) {
+        takeData(std::move(rhs));
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != std::addressof(rhs)) {
+            if constexpr (ChoosePOCCA<allocator_type>) {
+                if (alloc_ != rhs.alloc_) {
+                    cleanup();
+                    alloc_ = rhs.alloc_;
+                }
+            }
+            assign(rhs.begin(), rhs.end());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(
+        std::is_nothrow_move_constructible_v<value_type> &&
+        (allocator_traits::propagate_on_container_move_assignment::value || allocator_traits::is_always_equal::value)) {
+        if (this != std::addressof(rhs)) {
+            cleanup();
+            if constexpr (ChoosePOCMA<allocator_type>) {
+                alloc_ = std::move(rhs.alloc_);
+            }
+            takeData(std::move(rhs));
+        }
+        return *this;
+    }
+
+    template<typename InputIter, typename = std::enable_if_t<IsInputIteratorV<InputIter>>>
+    void assign(InputIter first, InputIter last) {
+        clear();
+        if constexpr (IsForwardIteratorV<InputIter>) {
+            reserve(static_cast<size_type>(std::distance(first, last)));
+        }
+
+        for (; first != last; ++first) {
+            emplaceBack(*first);
+        }
+    }
+
+    void assign(size_type count, const T& value) {
+        clear();
+        resize(count, value);
+    }
+
+    void assign(std::initializer_list<T> values) {
+        assign(values.begin(), values.end());
+    }
+
+    void resize(size_type new_size) {
+        resizeInternal(new_size);
+    }
+
+    void resize(size_type new_size, const T& value) {
+        resizeInternal(new_size, value);
+    }
+
+    [[nodiscard]] iterator begin() noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] iterator end() noexcept {
+        return data_ + size_;
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    [[nodiscard]] const_iterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+    [[nodiscard]] reference front() noexcept {
+        return *data_;
+    }
+
+    [[nodiscard]] const_reference front() const noexcept {
+        return *data_;
+    }
+
+    [[nodiscard]] reference back() noexcept {
+        return data_[size_ - 1];
+    }
+
+    [[nodiscard]] const_reference back() const noexcept {
+        return data_[size_ - 1];
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept {
+        return capacity_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /**
+     * @brief Whether the values are stored inline, in which case the SmallVector holds no allocation
+     */
+    [[nodiscard]] bool isInline() const noexcept {
+        return data_ == inlineData();
+    }
+
+    [[nodiscard]] reference operator[](size_type position) {
+        return data_[position];
+    }
+
+    [[nodiscard]] const_reference operator[](size_type position) const {
+        return data_[position];
+    }
+
+    void pushBack(const T& value) {
+        emplaceBack(value);
+    }
+
+    void pushBack(T&& value) {
+        emplaceBack(std::move(value));
+    }
+
+    template<typename... Args>
+    void emplaceBack(Args&&... args) {
+        if (size_ == capacity_) {
+            insertElement(end(), std::forward<Args>(args)...);
+        } else {
+            allocator_traits::construct(alloc_, data_ + size_, std::forward<Args>(args)...);
+            ++size_;
+        }
+    }
+
+    void popBack() {
+        if (size_ > 0) {
+            allocator_traits::destroy(alloc_, data_ + size_ - 1);
+            --size_;
+        }
+    }
+
+    iterator erase(const_iterator position) {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        iterator dest = const_cast<iterator>(first);
+        iterator src = const_cast<iterator>(last);
+        if (first == last) {
+            return dest;
+        }
+
+        iterator end = data_ + size_;
+        if constexpr (kRelocatable) {
+            for (auto current = dest; current != src; ++current) {
+                allocator_traits::destroy(alloc_, current);
+            }
+
+            relocateOverlapping(src, static_cast<size_type>(end - src), dest);
+            size_ -= static_cast<size_type>(src - dest);
+        } else {
+            auto new_end = std::move(src, end, dest);
+            for (auto current = new_end; current != end; ++current) {
+                allocator_traits::destroy(alloc_, current);
+            }
+            size_ -= static_cast<size_type>(src - dest);
+        }
+        return dest;
+    }
+
+    void clear() noexcept {
+        for (size_type i = 0; i < size_; ++i) {
+            allocator_traits::destroy(alloc_, data_ + i);
+        }
+        size_ = 0;
+    }
+
+    void reserve(size_type new_capacity) {
+        if (new_capacity > capacity_) {
+            moveToBuffer(new_capacity);
+        }
+    }
+
+    /**
+     * @brief Release the unused capacity, values which fit inline are moved back inline
+     */
+    void shrinkToFit() {
+        if (!isInline() && capacity_ > size_) {
+            moveToBuffer(size_);
+        }
+    }
+
+    iterator insert(const_iterator position, const T& value) {
+        return insertElement(position, value);
+    }
+
+    iterator insert(const_iterator position, T&& value) {
+        return insertElement(position, std::move(value));
+    }
+
+    template<typename... Args>
+    iterator emplace(const_iterator position, Args&&... args) {
+        return insertElement(position, std::forward<Args>(args)...);
+    }
+
+    [[nodiscard]] pointer data() noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] const_pointer data() const noexcept {
+        return data_;
+    }
+
+    ~SmallVector() {
+        cleanup();
+    }
+
+private:
+    //! Values are moved around with memcpy instead of being moved and destroyed one by one
+    static constexpr bool kRelocatable = CanRelocateV<allocator_type>;
+
+    [[nodiscard]] pointer inlineData() noexcept {
+        return inline_buffer_.data();
+    }
+
+    [[nodiscard]] const_pointer inlineData() const noexcept {
+        return inline_buffer_.data();
+    }
+
+    /**
+     * @brief Move count values from src to the uninitialized dest and end the lifetime of the sources
+     */
+    void moveValues(pointer src, size_type count, pointer dest) {
+        if constexpr (kRelocatable) {
+            relocate(src, count, dest);
+        } else {
+            for (size_type i = 0; i < count; ++i) {
+                allocator_traits::construct(alloc_, dest + i, std::move_if_noexcept(src[i]));
+                allocator_traits::destroy(alloc_, src + i);
+            }
+        }
+    }
+
+    /**
+     * @brief Move the values to the inline storage when they fit in it, else to a heap buffer of new_capacity
+     */
+    void moveToBuffer(size_type new_capacity) {
+        pointer new_buffer = inlineData();
+        if (new_capacity > N) {
+            new_buffer = allocator_traits::allocate(alloc_, new_capacity);
+        } else {
+            new_capacity = N;
+        }
+
+        moveValues(data_, size_, new_buffer);
+        releaseBuffer();
+        data_ = new_buffer;
+        capacity_ = new_capacity;
+    }
+
+    void releaseBuffer() noexcept {
+        if (!isInline()) {
+            allocator_traits::deallocate(alloc_, data_, capacity_);
+        }
+    }
+
+    void cleanup() noexcept {
+        clear();
+        releaseBuffer();
+        data_ = inlineData();
+        capacity_ = N;
+    }
+
+    /**
+     * @brief Take the values of rhs, its buffer when it is allocated and the allocators match
+     */
+    void takeData(SmallVector&& rhs) {
+        if (!rhs.isInline() && alloc_ == rhs.alloc_) {
+            data_ = rhs.data_;
+            size_ = rhs.size_;
+            capacity_ = rhs.capacity_;
+        } else {
+            reserve(rhs.size_);
+            moveValues(rhs.data_, rhs.size_, data_);
+            size_ = rhs.size_;
+            rhs.releaseBuffer();
+        }
+
+        rhs.data_ = rhs.inlineData();
+        rhs.size_ = 0;
+        rhs.capacity_ = N;
+    }
+
+    template<typename... Args>
+    void resizeInternal(size_type new_size, Args&&... args) {
+        if (new_size > size_) {
+            reserve(new_size);
+            while (size_ < new_size) {
+                allocator_traits::construct(alloc_, data_ + size_, std::forward<Args>(args)...);
+                ++size_;
+            }
+        } else {
+            while (size_ > new_size) {
+                popBack();
+            }
+        }
+    }
+
+    template<typename... Args>
+    iterator insertElement(const_iterator position, Args&&... args) {
+        auto index = static_cast<size_type>(position - data_);
+        if (size_ == capacity_) {
+            auto new_capacity = capacity_ * 2;
+            auto new_buffer = allocator_traits::allocate(alloc_, new_capacity);
+
+            // the new value goes first since the arguments may refer to a value of the vector
+            try {
+                allocator_traits::construct(alloc_, new_buffer + index, std::forward<Args>(args)...);
+            } catch (...) {
+                allocator_traits::deallocate(alloc_, new_buffer, new_capacity);
+                throw;
+            }
+
+            moveValues(data_, index, new_buffer);
+            moveValues(data_ + index, size_ - index, new_buffer + index + 1);
+            releaseBuffer();
+
+            data_ = new_buffer;
+            capacity_ = new_capacity;
+            ++size_;
+            return data_ + index;
+        }
+
+        if (index == size_) {
+            allocator_traits::construct(alloc_, data_ + size_, std::forward<Args>(args)...);
+            ++size_;
+            return data_ + index;
+        }
+
+        if constexpr (kRelocatable) {
+            // the value is built aside so that a throwing constructor leaves the vector untouched
+            alignas(value_type) unsigned char storage[sizeof(value_type)];
+            auto value = reinterpret_cast<pointer>(storage);
+            allocator_traits::construct(alloc_, value, std::forward<Args>(args)...);
+
+            relocateOverlapping(data_ + index, size_ - index, data_ + index + 1);
+            relocate(value, 1, data_ + index);
+        } else {
+            value_type value(std::forward<Args>(args)...);
+
+            allocator_traits::construct(alloc_, data_ + size_, std::move(data_[size_ - 1]));
+            std::move_backward(data_ + index, data_ + size_ - 1, data_ + size_);
+            data_[index] = std::move(value);
+        }
+
+        ++size_;
+        return data_ + index;
+    }
+
+    pointer data_;
+    size_type size_;
+    size_type capacity_;
+    Buffer<value_type, N> inline_buffer_;
+    allocator_type alloc_;
+};
+
+template<typename T, std::size_t N, typename Allocator>
+[[nodiscard]] bool
+operator==(const SmallVector<T, N, Allocator>& lhs, const SmallVector<T, N, Allocator>& rhs) {
+    return isEqual(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template<typename T, std::size_t N, typename Allocator>
+[[nodiscard]] bool
+operator!=(const SmallVector<T, N, Allocator>& lhs, const SmallVector<T, N, Allocator>& rhs) {
+    return !isEqual(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template<typename T, std::size_t N, typename Allocator>
+[[nodiscard]] bool
+operator<(const SmallVector<T, N, Allocator>& lhs, const SmallVector<T, N, Allocator>& rhs) {
+    return lexicographicalCompare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template<typename T, std::size_t N, typename Allocator>
+[[nodiscard]] bool
+operator>(const SmallVector<T, N, Allocator>& lhs, const SmallVector<T, N, Allocator>& rhs) {
+    return rhs < lhs;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+[[nodiscard]] bool
+operator<=(const SmallVector<T, N, Allocator>& lhs, const SmallVector<T, N, Allocator>& rhs) {
+    return !(rhs < lhs);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+[[nodiscard]] bool
+operator>=(const SmallVector<T, N, Allocator>& lhs, const SmallVector<T, N, Allocator>& rhs) {
+    return !(lhs < rhs);
+}
+
+}  // namespace nxt::core
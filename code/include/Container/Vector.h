@@ -4,6 +4,7 @@
 
 #include "../TypeTraits.h"
 #include "../Algorithm/Sort.h"
+#include "../Memory/Relocate.h"
 
 namespace nxt::core {
 
@@ -146,7 +147,7 @@ public:
 
                         size_type current_index = 0;
                         while (current_index < size_) {
-                            data_ + current_index = std::move(*(rhs.data_ + current_index));
+                            *(data_ + current_index) = std::move(*(rhs.data_ + current_index));
                             ++current_index;
                         }
 
@@ -158,16 +159,17 @@ public:
                     } else {
                         size_type current_index = 0;
                         while (current_index < new_size) {
-                            data_ + current_index = std::move(*(rhs.data_ + current_index));
+                            *(data_ + current_index) = std::move(*(rhs.data_ + current_index));
                             ++current_index;
                         }
 
                         while (current_index < size_) {
                             allocator_traits::destroy(alloc_, data_ + current_index);
+                            ++current_index;
                         }
                     }
                     size_ = new_size;
-                    return;
+                    return *this;
                 } else {
                     cleanup();
                 }
@@ -175,6 +177,7 @@ public:
 
             takeData(std::move(rhs));
         }
+        return *this;
     }
 
     template<typename InputIter, typename = std::enable_if_t<IsInputIteratorV<InputIter>>>
@@ -231,12 +234,10 @@ public:
             size_type current_index = 0;
             while (current_index < size_) {
                 *(data_ + current_index) = value;
-
                 ++current_index;
-                ++first;
             }
 
-            for (current_index < item_count) {
+            while (current_index < new_size) {
                 allocator_traits::construct(alloc_, data_ + current_index, value);
                 ++current_index;
             }
@@ -245,10 +246,8 @@ public:
         } else {
             size_type current_index = 0;
             while (current_index < new_size) {
-                *(data_ + current_index) = *first;
-
+                *(data_ + current_index) = value;
                 ++current_index;
-                ++first;
             }
 
             while (current_index < size_) {
@@ -367,16 +366,25 @@ public:
 
         iterator result = dest;
 
-        while (src != end) {
-            *dest = *src;
-            ++dest;
-            ++src;
-        }
+        if constexpr (kRelocatable) {
+            for (auto current = dest; current != src; ++current) {
+                allocator_traits::destroy(alloc_, current);
+            }
 
-        while (dest != end) {
-            allocator_traits::destroy(alloc_, dest);
-            ++dest;
-            --size_;
+            relocateOverlapping(src, static_cast<size_type>(end - src), dest);
+            size_ -= static_cast<size_type>(src - dest);
+        } else {
+            while (src != end) {
+                *dest = std::move(*src);
+                ++dest;
+                ++src;
+            }
+
+            while (dest != end) {
+                allocator_traits::destroy(alloc_, dest);
+                ++dest;
+                --size_;
+            }
         }
 
         return result;
@@ -422,11 +430,18 @@ public:
         return data_;
     }
 
+    [[nodiscard]] allocator_type getAllocator() const noexcept {
+        return alloc_;
+    }
+
     ~Vector() {
         cleanup();
     }
 
 private:
+    //! Values are moved around with memcpy instead of being moved and destroyed one by one
+    static constexpr bool kRelocatable = CanRelocateV<allocator_type>;
+
     void growIfNeeded() {
         if (size_ == capacity_) {
             growBuffer(capacity_ + 1, false);
@@ -443,6 +458,10 @@ private:
 
     template<typename... Args>
     void constructCountValues(size_type count, Args&&... args) {
+        if (count == 0) {
+            return;
+        }
+
         auto buffer = allocator_traits::allocate(alloc_, count);
         for (size_type i = 0; i < count; ++i) {
             allocator_traits::construct(alloc_, buffer + i, std::forward<Args>(args)...);
@@ -478,6 +497,7 @@ private:
 
     template<typename... Args>
     iterator insertElement(const_iterator position, Args&&... args) {
+        auto index = static_cast<size_type>(position - data_);
         if (size_ == capacity_) {
             constexpr size_type kMinSize = 8;
             auto actual_capacity = capacity_ * 2;
@@ -485,67 +505,67 @@ private:
 
             auto new_buffer = allocator_traits::allocate(alloc_, actual_capacity);
 
-            auto src = data_;
-            auto end = data_ + size_;
-            auto dest = new_buffer;
-
-            while (src != position) {
-                if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
-                    allocator_traits::construct(alloc_, dest, std::move(*src));
-                } else {
-                    allocator_traits::construct(alloc_, dest, *src);
-                }
-
-                ++src;
-                ++dest;
+            // the new value goes first since the arguments may refer to a value of the vector
+            try {
+                allocator_traits::construct(alloc_, new_buffer + index, std::forward<Args>(args)...);
+            } catch (...) {
+                allocator_traits::deallocate(alloc_, new_buffer, actual_capacity);
+                throw;
             }
 
-            allocator_traits::construct(alloc_, dest, std::forward<Args>(args)...);
-            auto result = dest;
-            ++dest;
+            if constexpr (kRelocatable) {
+                relocate(data_, index, new_buffer);
+                relocate(data_ + index, size_ - index, new_buffer + index + 1);
+            } else {
+                for (size_type i = 0; i < size_; ++i) {
+                    auto dest = new_buffer + (i < index ? i : i + 1);
+                    if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
+                        allocator_traits::construct(alloc_, dest, std::move(data_[i]));
+                    } else {
+                        allocator_traits::construct(alloc_, dest, data_[i]);
+                    }
+                }
 
-            while (src != end) {
-                if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
-                    allocator_traits::construct(alloc_, dest, std::move(*src));
-                } else {
-                    allocator_traits::construct(alloc_, dest, *src);
+                for (size_type i = 0; i < size_; ++i) {
+                    allocator_traits::destroy(alloc_, data_ + i);
                 }
+            }
 
-                ++src;
-                ++dest;
+            if (capacity_ > 0) {
+                allocator_traits::deallocate(alloc_, data_, capacity_);
             }
 
             ++size_;
             data_ = new_buffer;
             capacity_ = actual_capacity;
-            return result;
-        } else {
-            if (position == end()) {
-                emplaceBack(std::forward<Args>(args)...);
-                return data_ + size_ - 1;
-            }
-
-            // move the elements backwards one position
-            auto dest = data_ + size_;
+            return data_ + index;
+        }
 
-            auto last = dest;
-            iterator first = const_cast<iterator>(position);
+        if (index == size_) {
+            emplaceBack(std::forward<Args>(args)...);
+            return data_ + index;
+        }
 
-            // move the last element to unallocated space
-            allocator_traits::construct(alloc_, last, std::move(*(last - 1)));
-            --last;
+        if constexpr (kRelocatable) {
+            // the value is built aside so that a throwing constructor leaves the vector untouched, then the tail is
+            // shifted by a single memmove and the value relocated into the gap
+            alignas(value_type) unsigned char storage[sizeof(value_type)];
+            auto value = reinterpret_cast<pointer>(storage);
+            allocator_traits::construct(alloc_, value, std::forward<Args>(args)...);
 
-            // move all the elements one position
-            while (first != last) {
-                --last;
-                --dest;
-                *dest = *last;
-            }
+            relocateOverlapping(data_ + index, size_ - index, data_ + index + 1);
+            relocate(value, 1, data_ + index);
+        } else {
+            value_type value(std::forward<Args>(args)...);
 
-            allocator_traits::construct(alloc_, first, std::forward<Args>(args)...);
-            ++size_;
-            return first;
+            // move the last element to unallocated space, then the others one position backwards
+            allocator_traits::construct(alloc_, data_ + size_, std::move(data_[size_ - 1]));
+            std::move_backward(data_ + index, data_ + size_ - 1, data_ + size_);
+            data_[index] = std::move(value);
         }
+
+        ++size_;
+        return data_ + index;
     }
 
     void growBuffer(size_type new_capacity, bool exact) {
@@ -558,21 +578,27 @@ private:
 
         auto new_buffer = allocator_traits::allocate(alloc_, actual_capacity);
 
-        if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
-            for (size_type i = 0; i < size_; ++i) {
-                allocator_traits::construct(alloc_, new_buffer + i, std::move(data_[i]));
-            }
+        if constexpr (kRelocatable) {
+            relocate(data_, size_, new_buffer);
         } else {
+            if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
+                for (size_type i = 0; i < size_; ++i) {
+                    allocator_traits::construct(alloc_, new_buffer + i, std::move(data_[i]));
+                }
+            } else {
+                for (size_type i = 0; i < size_; ++i) {
+                    allocator_traits::construct(alloc_, new_buffer + i, data_[i]);
+                }
+            }
+
             for (size_type i = 0; i < size_; ++i) {
-                allocator_traits::construct(alloc_, new_buffer + i, data_[i]);
+                allocator_traits::destroy(alloc_, data_ + i);
             }
         }
 
-        for (size_type i = 0; i < size_; ++i) {
-            allocator_traits::destroy(alloc_, data_ + i);
+        if (capacity_ > 0) {
+            allocator_traits::deallocate(alloc_, data_, capacity_);
         }
-
-        allocator_traits::deallocate(alloc_, data_, capacity_);
         data_ = new_buffer;
         capacity_ = actual_capacity;
     }
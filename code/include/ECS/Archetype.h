@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Entity.h"
+#include "../Container/Vector.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Type erased description of a component type stored in an Archetype. Only structural changes go through
+ *        the function pointers, iteration uses the typed columns directly
+ *
+ */
+struct ComponentTypeInfo {
+    using RelocateFunction = void (*)(void* destination, void* source) noexcept;
+    using DestroyFunction = void (*)(void* object) noexcept;
+
+    //! unique id of the type, archetypes keep their types sorted by it
+    uint32_t id;
+    std::size_t size;
+    std::size_t alignment;
+    //! move constructs the object at destination from source and destroys source
+    RelocateFunction relocate;
+    DestroyFunction destroy;
+};
+
+class BaseComponentType {
+protected:
+    static std::atomic<uint32_t> next_id_;
+};
+
+/**
+ * @brief Gives a unique ComponentTypeInfo to every type stored in the archetype storage
+ *
+ * @tparam T Type of the component data
+ */
+template<typename T>
+class ComponentType : public BaseComponentType {
+public:
+    static_assert(std::is_same_v<T, std::decay_t<T>>, "Component data type can't be a reference or cv qualified");
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>,
+                  "Component data type must be nothrow move constructible and nothrow destructible");
+    static_assert(alignof(T) <= 64, "Component data type can't be aligned more than a cache line");
+
+    [[nodiscard]] static const ComponentTypeInfo& getInfo() noexcept {
+        static const ComponentTypeInfo info{next_id_++, sizeof(T), alignof(T), &relocate, &destroy};
+        return info;
+    }
+
+    [[nodiscard]] static uint32_t getId() noexcept {
+        return getInfo().id;
+    }
+
+private:
+    static void relocate(void* destination, void* source) noexcept {
+        auto object = static_cast<T*>(source);
+        new (destination) T(std::move(*object));
+        object->~T();
+    }
+
+    static void destroy(void* object) noexcept {
+        static_cast<T*>(object)->~T();
+    }
+};
+
+/**
+ * @brief Table storing all the entities which have exactly the same set of component types. Rows are kept
+ *        densely packed in fixed size chunks, each chunk stores the entities followed by one contiguous column
+ *        per component type (structure of arrays), so iterating a column is a linear scan over memory.
+ *
+ *        Components in a new row are left unconstructed, the owner (ArchetypeStorage) constructs or relocates
+ *        them in place.
+ *
+ */
+class Archetype {
+public:
+    static constexpr std::size_t kChunkSize = 16 * 1024;
+    static constexpr std::size_t kChunkAlignment = 64;
+    static constexpr std::size_t kInvalidColumn = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief Construct an empty Archetype
+     *
+     * @param types Component types of the archetype sorted by their id
+     */
+    explicit Archetype(Vector<const ComponentTypeInfo*> types)
+        : types_(std::move(types))
+        , size_(0) {
+        column_offsets_.resize(types_.size());
+
+        std::size_t row_size = sizeof(Entity);
+        for (auto type : types_) {
+            row_size += type->size;
+        }
+
+        // find the largest row count whose columns (including alignment padding) fit in a chunk
+        chunk_capacity_ = static_cast<uint32_t>(std::max<std::size_t>(kChunkSize / row_size, 1));
+        chunk_bytes_ = computeLayout(chunk_capacity_);
+        while (chunk_bytes_ > kChunkSize && chunk_capacity_ > 1) {
+            --chunk_capacity_;
+            chunk_bytes_ = computeLayout(chunk_capacity_);
+        }
+    }
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    /**
+     * @brief Component types of the archetype sorted by their id
+     */
+    [[nodiscard]] const Vector<const ComponentTypeInfo*>& getTypes() const noexcept {
+        return types_;
+    }
+
+    /**
+     * @brief Get the index of the column storing the given component type
+     *
+     * @param type_id Id of the component type
+     * @return Index of the column or kInvalidColumn if the archetype doesn't have the type
+     */
+    [[nodiscard]] std::size_t getColumnIndex(uint32_t type_id) const noexcept {
+        for (std::size_t i = 0; i < types_.size(); ++i) {
+            if (types_[i]->id == type_id) {
+                return i;
+            }
+        }
+        return kInvalidColumn;
+    }
+
+    [[nodiscard]] bool hasType(uint32_t type_id) const noexcept {
+        return getColumnIndex(type_id) != kInvalidColumn;
+    }
+
+    /**
+     * @brief Number of rows (entities) in the archetype
+     */
+    [[nodiscard]] uint32_t size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /**
+     * @brief Maximum number of rows stored in a single chunk
+     */
+    [[nodiscard]] uint32_t getChunkCapacity() const noexcept {
+        return chunk_capacity_;
+    }
+
+    /**
+     * @brief Number of chunks which have at least one row
+     */
+    [[nodiscard]] std::size_t getChunkCount() const noexcept {
+        return (size_ + chunk_capacity_ - 1) / chunk_capacity_;
+    }
+
+    /**
+     * @brief Number of rows in the given chunk
+     */
+    [[nodiscard]] uint32_t getChunkSize(std::size_t chunk_index) const noexcept {
+        auto first_row = static_cast<uint32_t>(chunk_index * chunk_capacity_);
+        return std::min(chunk_capacity_, size_ - first_row);
+    }
+
+    [[nodiscard]] Entity* getEntities(std::size_t chunk_index) noexcept {
+        return reinterpret_cast<Entity*>(chunks_[chunk_index]);
+    }
+
+    [[nodiscard]] const Entity* getEntities(std::size_t chunk_index) const noexcept {
+        return reinterpret_cast<const Entity*>(chunks_[chunk_index]);
+    }
+
+    /**
+     * @brief Get the start of a column in the given chunk
+     */
+    [[nodiscard]] void* getColumn(std::size_t chunk_index, std::size_t column_index) noexcept {
+        return chunks_[chunk_index] + column_offsets_[column_index];
+    }
+
+    template<typename T>
+    [[nodiscard]] T* getColumn(std::size_t chunk_index, std::size_t column_index) noexcept {
+        return std::launder(reinterpret_cast<T*>(getColumn(chunk_index, column_index)));
+    }
+
+    [[nodiscard]] Entity getEntity(uint32_t row) const noexcept {
+        return getEntities(row / chunk_capacity_)[row % chunk_capacity_];
+    }
+
+    /**
+     * @brief Get the address of a component in the given row
+     */
+    [[nodiscard]] void* getComponent(uint32_t row, std::size_t column_index) noexcept {
+        auto column = static_cast<std::byte*>(getColumn(row / chunk_capacity_, column_index));
+        return column + (row % chunk_capacity_) * types_[column_index]->size;
+    }
+
+    /**
+     * @brief Append a row for the entity. Components of the new row are not constructed
+     *
+     * @return Index of the new row
+     */
+    uint32_t appendRow(const Entity& entity) {
+        if (size_ == chunks_.size() * chunk_capacity_) {
+            allocateChunk();
+        }
+
+        new (getEntities(size_ / chunk_capacity_) + size_ % chunk_capacity_) Entity(entity);
+        return size_++;
+    }
+
+    /**
+     * @brief Destroy all the components in the given row. The row itself is not removed
+     */
+    void destroyRow(uint32_t row) noexcept {
+        for (std::size_t i = 0; i < types_.size(); ++i) {
+            types_[i]->destroy(getComponent(row, i));
+        }
+    }
+
+    /**
+     * @brief Remove a row whose components are already destroyed or relocated. The last row is relocated into the
+     *        removed row to keep the rows densely packed
+     *
+     * @return Entity which was moved into the row or kInvalidEntity if no entity was moved
+     */
+    Entity removeRow(uint32_t row) noexcept {
+        auto last_row = size_ - 1;
+        auto moved_entity = Entity::kInvalidEntity;
+        if (row != last_row) {
+            for (std::size_t i = 0; i < types_.size(); ++i) {
+                types_[i]->relocate(getComponent(row, i), getComponent(last_row, i));
+            }
+            moved_entity = getEntity(last_row);
+            getEntities(row / chunk_capacity_)[row % chunk_capacity_] = moved_entity;
+        }
+        --size_;
+
+        // keep a single spare chunk around so that an entity moving back and forth doesn't allocate every time
+        if (chunks_.size() > getChunkCount() + 1) {
+            ::operator delete(chunks_.back(), std::align_val_t(kChunkAlignment));
+            chunks_.popBack();
+        }
+        return moved_entity;
+    }
+
+    /**
+     * @brief Destroy all the rows in the archetype
+     */
+    void clear() noexcept {
+        for (uint32_t row = 0; row < size_; ++row) {
+            destroyRow(row);
+        }
+        size_ = 0;
+    }
+
+    /**
+     * @brief Get the cached archetype reached by adding (or removing) the given component type
+     *
+     * @return Cached archetype or nullptr if the transition isn't cached yet
+     */
+    [[nodiscard]] Archetype* getTransition(uint32_t type_id, bool add) const noexcept {
+        for (const auto& transition : transitions_) {
+            if (transition.type_id == type_id && transition.add == add) {
+                return transition.archetype;
+            }
+        }
+        return nullptr;
+    }
+
+    void setTransition(uint32_t type_id, bool add, Archetype* archetype) {
+        transitions_.pushBack({type_id, add, archetype});
+    }
+
+    ~Archetype() {
+        clear();
+        for (auto chunk : chunks_) {
+            ::operator delete(chunk, std::align_val_t(kChunkAlignment));
+        }
+    }
+
+private:
+    struct Transition {
+        uint32_t type_id;
+        bool add;
+        Archetype* archetype;
+    };
+
+    std::size_t computeLayout(uint32_t capacity) noexcept {
+        std::size_t offset = sizeof(Entity) * capacity;
+        for (std::size_t i = 0; i < types_.size(); ++i) {
+            auto alignment = types_[i]->alignment;
+            offset = (offset + alignment - 1) / alignment * alignment;
+            column_offsets_[i] = offset;
+            offset += types_[i]->size * capacity;
+        }
+        return offset;
+    }
+
+    void allocateChunk() {
+        auto chunk = static_cast<std::byte*>(::operator new(chunk_bytes_, std::align_val_t(kChunkAlignment)));
+        try {
+            chunks_.pushBack(chunk);
+        } catch (...) {
+            ::operator delete(chunk, std::align_val_t(kChunkAlignment));
+            throw;
+        }
+    }
+
+    Vector<const ComponentTypeInfo*> types_;
+    Vector<std::size_t> column_offsets_;
+    Vector<std::byte*> chunks_;
+    Vector<Transition> transitions_;
+    std::size_t chunk_bytes_;
+    uint32_t chunk_capacity_;
+    uint32_t size_;
+};
+
+}  // namespace nxt::core
@@ -0,0 +1,509 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Archetype.h"
+#include "Entity.h"
+#include "../Container/Vector.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Cached result of a query for all the archetypes having a set of component types. A query is kept up to
+ *        date by the ArchetypeStorage owning it: it only changes when a new archetype is created, adding or removing
+ *        entities is seen by the next iteration without any work.
+ *
+ */
+class ArchetypeQuery {
+public:
+    /**
+     * @brief Construct an empty query
+     *
+     * @param type_ids Ids of the component types in the order in which they are accessed
+     */
+    explicit ArchetypeQuery(Vector<uint32_t> type_ids)
+        : type_ids_(std::move(type_ids)) {}
+
+    ArchetypeQuery(const ArchetypeQuery&) = delete;
+    ArchetypeQuery& operator=(const ArchetypeQuery&) = delete;
+
+    [[nodiscard]] const Vector<uint32_t>& getTypeIds() const noexcept {
+        return type_ids_;
+    }
+
+    /**
+     * @brief Number of archetypes matched by the query, including the empty ones
+     */
+    [[nodiscard]] std::size_t getArchetypeCount() const noexcept {
+        return archetypes_.size();
+    }
+
+    [[nodiscard]] Archetype& getArchetype(std::size_t index) const noexcept {
+        return *archetypes_[index];
+    }
+
+    /**
+     * @brief Get the columns of the queried types in a matched archetype, in the same order as getTypeIds()
+     */
+    [[nodiscard]] const std::size_t* getColumnIndices(std::size_t index) const noexcept {
+        return column_indices_.data() + index * type_ids_.size();
+    }
+
+    /**
+     * @brief Number of entities matched by the query
+     */
+    [[nodiscard]] std::size_t getEntityCount() const noexcept {
+        std::size_t count = 0;
+        for (auto archetype : archetypes_) {
+            count += archetype->size();
+        }
+        return count;
+    }
+
+    /**
+     * @brief Add the archetype to the query if it has all the queried types
+     *
+     * @return True if the archetype was added, false otherwise
+     */
+    bool tryAddArchetype(Archetype& archetype) {
+        auto first_column = column_indices_.size();
+        column_indices_.reserve(first_column + type_ids_.size());
+        for (auto type_id : type_ids_) {
+            auto column_index = archetype.getColumnIndex(type_id);
+            if (column_index == Archetype::kInvalidColumn) {
+                column_indices_.resize(first_column);
+                return false;
+            }
+            column_indices_.pushBack(column_index);
+        }
+
+        try {
+            archetypes_.pushBack(&archetype);
+        } catch (...) {
+            column_indices_.resize(first_column);
+            throw;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Call func for every matched entity, either as func(entity, components&...) or func(components&...)
+     *
+     * @tparam Ts Component types in the same order as the type ids of the query, can be const qualified
+     */
+    template<typename... Ts, typename Func>
+    void each(Func& func) const {
+        for (std::size_t i = 0; i < archetypes_.size(); ++i) {
+            if (!archetypes_[i]->empty()) {
+                eachInArchetype<Ts...>(*archetypes_[i], getColumnIndices(i), func, std::index_sequence_for<Ts...>{});
+            }
+        }
+    }
+
+private:
+    template<typename... Ts, typename Func, std::size_t... Indices>
+    static void eachInArchetype(Archetype& archetype,
+                                const std::size_t* column_indices,
+                                Func& func,
+                                std::index_sequence<Indices...>) {
+        auto chunk_count = archetype.getChunkCount();
+        for (std::size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            auto entities = archetype.getEntities(chunk);
+            auto columns = std::make_tuple(
+                static_cast<Ts*>(archetype.getColumn<std::remove_const_t<Ts>>(chunk, column_indices[Indices]))...);
+            auto chunk_size = archetype.getChunkSize(chunk);
+            for (uint32_t i = 0; i < chunk_size; ++i) {
+                if constexpr (std::is_invocable_v<Func&, const Entity&, Ts&...>) {
+                    func(static_cast<const Entity&>(entities[i]), std::get<Indices>(columns)[i]...);
+                } else {
+                    func(std::get<Indices>(columns)[i]...);
+                }
+            }
+        }
+    }
+
+    Vector<uint32_t> type_ids_;
+    Vector<Archetype*> archetypes_;
+    //! type_ids_.size() column indices for every matched archetype
+    Vector<std::size_t> column_indices_;
+};
+
+/**
+ * @brief Storage engine for plain component data. Every entity lives in the Archetype matching its set of
+ *        component types, adding or removing a component moves the entity to another Archetype. Iterating all the
+ *        entities with a given set of components walks the matching archetypes chunk by chunk and hands out typed
+ *        pointers into the columns, so there is no virtual dispatch or per entity lookup in the loop.
+ *
+ *        Entities without any component are not stored. Structural changes (adding or removing components or
+ *        entities) are not allowed while iterating.
+ *
+ */
+class ArchetypeStorage {
+public:
+    ArchetypeStorage() = default;
+
+    ArchetypeStorage(const ArchetypeStorage&) = delete;
+    ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+    /**
+     * @brief Add a component to the entity. If the entity already has the component, it is replaced by the new value
+     *
+     * @param entity Entity to which the component is added
+     * @param args Arguments used to construct the component
+     * @return Reference to the added component
+     */
+    template<typename T, typename... Args>
+    T& addComponent(const Entity& entity, Args&&... args) {
+        const auto& info = ComponentType<T>::getInfo();
+        auto location = findLocation(entity);
+        if (location != nullptr) {
+            auto column_index = location->archetype->getColumnIndex(info.id);
+            if (column_index != Archetype::kInvalidColumn) {
+                auto component = static_cast<T*>(location->archetype->getComponent(location->row, column_index));
+                *component = T(std::forward<Args>(args)...);
+                return *component;
+            }
+        }
+
+        auto source = location != nullptr ? location->archetype : nullptr;
+        if (location == nullptr) {
+            reserveLocation(entity.getIndex());
+        }
+        auto destination = getArchetypeWith(source, info);
+        auto row = destination->appendRow(entity);
+        auto column_index = destination->getColumnIndex(info.id);
+        T* component = nullptr;
+        try {
+            component = new (destination->getComponent(row, column_index)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            destination->removeRow(row);
+            throw;
+        }
+
+        moveEntity(location, entity, destination, row);
+        return *component;
+    }
+
+    /**
+     * @brief Remove a component from the entity
+     *
+     * @return True if the entity had the component, false otherwise
+     */
+    template<typename T>
+    bool removeComponent(const Entity& entity) {
+        auto type_id = ComponentType<T>::getId();
+        auto location = findLocation(entity);
+        if (location == nullptr) {
+            return false;
+        }
+
+        auto source = location->archetype;
+        auto column_index = source->getColumnIndex(type_id);
+        if (column_index == Archetype::kInvalidColumn) {
+            return false;
+        }
+
+        if (source->getTypes().size() == 1) {
+            source->destroyRow(location->row);
+            eraseRow(*location);
+            return true;
+        }
+
+        // reserve the destination row before touching the components so that an allocation failure leaves
+        // the entity unchanged
+        auto destination = getArchetypeWithout(source, type_id);
+        auto row = destination->appendRow(entity);
+        source->getTypes()[column_index]->destroy(source->getComponent(location->row, column_index));
+        moveEntity(location, entity, destination, row, column_index);
+        return true;
+    }
+
+    template<typename T>
+    [[nodiscard]] bool hasComponent(const Entity& entity) const noexcept {
+        auto location = findLocation(entity);
+        return location != nullptr && location->archetype->hasType(ComponentType<T>::getId());
+    }
+
+    /**
+     * @brief Get the component of the entity
+     *
+     * @return Pointer to the component or nullptr if the entity doesn't have the component. The pointer is
+     *         invalidated by the next structural change
+     */
+    template<typename T>
+    [[nodiscard]] T* getComponent(const Entity& entity) noexcept {
+        auto location = findLocation(entity);
+        if (location == nullptr) {
+            return nullptr;
+        }
+
+        auto column_index = location->archetype->getColumnIndex(ComponentType<T>::getId());
+        if (column_index == Archetype::kInvalidColumn) {
+            return nullptr;
+        }
+        return static_cast<T*>(location->archetype->getComponent(location->row, column_index));
+    }
+
+    template<typename T>
+    [[nodiscard]] const T* getComponent(const Entity& entity) const noexcept {
+        return const_cast<ArchetypeStorage*>(this)->getComponent<T>(entity);
+    }
+
+    /**
+     * @brief Remove the entity and destroy all of its components
+     *
+     * @return True if the entity had any component, false otherwise
+     */
+    bool removeEntity(const Entity& entity) noexcept {
+        auto location = findLocation(entity);
+        if (location == nullptr) {
+            return false;
+        }
+
+        location->archetype->destroyRow(location->row);
+        eraseRow(*location);
+        return true;
+    }
+
+    /**
+     * @brief Call func(entity, components&...) or func(components&...) for every entity which has all the given
+     *        component types
+     *
+     * @tparam Ts Component types required, can be const qualified
+     */
+    template<typename... Ts, typename Func>
+    void forEach(Func&& func) {
+        getQuery<Ts...>().template each<Ts...>(func);
+    }
+
+    /**
+     * @brief Get the cached query for the given component types, creating it on first use. The query stays valid
+     *        and up to date for the lifetime of the storage
+     *
+     * @tparam Ts Component types of the query, can be const qualified
+     */
+    template<typename... Ts>
+    [[nodiscard]] const ArchetypeQuery& getQuery() {
+        static_assert(sizeof...(Ts) > 0, "At least one component type is required");
+        const std::array<uint32_t, sizeof...(Ts)> type_ids = {ComponentType<std::remove_const_t<Ts>>::getId()...};
+        for (const auto& query : queries_) {
+            const auto& query_type_ids = query->getTypeIds();
+            if (std::equal(query_type_ids.begin(), query_type_ids.end(), type_ids.begin(), type_ids.end())) {
+                return *query;
+            }
+        }
+        return createQuery(Vector<uint32_t>(type_ids.begin(), type_ids.end()));
+    }
+
+    /**
+     * @brief Number of archetypes created so far. Archetypes are kept alive even when they become empty
+     */
+    [[nodiscard]] std::size_t getArchetypeCount() const noexcept {
+        return archetypes_.size();
+    }
+
+    /**
+     * @brief Destroy all the stored entities and their components
+     */
+    void clear() noexcept {
+        for (const auto& archetype : archetypes_) {
+            archetype->clear();
+        }
+
+        for (auto& location : locations_) {
+            location = EntityLocation();
+        }
+    }
+
+private:
+    struct EntityLocation {
+        Archetype* archetype = nullptr;
+        uint32_t row = 0;
+    };
+
+    [[nodiscard]] EntityLocation* findLocation(const Entity& entity) noexcept {
+        auto index = entity.getIndex();
+        if (index >= locations_.size()) {
+            return nullptr;
+        }
+
+        auto& location = locations_[index];
+        if (location.archetype == nullptr || location.archetype->getEntity(location.row) != entity) {
+            return nullptr;
+        }
+        return &location;
+    }
+
+    [[nodiscard]] const EntityLocation* findLocation(const Entity& entity) const noexcept {
+        return const_cast<ArchetypeStorage*>(this)->findLocation(entity);
+    }
+
+    /**
+     * @brief Relocate the components of the entity from its current archetype (if any) into the given row
+     *
+     * @param location Current location of the entity or nullptr if the entity isn't stored yet, in which case
+     *        its location must be already reserved
+     * @param skipped_column Column of the source archetype which is already destroyed
+     */
+    void moveEntity(EntityLocation* location,
+                    const Entity& entity,
+                    Archetype* destination,
+                    uint32_t row,
+                    std::size_t skipped_column = Archetype::kInvalidColumn) noexcept {
+        if (location != nullptr) {
+            auto source = location->archetype;
+            const auto& source_types = source->getTypes();
+            for (std::size_t i = 0; i < source_types.size(); ++i) {
+                if (i != skipped_column) {
+                    auto column_index = destination->getColumnIndex(source_types[i]->id);
+                    source_types[i]->relocate(destination->getComponent(row, column_index),
+                                              source->getComponent(location->row, i));
+                }
+            }
+            eraseRow(*location);
+        } else {
+            location = &locations_[entity.getIndex()];
+        }
+
+        location->archetype = destination;
+        location->row = row;
+    }
+
+    void reserveLocation(uint32_t index) {
+        if (index >= locations_.size()) {
+            if (index >= locations_.capacity()) {
+                locations_.reserve(std::max<std::size_t>(locations_.capacity() * 2, index + 1));
+            }
+            locations_.resize(index + 1);
+        }
+    }
+
+    /**
+     * @brief Remove the row of an entity whose components are already destroyed or relocated
+     */
+    void eraseRow(EntityLocation& location) noexcept {
+        auto moved_entity = location.archetype->removeRow(location.row);
+        if (moved_entity.isValid()) {
+            locations_[moved_entity.getIndex()].row = location.row;
+        }
+        location = EntityLocation();
+    }
+
+    Archetype* getArchetypeWith(Archetype* source, const ComponentTypeInfo& info) {
+        if (source != nullptr) {
+            if (auto archetype = source->getTransition(info.id, true)) {
+                return archetype;
+            }
+        }
+
+        Vector<const ComponentTypeInfo*> types;
+        if (source != nullptr) {
+            types.reserve(source->getTypes().size() + 1);
+            for (auto type : source->getTypes()) {
+                if (type->id > info.id && (types.empty() || types.back()->id < info.id)) {
+                    types.pushBack(&info);
+                }
+                types.pushBack(type);
+            }
+        }
+        if (types.empty() || types.back()->id < info.id) {
+            types.pushBack(&info);
+        }
+
+        auto archetype = getOrCreateArchetype(std::move(types));
+        if (source != nullptr) {
+            source->setTransition(info.id, true, archetype);
+        }
+        return archetype;
+    }
+
+    Archetype* getArchetypeWithout(Archetype* source, uint32_t type_id) {
+        if (auto archetype = source->getTransition(type_id, false)) {
+            return archetype;
+        }
+
+        Vector<const ComponentTypeInfo*> types;
+        types.reserve(source->getTypes().size() - 1);
+        for (auto type : source->getTypes()) {
+            if (type->id != type_id) {
+                types.pushBack(type);
+            }
+        }
+
+        auto archetype = getOrCreateArchetype(std::move(types));
+        source->setTransition(type_id, false, archetype);
+        return archetype;
+    }
+
+    /**
+     * @brief Find the archetype with exactly the given types. This is only reached when the transition between
+     *        two archetypes is not cached yet, so a linear search is good enough
+     */
+    Archetype* getOrCreateArchetype(Vector<const ComponentTypeInfo*> types) {
+        for (const auto& archetype : archetypes_) {
+            if (archetype->getTypes() == types) {
+                return archetype.get();
+            }
+        }
+
+        archetypes_.emplaceBack(std::make_unique<Archetype>(std::move(types)));
+        auto archetype = archetypes_.back().get();
+        for (auto type : archetype->getTypes()) {
+            if (type->id >= type_archetypes_.size()) {
+                type_archetypes_.resize(type->id + 1);
+            }
+            type_archetypes_[type->id].pushBack(archetype);
+        }
+
+        // keep the cached queries up to date, this is the only structural change they care about
+        for (const auto& query : queries_) {
+            query->tryAddArchetype(*archetype);
+        }
+        return archetype;
+    }
+
+    /**
+     * @brief Create a query and fill it with the archetypes having all the types. The type stored in the fewest
+     *        archetypes drives the search, the other types are only checked on its archetypes
+     */
+    const ArchetypeQuery& createQuery(Vector<uint32_t> type_ids) {
+        auto query = std::make_unique<ArchetypeQuery>(std::move(type_ids));
+
+        const Vector<Archetype*>* driver = nullptr;
+        for (auto type_id : query->getTypeIds()) {
+            if (type_id >= type_archetypes_.size()) {
+                driver = nullptr;
+                break;
+            }
+
+            if (driver == nullptr || type_archetypes_[type_id].size() < driver->size()) {
+                driver = &type_archetypes_[type_id];
+            }
+        }
+
+        if (driver != nullptr) {
+            for (auto archetype : *driver) {
+                query->tryAddArchetype(*archetype);
+            }
+        }
+
+        queries_.emplaceBack(std::move(query));
+        return *queries_.back();
+    }
+
+    Vector<std::unique_ptr<Archetype>> archetypes_;
+    //! archetypes having a component type, indexed by the type id
+    Vector<Vector<Archetype*>> type_archetypes_;
+    Vector<std::unique_ptr<ArchetypeQuery>> queries_;
+    //! location of every stored entity indexed by the entity index
+    Vector<EntityLocation> locations_;
+};
+
+}  // namespace nxt::core
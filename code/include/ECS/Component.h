@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <string>
+
 #include "Entity.h"
 #include "../Container/Key.h"
 
@@ -11,6 +14,9 @@ namespace nxt::core {
 template<class T>
 struct ComponentLookup {};
 
+//! ComponentLookup<T>::component_id of a component which isn't registered
+constexpr std::size_t kInvalidComponentId = static_cast<std::size_t>(-1);
+
 /**
  * @brief Abstract base class for all Components
  *
@@ -24,7 +30,7 @@ public:
      * @param entity Entity to be added to the component
      * @return Key of the added entity in the component
      */
-    virtual Key addEntity(const Entity& entity) noexcept = 0;
+    virtual Key addEntity(const Entity& entity) = 0;
 
     /**
      * @brief Check if the given entity is present in the Component
@@ -44,6 +50,19 @@ public:
      */
     virtual bool removeEntity(const Entity& entity) noexcept = 0;
 
+    /**
+     * @brief Remove many entities at once. Default implementation calls removeEntity() for each of them,
+     *        components override it when they can remove a batch more efficiently
+     *
+     * @param entities Pointer to the first entity to remove
+     * @param count Number of entities to remove
+     */
+    virtual void removeEntities(const Entity* entities, std::size_t count) noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            removeEntity(entities[i]);
+        }
+    }
+
     /**
      * @brief Check if the given key points to a valid entity in the Component
      *
@@ -95,7 +114,7 @@ public:
  * @brief Use this macro to define a already registered component
  *
  */
-#define NXTCORE_DEFINE_COMPONENT(Component)               \
-    namespace nxt::core {                                 \
-    size_t ComponentLookup<Component>::component_id = -1; \
+#define NXTCORE_DEFINE_COMPONENT(Component)                                \
+    namespace nxt::core {                                                  \
+    size_t ComponentLookup<Component>::component_id = kInvalidComponentId; \
     }
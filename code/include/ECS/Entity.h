@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <unordered_map>
@@ -65,6 +66,18 @@ public:
         return index_ != rhs.index_ || generation_ != rhs.generation_;
     }
 
+    /**
+     * @brief Get the index of the Entity. Indices of alive entities are unique and densely packed, so they can be
+     *        used to index arrays
+     */
+    [[nodiscard]] constexpr uint32_t getIndex() const noexcept {
+        return index_;
+    }
+
+    [[nodiscard]] constexpr uint32_t getGeneration() const noexcept {
+        return generation_;
+    }
+
     [[nodiscard]] std::string getString() const noexcept {
         return std::to_string(index_) + '_' + std::to_string(generation_);
     }
@@ -83,6 +96,8 @@ private:
     //! current entity generation
     uint32_t generation_ = 0;
 };
+
+inline const Entity Entity::kInvalidEntity{};
 }  // namespace core
 
 namespace std {
@@ -91,7 +106,12 @@ namespace std {
 template<>
 struct hash<nxt::core::Entity> {
     size_t operator()(const nxt::core::Entity& entity) const noexcept {
-        return entity.index_;
+        // mix index and generation (splitmix64 finalizer) so that entities of the same index don't collide and
+        // consecutive indices spread over the buckets
+        auto value = (static_cast<uint64_t>(entity.generation_) << 32) | entity.index_;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return static_cast<size_t>(value ^ (value >> 31));
     }
 };
 }  // namespace std
@@ -0,0 +1,386 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "Entity.h"
+#include "EntityManager.h"
+#include "../Algorithm/Sort.h"
+#include "../Container/Vector.h"
+
+namespace nxt::core {
+
+class DeferredEntityCommands;
+
+/**
+ * @brief Records structural changes (creating and destroying entities, adding and removing components) to be applied
+ *        later by DeferredEntityCommands::playback(). A buffer is only used by a single thread, so recording doesn't
+ *        need any synchronization.
+ *
+ *        Entities created through the buffer are placeholders till the playback. They can be used in the other
+ *        commands of any buffer of the same DeferredEntityCommands, but not with the EntityManager directly.
+ *
+ */
+class EntityCommandBuffer {
+public:
+    EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+    EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+    /**
+     * @brief Set the sort key of the commands recorded from now on. Playback applies the commands in increasing
+     *        sort key order, commands with the same key are applied in the order they were recorded. Use distinct
+     *        keys (for example the index of a system or of a parallel job) for work recorded from different
+     *        threads to get the same order every run
+     */
+    void setSortKey(uint64_t sort_key) noexcept {
+        sort_key_ = sort_key;
+    }
+
+    [[nodiscard]] uint64_t getSortKey() const noexcept {
+        return sort_key_;
+    }
+
+    /**
+     * @brief Record the creation of an entity
+     *
+     * @return Placeholder for the entity, replaced by the created entity during the playback
+     */
+    [[nodiscard]] Entity createEntity(bool temporary = false);
+
+    /**
+     * @brief Record the destruction of an entity
+     */
+    void destroyEntity(const Entity& entity) {
+        commands_.pushBack({CommandType::kDestroyEntity, sort_key_, entity, false, nullptr, nullptr, nullptr});
+    }
+
+    /**
+     * @brief Record adding a component to an entity. The component is constructed now and moved to the
+     *        EntityManager during the playback
+     */
+    template<typename T, typename... Args>
+    void addComponent(const Entity& entity, Args&&... args) {
+        commands_.reserve(commands_.size() + 1);
+        auto component = new (allocatePayload(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        commands_.pushBack(
+            {CommandType::kAddComponent, sort_key_, entity, false, component, &applyAdd<T>, &destroy<T>});
+    }
+
+    /**
+     * @brief Record removing a component from an entity
+     */
+    template<typename T>
+    void removeComponent(const Entity& entity) {
+        commands_.pushBack(
+            {CommandType::kRemoveComponent, sort_key_, entity, false, nullptr, &applyRemove<T>, nullptr});
+    }
+
+    /**
+     * @brief Number of recorded commands
+     */
+    [[nodiscard]] std::size_t size() const noexcept {
+        return commands_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return commands_.empty();
+    }
+
+    ~EntityCommandBuffer() {
+        clear();
+        for (auto block : blocks_) {
+            ::operator delete(block, std::align_val_t(kBlockAlignment));
+        }
+    }
+
+private:
+    friend class DeferredEntityCommands;
+
+    enum class CommandType : uint8_t { kCreateEntity, kDestroyEntity, kAddComponent, kRemoveComponent };
+
+    using ApplyFunction = void (*)(EntityManager& manager, const Entity& entity, void* payload);
+    using DestroyFunction = void (*)(void* payload) noexcept;
+
+    struct Command {
+        CommandType type;
+        uint64_t sort_key;
+        Entity entity;
+        bool temporary;
+        void* payload;
+        ApplyFunction apply;
+        DestroyFunction destroy;
+    };
+
+    static constexpr std::size_t kBlockSize = 4096;
+    static constexpr std::size_t kBlockAlignment = 64;
+
+    explicit EntityCommandBuffer(DeferredEntityCommands& owner) noexcept
+        : owner_(owner) {}
+
+    template<typename T>
+    static void applyAdd(EntityManager& manager, const Entity& entity, void* payload) {
+        manager.addComponent<T>(entity, std::move(*static_cast<T*>(payload)));
+    }
+
+    template<typename T>
+    static void applyRemove(EntityManager& manager, const Entity& entity, void*) {
+        manager.removeComponent<T>(entity);
+    }
+
+    template<typename T>
+    static void destroy(void* payload) noexcept {
+        static_cast<T*>(payload)->~T();
+    }
+
+    /**
+     * @brief Bump allocate memory for a component from the blocks of the buffer. Blocks are reused after clear()
+     */
+    void* allocatePayload(std::size_t size, std::size_t alignment) {
+        static_assert(kBlockSize % kBlockAlignment == 0);
+        auto offset = (block_offset_ + alignment - 1) / alignment * alignment;
+        if (current_block_ >= blocks_.size() || offset + size > getBlockSize(current_block_)) {
+            // oversized payloads get a block of their own, which is kept for reuse like the others
+            if (current_block_ < blocks_.size()) {
+                ++current_block_;
+            }
+
+            while (current_block_ < blocks_.size() && size > getBlockSize(current_block_)) {
+                ++current_block_;
+            }
+
+            if (current_block_ == blocks_.size()) {
+                auto block_size = std::max(size, kBlockSize);
+                block_sizes_.reserve(block_sizes_.size() + 1);
+                blocks_.reserve(blocks_.size() + 1);
+                blocks_.pushBack(static_cast<std::byte*>(
+                    ::operator new(block_size, std::align_val_t(kBlockAlignment))));
+                block_sizes_.pushBack(block_size);
+            }
+            offset = 0;
+        }
+
+        block_offset_ = offset + size;
+        return blocks_[current_block_] + offset;
+    }
+
+    [[nodiscard]] std::size_t getBlockSize(std::size_t block_index) const noexcept {
+        return block_sizes_[block_index];
+    }
+
+    /**
+     * @brief Destroy the recorded commands and keep the memory for the next frame
+     */
+    void clear() noexcept {
+        for (const auto& command : commands_) {
+            if (command.destroy != nullptr) {
+                command.destroy(command.payload);
+            }
+        }
+        commands_.clear();
+        current_block_ = 0;
+        block_offset_ = 0;
+    }
+
+    DeferredEntityCommands& owner_;
+    Vector<Command> commands_;
+    Vector<std::byte*> blocks_;
+    Vector<std::size_t> block_sizes_;
+    std::size_t current_block_ = 0;
+    std::size_t block_offset_ = 0;
+    uint64_t sort_key_ = 0;
+};
+
+/**
+ * @brief Set of per thread EntityCommandBuffer used to make structural changes from parallel code (for example
+ *        Systems updated on TaskQueue workers). Every thread records into its own buffer and playback() applies
+ *        all of them at a sync point, when no thread is recording anymore.
+ *
+ */
+class DeferredEntityCommands {
+public:
+    DeferredEntityCommands() = default;
+
+    DeferredEntityCommands(const DeferredEntityCommands&) = delete;
+    DeferredEntityCommands& operator=(const DeferredEntityCommands&) = delete;
+
+    /**
+     * @brief Get the buffer of the calling thread, creating it on first use. Only the first call of every thread
+     *        takes a lock
+     */
+    [[nodiscard]] EntityCommandBuffer& getThreadBuffer() {
+        thread_local ThreadCache cache;
+        if (cache.owner_id == id_ && cache.buffer != nullptr) {
+            return *cache.buffer;
+        }
+
+        auto thread_id = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(mutex_);
+        EntityCommandBuffer* buffer = nullptr;
+        for (const auto& thread_buffer : buffers_) {
+            if (thread_buffer.thread_id == thread_id) {
+                buffer = thread_buffer.buffer.get();
+                break;
+            }
+        }
+
+        if (buffer == nullptr) {
+            buffers_.reserve(buffers_.size() + 1);
+            buffers_.pushBack({thread_id, std::unique_ptr<EntityCommandBuffer>(new EntityCommandBuffer(*this))});
+            buffer = buffers_.back().buffer.get();
+        }
+
+        cache.owner_id = id_;
+        cache.buffer = buffer;
+        return *buffer;
+    }
+
+    /**
+     * @brief Apply the commands of all the buffers to the EntityManager and clear the buffers. Commands are applied
+     *        in increasing sort key order, commands with the same sort key keep the order in which each thread
+     *        recorded them. Which thread gets which buffer changes between runs, so threads recording in the same
+     *        playback must use distinct sort keys. Must not be called while other threads are recording.
+     *
+     *        The buffers are cleared even if applying a command throws, the commands after it are dropped.
+     *
+     * @return Number of commands applied
+     */
+    std::size_t playback(EntityManager& manager) {
+        struct CommandRef {
+            uint64_t sort_key;
+            uint32_t buffer_index;
+            uint32_t command_index;
+        };
+
+        // a throwing command must not leave the applied commands behind for the next playback
+        struct ClearOnExit {
+            ~ClearOnExit() {
+                commands.clear();
+            }
+
+            DeferredEntityCommands& commands;
+        } clear_on_exit{*this};
+
+        Vector<CommandRef> command_refs;
+        for (uint32_t i = 0; i < buffers_.size(); ++i) {
+            const auto& commands = buffers_[i].buffer->commands_;
+            for (uint32_t j = 0; j < commands.size(); ++j) {
+                command_refs.pushBack({commands[j].sort_key, i, j});
+            }
+        }
+
+        // refs are unique, so this gives a stable order without a stable sort
+        auto compare_refs = [](const CommandRef& lhs, const CommandRef& rhs) {
+            if (lhs.sort_key != rhs.sort_key) {
+                return lhs.sort_key < rhs.sort_key;
+            }
+            if (lhs.buffer_index != rhs.buffer_index) {
+                return lhs.buffer_index < rhs.buffer_index;
+            }
+            return lhs.command_index < rhs.command_index;
+        };
+        quickSort(command_refs.begin(), command_refs.end(), compare_refs);
+        for (std::size_t i = 1; i < command_refs.size(); ++i) {
+            assert((command_refs[i - 1].sort_key != command_refs[i].sort_key ||
+                    command_refs[i - 1].buffer_index == command_refs[i].buffer_index) &&
+                   "Commands recorded from different threads need distinct sort keys for a deterministic playback");
+        }
+
+        Vector<Entity> created_entities(next_placeholder_.load(std::memory_order_relaxed), Entity::kInvalidEntity);
+        auto resolve = [&created_entities](const Entity& entity) {
+            if (!isPlaceholder(entity)) {
+                return entity;
+            }
+
+            assert(entity.getIndex() < created_entities.size() &&
+                   "Placeholder was created by another DeferredEntityCommands");
+            return created_entities[entity.getIndex()];
+        };
+
+        for (const auto& command_ref : command_refs) {
+            auto& command = buffers_[command_ref.buffer_index].buffer->commands_[command_ref.command_index];
+            switch (command.type) {
+                case EntityCommandBuffer::CommandType::kCreateEntity:
+                    created_entities[command.entity.getIndex()] = manager.createEntity(command.temporary);
+                    break;
+                case EntityCommandBuffer::CommandType::kDestroyEntity:
+                    manager.destroyEntity(resolve(command.entity));
+                    break;
+                case EntityCommandBuffer::CommandType::kAddComponent:
+                case EntityCommandBuffer::CommandType::kRemoveComponent: {
+                    auto entity = resolve(command.entity);
+                    if (manager.isAlive(entity)) {
+                        command.apply(manager, entity, command.payload);
+                    }
+                    break;
+                }
+            }
+        }
+
+        return command_refs.size();
+    }
+
+    /**
+     * @brief Drop all the recorded commands without applying them
+     */
+    void clear() noexcept {
+        for (const auto& thread_buffer : buffers_) {
+            thread_buffer.buffer->clear();
+        }
+        next_placeholder_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Check if the entity is a placeholder returned by EntityCommandBuffer::createEntity(). Entities created
+     *        by the EntityManager never have a generation of 0
+     */
+    [[nodiscard]] static bool isPlaceholder(const Entity& entity) noexcept {
+        return entity.getGeneration() == 0 && entity != Entity::kInvalidEntity;
+    }
+
+private:
+    friend class EntityCommandBuffer;
+
+    struct ThreadBuffer {
+        std::thread::id thread_id;
+        std::unique_ptr<EntityCommandBuffer> buffer;
+    };
+
+    struct ThreadCache {
+        uint64_t owner_id = 0;
+        EntityCommandBuffer* buffer = nullptr;
+    };
+
+    [[nodiscard]] static uint64_t getNextId() noexcept {
+        static std::atomic<uint64_t> next_id{1};
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t allocatePlaceholder() noexcept {
+        return next_placeholder_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! unique id so that the per thread caches never hit a destroyed instance reusing the same address
+    const uint64_t id_ = getNextId();
+    std::mutex mutex_;
+    Vector<ThreadBuffer> buffers_;
+    std::atomic<uint32_t> next_placeholder_ = 0;
+};
+
+inline Entity
+EntityCommandBuffer::createEntity(bool temporary) {
+    commands_.reserve(commands_.size() + 1);
+    Entity placeholder(owner_.allocatePlaceholder(), 0);
+    commands_.pushBack({CommandType::kCreateEntity, sort_key_, placeholder, temporary, nullptr, nullptr, nullptr});
+    return placeholder;
+}
+
+}  // namespace nxt::core
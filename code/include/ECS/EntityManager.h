@@ -1,11 +1,18 @@
 #pragma once
 
+#include <cassert>
 #include <memory>
-#include <unordered_set>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
+#include "ArchetypeStorage.h"
 #include "Component.h"
 #include "Entity.h"
+#include "SparseSetComponent.h"
+#include "View.h"
 #include "../Event.h"
+#include "../Container/FlatHashMap.h"
 #include "../Container/SlotMap.h"
 
 namespace nxt::core {
@@ -23,6 +30,31 @@ private:
     Entity created_entity_;
 };
 
+/**
+ * @brief Event emitted once by EntityManager::createEntities() for the whole batch of created entities. No
+ *        EntityCreatedEvent is emitted for the entities of the batch. The entities aren't copied into the event,
+ *        they are only valid while the event is received
+ *
+ */
+class EntitiesCreatedEvent : public Event<EntitiesCreatedEvent> {
+public:
+    EntitiesCreatedEvent(const Entity* entities, std::size_t count)
+        : created_entities_(entities)
+        , created_count_(count) {}
+
+    const Entity* GetCreatedEntities() const noexcept {
+        return created_entities_;
+    }
+
+    std::size_t GetCreatedCount() const noexcept {
+        return created_count_;
+    }
+
+private:
+    const Entity* created_entities_;
+    std::size_t created_count_;
+};
+
 /**
  * @brief Manager class which controls the lifecycle of Entities in an Application.
  *        Current responsibility of this Manager includes:
@@ -44,6 +76,16 @@ public:
      */
     [[nodiscard]] Entity createEntity(bool temporary = false) noexcept;
 
+    /**
+     * @brief Create many entities at once. Storage for all of them is reserved up front and a single
+     *        EntitiesCreatedEvent is emitted for the whole batch
+     *
+     * @param count Number of entities to create
+     * @param temporary True if the created entities are temporary
+     * @return Newly created entities
+     */
+    [[nodiscard]] Vector<Entity> createEntities(std::size_t count, bool temporary = false);
+
     /**
      * @brief Checks if the given Entity is still alive
      *
@@ -95,37 +137,179 @@ public:
      */
     bool destroyEntity(const Entity& entity) noexcept;
 
+    /**
+     * @brief Destroy many entities at once. Entities which are not alive are skipped. Every registered component
+     *        gets a single removeEntities() call for the whole batch
+     *
+     * @param entities Pointer to the first entity to destroy
+     * @param count Number of entities to destroy
+     * @return Number of entities destroyed
+     */
+    std::size_t destroyEntities(const Entity* entities, std::size_t count);
+
+    std::size_t destroyEntities(const Vector<Entity>& entities) {
+        return destroyEntities(entities.data(), entities.size());
+    }
+
+    /**
+     * @brief Get a registered component. For a type derived from Component the registered instance is returned,
+     *        for any other type its SparseSetComponent
+     */
     template<class T>
-    [[nodiscard]] T* getComponent() const noexcept {
-        static_assert(std::is_base_of<core::Component, T>::value,
-                      "Can only get derived class of ess::core::Component class");
-        assert(ess::core::ComponentLookup<T>::component_id != -1 &&
-               "Component is not registered. Use RegisterComponent() first before using GetComponent()");
-        return static_cast<T*>(components_[ess::core::ComponentLookup<T>::component_id].get());
+    [[nodiscard]] auto getComponent() const noexcept {
+        if constexpr (std::is_base_of_v<core::Component, T>) {
+            assert(ComponentLookup<T>::component_id != kInvalidComponentId &&
+                   "Component is not registered. Use registerComponent() first before using getComponent()");
+            return static_cast<T*>(components_[ComponentLookup<T>::component_id].get());
+        } else {
+            auto sparse_set = findSparseSet<T>();
+            assert(sparse_set != nullptr &&
+                   "Component is not registered. Use registerComponent() first before using getComponent()");
+            return sparse_set;
+        }
     }
 
+    /**
+     * @brief Register a component. A type derived from Component is instantiated and registered as is. Any other
+     *        type gets a SparseSetComponent as storage, which addComponent(), removeComponent(), hasComponent() and
+     *        getComponent(entity) then use instead of the archetype storage. Register such types before adding
+     *        them to any entity, registering them again does nothing. forEach<T>() iterates the sparse set, views
+     *        and forEach() over several types only cover the types kept in the archetype storage
+     */
     template<class T>
     void registerComponent() {
-        static_assert(std::is_base_of<core::Component, T>::value,
-                      "Can only register derived class of ess::core::Component class");
-        T* component = new T;
-        components_.emplaceBack(component);
-        component_map_.emplace(component->getName(), component);
-        component->onRegister();
-        ess::core::ComponentLookup<T>::component_id = components_.Size() - 1;
+        if constexpr (std::is_base_of_v<core::Component, T>) {
+            auto component = std::make_unique<T>();
+            auto component_pointer = component.get();
+            components_.emplaceBack(std::move(component));
+            component_map_.emplace(component_pointer->getName(), component_pointer);
+            component_pointer->onRegister();
+            ComponentLookup<T>::component_id = components_.size() - 1;
+        } else {
+            // a second storage would orphan the values already added to the first one
+            if (findSparseSet<T>() != nullptr) {
+                return;
+            }
+
+            auto type_id = ComponentType<T>::getId();
+            if (type_id >= sparse_sets_.size()) {
+                sparse_sets_.resize(type_id + 1, nullptr);
+            }
+
+            auto component = std::make_unique<SparseSetComponent<T>>();
+            auto component_pointer = component.get();
+            components_.emplaceBack(std::move(component));
+            component_map_.emplace(component_pointer->getName(), component_pointer);
+            component_pointer->onRegister();
+            sparse_sets_[type_id] = component_pointer;
+        }
     }
 
     template<class T>
     [[nodiscard]] bool isComponentRegistered() const noexcept {
-        static_assert(std::is_base_of<core::Component, T>::value,
-                      "Can only query derived class of ess::core::Component class");
-        return ess::core::ComponentLookup<T>::component_id != -1;
+        if constexpr (std::is_base_of_v<core::Component, T>) {
+            return ComponentLookup<T>::component_id != kInvalidComponentId;
+        } else {
+            return findSparseSet<T>() != nullptr;
+        }
+    }
+
+    /**
+     * @brief Add a component to an alive entity. Types registered with registerComponent() are stored in their
+     *        SparseSetComponent, any other type in the archetype storage without needing a registration. If the
+     *        entity already has the component, it is replaced by the new value
+     *
+     * @param entity Entity to which the component is added
+     * @param args Arguments used to construct the component
+     * @return Reference to the added component, invalidated by the next structural change
+     */
+    template<class T, class... Args>
+    T& addComponent(const Entity& entity, Args&&... args) {
+        assert(isAlive(entity) && "Components can only be added to alive entities");
+        if (auto sparse_set = findSparseSet<T>()) {
+            return sparse_set->emplace(entity, std::forward<Args>(args)...);
+        }
+        return archetypes_.addComponent<T>(entity, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Remove a component from the entity
+     *
+     * @return True if the entity had the component, false otherwise
+     */
+    template<class T>
+    bool removeComponent(const Entity& entity) {
+        if (auto sparse_set = findSparseSet<T>()) {
+            return sparse_set->remove(entity);
+        }
+        return archetypes_.removeComponent<T>(entity);
+    }
+
+    template<class T>
+    [[nodiscard]] bool hasComponent(const Entity& entity) const noexcept {
+        if (auto sparse_set = findSparseSet<T>()) {
+            return sparse_set->contains(entity);
+        }
+        return archetypes_.hasComponent<T>(entity);
+    }
+
+    /**
+     * @brief Get the component data of the entity
+     *
+     * @return Pointer to the component or nullptr if the entity doesn't have the component
+     */
+    template<class T>
+    [[nodiscard]] T* getComponent(const Entity& entity) noexcept {
+        if (auto sparse_set = findSparseSet<T>()) {
+            return sparse_set->tryGet(entity);
+        }
+        return archetypes_.getComponent<T>(entity);
+    }
+
+    template<class T>
+    [[nodiscard]] const T* getComponent(const Entity& entity) const noexcept {
+        return const_cast<EntityManager*>(this)->getComponent<T>(entity);
+    }
+
+    /**
+     * @brief Call func(entity, components&...) or func(components&...) for every entity which has all the given
+     *        components. Entities and components must not be added or removed from inside func. A single type
+     *        registered with registerComponent() is iterated in its SparseSetComponent, several types must all be
+     *        kept in the archetype storage
+     *
+     * @tparam Ts Component types required
+     */
+    template<class... Ts, class Func>
+    void forEach(Func&& func) {
+        if constexpr (sizeof...(Ts) == 1) {
+            if (auto sparse_set = findSparseSet<std::remove_const_t<Ts>...>()) {
+                sparse_set->each(std::forward<Func>(func));
+                return;
+            }
+        } else {
+            assert(!hasSparseSet<Ts...>() &&
+                   "forEach() over several components can't include types registered with registerComponent()");
+        }
+        archetypes_.forEach<Ts...>(std::forward<Func>(func));
+    }
+
+    /**
+     * @brief Get a view over all the entities having the given components. Views share a cached query which is
+     *        only updated when a new combination of components appears, so they are cheap to get every frame.
+     *        Views only cover the archetype storage, use forEach<T>() for a type registered with registerComponent()
+     *
+     * @tparam Ts Component types of the view, const qualified types can only be read
+     */
+    template<class... Ts>
+    [[nodiscard]] View<Ts...> view() {
+        assert(!hasSparseSet<Ts...>() && "Views can't include types registered with registerComponent()");
+        return View<Ts...>(archetypes_);
     }
 
     EntityManager(const EntityManager&) = delete;
     EntityManager& operator=(const EntityManager&) = delete;
 
-    [[nodiscard]] Component* getComponent(const std::string& name) const noexcept {
+    [[nodiscard]] Component* getComponent(std::string_view name) const noexcept {
         auto iter = component_map_.find(name);
         if (iter != component_map_.end()) {
             return iter->second;
@@ -141,6 +325,26 @@ public:
 
 private:
     EntityManager() = default;
+
+    template<class T>
+    [[nodiscard]] SparseSetComponent<T>* findSparseSet() const noexcept {
+        auto type_id = ComponentType<T>::getId();
+        if (type_id < sparse_sets_.size()) {
+            return static_cast<SparseSetComponent<T>*>(sparse_sets_[type_id]);
+        }
+        return nullptr;
+    }
+
+    //! Check if any of the types is stored in a SparseSetComponent
+    template<class... Ts>
+    [[nodiscard]] bool hasSparseSet() const noexcept {
+        return (... || (findSparseSet<std::remove_const_t<Ts>>() != nullptr));
+    }
+
+    /**
+     * @brief Add a new entity to the entity slot maps without emitting any event
+     */
+    Entity insertEntity(bool temporary);
     /**
      * @brief
      *
@@ -165,6 +369,9 @@ private:
     SlotMap<EntityInfo> entities_;
     SlotMap<Entity> entity_storage_;
     Vector<std::unique_ptr<Component>> components_;
-    std::unordered_map<std::string, Component*> component_map_;
+    FlatHashMap<std::string, Component*, StringHash, std::equal_to<>> component_map_;
+    ArchetypeStorage archetypes_;
+    //! SparseSetComponent of the registered types not derived from Component, indexed by the component type id
+    Vector<Component*> sparse_sets_;
 };
 }  // namespace nxt::core
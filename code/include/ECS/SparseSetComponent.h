@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "Component.h"
+#include "Entity.h"
+#include "../Container/Key.h"
+#include "../Container/Vector.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Component storing a value of type T per entity in a sparse set. A paged sparse array indexed by the entity
+ *        index points into dense arrays of entities and values, so add, remove and lookup are O(1) and iterating
+ *        touches only contiguous memory. Removal moves the last value into the hole to keep the dense arrays packed,
+ *        so the order of the values changes on removal.
+ *
+ *        This is the storage used by EntityManager::registerComponent<T>() for types not derived from Component.
+ *
+ * @tparam T Type of the value stored per entity
+ * @tparam PageSize Number of entity indices covered by a page of the sparse array
+ */
+template<typename T, std::size_t PageSize = 4096>
+class SparseSetComponent : public Component {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = typename Vector<T>::iterator;
+    using const_iterator = typename Vector<T>::const_iterator;
+
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+    static constexpr std::size_t page_size = PageSize;
+
+    explicit SparseSetComponent(std::string name = typeid(T).name())
+        : name_(std::move(name)) {}
+
+    [[nodiscard]] const std::string& getName() const noexcept override {
+        return name_;
+    }
+
+    /**
+     * @brief Add the entity with a value initialized T. Does nothing if the entity is already present
+     *
+     * @return Key of the entity in the component
+     */
+    Key addEntity(const Entity& entity) override {
+        if constexpr (std::is_default_constructible_v<T>) {
+            if (!hasEntity(entity)) {
+                emplace(entity);
+            }
+            return getKey(entity);
+        } else {
+            return Key(kInvalidIndex, 0);
+        }
+    }
+
+    [[nodiscard]] bool hasEntity(const Entity& entity) const noexcept override {
+        return findDenseIndex(entity) != kInvalidIndex;
+    }
+
+    bool removeEntity(const Entity& entity) noexcept override {
+        return remove(entity);
+    }
+
+    void removeEntities(const Entity* entities, std::size_t count) noexcept override {
+        for (std::size_t i = 0; i < count; ++i) {
+            remove(entities[i]);
+        }
+    }
+
+    /**
+     * @brief Keys of the component are the index and generation of the entity, so they stay valid as values move
+     *        around in the dense arrays
+     */
+    [[nodiscard]] bool isValid(const Key& key) const noexcept override {
+        return hasEntity(Entity(key.index, key.generation));
+    }
+
+    [[nodiscard]] Key getKey(const core::Entity& entity) const noexcept override {
+        if (hasEntity(entity)) {
+            return Key(entity.getIndex(), entity.getGeneration());
+        }
+        return Key(kInvalidIndex, 0);
+    }
+
+    void onRegister() override {}
+
+    /**
+     * @brief Add a value for the entity. If the entity already has a value, it is replaced
+     *
+     * @return Reference to the stored value, invalidated by the next add or remove
+     */
+    template<typename... Args>
+    T& emplace(const Entity& entity, Args&&... args) {
+        auto& sparse_index = getOrCreateSparseIndex(entity.getIndex());
+        if (sparse_index != kInvalidIndex) {
+            // also reached for a stale entity of the same index which was never removed
+            dense_entities_[sparse_index] = entity;
+            dense_values_[sparse_index] = T(std::forward<Args>(args)...);
+            return dense_values_[sparse_index];
+        }
+
+        dense_entities_.reserve(dense_entities_.size() + 1);
+        dense_values_.emplaceBack(std::forward<Args>(args)...);
+        dense_entities_.pushBack(entity);
+        sparse_index = static_cast<uint32_t>(dense_values_.size() - 1);
+        return dense_values_.back();
+    }
+
+    /**
+     * @brief Remove the value of the entity by moving the last value into its place
+     *
+     * @return True if the entity had a value, false otherwise
+     */
+    bool remove(const Entity& entity) noexcept {
+        auto dense_index = findDenseIndex(entity);
+        if (dense_index == kInvalidIndex) {
+            return false;
+        }
+
+        auto last_index = static_cast<uint32_t>(dense_values_.size() - 1);
+        if (dense_index != last_index) {
+            dense_values_[dense_index] = std::move(dense_values_[last_index]);
+            dense_entities_[dense_index] = dense_entities_[last_index];
+            sparseIndexAt(dense_entities_[dense_index].getIndex()) = dense_index;
+        }
+
+        sparseIndexAt(entity.getIndex()) = kInvalidIndex;
+        dense_values_.popBack();
+        dense_entities_.popBack();
+        return true;
+    }
+
+    [[nodiscard]] bool contains(const Entity& entity) const noexcept {
+        return hasEntity(entity);
+    }
+
+    /**
+     * @brief Get the value of the entity
+     *
+     * @return Pointer to the value or nullptr if the entity doesn't have one
+     */
+    [[nodiscard]] T* tryGet(const Entity& entity) noexcept {
+        auto dense_index = findDenseIndex(entity);
+        return dense_index != kInvalidIndex ? &dense_values_[dense_index] : nullptr;
+    }
+
+    [[nodiscard]] const T* tryGet(const Entity& entity) const noexcept {
+        auto dense_index = findDenseIndex(entity);
+        return dense_index != kInvalidIndex ? &dense_values_[dense_index] : nullptr;
+    }
+
+    /**
+     * @brief Call func(entity, value&) or func(value&) for every stored value in the dense order
+     */
+    template<typename Func>
+    void each(Func&& func) {
+        for (size_type i = 0; i < dense_values_.size(); ++i) {
+            if constexpr (std::is_invocable_v<Func&, const Entity&, T&>) {
+                func(static_cast<const Entity&>(dense_entities_[i]), dense_values_[i]);
+            } else {
+                func(dense_values_[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Entities having a value, in the same order as the values
+     */
+    [[nodiscard]] const Vector<Entity>& getEntities() const noexcept {
+        return dense_entities_;
+    }
+
+    [[nodiscard]] T* data() noexcept {
+        return dense_values_.data();
+    }
+
+    [[nodiscard]] const T* data() const noexcept {
+        return dense_values_.data();
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return dense_values_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return dense_values_.empty();
+    }
+
+    iterator begin() noexcept {
+        return dense_values_.begin();
+    }
+
+    const_iterator begin() const noexcept {
+        return dense_values_.begin();
+    }
+
+    iterator end() noexcept {
+        return dense_values_.end();
+    }
+
+    const_iterator end() const noexcept {
+        return dense_values_.end();
+    }
+
+    /**
+     * @brief Remove all the values. Pages of the sparse array are kept
+     */
+    void clear() noexcept {
+        for (const auto& entity : dense_entities_) {
+            sparseIndexAt(entity.getIndex()) = kInvalidIndex;
+        }
+        dense_values_.clear();
+        dense_entities_.clear();
+    }
+
+private:
+    [[nodiscard]] uint32_t findDenseIndex(const Entity& entity) const noexcept {
+        auto page_index = entity.getIndex() / page_size;
+        if (page_index >= sparse_pages_.size() || sparse_pages_[page_index] == nullptr) {
+            return kInvalidIndex;
+        }
+
+        auto dense_index = sparse_pages_[page_index][entity.getIndex() % page_size];
+        if (dense_index == kInvalidIndex || dense_entities_[dense_index] != entity) {
+            return kInvalidIndex;
+        }
+        return dense_index;
+    }
+
+    uint32_t& sparseIndexAt(uint32_t entity_index) noexcept {
+        return sparse_pages_[entity_index / page_size][entity_index % page_size];
+    }
+
+    uint32_t& getOrCreateSparseIndex(uint32_t entity_index) {
+        auto page_index = entity_index / page_size;
+        if (page_index >= sparse_pages_.size()) {
+            sparse_pages_.resize(page_index + 1);
+        }
+
+        auto& page = sparse_pages_[page_index];
+        if (page == nullptr) {
+            page = std::make_unique<uint32_t[]>(page_size);
+            for (std::size_t i = 0; i < page_size; ++i) {
+                page[i] = kInvalidIndex;
+            }
+        }
+        return page[entity_index % page_size];
+    }
+
+    std::string name_;
+    Vector<std::unique_ptr<uint32_t[]>> sparse_pages_;
+    Vector<Entity> dense_entities_;
+    Vector<T> dense_values_;
+};
+
+}  // namespace nxt::core
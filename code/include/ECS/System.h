@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+#include "Archetype.h"
+#include "../Container/Vector.h"
+
 namespace nxt::core {
 /**
  * @brief
@@ -11,6 +16,9 @@ namespace nxt::core {
 template<class T>
 struct SystemLookup {};
 
+//! SystemLookup<T>::system_id of a system which isn't registered
+constexpr std::size_t kInvalidSystemId = static_cast<std::size_t>(-1);
+
 /**
  * @brief Abstract base class for all Systems. A System is higher level abstraction over multiple components which would
  *        make it decisions based on the data changes or events
@@ -49,9 +57,82 @@ public:
     bool onProjectUnloaded() noexcept {
         return doProjectUnload();
     }
+
+    /**
+     * @brief Function called by System Manager once per frame. When systems are updated in parallel, the System
+     *        must only access the components it declared with reads() and writes()
+     *
+     * @param delta_time Time elapsed since the last update in seconds
+     */
+    void onUpdate(double delta_time) noexcept {
+        doUpdate(delta_time);
+    }
+
+    /**
+     * @brief Ids of the component types the System reads
+     */
+    [[nodiscard]] const Vector<uint32_t>& getReadComponents() const noexcept {
+        return read_components_;
+    }
+
+    /**
+     * @brief Ids of the component types the System writes
+     */
+    [[nodiscard]] const Vector<uint32_t>& getWriteComponents() const noexcept {
+        return write_components_;
+    }
+
+    /**
+     * @brief Check if the System has to run alone. Systems which haven't declared their component accesses are
+     *        exclusive, so they are never run concurrently with other systems
+     */
+    [[nodiscard]] bool isExclusive() const noexcept {
+        return exclusive_;
+    }
+
+    /**
+     * @brief Check if the System can't run concurrently with the other System, i.e if either of them is exclusive
+     *        or one of them writes a component the other one reads or writes
+     */
+    [[nodiscard]] bool conflictsWith(const System& other) const noexcept {
+        if (exclusive_ || other.exclusive_) {
+            return true;
+        }
+
+        return containsAny(write_components_, other.read_components_) ||
+               containsAny(write_components_, other.write_components_) ||
+               containsAny(other.write_components_, read_components_);
+    }
+
     virtual ~System() = default;
 
 protected:
+    /**
+     * @brief Declare the component types read by the System. Usually called from doRegister()
+     */
+    template<class... Ts>
+    void reads() {
+        (addComponentAccess(read_components_, ComponentType<Ts>::getId()), ...);
+        exclusive_ = false;
+    }
+
+    /**
+     * @brief Declare the component types read and written by the System. Usually called from doRegister()
+     */
+    template<class... Ts>
+    void writes() {
+        (addComponentAccess(write_components_, ComponentType<Ts>::getId()), ...);
+        exclusive_ = false;
+    }
+
+    /**
+     * @brief Mark the System exclusive or not. Use setExclusive(false) for a System which doesn't access any
+     *        component but can run concurrently with others
+     */
+    void setExclusive(bool exclusive) noexcept {
+        exclusive_ = exclusive;
+    }
+
     /**
      * @brief
      *
@@ -69,6 +150,37 @@ protected:
      *
      */
     virtual bool doProjectUnload() noexcept = 0;
+
+    /**
+     * @brief Update the System. Default implementation does nothing
+     *
+     */
+    virtual void doUpdate(double /*delta_time*/) noexcept {}
+
+private:
+    static void addComponentAccess(Vector<uint32_t>& components, uint32_t component_id) {
+        for (auto id : components) {
+            if (id == component_id) {
+                return;
+            }
+        }
+        components.pushBack(component_id);
+    }
+
+    [[nodiscard]] static bool containsAny(const Vector<uint32_t>& lhs, const Vector<uint32_t>& rhs) noexcept {
+        for (auto lhs_id : lhs) {
+            for (auto rhs_id : rhs) {
+                if (lhs_id == rhs_id) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    Vector<uint32_t> read_components_;
+    Vector<uint32_t> write_components_;
+    bool exclusive_ = true;
 };
 }  // namespace nxt::core
 
@@ -100,7 +212,7 @@ protected:
  * @brief Use this macro to define a already registered system
  *
  */
-#define NXTCORE_DEFINE_SYSTEM(System)            \
-    namespace nxt::core {                        \
-    size_t SystemLookup<System>::system_id = -1; \
+#define NXTCORE_DEFINE_SYSTEM(System)                          \
+    namespace nxt::core {                                      \
+    size_t SystemLookup<System>::system_id = kInvalidSystemId; \
     }
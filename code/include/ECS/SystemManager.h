@@ -1,12 +1,18 @@
 #pragma once
 
+#include <cassert>
 #include <memory>
+#include <string>
+#include <string_view>
 
-#include "Vector.h"
+#include "../Container/FlatHashMap.h"
+#include "../Container/Vector.h"
 #include "System.h"
 
 namespace nxt::core {
 
+class TaskQueue;
+
 class SystemManager {
 public:
     static SystemManager* get() {
@@ -16,48 +22,72 @@ public:
 
     template<class T>
     T* getSystem() const noexcept {
-        static_assert(std::is_base_of<core::System, T>::value, "Can only get derived class of ess::core::System class");
-        assert(ess::core::SystemLookup<T>::system_id != -1 &&
+        static_assert(std::is_base_of<core::System, T>::value, "Can only get derived class of nxt::core::System class");
+        assert(SystemLookup<T>::system_id != kInvalidSystemId &&
                "System is not registered. Use registerSystem() first before using getSystem()");
-        return static_cast<T*>(systems_[ess::core::SystemLookup<T>::system_id].get());
+        return static_cast<T*>(systems_[SystemLookup<T>::system_id].get());
     }
 
     template<class T>
     void registerSystem() {
         static_assert(std::is_base_of<core::System, T>::value,
-                      "Can only register derived class of ess::core::System class");
-        T* system = new T;
-        if (system->OnRegister()) {
-            systems_.EmplaceBack(system);
-            system_name_map_.Emplace(system->GetName(), system);
+                      "Can only register derived class of nxt::core::System class");
+        auto system = std::make_unique<T>();
+        if (system->onRegister()) {
+            // the map only gets the system once it is owned, so a failed push leaves no dangling entry behind
+            auto system_pointer = system.get();
+            systems_.emplaceBack(std::move(system));
+            system_name_map_.emplace(system_pointer->getName(), system_pointer);
 
-            ess::core::SystemLookup<T>::system_id = systems_.Size() - 1;
+            SystemLookup<T>::system_id = systems_.size() - 1;
         }
     }
 
     template<class T>
-    void isSystemRegistered() const noexcept {
+    [[nodiscard]] bool isSystemRegistered() const noexcept {
         static_assert(std::is_base_of<core::System, T>::value,
-                      "Can only query derived class of ess::core::System class");
-        return ess::core::SystemLookup<T>::system_id != -1;
+                      "Can only query derived class of nxt::core::System class");
+        return SystemLookup<T>::system_id != kInvalidSystemId;
     }
 
     SystemManager(const SystemManager&) = delete;
     SystemManager& operator=(const SystemManager&) = delete;
 
-    System* getSystem(const std::string& name) const noexcept {
-        auto iter = system_name_map_.Find(name);
-        if (iter != system_name_map_.End()) {
+    System* getSystem(std::string_view name) const noexcept {
+        auto iter = system_name_map_.find(name);
+        if (iter != system_name_map_.end()) {
             return iter->second;
         }
         return nullptr;
     }
 
+    [[nodiscard]] std::size_t getSystemCount() const noexcept {
+        return systems_.size();
+    }
+
+    /**
+     * @brief Update all the systems one after the other in the order they were registered
+     *
+     * @param delta_time Time elapsed since the last update in seconds
+     */
+    void update(double delta_time) noexcept;
+
+    /**
+     * @brief Update all the systems on the workers of the task queue. A conflict graph is built from the component
+     *        accesses declared by the systems: systems which don't conflict run concurrently, conflicting systems
+     *        run in the order they were registered. Returns once every system is updated.
+     *
+     *        Falls back to update(delta_time) if the task queue isn't running or if called from one of its workers.
+     *
+     * @param delta_time Time elapsed since the last update in seconds
+     * @param task_queue TaskQueue whose workers run the systems
+     */
+    void update(double delta_time, TaskQueue& task_queue);
+
 private:
     SystemManager() = default;
 
     Vector<std::unique_ptr<System>> systems_;
-    std::unordered_map<std::string, System*> system_name_map_;
+    FlatHashMap<std::string, System*, StringHash, std::equal_to<>> system_name_map_;
 };
-}  // namespace core
-}  // namespace ess
+}  // namespace nxt::core
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "ArchetypeStorage.h"
+#include "Entity.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Iterator over the entities matched by an ArchetypeQuery
+ *
+ */
+class ViewIterator {
+public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = Entity;
+    using pointer = const Entity*;
+    using reference = Entity;
+    using iterator_category = std::forward_iterator_tag;
+
+    ViewIterator(const ArchetypeQuery* query, std::size_t archetype_index) noexcept
+        : query_(query)
+        , archetype_index_(archetype_index)
+        , row_(0) {
+        skipEmptyArchetypes();
+    }
+
+    [[nodiscard]] Entity operator*() const noexcept {
+        return query_->getArchetype(archetype_index_).getEntity(row_);
+    }
+
+    ViewIterator& operator++() noexcept {
+        if (++row_ == query_->getArchetype(archetype_index_).size()) {
+            row_ = 0;
+            ++archetype_index_;
+            skipEmptyArchetypes();
+        }
+        return *this;
+    }
+
+    ViewIterator operator++(int) noexcept {
+        ViewIterator temp(*this);
+        this->operator++();
+        return temp;
+    }
+
+    [[nodiscard]] bool operator==(const ViewIterator& rhs) const noexcept {
+        return query_ == rhs.query_ && archetype_index_ == rhs.archetype_index_ && row_ == rhs.row_;
+    }
+
+    [[nodiscard]] bool operator!=(const ViewIterator& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+private:
+    void skipEmptyArchetypes() noexcept {
+        auto archetype_count = query_->getArchetypeCount();
+        while (archetype_index_ < archetype_count && query_->getArchetype(archetype_index_).empty()) {
+            ++archetype_index_;
+        }
+    }
+
+    const ArchetypeQuery* query_;
+    std::size_t archetype_index_;
+    uint32_t row_;
+};
+
+/**
+ * @brief View over all the entities having a set of component types. A View is cheap to copy and stays valid as
+ *        long as its storage is alive, entities and archetypes added after its creation are seen by it. Keep it
+ *        around (for example in a System) to skip the query lookup on every frame.
+ *
+ *        Entities and components must not be added or removed while iterating a View.
+ *
+ * @tparam Ts Component types of the view, const qualified types can only be read
+ */
+template<typename... Ts>
+class View {
+public:
+    using iterator = ViewIterator;
+    using const_iterator = ViewIterator;
+
+    explicit View(ArchetypeStorage& storage)
+        : storage_(&storage)
+        , query_(&storage.getQuery<Ts...>()) {}
+
+    /**
+     * @brief Call func for every entity in the view, either as func(entity, components&...) or
+     *        func(components&...). Components are passed in the order of the view types
+     */
+    template<typename Func>
+    void each(Func&& func) const {
+        query_->template each<Ts...>(func);
+    }
+
+    /**
+     * @brief Check if the entity has all the components of the view
+     */
+    [[nodiscard]] bool contains(const Entity& entity) const noexcept {
+        return (storage_->hasComponent<std::remove_const_t<Ts>>(entity) && ...);
+    }
+
+    /**
+     * @brief Get a component of an entity in the view
+     *
+     * @tparam T One of the view types, the returned reference is const if T is const in the view
+     */
+    template<typename T>
+    [[nodiscard]] decltype(auto) get(const Entity& entity) const noexcept {
+        static_assert((std::is_same_v<std::remove_const_t<T>, std::remove_const_t<Ts>> || ...),
+                      "Type is not a component of the View");
+        using component_type = std::remove_const_t<T>;
+        constexpr bool kIsReadOnly = ((std::is_same_v<component_type, std::remove_const_t<Ts>> &&
+                                       std::is_const_v<Ts>) || ...);
+
+        auto component = storage_->getComponent<component_type>(entity);
+        assert(component != nullptr && "Entity is not part of the View");
+        if constexpr (kIsReadOnly || std::is_const_v<T>) {
+            return static_cast<const component_type&>(*component);
+        } else {
+            return static_cast<component_type&>(*component);
+        }
+    }
+
+    /**
+     * @brief Number of entities in the view
+     */
+    [[nodiscard]] std::size_t size() const noexcept {
+        return query_->getEntityCount();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return begin() == end();
+    }
+
+    [[nodiscard]] iterator begin() const noexcept {
+        return iterator(query_, 0);
+    }
+
+    [[nodiscard]] iterator end() const noexcept {
+        return iterator(query_, query_->getArchetypeCount());
+    }
+
+private:
+    ArchetypeStorage* storage_;
+    const ArchetypeQuery* query_;
+};
+
+}  // namespace nxt::core
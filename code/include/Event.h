@@ -1,9 +1,9 @@
 #pragma once
 
 #include <atomic>
-#include <unordered_map>
 
-#include "Container/Vector.h"
+#include "Container/FlatHashMap.h"
+#include "Container/SmallVector.h"
 
 namespace nxt::core {
 
@@ -57,6 +57,7 @@ public:
                     receivers.erase(receiver_iter);
                     break;
                 }
+                ++receiver_iter;
             }
         }
     }
@@ -64,13 +65,20 @@ public:
 protected:
     template<typename TEvent>
     void Emit(const TEvent& event) {
-        auto& receivers = subscribers_[TEvent::GetEventId()];
-        for (auto& receiver : receivers) {
+        auto iter = subscribers_.find(TEvent::GetEventId());
+        if (iter == subscribers_.end()) {
+            return;
+        }
+        for (auto& receiver : iter->second) {
             static_cast<Receiver<TEvent>*>(receiver)->Receive(event);
         }
     }
 
 private:
-    std::unordered_map<uint32_t, Vector<BaseReceiver*>> subscribers_;
+    //! Receiver lists rarely exceed a few receivers, so they are stored inline
+    static constexpr std::size_t kInlineReceiverCount = 4;
+
+    //! The receiver lists move when the table grows, receivers must not subscribe while an event is emitted
+    FlatHashMap<uint32_t, SmallVector<BaseReceiver*, kInlineReceiverCount>> subscribers_;
 };
 }  // namespace next::core
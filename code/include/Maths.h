@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cstdint>
+
 #include "TypeTraits.h"
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 namespace nxt::core {
 
 template<typename T, typename = std::enable_if_t<std::is_unsigned_v<RemoveCVRefT<T>>>>
@@ -45,4 +51,65 @@ rotateRight(T value, uint32_t rotate) {
     return (value >> rotate_factor) | (value << (bit_size - rotate_factor));
 }
 
+/**
+ * @brief Number of zero bits below the lowest set bit of the value, which must not be zero. Compiles down to a
+ *        single instruction on the supported compilers
+ */
+template<typename T, typename = std::enable_if_t<std::is_unsigned_v<RemoveCVRefT<T>>>>
+[[nodiscard]] inline uint32_t
+countTrailingZeros(T value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) <= sizeof(unsigned int)) {
+        return static_cast<uint32_t>(__builtin_ctz(static_cast<unsigned int>(value)));
+    } else {
+        return static_cast<uint32_t>(__builtin_ctzll(static_cast<unsigned long long>(value)));
+    }
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+        _BitScanForward(&index, static_cast<unsigned long>(value));
+    } else {
+        _BitScanForward64(&index, static_cast<unsigned long long>(value));
+    }
+    return static_cast<uint32_t>(index);
+#else
+    uint32_t count = 0;
+    for (; (value & 1u) == 0; value >>= 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+/**
+ * @brief Number of zero bits above the highest set bit of the value, which must not be zero
+ */
+template<typename T, typename = std::enable_if_t<std::is_unsigned_v<RemoveCVRefT<T>>>>
+[[nodiscard]] inline uint32_t
+countLeadingZeros(T value) noexcept {
+    constexpr uint32_t bit_size = sizeof(T) * 8;
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) <= sizeof(unsigned int)) {
+        constexpr uint32_t padding = sizeof(unsigned int) * 8 - bit_size;
+        return static_cast<uint32_t>(__builtin_clz(static_cast<unsigned int>(value))) - padding;
+    } else {
+        return static_cast<uint32_t>(__builtin_clzll(static_cast<unsigned long long>(value)));
+    }
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+        _BitScanReverse(&index, static_cast<unsigned long>(value));
+    } else {
+        _BitScanReverse64(&index, static_cast<unsigned long long>(value));
+    }
+    return bit_size - 1 - static_cast<uint32_t>(index);
+#else
+    uint32_t count = 0;
+    for (T mask = T(1) << (bit_size - 1); (value & mask) == 0; mask >>= 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
 }  // namespace nxt::core
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "MonotonicArena.h"
+#include "../Export.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Get the frame arena of the calling thread, creating it on first use. The arena is meant for memory living at
+ *        most till the end of the current tick, everything allocated from it is reclaimed by resetFrameArenas()
+ */
+NXTCORE_DLL_EXPORT MonotonicArena&
+getFrameArena();
+
+/**
+ * @brief Rewind the frame arenas of all the threads. Call it once per tick at a sync point, when no thread is
+ *        allocating from its frame arena and nothing allocated during the previous tick is used anymore
+ */
+NXTCORE_DLL_EXPORT void
+resetFrameArenas() noexcept;
+
+/**
+ * @brief Stateless allocator getting its memory from the frame arena of the allocating thread. Deallocation does
+ *        nothing, so containers using it are cheap to fill and drop within a tick but must not outlive it
+ *
+ * @tparam T Type of object allocated
+ */
+template<typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    FrameAllocator() noexcept = default;
+
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t count) {
+        return static_cast<T*>(getFrameArena().allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) noexcept {}
+};
+
+template<typename T, typename U>
+bool
+operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) noexcept {
+    return true;
+}
+
+template<typename T, typename U>
+bool
+operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) noexcept {
+    return false;
+}
+
+}  // namespace nxt::core
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+
+#include "../Export.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Interface of a source of raw memory. Allocators like ResourceAllocator hold a pointer to a MemoryResource,
+ *        so the same container type can get its memory from the heap, an arena or a pool chosen at runtime.
+ *
+ */
+class MemoryResource {
+public:
+    MemoryResource() = default;
+    MemoryResource(const MemoryResource&) = default;
+    MemoryResource& operator=(const MemoryResource&) = default;
+
+    virtual ~MemoryResource() = default;
+
+    /**
+     * @brief Allocate a block of at least size bytes aligned to alignment, which must be a power of two
+     */
+    [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        return doAllocate(size, alignment);
+    }
+
+    /**
+     * @brief Return a block to the resource. Size and alignment must match the values used for allocate()
+     */
+    void deallocate(void* pointer, std::size_t size, std::size_t alignment = alignof(std::max_align_t)) noexcept {
+        doDeallocate(pointer, size, alignment);
+    }
+
+    /**
+     * @brief Check if memory allocated from this resource can be deallocated by rhs and the other way around
+     */
+    [[nodiscard]] bool isEqual(const MemoryResource& rhs) const noexcept {
+        return this == &rhs || doIsEqual(rhs);
+    }
+
+protected:
+    virtual void* doAllocate(std::size_t size, std::size_t alignment) = 0;
+
+    virtual void doDeallocate(void* pointer, std::size_t size, std::size_t alignment) noexcept = 0;
+
+    /**
+     * @brief Resources are only equal to themselves unless overridden
+     */
+    [[nodiscard]] virtual bool doIsEqual(const MemoryResource&) const noexcept {
+        return false;
+    }
+};
+
+/**
+ * @brief Get the resource forwarding to the global operator new and delete. It is the upstream of the other
+ *        resources and the resource of default constructed ResourceAllocators
+ */
+NXTCORE_DLL_EXPORT MemoryResource*
+getDefaultResource() noexcept;
+
+/**
+ * @brief Allocator which gets its memory from a MemoryResource, to plug a MonotonicArena, a PoolResource or any other
+ *        resource into the Allocator parameter of the containers. The allocator only holds a pointer, the resource
+ *        must outlive every container using it. Copies of a container share the resource of the original.
+ *
+ * @tparam T Type of object allocated
+ */
+template<typename T>
+class ResourceAllocator {
+public:
+    using value_type = T;
+
+    ResourceAllocator() noexcept
+        : resource_(getDefaultResource()) {}
+
+    ResourceAllocator(MemoryResource* resource) noexcept
+        : resource_(resource) {}
+
+    template<typename U>
+    ResourceAllocator(const ResourceAllocator<U>& rhs) noexcept
+        : resource_(rhs.getResource()) {}
+
+    [[nodiscard]] T* allocate(std::size_t count) {
+        return static_cast<T*>(resource_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        resource_->deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    [[nodiscard]] MemoryResource* getResource() const noexcept {
+        return resource_;
+    }
+
+private:
+    MemoryResource* resource_;
+};
+
+template<typename T, typename U>
+bool
+operator==(const ResourceAllocator<T>& lhs, const ResourceAllocator<U>& rhs) noexcept {
+    return lhs.getResource()->isEqual(*rhs.getResource());
+}
+
+template<typename T, typename U>
+bool
+operator!=(const ResourceAllocator<T>& lhs, const ResourceAllocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+}  // namespace nxt::core
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "MemoryResource.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Arena handing out memory by bumping a pointer through chunks taken from an upstream resource. Deallocation
+ *        does nothing, memory is reclaimed all at once by reset() or release(). Chunks grow geometrically, so the
+ *        number of upstream allocations is logarithmic in the total size.
+ *
+ *        reset() rewinds the arena but keeps the chunks, so an arena reset every frame stops touching the upstream
+ *        resource once it has grown to the size of the largest frame. The arena is not thread safe.
+ *
+ */
+class MonotonicArena : public MemoryResource {
+public:
+    static constexpr std::size_t kDefaultChunkSize = 4096;
+    static constexpr std::size_t kChunkAlignment = alignof(std::max_align_t);
+
+    explicit MonotonicArena(std::size_t initial_chunk_size = kDefaultChunkSize,
+                            MemoryResource* upstream = getDefaultResource()) noexcept
+        : upstream_(upstream)
+        , next_chunk_size_(initial_chunk_size < kMinChunkSize ? kMinChunkSize : initial_chunk_size) {}
+
+    explicit MonotonicArena(MemoryResource* upstream) noexcept
+        : MonotonicArena(kDefaultChunkSize, upstream) {}
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ~MonotonicArena() override {
+        release();
+    }
+
+    /**
+     * @brief Make all the memory of the arena available again without returning the chunks to the upstream resource.
+     *        Everything allocated from the arena so far must not be used anymore
+     */
+    void reset() noexcept {
+        setCurrentChunk(first_chunk_);
+    }
+
+    /**
+     * @brief Return all the chunks to the upstream resource. Everything allocated from the arena so far must not be
+     *        used anymore
+     */
+    void release() noexcept {
+        auto chunk = first_chunk_;
+        while (chunk != nullptr) {
+            auto next_chunk = chunk->next;
+            upstream_->deallocate(chunk, chunk->size, kChunkAlignment);
+            chunk = next_chunk;
+        }
+
+        first_chunk_ = nullptr;
+        setCurrentChunk(nullptr);
+    }
+
+    [[nodiscard]] MemoryResource* getUpstreamResource() const noexcept {
+        return upstream_;
+    }
+
+    /**
+     * @brief Number of chunks allocated from the upstream resource
+     */
+    [[nodiscard]] std::size_t getChunkCount() const noexcept {
+        std::size_t count = 0;
+        for (auto chunk = first_chunk_; chunk != nullptr; chunk = chunk->next) {
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Total size in bytes of the chunks allocated from the upstream resource
+     */
+    [[nodiscard]] std::size_t getCapacity() const noexcept {
+        std::size_t capacity = 0;
+        for (auto chunk = first_chunk_; chunk != nullptr; chunk = chunk->next) {
+            capacity += chunk->size;
+        }
+        return capacity;
+    }
+
+protected:
+    void* doAllocate(std::size_t size, std::size_t alignment) override {
+        auto pointer = allocateFromChunk(size, alignment);
+        if (pointer != nullptr) {
+            return pointer;
+        }
+
+        // move to the next chunk kept by reset(), chunks too small for this request are skipped for this frame
+        while (current_chunk_ != nullptr && current_chunk_->next != nullptr) {
+            setCurrentChunk(current_chunk_->next);
+            pointer = allocateFromChunk(size, alignment);
+            if (pointer != nullptr) {
+                return pointer;
+            }
+        }
+
+        appendChunk(size + alignment);
+        return allocateFromChunk(size, alignment);
+    }
+
+    void doDeallocate(void*, std::size_t, std::size_t) noexcept override {}
+
+private:
+    struct alignas(kChunkAlignment) Chunk {
+        Chunk* next;
+        std::size_t size;
+    };
+
+    static constexpr std::size_t kMinChunkSize = 4 * sizeof(Chunk);
+
+    void* allocateFromChunk(std::size_t size, std::size_t alignment) noexcept {
+        auto current = reinterpret_cast<std::uintptr_t>(current_);
+        auto aligned = (current + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+        if (current_ == nullptr || aligned < current || size > reinterpret_cast<std::uintptr_t>(end_) - aligned) {
+            return nullptr;
+        }
+
+        current_ = reinterpret_cast<std::byte*>(aligned + size);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void appendChunk(std::size_t min_size) {
+        auto chunk_size = next_chunk_size_;
+        while (chunk_size - sizeof(Chunk) < min_size) {
+            chunk_size *= 2;
+        }
+
+        auto chunk = static_cast<Chunk*>(upstream_->allocate(chunk_size, kChunkAlignment));
+        chunk->next = nullptr;
+        chunk->size = chunk_size;
+        if (current_chunk_ == nullptr) {
+            first_chunk_ = chunk;
+        } else {
+            current_chunk_->next = chunk;
+        }
+
+        next_chunk_size_ = chunk_size * 2;
+        setCurrentChunk(chunk);
+    }
+
+    void setCurrentChunk(Chunk* chunk) noexcept {
+        current_chunk_ = chunk;
+        if (chunk != nullptr) {
+            current_ = reinterpret_cast<std::byte*>(chunk + 1);
+            end_ = reinterpret_cast<std::byte*>(chunk) + chunk->size;
+        } else {
+            current_ = nullptr;
+            end_ = nullptr;
+        }
+    }
+
+    MemoryResource* upstream_;
+    Chunk* first_chunk_ = nullptr;
+    Chunk* current_chunk_ = nullptr;
+    std::byte* current_ = nullptr;
+    std::byte* end_ = nullptr;
+    std::size_t next_chunk_size_;
+};
+
+}  // namespace nxt::core
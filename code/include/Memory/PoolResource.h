@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "MemoryResource.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Pool of fixed size blocks for node based containers. Blocks are grouped in size classes of
+ *        kBlockGranularity bytes, each size class keeps an intrusive free list of released blocks and carves new
+ *        blocks out of slabs taken from the upstream resource, so allocating a node after the warm up is a pointer
+ *        pop. Requests larger than kMaxBlockSize or more aligned than kBlockGranularity are forwarded to the
+ *        upstream resource.
+ *
+ *        Slabs are only returned to the upstream resource by release() or when the pool is destroyed. The pool is
+ *        not thread safe, use TaskPool for blocks shared between threads.
+ *
+ */
+class PoolResource : public MemoryResource {
+public:
+    static constexpr std::size_t kBlockGranularity = alignof(std::max_align_t);
+    static constexpr std::size_t kSizeClassCount = 32;
+    static constexpr std::size_t kMaxBlockSize = kBlockGranularity * kSizeClassCount;
+    static constexpr std::size_t kSlabSize = 16 * 1024;
+
+    explicit PoolResource(MemoryResource* upstream = getDefaultResource()) noexcept
+        : upstream_(upstream) {}
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    ~PoolResource() override {
+        release();
+    }
+
+    /**
+     * @brief Return all the slabs to the upstream resource. Blocks of the size classes must not be used anymore,
+     *        larger blocks forwarded to the upstream resource are not affected
+     */
+    void release() noexcept {
+        auto slab = slabs_;
+        while (slab != nullptr) {
+            auto next_slab = slab->next;
+            upstream_->deallocate(slab, kSlabSize, kBlockGranularity);
+            slab = next_slab;
+        }
+
+        slabs_ = nullptr;
+        size_classes_ = {};
+    }
+
+    [[nodiscard]] MemoryResource* getUpstreamResource() const noexcept {
+        return upstream_;
+    }
+
+    /**
+     * @brief Number of slabs allocated from the upstream resource
+     */
+    [[nodiscard]] std::size_t getSlabCount() const noexcept {
+        std::size_t count = 0;
+        for (auto slab = slabs_; slab != nullptr; slab = slab->next) {
+            ++count;
+        }
+        return count;
+    }
+
+protected:
+    void* doAllocate(std::size_t size, std::size_t alignment) override {
+        if (!isPooled(size, alignment)) {
+            return upstream_->allocate(size, alignment);
+        }
+
+        auto& size_class = size_classes_[getSizeClassIndex(size)];
+        if (size_class.free_list != nullptr) {
+            auto block = size_class.free_list;
+            size_class.free_list = block->next;
+            return block;
+        }
+
+        // blocks are carved lazily so that the untouched part of a slab is never paged in
+        auto block_size = getBlockSize(getSizeClassIndex(size));
+        if (size_class.slab_end - size_class.slab_current < static_cast<std::ptrdiff_t>(block_size)) {
+            auto slab = allocateSlab();
+            size_class.slab_current = reinterpret_cast<std::byte*>(slab) + kSlabHeaderSize;
+            size_class.slab_end = reinterpret_cast<std::byte*>(slab) + kSlabSize;
+        }
+
+        auto block = size_class.slab_current;
+        size_class.slab_current += block_size;
+        return block;
+    }
+
+    void doDeallocate(void* pointer, std::size_t size, std::size_t alignment) noexcept override {
+        if (!isPooled(size, alignment)) {
+            upstream_->deallocate(pointer, size, alignment);
+            return;
+        }
+
+        auto& size_class = size_classes_[getSizeClassIndex(size)];
+        auto block = static_cast<FreeBlock*>(pointer);
+        block->next = size_class.free_list;
+        size_class.free_list = block;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Slab {
+        Slab* next;
+    };
+
+    struct SizeClass {
+        FreeBlock* free_list = nullptr;
+        std::byte* slab_current = nullptr;
+        std::byte* slab_end = nullptr;
+    };
+
+    static constexpr std::size_t kSlabHeaderSize = kBlockGranularity;
+
+    static_assert(sizeof(Slab) <= kSlabHeaderSize);
+    static_assert(kMaxBlockSize <= kSlabSize - kSlabHeaderSize);
+
+    [[nodiscard]] static constexpr bool isPooled(std::size_t size, std::size_t alignment) noexcept {
+        return size <= kMaxBlockSize && alignment <= kBlockGranularity;
+    }
+
+    [[nodiscard]] static constexpr std::size_t getSizeClassIndex(std::size_t size) noexcept {
+        return size == 0 ? 0 : (size - 1) / kBlockGranularity;
+    }
+
+    [[nodiscard]] static constexpr std::size_t getBlockSize(std::size_t size_class_index) noexcept {
+        return (size_class_index + 1) * kBlockGranularity;
+    }
+
+    Slab* allocateSlab() {
+        auto slab = static_cast<Slab*>(upstream_->allocate(kSlabSize, kBlockGranularity));
+        slab->next = slabs_;
+        slabs_ = slab;
+        return slab;
+    }
+
+    MemoryResource* upstream_;
+    Slab* slabs_ = nullptr;
+    std::array<SizeClass, kSizeClassCount> size_classes_;
+};
+
+}  // namespace nxt::core
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include "../TypeTraits.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Whether a container may relocate the values of the allocator with memcpy. Besides the values being
+ *        trivially relocatable the allocator must hand out raw pointers, since the construct and destroy of the
+ *        allocator are skipped for the relocated values
+ */
+template<typename Allocator>
+constexpr auto CanRelocateV = IsTriviallyRelocatableV<typename std::allocator_traits<Allocator>::value_type> &&
+                              std::is_pointer_v<typename std::allocator_traits<Allocator>::pointer>;
+
+/**
+ * @brief Relocate count values from first to the uninitialized range at dest, the ranges must not overlap. The
+ *        values at first are left without their lifetime and must not be destroyed
+ */
+template<typename T>
+void
+relocate(T* first, std::size_t count, T* dest) noexcept {
+    static_assert(IsTriviallyRelocatableV<T>, "T must be trivially relocatable");
+    if (count > 0) {
+        std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T));
+    }
+}
+
+/**
+ * @brief Relocate count values from first to dest, which may overlap with them
+ */
+template<typename T>
+void
+relocateOverlapping(T* first, std::size_t count, T* dest) noexcept {
+    static_assert(IsTriviallyRelocatableV<T>, "T must be trivially relocatable");
+    if (count > 0) {
+        std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T));
+    }
+}
+
+}  // namespace nxt::core
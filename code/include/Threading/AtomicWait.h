@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "../Export.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Bucket of the global parking table. Waiters on all the atomics which hash to the same bucket share
+ *        the mutex and the condition variable, so an atomic used for waiting doesn't need its own.
+ *
+ */
+struct alignas(64) WaitBucket {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<uint32_t> waiter_count{0};
+};
+
+/**
+ * @brief Get the parking bucket for the given address
+ */
+NXTCORE_DLL_EXPORT WaitBucket& getWaitBucket(const void* address) noexcept;
+
+// number of times the value is checked before the thread is parked
+inline constexpr uint32_t kAtomicWaitSpinCount = 32;
+
+/**
+ * @brief Block till the value of the atomic is different from old. Works like a futex: the waiting thread
+ *        parks in a shared bucket and is woken up by atomicNotifyAll()
+ *
+ * @param atomic Atomic to wait on
+ * @param old Value which makes the thread keep waiting
+ */
+template<typename T>
+void
+atomicWait(const std::atomic<T>& atomic, T old) {
+    for (uint32_t i = 0; i < kAtomicWaitSpinCount; ++i) {
+        if (atomic.load(std::memory_order_acquire) != old) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    auto& bucket = getWaitBucket(&atomic);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    bucket.waiter_count.fetch_add(1, std::memory_order_seq_cst);
+    while (atomic.load(std::memory_order_seq_cst) == old) {
+        bucket.condition.wait(lock);
+    }
+    bucket.waiter_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Block till the value of the atomic is different from old or the timeout expires
+ *
+ * @return true if the value changed
+ * @return false if the timeout expired
+ */
+template<typename T, typename Rep, typename Period>
+bool
+atomicWaitFor(const std::atomic<T>& atomic, T old, const std::chrono::duration<Rep, Period>& duration) {
+    if (atomic.load(std::memory_order_acquire) != old) {
+        return true;
+    }
+
+    auto& bucket = getWaitBucket(&atomic);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    bucket.waiter_count.fetch_add(1, std::memory_order_seq_cst);
+    bool changed = bucket.condition.wait_for(
+        lock, duration, [&atomic, old]() { return atomic.load(std::memory_order_seq_cst) != old; });
+    bucket.waiter_count.fetch_sub(1, std::memory_order_relaxed);
+    return changed;
+}
+
+/**
+ * @brief Wake up all the threads waiting on the atomic. The value has to be changed before the call
+ */
+template<typename T>
+void
+atomicNotifyAll(const std::atomic<T>& atomic) {
+    auto& bucket = getWaitBucket(&atomic);
+
+    // the waiter count is incremented before the waiter checks the value, so either the waiter sees the new
+    // value or the notifier sees the waiter
+    if (bucket.waiter_count.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(bucket.mutex);
+        bucket.condition.notify_all();
+    }
+}
+
+}  // namespace nxt::core
@@ -1,19 +1,27 @@
 #pragma once
 
 #include <functional>
-#include <future>
-#include <thread>
+#include <memory>
 #include <optional>
+#include <tuple>
+#include <utility>
 
 #include "Task.h"
+#include "TaskPool.h"
 
 namespace nxt::core {
 
+/**
+ * @brief Task which invokes a callable with the stored arguments. The callable and the arguments are stored
+ *        inline in the task, so creating it needs a single allocation
+ *
+ */
 template<typename Tuple, typename Result, typename Func, typename... Args>
 class GenericTask : public Task {
 public:
-    GenericTask(std::unique_ptr<Tuple> tuple)
-        : tuple_(std::move(tuple))
+    template<typename... Values>
+    explicit GenericTask(std::in_place_t, Values&&... values)
+        : tuple_(std::forward<Values>(values)...)
         , result_() {}
 
     [[nodiscard]] const Result& getResult() const noexcept {
@@ -22,7 +30,7 @@ public:
     }
 
     [[nodiscard]] bool hasResult() const noexcept {
-        return result.has_value();
+        return result_.has_value();
     }
 
 protected:
@@ -32,20 +40,21 @@ protected:
     }
 
 private:
-    template <size_t... Indices> 
+    template <size_t... Indices>
     void invokeHelper(std::index_sequence<Indices...>) {
-        result_ = std::invoke(std::move(std::get<Indices>(*tuple_))...);
+        result_ = std::invoke(std::move(std::get<Indices>(tuple_))...);
     }
 
-    std::unique_ptr<Tuple> tuple_;
+    Tuple tuple_;
     std::optional<Result> result_;
 };
 
 template<typename Tuple, typename Func, typename... Args>
 class GenericTask<Tuple, void, Func, Args...> : public Task {
 public:
-    GenericTask(std::unique_ptr<Tuple> tuple)
-        : tuple_(std::move(tuple)) {}
+    template<typename... Values>
+    explicit GenericTask(std::in_place_t, Values&&... values)
+        : tuple_(std::forward<Values>(values)...) {}
 
 protected:
     bool run() override {
@@ -56,21 +65,36 @@ protected:
 private:
     template<size_t... Indices>
     void invokeHelper(std::index_sequence<Indices...>) {
-        std::invoke(std::move(std::get<Indices>(*tuple_))...);
+        std::invoke(std::move(std::get<Indices>(tuple_))...);
     }
 
-    std::unique_ptr<Tuple> tuple_;
+    Tuple tuple_;
 };
 
+template<typename Func, typename... Args>
+using GenericTaskType = GenericTask<std::tuple<std::decay_t<Func>, std::decay_t<Args>...>,
+                                    std::invoke_result_t<Func, Args...>,
+                                    Func,
+                                    Args...>;
+
 template<typename Func, typename... Args>
 [[nodiscard]] auto
 makeGenericTask(Func&& func, Args&& ... args) {
-    using tuple_type = std::tuple<std::decay_t<Func>, std::decay_t<Args>...>;
-    using func_type = std::decay_t<Func>;
-    using result_type = std::invoke_result_t<Func, Args...>;
+    return std::make_shared<GenericTaskType<Func, Args...>>(
+        std::in_place, std::forward<Func>(func), std::forward<Args>(args)...);
+}
 
-    auto tuple = std::make_unique<tuple_type>(std::forward<Func>(func), std::forward<Args>(args)...);
-    return std::make_shared<GenericTask<tuple_type, result_type, Func, Args...>>(std::move(tuple));
+/**
+ * @brief Create a GenericTask whose memory, including the shared_ptr control block, comes from the pool
+ *
+ * @param pool Pool used for the allocation, kept alive till the task is destroyed
+ */
+template<typename Func, typename... Args>
+[[nodiscard]] auto
+allocateGenericTask(const std::shared_ptr<TaskPool>& pool, Func&& func, Args&&... args) {
+    using task_type = GenericTaskType<Func, Args...>;
+    return std::allocate_shared<task_type>(
+        TaskPoolAllocator<task_type>(pool), std::in_place, std::forward<Func>(func), std::forward<Args>(args)...);
 }
 
 }  // namespace nxt::core
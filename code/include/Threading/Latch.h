@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "AtomicWait.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Single use countdown barrier. Threads block in wait() till the counter has been decreased to zero
+ *
+ */
+class Latch {
+public:
+    explicit Latch(std::ptrdiff_t count)
+        : count_(count) {}
+
+    Latch(const Latch&) = delete;
+    Latch& operator=(const Latch&) = delete;
+
+    /**
+     * @brief Decrease the counter and wake up the waiting threads when it reaches zero
+     *
+     * @param update Value to be subtracted from the counter
+     */
+    void countDown(std::ptrdiff_t update = 1) {
+        if (update != 0 && count_.fetch_sub(update, std::memory_order_seq_cst) == update) {
+            atomicNotifyAll(count_);
+        }
+    }
+
+    /**
+     * @brief Check if the counter has reached zero without blocking
+     */
+    [[nodiscard]] bool tryWait() const noexcept {
+        return count_.load(std::memory_order_acquire) == 0;
+    }
+
+    /**
+     * @brief Block till the counter reaches zero
+     */
+    void wait() const {
+        auto count = count_.load(std::memory_order_acquire);
+        while (count != 0) {
+            atomicWait(count_, count);
+            count = count_.load(std::memory_order_acquire);
+        }
+    }
+
+private:
+    std::atomic<std::ptrdiff_t> count_;
+};
+
+}  // namespace nxt::core
@@ -7,6 +7,8 @@ namespace nxt::core {
 
 class SpinLock {
 public:
+    SpinLock() noexcept = default;
+
     void lock() noexcept {
         while (flag_.test_and_set(std::memory_order_acquire)) {
             _mm_pause();
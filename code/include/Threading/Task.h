@@ -1,9 +1,12 @@
 #pragma once
 
 #include <atomic>
-#include <condition_variable>
+#include <chrono>
 #include <cstdint>
-#include <mutex>
+#include <memory>
+
+#include "../Container/Vector.h"
+#include "AtomicWait.h"
 
 namespace nxt::core {
 class TaskQueue;
@@ -24,7 +27,8 @@ public:
      *
      */
     Task()
-        : status_(Status::kNotQueued) {}
+        : status_(Status::kNotQueued)
+        , pending_predecessors_(0) {}
 
     /**
      * @brief
@@ -60,20 +64,55 @@ public:
      *
      */
     void wait() const {
-        std::unique_lock<std::mutex> lock(mutex_);
-        cond_variable_.wait(lock, [this]() {
-            auto status = getStatus();
-            return status == Status::kError || status == Status::kFinished;
-        });
+        auto status = getStatus();
+        while (!isDone(status)) {
+            atomicWait(status_, status);
+            status = getStatus();
+        }
+    }
+
+    /**
+     * @brief Make the given task a successor of this task. The successor is queued automatically on the
+     *        TaskQueue which executed its last predecessor, so it should not be added to a TaskQueue by the
+     *        caller. Edges must be added before this task is queued. If a predecessor ends with Status::kError
+     *        the successor is not run and ends with Status::kError as well, and so do the tasks after it.
+     *
+     * @param successor Task to be run after this task finishes
+     * @return true if the edge was added
+     * @return false if this task was already queued or the successor is not a valid task
+     */
+    bool precede(const std::shared_ptr<Task>& successor) {
+        if (successor == nullptr || successor.get() == this || getStatus() != Status::kNotQueued ||
+            successor->getStatus() != Status::kNotQueued) {
+            return false;
+        }
+
+        successor->pending_predecessors_.fetch_add(1, std::memory_order_acq_rel);
+        successors_.pushBack(successor);
+        return true;
+    }
+
+    /**
+     * @brief Check if the task is still waiting for some of its predecessors to finish
+     *
+     * @return true if there are unfinished predecessors
+     * @return false otherwise
+     */
+    [[nodiscard]] bool hasPendingPredecessors() const noexcept {
+        return pending_predecessors_.load(std::memory_order_acquire) > 0;
     }
 
     template<typename Rep, typename Period>
     void waitFor(const std::chrono::duration<Rep, Period>& duration) const {
-        std::unique_lock<std::mutex> lock(mutex_);
-        cond_variable_.wait_for(lock, duration, [this]() {
-            auto status = GetStatus();
-            return status == Status::kError || status == Status::kFinished;
-        });
+        auto deadline = std::chrono::steady_clock::now() + duration;
+        auto status = getStatus();
+        while (!isDone(status)) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline || !atomicWaitFor(status_, status, deadline - now)) {
+                return;
+            }
+            status = getStatus();
+        }
     }
 
     /**
@@ -98,18 +137,30 @@ protected:
      */
     void setStatus(Status status) noexcept {
         if (status != getStatus()) {
-            std::unique_lock lock(mutex_);
-            status_.store(status, std::memory_order::memory_order_release);
-            if (status == Status::kError || status == Status::kFinished) {
-                cond_variable_.notify_all();
+            status_.store(status, std::memory_order_seq_cst);
+            if (isDone(status)) {
+                atomicNotifyAll(status_);
             }
         }
     }
 
 private:
+    [[nodiscard]] static constexpr bool isDone(Status status) noexcept {
+        return status == Status::kError || status == Status::kFinished;
+    }
+
+    // waiters park on the status itself, so a task doesn't need its own mutex and condition variable
     std::atomic<Status> status_;
-    mutable std::mutex mutex_;
-    mutable std::condition_variable cond_variable_;
+
+    // Reference held by the TaskQueue while the task is waiting to be executed, so that the
+    // scheduler can pass around raw pointers in its lock-free deques
+    std::shared_ptr<Task> queue_reference_;
+
+    // number of predecessors which have not finished yet, the task is queued when it drops to zero
+    std::atomic<uint32_t> pending_predecessors_;
+
+    // tasks which are waiting for this task to finish
+    Vector<std::shared_ptr<Task>> successors_;
 
     // Add TaskQueue as a friend class so that it can call SetStatus function
     friend class TaskQueue;
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <memory>
+
+#include "../Container/Vector.h"
+#include "GenericTask.h"
+#include "Task.h"
+#include "TaskPool.h"
+#include "TaskQueue.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Builder for a directed acyclic graph of tasks. Only the tasks without predecessors are submitted
+ *        to the TaskQueue, every other task is queued by the worker which finishes its last predecessor.
+ *        A graph can only be submitted once as tasks are not reusable after execution.
+ */
+class TaskGraph {
+public:
+    using size_type = std::size_t;
+
+    /**
+     * @brief Construct a graph with its own pool for the tasks created with emplaceTask()
+     */
+    TaskGraph()
+        : task_pool_(std::make_shared<TaskPool>()) {}
+
+    /**
+     * @brief Construct a graph which creates its tasks from the given pool, usually the one of the TaskQueue
+     *        executing the graph so that the memory of finished tasks is recycled across graphs
+     */
+    explicit TaskGraph(std::shared_ptr<TaskPool> task_pool)
+        : task_pool_(std::move(task_pool)) {}
+
+    /**
+     * @brief Add an already created task to the graph
+     *
+     * @param task Task to be added
+     * @return The added task
+     */
+    const std::shared_ptr<Task>& addTask(const std::shared_ptr<Task>& task) {
+        tasks_.pushBack(task);
+        return tasks_.back();
+    }
+
+    /**
+     * @brief Create a GenericTask from the function and the arguments using the task pool of the graph and add
+     *        it to the graph
+     *
+     * @return The created task
+     */
+    template<typename Func, typename... Args>
+    auto emplaceTask(Func&& func, Args&&... args) {
+        auto task = allocateGenericTask(task_pool_, std::forward<Func>(func), std::forward<Args>(args)...);
+        tasks_.pushBack(task);
+        return task;
+    }
+
+    /**
+     * @brief Add an edge so that the successor only runs after the predecessor has finished. A failing
+     *        predecessor fails the successor and everything depending on it without running them
+     *
+     * @return true if the edge was added
+     * @return false if the predecessor was already queued
+     */
+    bool addDependency(const std::shared_ptr<Task>& predecessor, const std::shared_ptr<Task>& successor) {
+        return predecessor->precede(successor);
+    }
+
+    /**
+     * @brief Queue the root tasks of the graph. The remaining tasks are queued as their predecessors finish
+     *
+     * @param task_queue TaskQueue used for executing the graph
+     * @return Number of root tasks queued
+     */
+    size_type submit(TaskQueue& task_queue) {
+        Vector<std::shared_ptr<Task>> root_tasks;
+        for (const auto& task : tasks_) {
+            if (!task->hasPendingPredecessors()) {
+                root_tasks.pushBack(task);
+            }
+        }
+
+        return task_queue.addTasks(root_tasks);
+    }
+
+    /**
+     * @brief Wait for all the tasks in the graph to finish
+     */
+    void wait() const {
+        for (const auto& task : tasks_) {
+            task->wait();
+        }
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return tasks_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return tasks_.empty();
+    }
+
+    /**
+     * @brief Get the pool used for allocating the tasks created with emplaceTask()
+     */
+    [[nodiscard]] const std::shared_ptr<TaskPool>& getTaskPool() const noexcept {
+        return task_pool_;
+    }
+
+    /**
+     * @brief Remove all the tasks from the graph. Tasks already submitted keep running
+     */
+    void clear() noexcept {
+        tasks_.clear();
+    }
+
+private:
+    Vector<std::shared_ptr<Task>> tasks_;
+    std::shared_ptr<TaskPool> task_pool_;
+};
+
+}  // namespace nxt::core
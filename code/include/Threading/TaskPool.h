@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+
+#include "../Container/Vector.h"
+#include "SpinLock.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Thread safe slab pool for task objects. Blocks are grouped in size classes of kBlockGranularity bytes,
+ *        each size class keeps an intrusive free list of released blocks so that creating a task after the
+ *        warm up doesn't touch the global heap. Requests larger than kMaxBlockSize fall back to operator new.
+ *        Memory is only returned to the system when the pool is destroyed.
+ *
+ */
+class TaskPool {
+public:
+    static constexpr std::size_t kBlockGranularity = 64;
+    static constexpr std::size_t kSizeClassCount = 8;
+    static constexpr std::size_t kMaxBlockSize = kBlockGranularity * kSizeClassCount;
+    static constexpr std::size_t kSlabSize = 64 * 1024;
+
+    TaskPool() = default;
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /**
+     * @brief Allocate a block of at least size bytes
+     *
+     * @param size Size of the block in bytes
+     * @param alignment Alignment of the block, must not be larger than kBlockGranularity to use the pool
+     */
+    [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        if (!isPooled(size, alignment)) {
+            return ::operator new(size, std::align_val_t(alignment));
+        }
+
+        auto& size_class = size_classes_[getSizeClassIndex(size)];
+        std::lock_guard<SpinLock> lock(size_class.lock);
+        if (size_class.free_list == nullptr) {
+            size_class.free_list = allocateSlab(getSizeClassIndex(size));
+        }
+
+        auto block = size_class.free_list;
+        size_class.free_list = block->next;
+        return block;
+    }
+
+    /**
+     * @brief Return a block to the pool. Size and alignment must match the values used for allocate()
+     */
+    void deallocate(void* pointer, std::size_t size, std::size_t alignment = alignof(std::max_align_t)) noexcept {
+        if (!isPooled(size, alignment)) {
+            ::operator delete(pointer, std::align_val_t(alignment));
+            return;
+        }
+
+        auto& size_class = size_classes_[getSizeClassIndex(size)];
+        auto block = static_cast<FreeBlock*>(pointer);
+        std::lock_guard<SpinLock> lock(size_class.lock);
+        block->next = size_class.free_list;
+        size_class.free_list = block;
+    }
+
+    /**
+     * @brief Number of slabs allocated from the system so far
+     */
+    [[nodiscard]] std::size_t getSlabCount() const {
+        std::lock_guard<SpinLock> lock(slab_lock_);
+        return slabs_.size();
+    }
+
+    ~TaskPool() {
+        for (auto slab : slabs_) {
+            ::operator delete(slab, std::align_val_t(kBlockGranularity));
+        }
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct alignas(64) SizeClass {
+        SpinLock lock;
+        FreeBlock* free_list = nullptr;
+    };
+
+    [[nodiscard]] static constexpr bool isPooled(std::size_t size, std::size_t alignment) noexcept {
+        return size <= kMaxBlockSize && alignment <= kBlockGranularity;
+    }
+
+    [[nodiscard]] static constexpr std::size_t getSizeClassIndex(std::size_t size) noexcept {
+        return size == 0 ? 0 : (size - 1) / kBlockGranularity;
+    }
+
+    FreeBlock* allocateSlab(std::size_t size_class_index) {
+        auto slab = static_cast<std::byte*>(::operator new(kSlabSize, std::align_val_t(kBlockGranularity)));
+        {
+            std::lock_guard<SpinLock> lock(slab_lock_);
+            try {
+                slabs_.pushBack(slab);
+            } catch (...) {
+                ::operator delete(slab, std::align_val_t(kBlockGranularity));
+                throw;
+            }
+        }
+
+        // carve the whole slab into blocks of the size class and chain them together
+        auto block_size = (size_class_index + 1) * kBlockGranularity;
+        auto block_count = kSlabSize / block_size;
+        FreeBlock* head = nullptr;
+        for (std::size_t i = block_count; i > 0; --i) {
+            auto block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * block_size);
+            block->next = head;
+            head = block;
+        }
+        return head;
+    }
+
+    std::array<SizeClass, kSizeClassCount> size_classes_;
+    mutable SpinLock slab_lock_;
+    Vector<std::byte*> slabs_;
+};
+
+/**
+ * @brief Allocator which gets its memory from a shared TaskPool. Every copy keeps the pool alive, so objects
+ *        allocated from it (for example by std::allocate_shared) can outlive the owner of the pool.
+ *
+ * @tparam T Type of object allocated
+ */
+template<typename T>
+class TaskPoolAllocator {
+public:
+    using value_type = T;
+
+    explicit TaskPoolAllocator(std::shared_ptr<TaskPool> pool) noexcept
+        : pool_(std::move(pool)) {}
+
+    template<typename U>
+    TaskPoolAllocator(const TaskPoolAllocator<U>& rhs) noexcept
+        : pool_(rhs.getPool()) {}
+
+    [[nodiscard]] T* allocate(std::size_t count) {
+        return static_cast<T*>(pool_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        pool_->deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    [[nodiscard]] const std::shared_ptr<TaskPool>& getPool() const noexcept {
+        return pool_;
+    }
+
+private:
+    std::shared_ptr<TaskPool> pool_;
+};
+
+template<typename T, typename U>
+bool
+operator==(const TaskPoolAllocator<T>& lhs, const TaskPoolAllocator<U>& rhs) noexcept {
+    return lhs.getPool() == rhs.getPool();
+}
+
+template<typename T, typename U>
+bool
+operator!=(const TaskPoolAllocator<T>& lhs, const TaskPoolAllocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+}  // namespace nxt::core
@@ -1,17 +1,26 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 
+#include "../Container/ConcurrentRingBuffer.h"
 #include "../Container/Queue.h"
 #include "../Container/Vector.h"
 #include "../Export.h"
+#include "GenericTask.h"
 #include "Task.h"
+#include "TaskPool.h"
 
 namespace nxt::core {
 /**
- * @brief
+ * @brief Thread pool which executes Tasks using work stealing. Each worker thread owns a deque of tasks,
+ *        tasks added from inside a worker thread are pushed to its own deque while tasks added from other
+ *        threads go to a shared injection queue. Idle workers steal from the other workers and only park
+ *        when there is no work left anywhere.
  *
  */
 class TaskQueue {
@@ -31,7 +40,8 @@ public:
     const std::string& getName() const noexcept;
 
     /**
-     * @brief Set the Max Threads object
+     * @brief Set the Max Threads object. Running workers are restarted with the new count, unless called from
+     *        one of the worker threads which can't join itself. The count is then used by the next start()
      *
      * @param num_of_threads
      */
@@ -45,49 +55,117 @@ public:
     uint32_t getMaxThreads() const noexcept;
 
     /**
-     * @brief
+     * @brief Check if the worker threads are running
+     */
+    [[nodiscard]] bool isRunning() const noexcept;
+
+    /**
+     * @brief Check if the calling thread is one of the worker threads of this queue
+     */
+    [[nodiscard]] bool isWorkerThread() const noexcept;
+
+    /**
+     * @brief Add a task to the queue. If called from a worker thread of this queue, the task is pushed to
+     *        the worker's own deque so that it stays local unless stolen. Tasks which still wait for their
+     *        predecessors are rejected, they are queued automatically once the last predecessor finishes.
      *
-     * @param task
-     * @return true
-     * @return false
+     * @param task Task to be queued
+     * @return true if the task was queued
+     * @return false if the task was already queued, executed or has unfinished predecessors
      */
     bool addTask(const std::shared_ptr<Task>& task);
 
-    std::size_t addTasks(const Vector<std::shared_ptr<Task>>& task);
+    /**
+     * @brief Add multiple tasks to the queue in one go
+     *
+     * @param tasks Tasks to be queued
+     * @return Number of tasks which were queued
+     */
+    std::size_t addTasks(const Vector<std::shared_ptr<Task>>& tasks);
+
+    /**
+     * @brief Create a GenericTask from the function and the arguments using the task pool of this queue. The
+     *        task is not queued, so edges can still be added before calling addTask()
+     *
+     * @return Created task
+     */
+    template<typename Func, typename... Args>
+    [[nodiscard]] auto makeTask(Func&& func, Args&&... args) {
+        return allocateGenericTask(task_pool_, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
 
-    ///**
-    // * @brief
-    // *
-    // * @param tasks
-    // * @return unsigned int
-    // */
-    // std::size_t addTasks(const Vector<std::shared_ptr<Task>>& tasks);
+    /**
+     * @brief Get the pool used for allocating the tasks created with makeTask()
+     */
+    [[nodiscard]] const std::shared_ptr<TaskPool>& getTaskPool() const noexcept;
 
     /**
-     * @brief
+     * @brief Start the worker threads
      *
      */
     void start();
 
     /**
-     * @brief
+     * @brief Stop the worker threads. Tasks which were not executed yet stay in the queue and are
+     *        picked up again on the next start()
      *
      */
     void stop();
 
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    /**
+     * @brief Stop the worker threads. Tasks which were not executed yet are released with Status::kError
+     */
     ~TaskQueue();
 
 private:
+    struct Worker;
+
     void spawnWorkerThreads();
-    void workerLogic();
+    void joinWorkerThreads();
+    void workerLogic(uint32_t worker_index);
+    void prepareTask(const std::shared_ptr<Task>& task);
+    void runTask(Task* task);
+    void releaseSuccessors(Task& task);
+    static void cancelTask(Task& task);
+    static void failSuccessors(Task& task);
+    Task* findTask(Worker& worker);
+    void pushInjectedTask(Task* task);
+    Task* popInjectedTask(Worker& worker);
+    void refillInjectedTasks();
+    Task* stealTask(Worker& worker);
+    bool hasPendingTasks() const noexcept;
+    void parkWorker();
+    void wakeWorkers(std::size_t count);
+    void wakeAllWorkers();
 
     std::string name_;
-    Queue<std::shared_ptr<Task>> tasks_;
-    std::atomic<uint32_t> current_threads_;
-    uint32_t max_threads_;
+    std::atomic<uint32_t> max_threads_;
     std::atomic<bool> queue_running_;
-    std::mutex mutex_;
-    std::condition_variable conditional_variable_;
-    std::unordered_map<std::thread::id, std::thread> threads_;
+
+    // worker owned deques, only modified when no worker thread is running
+    Vector<std::unique_ptr<Worker>> workers_;
+
+    // tasks added from threads which are not workers of this queue, the lock-free ring takes the common case
+    // and the overflow queue takes the tasks which don't fit
+    MPMCRingBuffer<Task*> injected_tasks_;
+    std::atomic<std::size_t> injected_count_;
+    Queue<Task*> overflow_tasks_;
+    std::atomic<std::size_t> overflow_count_;
+    std::mutex overflow_mutex_;
+
+    // parking support for idle workers
+    std::atomic<uint32_t> sleeping_workers_;
+    std::atomic<uint64_t> wake_epoch_;
+    std::mutex park_mutex_;
+    std::condition_variable park_condition_;
+
+    // serializes start(), stop() and setMaxThreads()
+    std::mutex state_mutex_;
+
+    // recycles the memory of the tasks created with makeTask()
+    std::shared_ptr<TaskPool> task_pool_;
 };
 }  // namespace nxt::core
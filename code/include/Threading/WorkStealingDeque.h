@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "../Container/Vector.h"
+#include "../Maths.h"
+
+namespace nxt::core {
+
+/**
+ * @brief Chase-Lev work stealing deque. The owner thread pushes and pops items at the bottom of the deque
+ *        while any other thread can steal items from the top. Only the owner thread is allowed to call
+ *        push() and pop(), steal() is safe to call from any thread.
+ *
+ * @tparam T Trivially copyable type stored in the deque (usually a pointer)
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static_assert(std::is_trivially_copyable_v<value_type>, "WorkStealingDeque only supports trivially copyable types");
+
+    /**
+     * @brief Construct a new deque with the given initial capacity
+     *
+     * @param capacity Initial capacity, rounded up to next power of 2
+     */
+    explicit WorkStealingDeque(size_type capacity = 256)
+        : top_(0)
+        , bottom_(0)
+        , array_(nullptr) {
+        if (!isPowerOf2(capacity)) {
+            capacity = getNextPowerOf2(capacity);
+        }
+        auto array = std::make_unique<CircularArray>(capacity);
+        array_.store(array.get(), std::memory_order_relaxed);
+        arrays_.emplaceBack(std::move(array));
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * @brief Push a value at the bottom of the deque. Must only be called by the owner thread
+     *
+     * @param value Value to be pushed
+     */
+    void push(value_type value) {
+        auto bottom = bottom_.load(std::memory_order_relaxed);
+        auto top = top_.load(std::memory_order_acquire);
+        auto array = array_.load(std::memory_order_relaxed);
+
+        if (bottom - top > static_cast<int64_t>(array->capacity()) - 1) {
+            array = grow(array, top, bottom);
+        }
+
+        array->put(bottom, value);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Pop the value from the bottom of the deque. Must only be called by the owner thread
+     *
+     * @return Popped value or empty optional if deque was empty
+     */
+    [[nodiscard]] std::optional<value_type> pop() {
+        auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        auto array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = top_.load(std::memory_order_relaxed);
+
+        if (top <= bottom) {
+            auto value = array->get(bottom);
+            if (top == bottom) {
+                // last item in the deque, race against the thieves for it
+                bool won = top_.compare_exchange_strong(
+                    top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                if (!won) {
+                    return std::nullopt;
+                }
+            }
+            return value;
+        }
+
+        // deque was empty, restore the bottom
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Steal the value from the top of the deque. Can be called from any thread
+     *
+     * @return Stolen value or empty optional if the deque was empty or another thread won the race
+     */
+    [[nodiscard]] std::optional<value_type> steal() {
+        auto top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top < bottom) {
+            auto array = array_.load(std::memory_order_acquire);
+            auto value = array->get(top);
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Approximate number of items in the deque. The value can be stale if other threads are
+     *        modifying the deque at the same time
+     */
+    [[nodiscard]] size_type size() const noexcept {
+        auto bottom = bottom_.load(std::memory_order_relaxed);
+        auto top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_type>(bottom - top) : 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+private:
+    class CircularArray {
+    public:
+        explicit CircularArray(size_type capacity)
+            : capacity_(capacity)
+            , data_(std::make_unique<std::atomic<value_type>[]>(capacity)) {}
+
+        [[nodiscard]] size_type capacity() const noexcept {
+            return capacity_;
+        }
+
+        void put(int64_t index, value_type value) noexcept {
+            data_[mask(index)].store(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] value_type get(int64_t index) const noexcept {
+            return data_[mask(index)].load(std::memory_order_relaxed);
+        }
+
+    private:
+        [[nodiscard]] size_type mask(int64_t index) const noexcept {
+            // capacity is always a power of 2
+            return static_cast<size_type>(index) & (capacity_ - 1);
+        }
+
+        size_type capacity_;
+        std::unique_ptr<std::atomic<value_type>[]> data_;
+    };
+
+    CircularArray* grow(CircularArray* array, int64_t top, int64_t bottom) {
+        auto new_array = std::make_unique<CircularArray>(array->capacity() * 2);
+        for (auto i = top; i < bottom; ++i) {
+            new_array->put(i, array->get(i));
+        }
+
+        // thieves may still be reading from the old array, so it is kept alive till the
+        // deque is destroyed
+        auto result = new_array.get();
+        arrays_.emplaceBack(std::move(new_array));
+        array_.store(result, std::memory_order_release);
+        return result;
+    }
+
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    std::atomic<CircularArray*> array_;
+    Vector<std::unique_ptr<CircularArray>> arrays_;
+};
+
+}  // namespace nxt::core
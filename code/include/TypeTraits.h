@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace nxt::core {
 
@@ -150,6 +152,46 @@ using ReplaceFirstTemplateParameterT = typename ReplaceFirstTemplateParameter<U,
 template<typename T>
 using RemoveCVRefT = typename std::remove_cv_t<std::remove_reference_t<T>>;
 
+/**
+ * @brief Whether a hash or comparison function object declares `is_transparent`, so that containers may look up
+ *        keys of other types with it
+ */
+template<typename T, typename = void>
+struct IsTransparent : std::false_type {};
+
+template<typename T>
+struct IsTransparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+template<typename T>
+constexpr auto IsTransparentV = IsTransparent<T>::value;
+
+template<typename T>
+using TriviallyRelocatableTag = typename T::is_trivially_relocatable;
+
+/**
+ * @brief Whether a value can be relocated, moved to a new address with the source left without its destructor run,
+ *        by copying its bytes. Holds for the trivially copyable types. Other types opt in with a member
+ *        `using is_trivially_relocatable = std::true_type;` or by specializing the trait, which is only right when
+ *        the value never points into itself
+ */
+template<typename T, typename = void>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template<typename T>
+struct IsTriviallyRelocatable<T, std::void_t<TriviallyRelocatableTag<T>>>
+    : std::bool_constant<std::is_trivially_copyable_v<T> || TriviallyRelocatableTag<T>::value> {};
+
+template<typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {};
+
+template<typename T, typename U>
+struct IsTriviallyRelocatable<std::pair<T, U>>
+    : std::bool_constant<IsTriviallyRelocatable<std::remove_const_t<T>>::value &&
+                         IsTriviallyRelocatable<std::remove_const_t<U>>::value> {};
+
+template<typename T>
+constexpr auto IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
 template<typename Allocator>
 constexpr auto ChoosePOCCA = std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value &&
                              !std::allocator_traits<Allocator>::is_always_equal::value;
@@ -0,0 +1,5 @@
+#include "../include/ECS/Archetype.h"
+
+namespace nxt::core {
+std::atomic<uint32_t> BaseComponentType::next_id_{0u};
+}
@@ -0,0 +1,21 @@
+#include "../include/Threading/AtomicWait.h"
+
+#include <array>
+
+namespace nxt::core {
+
+namespace {
+constexpr std::size_t kWaitBucketCount = 256;
+
+std::array<WaitBucket, kWaitBucketCount> wait_buckets;
+}  // namespace
+
+WaitBucket&
+getWaitBucket(const void* address) noexcept {
+    // drop the low bits as atomics waited on are usually at least 8 byte aligned
+    auto hash = reinterpret_cast<std::uintptr_t>(address) >> 3;
+    hash ^= hash >> 8;
+    return wait_buckets[hash % kWaitBucketCount];
+}
+
+}  // namespace nxt::core
@@ -12,21 +12,7 @@ EntityManager::get() {
 
 Entity
 EntityManager::createEntity(bool temporary) noexcept {
-    // insert a invalid entity to get its key
-    Entity entity;
-    auto key = entities_.emplace();
-
-    // update the inserted entity info with the values
-    // returned as the key
-    auto& entity_info = entities_.at(key);
-    entity_info.generation = key.generation;
-    entity_info.index = static_cast<unsigned int>(key.index);
-    entity_info.active = 1;
-    entity_info.temporary = temporary;
-
-    entity_storage_.insert({static_cast<unsigned int>(key.index), key.generation});
-    entity.index_ = static_cast<unsigned int>(key.index);
-    entity.generation_ = key.generation;
+    auto entity = insertEntity(temporary);
 
     EntityCreatedEvent entity_event(entity);
     Emit(entity_event);
@@ -34,6 +20,26 @@ EntityManager::createEntity(bool temporary) noexcept {
     return entity;
 }
 
+Vector<Entity>
+EntityManager::createEntities(std::size_t count, bool temporary) {
+    Vector<Entity> entities;
+    entities.reserve(count);
+
+    // grow the slot maps once instead of page by page
+    auto capacity = static_cast<Key::index_type>(entities_.size() + count + 1);
+    entities_.reserve(capacity);
+    entity_storage_.reserve(capacity);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        entities.pushBack(insertEntity(temporary));
+    }
+
+    EntitiesCreatedEvent entities_event(entities.data(), entities.size());
+    Emit(entities_event);
+
+    return entities;
+}
+
 bool
 EntityManager::isAlive(const Entity& entity) const noexcept {
     Key key{entity.index_, entity.generation_};
@@ -79,8 +85,14 @@ EntityManager::setTemporary(const Entity& entity, bool value) {
 bool
 EntityManager::destroyEntity(const Entity& entity) noexcept {
     Key key{entity.index_, entity.generation_};
+    if (!entities_.exist(key)) {
+        return false;
+    }
     entity_storage_.erase(key);
 
+    // component data in the archetype storage is destroyed in one go without going through the components
+    archetypes_.removeEntity(entity);
+
     // delete the entity from all the components if present
     for (const auto& component : components_) {
         component->removeEntity(entity);
@@ -89,17 +101,63 @@ EntityManager::destroyEntity(const Entity& entity) noexcept {
     return entities_.erase(key);
 }
 
+std::size_t
+EntityManager::destroyEntities(const Entity* entities, std::size_t count) {
+    Vector<Entity> destroyed_entities;
+    destroyed_entities.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& entity = entities[i];
+        Key key{entity.index_, entity.generation_};
+        if (entities_.erase(key)) {
+            entity_storage_.erase(key);
+            archetypes_.removeEntity(entity);
+            destroyed_entities.pushBack(entity);
+        }
+    }
+
+    if (!destroyed_entities.empty()) {
+        for (const auto& component : components_) {
+            component->removeEntities(destroyed_entities.data(), destroyed_entities.size());
+        }
+    }
+
+    return destroyed_entities.size();
+}
+
 void
 EntityManager::clearAllEntities() {
     Vector<Entity> entities;
     entities.reserve(entity_storage_.size());
-    for (auto entity : entity_storage_) {
-        entities.pushBack(entity);
-    }
+    entity_storage_.forEachValid([&entities](Entity entity) { entities.pushBack(entity); });
 
-    for (auto entity : entities) {
-        destroyEntity(entity);
+    // every entity goes away, so the component data is dropped in one go instead of row by row
+    archetypes_.clear();
+    for (const auto& component : components_) {
+        component->removeEntities(entities.data(), entities.size());
     }
+
+    entity_storage_.clear();
+    entities_.clear();
+}
+
+Entity
+EntityManager::insertEntity(bool temporary) {
+    // insert a invalid entity to get its key
+    Entity entity;
+    auto key = entities_.emplace();
+
+    // update the inserted entity info with the values
+    // returned as the key
+    auto& entity_info = entities_.at(key);
+    entity_info.generation = key.generation;
+    entity_info.index = static_cast<unsigned int>(key.index);
+    entity_info.active = 1;
+    entity_info.temporary = temporary;
+
+    entity_storage_.insert({static_cast<unsigned int>(key.index), key.generation});
+    entity.index_ = static_cast<unsigned int>(key.index);
+    entity.generation_ = key.generation;
+    return entity;
 }
 
 }  // namespace nxt::core
@@ -0,0 +1,62 @@
+#include "../include/Memory/FrameAllocator.h"
+
+#include <mutex>
+
+#include "../include/Container/Vector.h"
+
+namespace nxt::core {
+
+namespace {
+constexpr std::size_t kFrameArenaChunkSize = 64 * 1024;
+
+struct FrameArenaRegistry {
+    std::mutex mutex;
+    Vector<MonotonicArena*> arenas;
+};
+
+FrameArenaRegistry&
+getFrameArenaRegistry() {
+    static FrameArenaRegistry registry;
+    return registry;
+}
+
+// registers the arena of a thread for resetFrameArenas() as long as the thread lives
+struct ThreadFrameArena {
+    ThreadFrameArena()
+        : arena(kFrameArenaChunkSize) {
+        auto& registry = getFrameArenaRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.arenas.pushBack(&arena);
+    }
+
+    ~ThreadFrameArena() {
+        auto& registry = getFrameArenaRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (auto it = registry.arenas.begin(); it != registry.arenas.end(); ++it) {
+            if (*it == &arena) {
+                registry.arenas.erase(it);
+                break;
+            }
+        }
+    }
+
+    MonotonicArena arena;
+};
+}  // namespace
+
+MonotonicArena&
+getFrameArena() {
+    thread_local ThreadFrameArena thread_arena;
+    return thread_arena.arena;
+}
+
+void
+resetFrameArenas() noexcept {
+    auto& registry = getFrameArenaRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto arena : registry.arenas) {
+        arena->reset();
+    }
+}
+
+}  // namespace nxt::core
@@ -0,0 +1,30 @@
+#include "../include/Memory/MemoryResource.h"
+
+#include <new>
+
+namespace nxt::core {
+
+namespace {
+class NewDeleteResource : public MemoryResource {
+protected:
+    void* doAllocate(std::size_t size, std::size_t alignment) override {
+        return ::operator new(size, std::align_val_t(alignment));
+    }
+
+    void doDeallocate(void* pointer, std::size_t, std::size_t alignment) noexcept override {
+        ::operator delete(pointer, std::align_val_t(alignment));
+    }
+
+    [[nodiscard]] bool doIsEqual(const MemoryResource& rhs) const noexcept override {
+        return dynamic_cast<const NewDeleteResource*>(&rhs) != nullptr;
+    }
+};
+}  // namespace
+
+MemoryResource*
+getDefaultResource() noexcept {
+    static NewDeleteResource resource;
+    return &resource;
+}
+
+}  // namespace nxt::core
@@ -0,0 +1,42 @@
+#include "../include/ECS/SystemManager.h"
+#include "../include/Threading/TaskGraph.h"
+#include "../include/Threading/TaskQueue.h"
+
+namespace nxt::core {
+
+void
+SystemManager::update(double delta_time) noexcept {
+    for (const auto& system : systems_) {
+        system->onUpdate(delta_time);
+    }
+}
+
+void
+SystemManager::update(double delta_time, TaskQueue& task_queue) {
+    // waiting for the graph from a worker would block it, so run the systems inline instead
+    if (systems_.size() < 2 || !task_queue.isRunning() || task_queue.isWorkerThread()) {
+        update(delta_time);
+        return;
+    }
+
+    TaskGraph graph(task_queue.getTaskPool());
+    Vector<std::shared_ptr<Task>> tasks;
+    tasks.reserve(systems_.size());
+    for (std::size_t i = 0; i < systems_.size(); ++i) {
+        auto system = systems_[i].get();
+        tasks.pushBack(graph.emplaceTask([system, delta_time]() { system->onUpdate(delta_time); }));
+
+        // every system waits for the previously registered systems it conflicts with. The declarations can change
+        // between frames, so the graph is rebuilt on every update
+        for (std::size_t j = 0; j < i; ++j) {
+            if (system->conflictsWith(*systems_[j])) {
+                graph.addDependency(tasks[j], tasks[i]);
+            }
+        }
+    }
+
+    graph.submit(task_queue);
+    graph.wait();
+}
+
+}  // namespace nxt::core
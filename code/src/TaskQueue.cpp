@@ -2,12 +2,59 @@
 
 #include <thread>
 
+#include "../include/Threading/WorkStealingDeque.h"
+
 namespace nxt::core {
+
+namespace {
+// worker thread currently running on this thread, used to push tasks spawned from
+// inside a task to the local deque of the worker
+struct CurrentWorker {
+    const TaskQueue* queue = nullptr;
+    uint32_t index = 0;
+};
+
+thread_local CurrentWorker current_worker;
+
+// number of rounds a worker looks for work before parking
+constexpr uint32_t kSpinCount = 64;
+
+// max number of tasks moved from the injection queue to a worker deque at once
+constexpr std::size_t kInjectionBatchSize = 16;
+
+// number of slots in the lock-free injection ring
+constexpr std::size_t kInjectionCapacity = 1024;
+}  // namespace
+
+struct TaskQueue::Worker {
+    explicit Worker(uint32_t index)
+        : deque()
+        , thread()
+        , random_state(0x9E3779B97F4A7C15ull * (index + 1)) {}
+
+    uint64_t nextRandom() noexcept {
+        // xorshift64
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 7;
+        random_state ^= random_state << 17;
+        return random_state;
+    }
+
+    WorkStealingDeque<Task*> deque;
+    std::thread thread;
+    uint64_t random_state;
+};
+
 TaskQueue::TaskQueue(const std::string& name)
     : name_(name)
-    , current_threads_(0)
     , max_threads_(std::max(std::thread::hardware_concurrency(), 2u) - 1)
-    , queue_running_(false) {}
+    , queue_running_(false)
+    , injected_tasks_(kInjectionCapacity)
+    , injected_count_(0)
+    , overflow_count_(0)
+    , sleeping_workers_(0)
+    , wake_epoch_(0)
+    , task_pool_(std::make_shared<TaskPool>()) {}
 
 const std::string&
 TaskQueue::getName() const noexcept {
@@ -16,24 +63,55 @@ TaskQueue::getName() const noexcept {
 
 void
 TaskQueue::setMaxThreads(uint32_t num_of_threads) {
-    max_threads_ = num_of_threads;
+    if (current_worker.queue == this) {
+        // a worker can't join itself, so the running workers are kept and the new count is used by the next start()
+        max_threads_.store(num_of_threads, std::memory_order_relaxed);
+        return;
+    }
+
+    std::lock_guard lock(state_mutex_);
+    max_threads_.store(num_of_threads, std::memory_order_relaxed);
     if (queue_running_.load(std::memory_order_acquire)) {
+        // worker deques are fixed while the workers are running, so restart them with the new count
+        queue_running_.store(false, std::memory_order_release);
+        wakeAllWorkers();
+        joinWorkerThreads();
+        queue_running_.store(true, std::memory_order_release);
         spawnWorkerThreads();
     }
 }
 
 uint32_t
 TaskQueue::getMaxThreads() const noexcept {
-    return max_threads_;
+    return max_threads_.load(std::memory_order_relaxed);
+}
+
+bool
+TaskQueue::isRunning() const noexcept {
+    return queue_running_.load(std::memory_order_acquire);
+}
+
+bool
+TaskQueue::isWorkerThread() const noexcept {
+    return current_worker.queue == this;
+}
+
+const std::shared_ptr<TaskPool>&
+TaskQueue::getTaskPool() const noexcept {
+    return task_pool_;
 }
 
 bool
 TaskQueue::addTask(const std::shared_ptr<Task>& task) {
-    if (task->getStatus() == Task::Status::kNotQueued) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        tasks_.push(task);
-        task->setStatus(Task::Status::kQueued);
-        conditional_variable_.notify_one();
+    if (task->getStatus() == Task::Status::kNotQueued && !task->hasPendingPredecessors()) {
+        prepareTask(task);
+        if (current_worker.queue == this) {
+            workers_[current_worker.index]->deque.push(task.get());
+        } else {
+            pushInjectedTask(task.get());
+        }
+
+        wakeWorkers(1);
         return true;
     }
 
@@ -42,71 +120,362 @@ TaskQueue::addTask(const std::shared_ptr<Task>& task) {
 
 std::size_t
 TaskQueue::addTasks(const Vector<std::shared_ptr<Task>>& tasks) {
-    uint32_t count = 0;
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto& task : tasks) {
-        if (task->getStatus() == Task::Status::kNotQueued) {
-            tasks_.push(task);
-            task->setStatus(Task::Status::kQueued);
-            ++count;
+    std::size_t count = 0;
+    if (current_worker.queue == this) {
+        auto& deque = workers_[current_worker.index]->deque;
+        for (const auto& task : tasks) {
+            if (task->getStatus() == Task::Status::kNotQueued && !task->hasPendingPredecessors()) {
+                prepareTask(task);
+                deque.push(task.get());
+                ++count;
+            }
+        }
+    } else {
+        for (const auto& task : tasks) {
+            if (task->getStatus() == Task::Status::kNotQueued && !task->hasPendingPredecessors()) {
+                prepareTask(task);
+                pushInjectedTask(task.get());
+                ++count;
+            }
         }
     }
-    conditional_variable_.notify_all();
 
+    wakeWorkers(count);
     return count;
 }
 
 void
 TaskQueue::start() {
-    queue_running_.store(true, std::memory_order_release);
-    spawnWorkerThreads();
+    std::lock_guard lock(state_mutex_);
+    if (!queue_running_.load(std::memory_order_acquire)) {
+        // join the workers left over from a stop() called from inside a worker thread
+        joinWorkerThreads();
+        queue_running_.store(true, std::memory_order_release);
+        spawnWorkerThreads();
+    }
 }
 
 void
 TaskQueue::stop() {
-    std::lock_guard lock(mutex_);
+    if (current_worker.queue == this) {
+        // a worker can't join itself, the workers are joined by the next start() or the destructor instead
+        queue_running_.store(false, std::memory_order_release);
+        wakeAllWorkers();
+        return;
+    }
+
+    std::lock_guard lock(state_mutex_);
     queue_running_.store(false, std::memory_order_release);
-    conditional_variable_.notify_all();
+    wakeAllWorkers();
+    joinWorkerThreads();
 }
 
 void
 TaskQueue::spawnWorkerThreads() {
-    while (current_threads_.load(std::memory_order_acquire) < max_threads_) {
-        std::lock_guard lock(mutex_);
-        current_threads_.fetch_add(1, std::memory_order_release);
-        std::thread thread(&TaskQueue::workerLogic, this);
-        threads_[thread.get_id()] = std::move(thread);
+    // all the workers need to exist before any thread starts as workers steal from each other
+    auto thread_count = max_threads_.load(std::memory_order_relaxed);
+    workers_.reserve(thread_count);
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        workers_.emplaceBack(std::make_unique<Worker>(i));
+    }
+
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        workers_[i]->thread = std::thread(&TaskQueue::workerLogic, this, i);
+    }
+}
+
+void
+TaskQueue::joinWorkerThreads() {
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // move the tasks which were not executed back to the injection queue in their original order
+    for (auto& worker : workers_) {
+        while (auto task = worker->deque.steal()) {
+            pushInjectedTask(*task);
+        }
     }
+
+    workers_.clear();
 }
 
 void
-TaskQueue::workerLogic() {
-    while (queue_running_.load(std::memory_order_acquire) &&
-           current_threads_.load(std::memory_order_acquire) <= max_threads_) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        conditional_variable_.wait(
-            lock, [this]() { return !queue_running_.load(std::memory_order_acquire) || !tasks_.empty(); });
+TaskQueue::workerLogic(uint32_t worker_index) {
+    current_worker = {this, worker_index};
+    auto& worker = *workers_[worker_index];
 
-        if (!queue_running_.load(std::memory_order_acquire))
-            break;
+    uint32_t idle_rounds = 0;
+    while (queue_running_.load(std::memory_order_acquire)) {
+        if (auto task = findTask(worker)) {
+            runTask(task);
+            idle_rounds = 0;
+        } else if (++idle_rounds < kSpinCount) {
+            std::this_thread::yield();
+        } else {
+            parkWorker();
+            idle_rounds = 0;
+        }
+    }
 
-        std::shared_ptr<Task> task = tasks_.popAndExtract();
-        lock.unlock();
+    current_worker = {};
+}
+
+void
+TaskQueue::prepareTask(const std::shared_ptr<Task>& task) {
+    // the queue keeps the task alive till it is executed as the deques only store raw pointers
+    task->queue_reference_ = task;
+    task->setStatus(Task::Status::kQueued);
+}
+
+void
+TaskQueue::runTask(Task* task) {
+    // take over the reference held by the queue so that the task is released after execution
+    auto reference = std::move(task->queue_reference_);
+    if (task->getStatus() == Task::Status::kQueued) {
+        task->execute();
+    }
+
+    releaseSuccessors(*task);
+}
 
-        if (task->getStatus() == Task::Status::kQueued) {
-            task->execute();
+void
+TaskQueue::releaseSuccessors(Task& task) {
+    if (task.successors_.empty()) {
+        return;
+    }
+
+    if (task.getStatus() == Task::Status::kError) {
+        failSuccessors(task);
+        return;
+    }
+
+    // successors whose last predecessor was this task are pushed to the local deque, so that they
+    // run on the same worker and see the results of the task in cache
+    auto& deque = workers_[current_worker.index]->deque;
+    std::size_t ready_count = 0;
+    for (const auto& successor : task.successors_) {
+        if (successor->pending_predecessors_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // another predecessor failed, so the successor is released without running
+            if (successor->getStatus() == Task::Status::kError) {
+                failSuccessors(*successor);
+                continue;
+            }
+
+            prepareTask(successor);
+            deque.push(successor.get());
+            ++ready_count;
         }
     }
-    current_threads_.fetch_sub(1, std::memory_order_release);
+
+    task.successors_.clear();
+    wakeWorkers(ready_count);
+}
+
+Task*
+TaskQueue::findTask(Worker& worker) {
+    if (auto task = worker.deque.pop()) {
+        return *task;
+    }
+
+    if (auto task = popInjectedTask(worker)) {
+        return task;
+    }
+
+    return stealTask(worker);
+}
+
+void
+TaskQueue::pushInjectedTask(Task* task) {
+    // once tasks spill into the overflow queue new tasks queue up behind them till it is drained
+    if (overflow_count_.load(std::memory_order_acquire) > 0 || !injected_tasks_.tryPushBack(task)) {
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        overflow_tasks_.push(task);
+        overflow_count_.fetch_add(1, std::memory_order_release);
+    }
+    injected_count_.fetch_add(1, std::memory_order_seq_cst);
+}
+
+Task*
+TaskQueue::popInjectedTask(Worker& worker) {
+    if (injected_count_.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+
+    Task* task = nullptr;
+    if (!injected_tasks_.tryPopFront(task)) {
+        if (overflow_count_.load(std::memory_order_acquire) == 0) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        if (overflow_tasks_.empty()) {
+            return nullptr;
+        }
+        task = overflow_tasks_.popAndExtract();
+        overflow_count_.fetch_sub(1, std::memory_order_release);
+    }
+
+    // move a batch to the local deque, idle workers steal from there instead of contending on the ring
+    std::size_t taken = 1;
+    Task* next = nullptr;
+    while (taken <= kInjectionBatchSize && injected_tasks_.tryPopFront(next)) {
+        worker.deque.push(next);
+        ++taken;
+    }
+    auto remaining = injected_count_.fetch_sub(taken, std::memory_order_seq_cst) - taken;
+
+    refillInjectedTasks();
+
+    // like the successors pushed to the local deque, the batch and the rest of the ring are left to the other
+    // workers, so wake one of them instead of waiting for the next task to be added
+    if (remaining > 0 || taken > 1) {
+        wakeWorkers(1);
+    }
+    return task;
+}
+
+void
+TaskQueue::refillInjectedTasks() {
+    if (overflow_count_.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(overflow_mutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+        while (!overflow_tasks_.empty() && injected_tasks_.tryPushBack(overflow_tasks_.front())) {
+            overflow_tasks_.pop();
+            overflow_count_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+}
+
+Task*
+TaskQueue::stealTask(Worker& worker) {
+    auto worker_count = workers_.size();
+    if (worker_count < 2) {
+        return nullptr;
+    }
+
+    // start from a random victim so that thieves don't all hammer the same deque
+    auto start = static_cast<std::size_t>(worker.nextRandom() % worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        auto& victim = *workers_[(start + i) % worker_count];
+        if (&victim != &worker) {
+            if (auto task = victim.deque.steal()) {
+                return *task;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+bool
+TaskQueue::hasPendingTasks() const noexcept {
+    if (injected_count_.load(std::memory_order_seq_cst) > 0) {
+        return true;
+    }
+
+    for (const auto& worker : workers_) {
+        if (!worker->deque.empty()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+TaskQueue::parkWorker() {
+    sleeping_workers_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        auto epoch = wake_epoch_.load(std::memory_order_seq_cst);
+
+        // check again after announcing the sleep so that a task added in between is not missed
+        if (queue_running_.load(std::memory_order_acquire) && !hasPendingTasks()) {
+            park_condition_.wait(lock, [this, epoch]() {
+                return wake_epoch_.load(std::memory_order_seq_cst) != epoch ||
+                       !queue_running_.load(std::memory_order_acquire);
+            });
+        }
+    }
+    sleeping_workers_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void
+TaskQueue::wakeWorkers(std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping_workers_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        if (count == 1) {
+            park_condition_.notify_one();
+        } else {
+            park_condition_.notify_all();
+        }
+    }
+}
+
+void
+TaskQueue::wakeAllWorkers() {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+    park_condition_.notify_all();
 }
 
 TaskQueue::~TaskQueue() {
     stop();
+    joinWorkerThreads();
+
+    // release the tasks which were never executed
+    Task* task = nullptr;
+    while (injected_tasks_.tryPopFront(task)) {
+        cancelTask(*task);
+    }
+
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    while (!overflow_tasks_.empty()) {
+        cancelTask(*overflow_tasks_.popAndExtract());
+    }
+}
+
+void
+TaskQueue::cancelTask(Task& task) {
+    // the task ends with an error so that its waiters are woken up instead of blocking forever
+    auto reference = std::move(task.queue_reference_);
+    task.setStatus(Task::Status::kError);
+    failSuccessors(task);
+}
 
-    for (auto& pair : threads_)
-        if (pair.second.joinable())
-            pair.second.join();
+void
+TaskQueue::failSuccessors(Task& task) {
+    // every task depending on a failed task fails as well without running, the error is marked before the
+    // predecessor count drops so that the last predecessor sees it. Dependency chains can be long, so the
+    // tasks whose last predecessor failed are kept on a stack instead of recursing
+    Vector<std::shared_ptr<Task>> failed_tasks;
+    auto fail = [&failed_tasks](Task& failed) {
+        for (auto& successor : failed.successors_) {
+            successor->setStatus(Task::Status::kError);
+            if (successor->pending_predecessors_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                failed_tasks.pushBack(std::move(successor));
+            }
+        }
+        failed.successors_.clear();
+    };
 
+    fail(task);
+    while (!failed_tasks.empty()) {
+        auto failed = std::move(failed_tasks.back());
+        failed_tasks.popBack();
+        fail(*failed);
+    }
 }
 
 }  // namespace nxt::core
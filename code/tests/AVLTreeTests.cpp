@@ -1,6 +1,20 @@
 #include "catch.hpp"
 
+#include "CountingResource.h"
+
 #include "../include/Container/AVLTree.h"
+#include "../include/Container/Vector.h"
+#include "../include/Memory/MemoryResource.h"
+#include "../include/Util/StopWatch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+
+using nxt::tests::CountingResource;
 
 TEST_CASE("AVLTree Tests", "[avl_tree]") {
     SECTION("sorting check") {
@@ -121,4 +135,345 @@ TEST_CASE("AVLTree Tests", "[avl_tree]") {
 
         REQUIRE(avl.size() == 0);
     }
-}
\ No newline at end of file
+
+    SECTION("lower and upper bounds") {
+        nxt::core::AVLTree<nxt::core::SimpleTraits<int>> avl;
+        for (int i = 0; i < 100; ++i) {
+            avl.insert(i * 2);
+        }
+
+        REQUIRE(*avl.lowerBound(-1) == 0);
+        REQUIRE(*avl.lowerBound(10) == 10);
+        REQUIRE(*avl.lowerBound(11) == 12);
+        REQUIRE(avl.lowerBound(199) == avl.end());
+        REQUIRE(*avl.upperBound(10) == 12);
+        REQUIRE(*avl.upperBound(11) == 12);
+        REQUIRE(avl.upperBound(198) == avl.end());
+    }
+
+    SECTION("hint insert") {
+        nxt::core::AVLTree<nxt::core::MappedTraits<int, int>> avl;
+        for (int i = 0; i < 10000; ++i) {
+            avl.insert(avl.end(), {i * 2, i});
+        }
+        REQUIRE(avl.size() == 10000);
+
+        // right hint in the middle, wrong hints and duplicates
+        auto it = avl.insert(avl.find(10), {9, -1});
+        REQUIRE(it->first == 9);
+        REQUIRE((++it)->first == 10);
+        REQUIRE(avl.insert(avl.begin(), {5001, -1})->first == 5001);
+        REQUIRE(avl.insert(avl.end(), {-1, -1})->first == -1);
+        REQUIRE(avl.insert(avl.find(20), {10, -1})->second == 5);
+        REQUIRE(avl.insert({10, -1}).first->second == 5);
+        REQUIRE(avl.size() == 10003);
+
+        bool sorted = true;
+        int previous = -2;
+        for (const auto& value : avl) {
+            sorted = sorted && previous < value.first;
+            previous = value.first;
+        }
+        REQUIRE(sorted);
+
+        bool all_found = true;
+        for (int i = 0; i < 10000; ++i) {
+            all_found = all_found && avl.find(i * 2)->second == i;
+        }
+        REQUIRE(all_found);
+
+        for (int i = 0; i < 10000; ++i) {
+            REQUIRE(avl.erase(i * 2) == 1);
+        }
+        REQUIRE(avl.size() == 3);
+    }
+
+    SECTION("node pooling") {
+        CountingResource resource;
+        using Allocator = nxt::core::ResourceAllocator<std::string>;
+        {
+            nxt::core::AVLTree<nxt::core::SimpleTraits<std::string, std::less<>, Allocator>> avl{Allocator(&resource)};
+            for (int i = 0; i < 10000; ++i) {
+                avl.insert(std::to_string(i) + " is a long string to avoid the small string optimization");
+            }
+            REQUIRE(avl.size() == 10000);
+
+            // nodes come from slabs
+            REQUIRE(resource.allocation_count < 20);
+
+            // erased nodes are reused for the next inserts
+            for (int i = 0; i < 10000; i += 2) {
+                REQUIRE(avl.erase(std::to_string(i) + " is a long string to avoid the small string optimization") == 1);
+            }
+            REQUIRE(avl.size() == 5000);
+            auto allocation_count = resource.allocation_count;
+            for (int i = 0; i < 5000; ++i) {
+                avl.emplace(std::to_string(i) + "b is a long string to avoid the small string optimization");
+            }
+            REQUIRE(resource.allocation_count == allocation_count);
+            REQUIRE(avl.size() == 10000);
+
+            bool sorted = true;
+            auto previous = avl.begin();
+            for (auto it = ++avl.begin(); it != avl.end(); ++it, ++previous) {
+                sorted = sorted && *previous < *it;
+            }
+            REQUIRE(sorted);
+
+            auto copy_avl = avl;
+            REQUIRE(copy_avl.size() == 10000);
+
+            // clear gives back the slabs and destroys the strings
+            avl.clear();
+            REQUIRE(avl.empty());
+            REQUIRE(avl.begin() == avl.end());
+            avl.insert("again");
+            REQUIRE(*avl.begin() == "again");
+        }
+        REQUIRE(resource.live_count == 0);
+    }
+
+    SECTION("erase min and max") {
+        nxt::core::AVLTree<nxt::core::SimpleTraits<int>> avl;
+        for (int i = 0; i < 1000; ++i) {
+            avl.insert((i * 7919) % 1000);
+        }
+
+        for (int i = 0; i < 500; ++i) {
+            REQUIRE(*avl.begin() == i);
+            REQUIRE(*--avl.end() == 999 - i);
+            REQUIRE(avl.erase(i) == 1);
+            REQUIRE(avl.erase(999 - i) == 1);
+        }
+        REQUIRE(avl.empty());
+        REQUIRE(avl.begin() == avl.end());
+    }
+
+    SECTION("sorted build and merge") {
+        nxt::core::Vector<int> evens;
+        for (int i = 0; i < 1000; ++i) {
+            evens.pushBack(i * 2);
+        }
+
+        nxt::core::AVLTree<nxt::core::SimpleTraits<int>> avl;
+        avl.insert(7);
+        avl.assignSorted(evens.begin(), evens.end());
+        REQUIRE(avl.size() == 1000);
+        REQUIRE(avl.find(7) == avl.end());
+
+        bool in_order = true;
+        int expected = 0;
+        for (auto value : avl) {
+            in_order = in_order && value == expected;
+            expected += 2;
+        }
+        REQUIRE(in_order);
+        REQUIRE(*--avl.end() == 1998);
+
+        // a large batch is merged, keys already present are skipped
+        nxt::core::Vector<int> batch;
+        for (int i = 0; i < 2000; i += 3) {
+            batch.pushBack(i);
+        }
+        auto is_odd = [](int value) { return value % 2 != 0; };
+        auto expected_inserted = std::count_if(batch.begin(), batch.end(), is_odd);
+        REQUIRE(avl.mergeSorted(batch.begin(), batch.end()) == static_cast<std::size_t>(expected_inserted));
+        REQUIRE(avl.size() == 1000 + static_cast<std::size_t>(expected_inserted));
+
+        bool merged = true;
+        int previous = -1;
+        std::size_t count = 0;
+        for (auto value : avl) {
+            merged = merged && value > previous && (value % 2 == 0 || value % 3 == 0);
+            previous = value;
+            ++count;
+        }
+        REQUIRE(merged);
+        REQUIRE(count == avl.size());
+
+        // a small batch is inserted value by value
+        int small_batch[] = {-1, 5, 1998, 5000};
+        REQUIRE(avl.mergeSorted(std::begin(small_batch), std::end(small_batch)) == 3);
+        REQUIRE(*avl.begin() == -1);
+        REQUIRE(*--avl.end() == 5000);
+
+        // the built tree keeps working with single inserts and erases
+        for (int i = 0; i < 2000; ++i) {
+            avl.erase(i);
+        }
+        REQUIRE(avl.size() == 2);
+
+        // range constructor, with sorted and unsorted input
+        nxt::core::AVLTree<nxt::core::SimpleTraits<int>> from_sorted(evens.begin(), evens.end());
+        REQUIRE(from_sorted.size() == 1000);
+        int unsorted[] = {5, 1, 3, 1, 4};
+        nxt::core::AVLTree<nxt::core::SimpleTraits<int>> from_unsorted(std::begin(unsorted), std::end(unsorted));
+        REQUIRE(from_unsorted.size() == 4);
+        REQUIRE(*from_unsorted.begin() == 1);
+    }
+
+    SECTION("order statistics") {
+        nxt::core::AVLTree<nxt::core::SimpleTraits<int>, true> tree;
+        std::set<int> expected;
+        for (int i = 0; i < 5000; ++i) {
+            auto key = static_cast<int>((static_cast<int64_t>(i) * 7919) % 5000);
+            tree.insert(key * 2);
+            expected.insert(key * 2);
+        }
+
+        // keep the sizes through erases, hint inserts and the sorted merge
+        for (int i = 0; i < 10000; i += 6) {
+            tree.erase(i);
+            expected.erase(i);
+        }
+        for (int i = 10001; i < 10201; i += 2) {
+            tree.insert(tree.end(), i);
+            expected.insert(i);
+        }
+        nxt::core::Vector<int> batch;
+        for (int i = 1; i < 3000; i += 4) {
+            batch.pushBack(i);
+            expected.insert(i);
+        }
+        tree.mergeSorted(batch.begin(), batch.end());
+        REQUIRE(tree.size() == expected.size());
+
+        bool select_valid = true;
+        std::size_t position = 0;
+        for (auto value : expected) {
+            select_valid = select_valid && *tree.select(position) == value;
+            ++position;
+        }
+        REQUIRE(select_valid);
+        REQUIRE(tree.select(tree.size()) == tree.end());
+
+        bool rank_valid = true;
+        for (int key = -1; key < 10300; key += 7) {
+            auto expected_rank = static_cast<std::size_t>(std::distance(expected.begin(), expected.lower_bound(key)));
+            rank_valid = rank_valid && tree.rank(key) == expected_rank;
+        }
+        REQUIRE(rank_valid);
+
+        REQUIRE(tree.countRange(0, 10) == 6);
+        REQUIRE(tree.countRange(10, 0) == 0);
+        REQUIRE(tree.countRange(-100, 100000) == tree.size());
+
+        // percentiles of a live distribution
+        auto median = *tree.select(tree.size() / 2);
+        REQUIRE(tree.rank(median) == tree.size() / 2);
+
+        tree.clear();
+        REQUIRE(tree.rank(5) == 0);
+        REQUIRE(tree.select(0) == tree.end());
+    }
+}
+
+TEST_CASE("AVLTree Benchmark", "[.benchmark][avl_tree]") {
+    constexpr int kCount = 1000000;
+    auto scrambled = [](int i) { return static_cast<int>((static_cast<int64_t>(i) * 7919) % kCount); };
+
+    {
+        nxt::core::StopWatch watch("AVLTree");
+        std::map<int, int> map;
+        for (int i = 0; i < kCount; ++i) {
+            map.emplace(scrambled(i), i);
+        }
+        watch.start();
+        map.clear();
+        watch.stop();
+        WARN("std::map clear: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    {
+        nxt::core::StopWatch watch("AVLTree");
+        nxt::core::AVLTree<nxt::core::MappedTraits<int, int>> avl;
+        for (int i = 0; i < kCount; ++i) {
+            avl.insert({scrambled(i), i});
+        }
+        watch.start();
+        avl.clear();
+        watch.stop();
+        WARN("AVLTree clear: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    {
+        nxt::core::StopWatch watch("AVLTree");
+        watch.start();
+        nxt::core::AVLTree<nxt::core::MappedTraits<int, int>> avl;
+        for (int i = 0; i < kCount; ++i) {
+            avl.insert({scrambled(i), i});
+        }
+        for (int i = 0; i < kCount; i += 2) {
+            avl.erase(i);
+        }
+        for (int i = 0; i < kCount; i += 2) {
+            avl.insert({i, i});
+        }
+        watch.stop();
+        WARN("AVLTree insert, erase and reinsert: " << watch.getDuration<std::chrono::milliseconds>().count()
+                                                    << " ms");
+    }
+
+    {
+        nxt::core::Vector<std::pair<int, int>> values;
+        for (int i = 0; i < kCount; ++i) {
+            values.pushBack({i, i});
+        }
+
+        nxt::core::StopWatch watch("AVLTree");
+        watch.start();
+        nxt::core::AVLTree<nxt::core::MappedTraits<int, int>> avl;
+        for (const auto& value : values) {
+            avl.insert(value);
+        }
+        watch.stop();
+        WARN("AVLTree sorted inserts: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+        nxt::core::AVLTree<nxt::core::MappedTraits<int, int>> sorted_avl;
+        watch.reset();
+        watch.start();
+        sorted_avl.assignSorted(values.begin(), values.end());
+        watch.stop();
+        WARN("AVLTree assignSorted: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    {
+        nxt::core::StopWatch watch("AVLTree");
+        std::map<int, int> map;
+        watch.start();
+        for (int i = 0; i < kCount; ++i) {
+            map.emplace(scrambled(i), i);
+        }
+        watch.stop();
+        WARN("std::map random inserts: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+        nxt::core::AVLTree<nxt::core::MappedTraits<int, int>> avl;
+        watch.reset();
+        watch.start();
+        for (int i = 0; i < kCount; ++i) {
+            avl.emplace(scrambled(i), i);
+        }
+        watch.stop();
+        WARN("AVLTree random inserts: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    {
+        nxt::core::StopWatch watch("AVLTree");
+        std::map<int, int> map;
+        watch.start();
+        for (int i = 0; i < kCount; ++i) {
+            map.emplace_hint(map.end(), i, i);
+        }
+        watch.stop();
+        WARN("std::map sequential hint inserts: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+        nxt::core::AVLTree<nxt::core::MappedTraits<int, int>> avl;
+        watch.reset();
+        watch.start();
+        for (int i = 0; i < kCount; ++i) {
+            avl.insert(avl.end(), {i, i});
+        }
+        watch.stop();
+        WARN("AVLTree sequential hint inserts: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+}
@@ -0,0 +1,162 @@
+#include "catch.hpp"
+
+#include "../include/ECS/ArchetypeStorage.h"
+#include "../include/ECS/EntityManager.h"
+
+#include <memory>
+#include <string>
+
+namespace {
+struct Position {
+    float x;
+    float y;
+};
+
+struct Velocity {
+    float x;
+    float y;
+};
+
+struct Name {
+    std::string value;
+};
+}  // namespace
+
+TEST_CASE("ArchetypeStorage Tests", "[archetype_storage]") {
+    SECTION("Add and remove components") {
+        nxt::core::ArchetypeStorage storage;
+        nxt::core::Entity entity(0, 1);
+
+        REQUIRE_FALSE(storage.hasComponent<Position>(entity));
+        REQUIRE(storage.getComponent<Position>(entity) == nullptr);
+
+        storage.addComponent<Position>(entity, Position{1.0f, 2.0f});
+        REQUIRE(storage.hasComponent<Position>(entity));
+        REQUIRE_FALSE(storage.hasComponent<Velocity>(entity));
+        REQUIRE(storage.getComponent<Position>(entity)->y == 2.0f);
+
+        storage.addComponent<Velocity>(entity, Velocity{3.0f, 4.0f});
+        storage.addComponent<Name>(entity, Name{"entity"});
+        REQUIRE(storage.getComponent<Position>(entity)->x == 1.0f);
+        REQUIRE(storage.getComponent<Velocity>(entity)->x == 3.0f);
+        REQUIRE(storage.getComponent<Name>(entity)->value == "entity");
+        REQUIRE(storage.getArchetypeCount() == 3);
+
+        // adding an existing component replaces it
+        storage.addComponent<Position>(entity, Position{5.0f, 6.0f});
+        REQUIRE(storage.getComponent<Position>(entity)->x == 5.0f);
+        REQUIRE(storage.getArchetypeCount() == 3);
+
+        REQUIRE(storage.removeComponent<Velocity>(entity));
+        REQUIRE_FALSE(storage.removeComponent<Velocity>(entity));
+        REQUIRE_FALSE(storage.hasComponent<Velocity>(entity));
+        REQUIRE(storage.getComponent<Position>(entity)->y == 6.0f);
+        REQUIRE(storage.getComponent<Name>(entity)->value == "entity");
+
+        // an entity of a different generation doesn't see the components
+        REQUIRE_FALSE(storage.hasComponent<Position>(nxt::core::Entity(0, 2)));
+
+        REQUIRE(storage.removeEntity(entity));
+        REQUIRE_FALSE(storage.hasComponent<Position>(entity));
+        REQUIRE_FALSE(storage.removeEntity(entity));
+    }
+
+    SECTION("Same component set shares an archetype") {
+        nxt::core::ArchetypeStorage storage;
+        nxt::core::Entity first(0, 1);
+        nxt::core::Entity second(1, 1);
+
+        storage.addComponent<Position>(first, Position{1.0f, 1.0f});
+        storage.addComponent<Velocity>(first, Velocity{1.0f, 1.0f});
+
+        // different insertion order ends in the same archetype
+        storage.addComponent<Velocity>(second, Velocity{2.0f, 2.0f});
+        storage.addComponent<Position>(second, Position{2.0f, 2.0f});
+
+        int count = 0;
+        storage.forEach<Position, Velocity>([&count](const nxt::core::Entity&, Position&, Velocity&) { ++count; });
+        REQUIRE(count == 2);
+    }
+
+    SECTION("Iteration over many entities") {
+        constexpr uint32_t kCount = 10000;
+        nxt::core::ArchetypeStorage storage;
+
+        for (uint32_t i = 0; i < kCount; ++i) {
+            nxt::core::Entity entity(i, 1);
+            storage.addComponent<Position>(entity, Position{static_cast<float>(i), 0.0f});
+            if (i % 2 == 0) {
+                storage.addComponent<Velocity>(entity, Velocity{1.0f, 2.0f});
+            }
+        }
+
+        storage.forEach<Position, Velocity>([](const nxt::core::Entity&, Position& position, Velocity& velocity) {
+            position.x += velocity.x;
+            position.y += velocity.y;
+        });
+
+        int position_count = 0;
+        bool all_updated = true;
+        storage.forEach<Position>([&](const nxt::core::Entity& entity, const Position& position) {
+            ++position_count;
+            auto index = entity.getIndex();
+            auto expected_x = static_cast<float>(index) + (index % 2 == 0 ? 1.0f : 0.0f);
+            all_updated = all_updated && position.x == expected_x;
+        });
+        REQUIRE(position_count == kCount);
+        REQUIRE(all_updated);
+
+        // removing entities from the middle keeps the rest reachable
+        for (uint32_t i = 0; i < kCount; i += 3) {
+            REQUIRE(storage.removeEntity(nxt::core::Entity(i, 1)));
+        }
+
+        position_count = 0;
+        storage.forEach<Position>([&position_count](const nxt::core::Entity&, Position&) { ++position_count; });
+        REQUIRE(position_count == kCount - (kCount + 2) / 3);
+
+        for (uint32_t i = 1; i < kCount; i += 3) {
+            nxt::core::Entity entity(i, 1);
+            REQUIRE(storage.getComponent<Position>(entity)->y == (i % 2 == 0 ? 2.0f : 0.0f));
+        }
+    }
+
+    SECTION("Components are destroyed") {
+        auto shared = std::make_shared<int>(1);
+        {
+            nxt::core::ArchetypeStorage storage;
+            for (uint32_t i = 0; i < 100; ++i) {
+                nxt::core::Entity entity(i, 1);
+                storage.addComponent<std::shared_ptr<int>>(entity, shared);
+                storage.addComponent<Position>(entity, Position{0.0f, 0.0f});
+            }
+            REQUIRE(shared.use_count() == 101);
+
+            storage.removeComponent<std::shared_ptr<int>>(nxt::core::Entity(0, 1));
+            storage.removeEntity(nxt::core::Entity(1, 1));
+            REQUIRE(shared.use_count() == 99);
+        }
+        REQUIRE(shared.use_count() == 1);
+    }
+}
+
+TEST_CASE("EntityManager Component Data Tests", "[archetype_storage]") {
+    auto manager = nxt::core::EntityManager::get();
+    auto entity = manager->createEntity();
+
+    manager->addComponent<Position>(entity, Position{1.0f, 2.0f});
+    manager->addComponent<Name>(entity, Name{"player"});
+    REQUIRE(manager->hasComponent<Position>(entity));
+    REQUIRE(manager->getComponent<Name>(entity)->value == "player");
+
+    int count = 0;
+    manager->forEach<Position, Name>([&](const nxt::core::Entity& current, Position& position, Name&) {
+        REQUIRE(current == entity);
+        REQUIRE(position.y == 2.0f);
+        ++count;
+    });
+    REQUIRE(count == 1);
+
+    REQUIRE(manager->destroyEntity(entity));
+    REQUIRE_FALSE(manager->hasComponent<Position>(entity));
+}
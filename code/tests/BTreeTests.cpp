@@ -0,0 +1,398 @@
+#include "catch.hpp"
+
+#include "CountingResource.h"
+
+#include "../include/Container/AVLTree.h"
+#include "../include/Container/BTree.h"
+#include "../include/Memory/MemoryResource.h"
+#include "../include/Util/StopWatch.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+using nxt::tests::CountingResource;
+
+// value whose constructor throws on request
+struct ThrowingValue {
+    explicit ThrowingValue(bool fail) {
+        if (fail) {
+            throw std::runtime_error("ThrowingValue");
+        }
+    }
+};
+
+// small nodes to get a deep tree out of a few values
+using SmallTree = nxt::core::BTree<int, int, 64>;
+
+template<typename Tree>
+bool
+matches(const Tree& tree, const std::map<int, int>& expected) {
+    if (tree.size() != expected.size()) {
+        return false;
+    }
+
+    auto it = tree.begin();
+    for (const auto& value : expected) {
+        if (it == tree.end() || it->first != value.first || it->second != value.second) {
+            return false;
+        }
+        ++it;
+    }
+    return it == tree.end();
+}
+}  // namespace
+
+TEST_CASE("BTree Tests", "[btree]") {
+    SECTION("sorting check") {
+        int values[] = {5, 8, 0, 1, 12, -5, 6};
+        int sorted_values[] = {-5, 0, 1, 5, 6, 8, 12};
+
+        SmallTree tree;
+        for (auto value : values) {
+            REQUIRE(tree.insert({value, 2 * value}).second);
+        }
+        REQUIRE_FALSE(tree.insert({5, 0}).second);
+        REQUIRE(tree.find(5)->second == 10);
+        REQUIRE(tree.size() == 7);
+
+        std::size_t i = 0;
+        for (const auto& value : tree) {
+            REQUIRE(value.first == sorted_values[i]);
+            REQUIRE(value.second == 2 * sorted_values[i]);
+            ++i;
+        }
+
+        i = 7;
+        for (auto it = tree.end(); it != tree.begin();) {
+            --it;
+            REQUIRE(it.key() == sorted_values[--i]);
+        }
+
+        REQUIRE(tree.erase(-5) == 1);
+        REQUIRE(tree.erase(-10) == 0);
+        REQUIRE(tree.size() == 6);
+        REQUIRE(tree.begin()->first == 0);
+
+        tree.find(8)->second = 100;
+        REQUIRE(tree.find(8).value() == 100);
+        REQUIRE(tree.find(7) == tree.end());
+
+        tree.clear();
+        REQUIRE(tree.empty());
+        REQUIRE(tree.begin() == tree.end());
+    }
+
+    SECTION("random inserts and erases") {
+        SmallTree tree;
+        std::map<int, int> expected;
+
+        constexpr int kCount = 5000;
+        for (int i = 0; i < kCount; ++i) {
+            auto key = static_cast<int>((static_cast<int64_t>(i) * 7919) % kCount);
+            tree.emplace(key, i);
+            expected.emplace(key, i);
+        }
+        REQUIRE(tree.height() > 2);
+        REQUIRE(matches(tree, expected));
+
+        for (int i = 0; i < kCount; i += 3) {
+            REQUIRE(tree.erase(i) == 1);
+            expected.erase(i);
+        }
+        REQUIRE(matches(tree, expected));
+
+        for (int i = 0; i < kCount; i += 2) {
+            tree.tryEmplace(i, -i);
+            expected.emplace(i, -i);
+        }
+        REQUIRE(matches(tree, expected));
+
+        bool all_found = true;
+        for (int i = 0; i < kCount; ++i) {
+            auto it = tree.find(i);
+            auto expected_it = expected.find(i);
+            all_found = all_found &&
+                        (expected_it == expected.end() ? it == tree.end() : it->second == expected_it->second);
+        }
+        REQUIRE(all_found);
+
+        // erasing everything shrinks the tree back to nothing
+        for (int i = kCount - 1; i >= 0; --i) {
+            tree.erase(i);
+            expected.erase(i);
+            if (i % 500 == 0) {
+                REQUIRE(matches(tree, expected));
+            }
+        }
+        REQUIRE(tree.empty());
+        REQUIRE(tree.height() == 0);
+        REQUIRE(tree.begin() == tree.end());
+    }
+
+    SECTION("lower and upper bounds") {
+        SmallTree tree;
+        for (int i = 0; i < 1000; ++i) {
+            tree.insert({i * 2, i});
+        }
+
+        bool bounds_valid = true;
+        for (int i = -1; i < 2001; ++i) {
+            auto lower = tree.lowerBound(i);
+            auto upper = tree.upperBound(i);
+            auto expected_lower = i < 0 ? 0 : (i + 1) / 2 * 2;
+            auto expected_upper = i < 0 ? 0 : i / 2 * 2 + 2;
+            bounds_valid = bounds_valid &&
+                           (expected_lower >= 2000 ? lower == tree.end() : lower.key() == expected_lower);
+            bounds_valid = bounds_valid &&
+                           (expected_upper >= 2000 ? upper == tree.end() : upper.key() == expected_upper);
+        }
+        REQUIRE(bounds_valid);
+
+        // range scan
+        int sum = 0;
+        for (auto it = tree.lowerBound(100); it != tree.upperBound(200); ++it) {
+            sum += it->second;
+        }
+        REQUIRE(sum == (50 + 100) * 51 / 2);
+    }
+
+    SECTION("bulk load") {
+        for (int count : {0, 1, 5, 6, 100, 1234}) {
+            std::vector<std::pair<int, int>> values;
+            std::map<int, int> expected;
+            for (int i = 0; i < count; ++i) {
+                values.emplace_back(i * 3, i);
+                expected.emplace(i * 3, i);
+            }
+
+            SmallTree tree;
+            tree.insert({-1, -1});
+            tree.assignSorted(values.begin(), values.end());
+            REQUIRE(matches(tree, expected));
+
+            bool all_found = true;
+            for (int i = 0; i < count; ++i) {
+                all_found = all_found && tree.find(i * 3)->second == i;
+            }
+            REQUIRE(all_found);
+
+            // a bulk loaded tree keeps working after updates
+            for (int i = 0; i < count; i += 2) {
+                tree.erase(i * 3);
+                tree.insert({i * 3 + 1, i});
+                expected.erase(i * 3);
+                expected.emplace(i * 3 + 1, i);
+            }
+            REQUIRE(matches(tree, expected));
+        }
+    }
+
+    SECTION("allocation failures") {
+        CountingResource resource;
+        using Allocator = nxt::core::ResourceAllocator<std::pair<const int, int>>;
+        using FailingTree = nxt::core::BTree<int, int, 64, std::less<>, Allocator>;
+
+        // every allocation of a growing tree fails once, the tree keeps the values inserted so far
+        for (std::size_t budget = 0; budget < 120; budget += 7) {
+            {
+                FailingTree tree{Allocator(&resource)};
+                std::map<int, int> expected;
+                resource.allocations_left = budget;
+                try {
+                    for (int i = 0; i < 1000; ++i) {
+                        auto key = (i * 7919) % 1000;
+                        tree.insert({key, i});
+                        expected.emplace(key, i);
+                    }
+                } catch (const std::bad_alloc&) {
+                }
+                resource.allocations_left = SIZE_MAX;
+                REQUIRE(matches(tree, expected));
+
+                // the tree is still usable after the failure
+                tree.insert({5000, 1});
+                expected.emplace(5000, 1);
+                REQUIRE(matches(tree, expected));
+            }
+            REQUIRE(resource.live_count == 0);
+        }
+
+        // a throwing first insert leaves no root behind
+        {
+            nxt::core::BTree<int, ThrowingValue, 64> tree;
+            REQUIRE_THROWS_AS(tree.tryEmplace(1, true), std::runtime_error);
+            REQUIRE(tree.empty());
+            REQUIRE(tree.begin() == tree.end());
+            REQUIRE(tree.tryEmplace(2, false).second);
+            REQUIRE(tree.size() == 1);
+            REQUIRE(tree.begin()->first == 2);
+        }
+
+        std::vector<std::pair<int, int>> values;
+        for (int i = 0; i < 500; ++i) {
+            values.emplace_back(i, i);
+        }
+        for (std::size_t budget = 0; budget < 200; budget += 13) {
+            {
+                FailingTree tree{Allocator(&resource)};
+                resource.allocations_left = budget;
+                try {
+                    tree.assignSorted(values.begin(), values.end());
+                } catch (const std::bad_alloc&) {
+                    REQUIRE(tree.empty());
+                    REQUIRE(tree.begin() == tree.end());
+                }
+                resource.allocations_left = SIZE_MAX;
+            }
+            REQUIRE(resource.live_count == 0);
+        }
+    }
+
+    SECTION("copy and move") {
+        SmallTree tree;
+        std::map<int, int> expected;
+        for (int i = 0; i < 500; ++i) {
+            tree.insert({i, i * i});
+            expected.emplace(i, i * i);
+        }
+
+        auto copy_tree = tree;
+        REQUIRE(matches(copy_tree, expected));
+        copy_tree.erase(10);
+        REQUIRE(tree.find(10) != tree.end());
+
+        auto moved_tree = std::move(tree);
+        REQUIRE(tree.empty());
+        REQUIRE(matches(moved_tree, expected));
+    }
+
+    SECTION("non trivial values") {
+        CountingResource resource;
+        auto shared = std::make_shared<int>(0);
+        using Allocator = nxt::core::ResourceAllocator<std::pair<const std::string, std::shared_ptr<int>>>;
+        {
+            nxt::core::BTree<std::string, std::shared_ptr<int>, 256, std::less<>, Allocator> tree{
+                Allocator(&resource)};
+            for (int i = 0; i < 2000; ++i) {
+                tree.emplace(std::to_string(i), shared);
+            }
+            REQUIRE(shared.use_count() == 2001);
+
+            // heterogeneous lookup through std::less<>
+            REQUIRE(tree.find("1234") != tree.end());
+            REQUIRE(tree.contains(std::string("42")));
+            REQUIRE(tree.lowerBound("1999a").key() == "2");
+
+            for (int i = 0; i < 2000; i += 2) {
+                REQUIRE(tree.erase(std::to_string(i)) == 1);
+            }
+            REQUIRE(shared.use_count() == 1001);
+
+            auto copy_tree = tree;
+            REQUIRE(shared.use_count() == 2001);
+            copy_tree.clear();
+            REQUIRE(shared.use_count() == 1001);
+        }
+        REQUIRE(shared.use_count() == 1);
+        REQUIRE(resource.live_count == 0);
+    }
+}
+
+TEST_CASE("BTree Benchmark", "[.benchmark][btree]") {
+    constexpr int kCount = 1000000;
+    auto scrambled = [](int i) { return static_cast<int>((static_cast<int64_t>(i) * 7919) % kCount); };
+    // lookups in another order than the inserts, the AVLTree nodes are laid out in insertion order
+    auto lookup = [](int i) { return static_cast<int>((static_cast<int64_t>(i) * 104729) % kCount); };
+
+    nxt::core::AVLTree<nxt::core::MappedTraits<int, int>> avl;
+    nxt::core::BTree<int, int> tree;
+    {
+        nxt::core::StopWatch watch("BTree");
+        watch.start();
+        for (int i = 0; i < kCount; ++i) {
+            avl.insert({scrambled(i), i});
+        }
+        watch.stop();
+        WARN("AVLTree insert: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    {
+        nxt::core::StopWatch watch("BTree");
+        watch.start();
+        for (int i = 0; i < kCount; ++i) {
+            tree.insert({scrambled(i), i});
+        }
+        watch.stop();
+        WARN("BTree insert: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    {
+        nxt::core::StopWatch watch("BTree");
+        std::vector<std::pair<int, int>> values;
+        for (int i = 0; i < kCount; ++i) {
+            values.emplace_back(i, i);
+        }
+        nxt::core::BTree<int, int> loaded;
+        watch.start();
+        loaded.assignSorted(values.begin(), values.end());
+        watch.stop();
+        WARN("BTree bulk load: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    int64_t avl_sum = 0;
+    {
+        nxt::core::StopWatch watch("BTree");
+        watch.start();
+        for (int i = 0; i < kCount; ++i) {
+            avl_sum += avl.find(lookup(i))->second;
+        }
+        watch.stop();
+        WARN("AVLTree find: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    int64_t tree_sum = 0;
+    {
+        nxt::core::StopWatch watch("BTree");
+        watch.start();
+        for (int i = 0; i < kCount; ++i) {
+            tree_sum += tree.find(lookup(i))->second;
+        }
+        watch.stop();
+        WARN("BTree find: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+    REQUIRE(avl_sum == tree_sum);
+
+    avl_sum = 0;
+    {
+        nxt::core::StopWatch watch("BTree");
+        watch.start();
+        for (int pass = 0; pass < 10; ++pass) {
+            for (const auto& value : avl) {
+                avl_sum += value.second;
+            }
+        }
+        watch.stop();
+        WARN("AVLTree scan: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    tree_sum = 0;
+    {
+        nxt::core::StopWatch watch("BTree");
+        watch.start();
+        for (int pass = 0; pass < 10; ++pass) {
+            for (const auto& value : tree) {
+                tree_sum += value.second;
+            }
+        }
+        watch.stop();
+        WARN("BTree scan: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+    REQUIRE(avl_sum == tree_sum);
+}
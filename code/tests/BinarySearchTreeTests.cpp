@@ -1,6 +1,11 @@
 #include "catch.hpp"
 
 #include "../include/Container/BinarySearchTree.h"
+#include "../include/Container/Vector.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
 
 TEST_CASE("BinarySeachTree Tests", "[binary_search_tree]") {
     SECTION("sorting check") {
@@ -92,4 +97,125 @@ TEST_CASE("BinarySeachTree Tests", "[binary_search_tree]") {
             ++i;
         }
     }
-}
\ No newline at end of file
+
+    SECTION("node pooling") {
+        auto shared = std::make_shared<int>(0);
+        nxt::core::BinarySearchTree<nxt::core::MappedTraits<int, std::shared_ptr<int>>> bst;
+        for (int i = 0; i < 1000; ++i) {
+            bst.insert({(i * 7919) % 1000, shared});
+        }
+        REQUIRE(shared.use_count() == 1001);
+
+        for (int i = 0; i < 1000; i += 3) {
+            REQUIRE(bst.erase(i) == 1);
+        }
+        REQUIRE(bst.size() == 666);
+        REQUIRE(shared.use_count() == 667);
+        REQUIRE(bst.find(3) == bst.end());
+        REQUIRE(bst.find(4) != bst.end());
+
+        int expected = 1;
+        bool sorted = true;
+        for (const auto& value : bst) {
+            sorted = sorted && value.first == expected;
+            expected += expected % 3 == 2 ? 2 : 1;
+        }
+        REQUIRE(sorted);
+
+        bst.clear();
+        REQUIRE(shared.use_count() == 1);
+        REQUIRE(bst.begin() == bst.end());
+
+        bst.insert({1, shared});
+        REQUIRE(bst.size() == 1);
+    }
+
+    SECTION("sorted build and merge") {
+        nxt::core::Vector<int> evens;
+        for (int i = 0; i < 1000; ++i) {
+            evens.pushBack(i * 2);
+        }
+
+        nxt::core::BinarySearchTree<nxt::core::SimpleTraits<int>> bst;
+        bst.insert(7);
+        bst.assignSorted(evens.begin(), evens.end());
+        REQUIRE(bst.size() == 1000);
+        REQUIRE(bst.find(7) == bst.end());
+
+        bool in_order = true;
+        int expected = 0;
+        for (auto value : bst) {
+            in_order = in_order && value == expected;
+            expected += 2;
+        }
+        REQUIRE(in_order);
+        REQUIRE(*--bst.end() == 1998);
+
+        // a large batch is merged, keys already present are skipped
+        nxt::core::Vector<int> batch;
+        for (int i = 0; i < 2000; i += 3) {
+            batch.pushBack(i);
+        }
+        auto is_odd = [](int value) { return value % 2 != 0; };
+        auto expected_inserted = std::count_if(batch.begin(), batch.end(), is_odd);
+        REQUIRE(bst.mergeSorted(batch.begin(), batch.end()) == static_cast<std::size_t>(expected_inserted));
+        REQUIRE(bst.size() == 1000 + static_cast<std::size_t>(expected_inserted));
+
+        bool merged = true;
+        int previous = -1;
+        std::size_t count = 0;
+        for (auto value : bst) {
+            merged = merged && value > previous && (value % 2 == 0 || value % 3 == 0);
+            previous = value;
+            ++count;
+        }
+        REQUIRE(merged);
+        REQUIRE(count == bst.size());
+
+        // a small batch is inserted value by value
+        int small_batch[] = {-1, 5, 1998, 5000};
+        REQUIRE(bst.mergeSorted(std::begin(small_batch), std::end(small_batch)) == 3);
+        REQUIRE(*bst.begin() == -1);
+        REQUIRE(*--bst.end() == 5000);
+
+        // the built tree keeps working with single inserts and erases
+        for (int i = 0; i < 2000; ++i) {
+            bst.erase(i);
+        }
+        REQUIRE(bst.size() == 2);
+
+        // range constructor, with sorted and unsorted input
+        nxt::core::BinarySearchTree<nxt::core::SimpleTraits<int>> from_sorted(evens.begin(), evens.end());
+        REQUIRE(from_sorted.size() == 1000);
+        int unsorted[] = {5, 1, 3, 1, 4};
+        nxt::core::BinarySearchTree<nxt::core::SimpleTraits<int>> from_unsorted(std::begin(unsorted),
+                                                                                std::end(unsorted));
+        REQUIRE(from_unsorted.size() == 4);
+        REQUIRE(*from_unsorted.begin() == 1);
+    }
+
+    SECTION("degenerate input") {
+        // sorted inserts build a list, which the iterative paths handle without recursing per level
+        constexpr int kCount = 20000;
+        nxt::core::BinarySearchTree<nxt::core::SimpleTraits<int>> bst;
+        for (int i = 0; i < kCount; ++i) {
+            bst.insert(i);
+        }
+        for (int i = kCount; i < 50 * kCount; ++i) {
+            bst.insert(bst.end(), i);
+        }
+        REQUIRE(bst.size() == 50 * kCount);
+        REQUIRE(bst.find(kCount - 1) != bst.end());
+        REQUIRE(*--bst.end() == 50 * kCount - 1);
+
+        auto copy_bst = bst;
+        REQUIRE(copy_bst.size() == 50 * kCount);
+        REQUIRE(copy_bst.find(50 * kCount - 1) != copy_bst.end());
+
+        for (int i = 0; i < kCount; ++i) {
+            bst.erase(i);
+        }
+        REQUIRE(bst.size() == 49 * kCount);
+        REQUIRE(*bst.begin() == kCount);
+    }
+}
@@ -0,0 +1,224 @@
+#include "catch.hpp"
+
+#include "../include/Container/ConcurrentRingBuffer.h"
+#include "../include/Container/Queue.h"
+#include "../include/Container/Vector.h"
+#include "../include/Util/StopWatch.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+// value whose constructor throws for negative values
+struct ThrowingValue {
+    ThrowingValue(int value = 0)
+        : value(value) {
+        if (value < 0) {
+            throw std::invalid_argument("negative value");
+        }
+    }
+
+    int value;
+};
+
+// pushes [0, count) from every producer and checks that every value is popped exactly once
+template<typename RingBuffer>
+void
+runProducersAndConsumers(RingBuffer& ring_buffer, int producer_count, int consumer_count, int count) {
+    std::atomic<long long> popped_sum = 0;
+    std::atomic<int> popped_count = 0;
+    const int total_count = producer_count * count;
+
+    nxt::core::Vector<std::thread> threads;
+    for (int i = 0; i < producer_count; ++i) {
+        threads.emplaceBack([&ring_buffer, count]() {
+            for (int value = 0; value < count; ++value) {
+                while (!ring_buffer.tryPushBack(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < consumer_count; ++i) {
+        threads.emplaceBack([&ring_buffer, &popped_sum, &popped_count, total_count]() {
+            int value = 0;
+            while (popped_count.load() < total_count) {
+                if (ring_buffer.tryPopFront(value)) {
+                    popped_sum.fetch_add(value);
+                    popped_count.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(popped_count == total_count);
+    REQUIRE(popped_sum == static_cast<long long>(producer_count) * count * (count - 1) / 2);
+    REQUIRE(ring_buffer.empty());
+}
+}  // namespace
+
+TEST_CASE("ConcurrentRingBuffer Tests", "[concurrent_ring_buffer]") {
+    SECTION("MPMCRingBuffer single thread Tests") {
+        nxt::core::MPMCRingBuffer<std::string> ring_buffer(5);
+        REQUIRE(ring_buffer.capacity() == 8);
+        REQUIRE(ring_buffer.empty());
+        REQUIRE_FALSE(ring_buffer.tryPopFront().has_value());
+
+        for (int i = 0; i < 8; ++i) {
+            REQUIRE(ring_buffer.tryPushBack(std::to_string(i)));
+        }
+        REQUIRE_FALSE(ring_buffer.tryPushBack("full"));
+        REQUIRE(ring_buffer.size() == 8);
+
+        REQUIRE(ring_buffer.tryPopFront() == "0");
+        std::string value;
+        REQUIRE(ring_buffer.tryPopFront(value));
+        REQUIRE(value == "1");
+
+        // wrap around the end of the buffer
+        REQUIRE(ring_buffer.tryEmplaceBack(3, 'a'));
+        REQUIRE(ring_buffer.tryPushBack("9"));
+        REQUIRE_FALSE(ring_buffer.tryPushBack("full"));
+
+        for (int i = 2; i < 8; ++i) {
+            REQUIRE(ring_buffer.tryPopFront() == std::to_string(i));
+        }
+        REQUIRE(ring_buffer.tryPopFront() == "aaa");
+        REQUIRE(ring_buffer.tryPopFront() == "9");
+        REQUIRE(ring_buffer.empty());
+
+        // values left in the buffer are destroyed with it
+        auto shared = std::make_shared<int>(1);
+        {
+            nxt::core::MPMCRingBuffer<std::shared_ptr<int>> shared_buffer(4);
+            REQUIRE(shared_buffer.tryPushBack(shared));
+            REQUIRE(shared_buffer.tryPushBack(shared));
+            REQUIRE(shared.use_count() == 3);
+        }
+        REQUIRE(shared.use_count() == 1);
+    }
+
+    SECTION("MPSCRingBuffer single thread Tests") {
+        nxt::core::MPSCRingBuffer<int> ring_buffer(4);
+        REQUIRE(ring_buffer.capacity() == 4);
+
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(ring_buffer.tryPushBack(i));
+        }
+        REQUIRE_FALSE(ring_buffer.tryPushBack(4));
+
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(ring_buffer.tryPopFront() == i);
+        }
+        REQUIRE_FALSE(ring_buffer.tryPopFront().has_value());
+    }
+
+    SECTION("Throwing constructor Tests") {
+        // a failed construction must not leave a claimed slot behind which blocks the consumers
+        nxt::core::MPMCRingBuffer<ThrowingValue> mpmc_buffer(2);
+        REQUIRE_THROWS_AS(mpmc_buffer.tryEmplaceBack(-1), std::invalid_argument);
+        REQUIRE(mpmc_buffer.empty());
+        REQUIRE(mpmc_buffer.tryEmplaceBack(1));
+        REQUIRE(mpmc_buffer.tryEmplaceBack(2));
+        REQUIRE_FALSE(mpmc_buffer.tryEmplaceBack(3));
+        REQUIRE(mpmc_buffer.tryPopFront()->value == 1);
+        REQUIRE(mpmc_buffer.tryPopFront()->value == 2);
+
+        nxt::core::MPSCRingBuffer<ThrowingValue> mpsc_buffer(2);
+        REQUIRE_THROWS_AS(mpsc_buffer.tryEmplaceBack(-1), std::invalid_argument);
+        REQUIRE(mpsc_buffer.tryEmplaceBack(1));
+        REQUIRE(mpsc_buffer.tryPopFront()->value == 1);
+        REQUIRE(mpsc_buffer.empty());
+    }
+
+    SECTION("SPSCRingBuffer single thread Tests") {
+        nxt::core::SPSCRingBuffer<std::unique_ptr<int>> ring_buffer(2);
+        REQUIRE(ring_buffer.tryPushBack(std::make_unique<int>(1)));
+        REQUIRE(ring_buffer.tryEmplaceBack(new int(2)));
+        REQUIRE_FALSE(ring_buffer.tryPushBack(std::make_unique<int>(3)));
+        REQUIRE(ring_buffer.size() == 2);
+
+        REQUIRE(*ring_buffer.tryPopFront().value() == 1);
+        REQUIRE(ring_buffer.tryPushBack(std::make_unique<int>(3)));
+        REQUIRE(*ring_buffer.tryPopFront().value() == 2);
+        REQUIRE(*ring_buffer.tryPopFront().value() == 3);
+        REQUIRE(ring_buffer.empty());
+    }
+
+    SECTION("Multi threaded Tests") {
+        nxt::core::MPMCRingBuffer<int> mpmc_buffer(64);
+        runProducersAndConsumers(mpmc_buffer, 4, 4, 20000);
+
+        nxt::core::MPSCRingBuffer<int> mpsc_buffer(64);
+        runProducersAndConsumers(mpsc_buffer, 4, 1, 20000);
+
+        nxt::core::SPSCRingBuffer<int> spsc_buffer(64);
+        runProducersAndConsumers(spsc_buffer, 1, 1, 50000);
+    }
+}
+
+namespace {
+// Queue guarded by a mutex with the same interface as the lock-free ring buffers
+class LockedQueue {
+public:
+    bool tryPushBack(int value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(value);
+        return true;
+    }
+
+    bool tryPopFront(int& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) {
+            return false;
+        }
+        value = queue_.popAndExtract();
+        return true;
+    }
+
+    bool empty() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.empty();
+    }
+
+private:
+    std::mutex mutex_;
+    nxt::core::Queue<int> queue_;
+};
+}  // namespace
+
+TEST_CASE("ConcurrentRingBuffer Benchmark", "[.benchmark][concurrent_ring_buffer]") {
+    constexpr int kCount = 1000000;
+    const int thread_count = static_cast<int>(std::max(std::thread::hardware_concurrency() / 2, 1u));
+
+    auto measure = [thread_count](const std::string& name, auto& queue, int consumer_count) {
+        nxt::core::StopWatch watch(name);
+        watch.start();
+        runProducersAndConsumers(queue, thread_count, consumer_count, kCount / thread_count);
+        watch.stop();
+        WARN(name << ": " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    };
+
+    LockedQueue locked_queue;
+    measure("Queue + std::mutex MPMC", locked_queue, thread_count);
+
+    nxt::core::MPMCRingBuffer<int> mpmc_buffer(1024);
+    measure("MPMCRingBuffer", mpmc_buffer, thread_count);
+
+    LockedQueue locked_mpsc_queue;
+    measure("Queue + std::mutex MPSC", locked_mpsc_queue, 1);
+
+    nxt::core::MPSCRingBuffer<int> mpsc_buffer(1024);
+    measure("MPSCRingBuffer", mpsc_buffer, 1);
+}
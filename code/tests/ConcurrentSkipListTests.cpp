@@ -0,0 +1,158 @@
+#include "catch.hpp"
+
+#include "../include/Container/CommonTree.h"
+#include "../include/Container/ConcurrentSkipList.h"
+#include "../include/Container/Vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+
+TEST_CASE("ConcurrentSkipList Tests", "[skip_list]") {
+    SECTION("single thread") {
+        int values[] = {5, 8, 0, 1, 12, -5, 6};
+        int sorted_values[] = {-5, 0, 1, 5, 6, 8, 12};
+
+        nxt::core::ConcurrentSkipList<nxt::core::MappedTraits<int, std::string>> skip_list;
+        for (auto value : values) {
+            REQUIRE(skip_list.insert({value, std::to_string(value)}));
+        }
+        REQUIRE_FALSE(skip_list.insert({5, "duplicate"}));
+        REQUIRE(skip_list.size() == 7);
+
+        std::size_t i = 0;
+        for (const auto& value : skip_list) {
+            REQUIRE(value.first == sorted_values[i]);
+            REQUIRE(value.second == std::to_string(sorted_values[i]));
+            ++i;
+        }
+        REQUIRE(i == 7);
+
+        REQUIRE(skip_list.find(8)->second == "8");
+        REQUIRE(skip_list.find(7) == skip_list.end());
+        REQUIRE(skip_list.erase(-5) == 1);
+        REQUIRE(skip_list.erase(-5) == 0);
+        REQUIRE_FALSE(skip_list.contains(-5));
+        REQUIRE(skip_list.begin()->first == 0);
+
+        // an erased key can be inserted again
+        REQUIRE(skip_list.insert({-5, "again"}));
+        REQUIRE(skip_list.find(-5)->second == "again");
+        skip_list.reclaim();
+        REQUIRE(skip_list.size() == 7);
+
+        skip_list.clear();
+        REQUIRE(skip_list.empty());
+        REQUIRE(skip_list.begin() == skip_list.end());
+    }
+
+    SECTION("multiple writers") {
+        constexpr int kThreadCount = 4;
+        constexpr int kCount = 20000;
+
+        nxt::core::ConcurrentSkipList<nxt::core::SimpleTraits<int>> skip_list;
+        std::atomic<int> inserted_count = 0;
+        nxt::core::Vector<std::thread> threads;
+        // every thread inserts all the keys, only one insert of each succeeds
+        for (int t = 0; t < kThreadCount; ++t) {
+            threads.emplaceBack([&skip_list, &inserted_count, t]() {
+                for (int i = 0; i < kCount; ++i) {
+                    auto value = (i * 7919 + t) % kCount;
+                    if (skip_list.insert(value)) {
+                        inserted_count.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(inserted_count.load() == kCount);
+        REQUIRE(skip_list.size() == kCount);
+        int expected = 0;
+        bool in_order = true;
+        for (auto value : skip_list) {
+            in_order = in_order && value == expected;
+            ++expected;
+        }
+        REQUIRE(in_order);
+        REQUIRE(expected == kCount);
+    }
+
+    SECTION("multiple writers moving values in") {
+        constexpr int kThreadCount = 8;
+        constexpr int kCount = 5000;
+
+        nxt::core::ConcurrentSkipList<nxt::core::SimpleTraits<std::string>> skip_list;
+        nxt::core::Vector<std::thread> threads;
+        // long strings, so a moved-from value is left empty
+        for (int t = 0; t < kThreadCount; ++t) {
+            threads.emplaceBack([&skip_list, t]() {
+                for (int i = t; i < kCount; i += kThreadCount) {
+                    auto value = std::string(40, 'x') + std::to_string(kCount + (i * 7919) % kCount);
+                    skip_list.insert(std::move(value));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(skip_list.size() == kCount);
+        nxt::core::Vector<std::string> values;
+        for (const auto& value : skip_list) {
+            values.pushBack(value);
+        }
+        REQUIRE(values.size() == kCount);
+        REQUIRE(std::is_sorted(values.begin(), values.end()));
+        REQUIRE(std::adjacent_find(values.begin(), values.end()) == values.end());
+    }
+
+    SECTION("concurrent inserts, erases and lookups") {
+        constexpr int kThreadCount = 4;
+        constexpr int kCount = 4096;
+
+        nxt::core::ConcurrentSkipList<nxt::core::SimpleTraits<int>> skip_list;
+        std::atomic<int> balance = 0;
+        std::atomic<bool> found_odd = false;
+        nxt::core::Vector<std::thread> threads;
+        for (int t = 0; t < kThreadCount; ++t) {
+            threads.emplaceBack([&skip_list, &balance, t]() {
+                nxt::core::RandomGenerator random(t + 1);
+                for (int i = 0; i < 50000; ++i) {
+                    auto value = static_cast<int>(random(64) * 977 + i) % kCount * 2;
+                    if (i % 2 == 0) {
+                        balance.fetch_add(skip_list.insert(value) ? 1 : 0);
+                    } else {
+                        balance.fetch_sub(static_cast<int>(skip_list.erase(value)));
+                    }
+                }
+            });
+        }
+        // the readers never see keys which are never inserted
+        threads.emplaceBack([&skip_list, &found_odd]() {
+            for (int i = 0; i < 50000; ++i) {
+                if (skip_list.contains((i % kCount) * 2 + 1)) {
+                    found_odd = true;
+                }
+            }
+        });
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE_FALSE(found_odd.load());
+        REQUIRE(skip_list.size() == static_cast<std::size_t>(balance.load()));
+        REQUIRE(static_cast<int>(std::distance(skip_list.begin(), skip_list.end())) == balance.load());
+        REQUIRE(std::is_sorted(skip_list.begin(), skip_list.end()));
+        REQUIRE(std::adjacent_find(skip_list.begin(), skip_list.end()) == skip_list.end());
+
+        skip_list.reclaim();
+        for (int i = 0; i < kCount; ++i) {
+            skip_list.erase(i * 2);
+        }
+        REQUIRE(skip_list.empty());
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "../include/Memory/MemoryResource.h"
+
+namespace nxt::tests {
+
+/**
+ * @brief Memory resource forwarding to the default resource and counting the calls, used by the tests to check
+ *        the allocations of containers and resources built on top of it. Allocations throw std::bad_alloc once
+ *        allocations_left runs out, to test the behavior on allocation failures
+ */
+class CountingResource : public core::MemoryResource {
+public:
+    std::size_t allocation_count = 0;
+    std::size_t deallocation_count = 0;
+    //! allocations not deallocated yet
+    std::size_t live_count = 0;
+    //! bytes allocated and not deallocated yet
+    std::size_t allocated_size = 0;
+    //! allocations which still succeed, the next ones throw std::bad_alloc
+    std::size_t allocations_left = SIZE_MAX;
+
+protected:
+    void* doAllocate(std::size_t size, std::size_t alignment) override {
+        if (allocations_left == 0) {
+            throw std::bad_alloc();
+        }
+        --allocations_left;
+        ++allocation_count;
+        ++live_count;
+        allocated_size += size;
+        return core::getDefaultResource()->allocate(size, alignment);
+    }
+
+    void doDeallocate(void* pointer, std::size_t size, std::size_t alignment) noexcept override {
+        ++deallocation_count;
+        --live_count;
+        allocated_size -= size;
+        core::getDefaultResource()->deallocate(pointer, size, alignment);
+    }
+};
+
+}  // namespace nxt::tests
@@ -0,0 +1,132 @@
+#include "catch.hpp"
+
+#include "../include/ECS/EntityCommandBuffer.h"
+#include "../include/ECS/EntityManager.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+struct Spawned {
+    int job;
+    int index;
+};
+
+struct Label {
+    std::string text;
+};
+}  // namespace
+
+TEST_CASE("EntityCommandBuffer Tests", "[entity_command_buffer]") {
+    auto manager = nxt::core::EntityManager::get();
+
+    SECTION("Playback applies the commands") {
+        nxt::core::DeferredEntityCommands commands;
+        auto existing = manager->createEntity();
+        manager->addComponent<Label>(existing, Label{"existing"});
+        auto doomed = manager->createEntity();
+
+        auto& buffer = commands.getThreadBuffer();
+        REQUIRE(&buffer == &commands.getThreadBuffer());
+
+        auto placeholder = buffer.createEntity();
+        REQUIRE(nxt::core::DeferredEntityCommands::isPlaceholder(placeholder));
+        REQUIRE_FALSE(manager->isAlive(placeholder));
+        buffer.addComponent<Label>(placeholder, Label{"created"});
+        buffer.addComponent<Spawned>(placeholder, Spawned{0, 1});
+        buffer.removeComponent<Spawned>(placeholder);
+        buffer.removeComponent<Label>(existing);
+        buffer.destroyEntity(doomed);
+        REQUIRE(buffer.size() == 6);
+
+        // nothing changes before the playback
+        REQUIRE(manager->hasComponent<Label>(existing));
+        REQUIRE(manager->isAlive(doomed));
+
+        REQUIRE(commands.playback(*manager) == 6);
+        REQUIRE(buffer.empty());
+        REQUIRE_FALSE(manager->hasComponent<Label>(existing));
+        REQUIRE_FALSE(manager->isAlive(doomed));
+
+        nxt::core::Vector<nxt::core::Entity> created;
+        manager->view<Label>().each([&](const nxt::core::Entity& entity, const Label& label) {
+            REQUIRE(label.text == "created");
+            REQUIRE_FALSE(manager->hasComponent<Spawned>(entity));
+            created.pushBack(entity);
+        });
+        REQUIRE(created.size() == 1);
+        manager->destroyEntities(created);
+        manager->destroyEntity(existing);
+    }
+
+    SECTION("Commands from many threads are applied in sort key order") {
+        constexpr int kJobCount = 8;
+        constexpr int kEntityCount = 500;
+        nxt::core::DeferredEntityCommands commands;
+
+        // jobs are recorded from different threads in a scrambled order
+        nxt::core::Vector<std::thread> threads;
+        for (int thread_index = 0; thread_index < 4; ++thread_index) {
+            threads.emplaceBack([&commands, thread_index]() {
+                auto& buffer = commands.getThreadBuffer();
+                for (int job = kJobCount - 1 - thread_index; job >= 0; job -= 4) {
+                    buffer.setSortKey(static_cast<uint64_t>(job));
+                    for (int i = 0; i < kEntityCount; ++i) {
+                        auto entity = buffer.createEntity();
+                        buffer.addComponent<Spawned>(entity, Spawned{job, i});
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(commands.playback(*manager) == kJobCount * kEntityCount * 2);
+
+        nxt::core::Vector<nxt::core::Entity> created;
+        nxt::core::Vector<uint32_t> first_index(kJobCount, UINT32_MAX);
+        nxt::core::Vector<uint32_t> last_index(kJobCount, 0);
+        manager->view<Spawned>().each([&](const nxt::core::Entity& entity, const Spawned& value) {
+            created.pushBack(entity);
+            first_index[value.job] = std::min(first_index[value.job], entity.getIndex());
+            last_index[value.job] = std::max(last_index[value.job], entity.getIndex());
+        });
+        REQUIRE(created.size() == kJobCount * kEntityCount);
+
+        // creation follows the sort keys: every entity created for a job comes before the ones of the next job
+        bool ordered = true;
+        for (int job = 1; job < kJobCount; ++job) {
+            ordered = ordered && last_index[job - 1] < first_index[job];
+        }
+        REQUIRE(ordered);
+
+        manager->destroyEntities(created);
+    }
+
+    SECTION("Clear drops the recorded components") {
+        auto shared = std::make_shared<int>(1);
+        {
+            nxt::core::DeferredEntityCommands commands;
+            auto& buffer = commands.getThreadBuffer();
+            for (int i = 0; i < 1000; ++i) {
+                buffer.addComponent<std::shared_ptr<int>>(buffer.createEntity(), shared);
+            }
+            REQUIRE(shared.use_count() == 1001);
+
+            commands.clear();
+            REQUIRE(shared.use_count() == 1);
+            REQUIRE(buffer.empty());
+
+            // large payloads and reused blocks
+            buffer.addComponent<std::array<char, 10000>>(buffer.createEntity());
+            buffer.addComponent<std::shared_ptr<int>>(buffer.createEntity(), shared);
+            REQUIRE(shared.use_count() == 2);
+        }
+        REQUIRE(shared.use_count() == 1);
+    }
+}
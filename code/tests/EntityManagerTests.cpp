@@ -0,0 +1,181 @@
+#include "catch.hpp"
+
+#include "../include/ECS/EntityManager.h"
+#include "../include/Util/StopWatch.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+
+namespace {
+// component tracking its entities in a set, counts the batch removals
+class TrackingComponent : public nxt::core::Component {
+public:
+    const std::string& getName() const noexcept override {
+        return name_;
+    }
+
+    nxt::core::Key addEntity(const nxt::core::Entity& entity) noexcept override {
+        entities_.insert(entity);
+        return {entity.getIndex(), entity.getGeneration()};
+    }
+
+    bool hasEntity(const nxt::core::Entity& entity) const noexcept override {
+        return entities_.count(entity) != 0;
+    }
+
+    bool removeEntity(const nxt::core::Entity& entity) noexcept override {
+        return entities_.erase(entity) != 0;
+    }
+
+    void removeEntities(const nxt::core::Entity* entities, std::size_t count) noexcept override {
+        ++batch_remove_count;
+        Component::removeEntities(entities, count);
+    }
+
+    bool isValid(const nxt::core::Key& key) const noexcept override {
+        return hasEntity(nxt::core::Entity(key.index, key.generation));
+    }
+
+    nxt::core::Key getKey(const nxt::core::Entity& entity) const noexcept override {
+        return {entity.getIndex(), entity.getGeneration()};
+    }
+
+    void onRegister() override {}
+
+    int batch_remove_count = 0;
+
+private:
+    std::string name_ = "TrackingComponent";
+    std::unordered_set<nxt::core::Entity> entities_;
+};
+
+class CreatedReceiver : public nxt::core::Receiver<nxt::core::EntitiesCreatedEvent>,
+                        public nxt::core::Receiver<nxt::core::EntityCreatedEvent> {
+public:
+    void Receive(const nxt::core::EntitiesCreatedEvent& event) override {
+        ++batch_event_count;
+        for (std::size_t i = 0; i < event.GetCreatedCount(); ++i) {
+            created_entities.insert(event.GetCreatedEntities()[i]);
+        }
+    }
+
+    void Receive(const nxt::core::EntityCreatedEvent&) override {
+        ++single_event_count;
+    }
+
+    int batch_event_count = 0;
+    int single_event_count = 0;
+    std::unordered_set<nxt::core::Entity> created_entities;
+};
+
+struct Particle {
+    float lifetime;
+};
+}  // namespace
+
+NXTCORE_REGISTER_COMPONENT_NO_EXPORT(TrackingComponent)
+NXTCORE_DEFINE_COMPONENT(TrackingComponent)
+
+TEST_CASE("EntityManager Tests", "[entity_manager]") {
+    auto manager = nxt::core::EntityManager::get();
+    if (!manager->isComponentRegistered<TrackingComponent>()) {
+        manager->registerComponent<TrackingComponent>();
+    }
+    auto component = manager->getComponent<TrackingComponent>();
+
+    SECTION("Batched creation and destruction") {
+        CreatedReceiver receiver;
+        manager->Subscribe<nxt::core::EntitiesCreatedEvent>(&receiver);
+        manager->Subscribe<nxt::core::EntityCreatedEvent>(&receiver);
+
+        auto entities = manager->createEntities(5000, true);
+        REQUIRE(entities.size() == 5000);
+        REQUIRE(receiver.batch_event_count == 1);
+        REQUIRE(receiver.single_event_count == 0);
+        REQUIRE(receiver.created_entities.size() == 5000);
+        REQUIRE(std::all_of(entities.begin(), entities.end(), [&receiver](const nxt::core::Entity& entity) {
+            return receiver.created_entities.count(entity) == 1;
+        }));
+
+        manager->Unsubscribe<nxt::core::EntitiesCreatedEvent>(&receiver);
+        manager->Unsubscribe<nxt::core::EntityCreatedEvent>(&receiver);
+
+        std::unordered_set<nxt::core::Entity> unique_entities(entities.begin(), entities.end());
+        REQUIRE(unique_entities.size() == entities.size());
+        for (const auto& entity : entities) {
+            REQUIRE(manager->isAlive(entity));
+            REQUIRE(manager->isTemporary(entity));
+            component->addEntity(entity);
+            manager->addComponent<Particle>(entity, Particle{1.0f});
+        }
+
+        auto batch_remove_count = component->batch_remove_count;
+        nxt::core::Vector<nxt::core::Entity> half(entities.begin(), entities.begin() + 2500);
+        REQUIRE(manager->destroyEntities(half) == 2500);
+        REQUIRE(component->batch_remove_count == batch_remove_count + 1);
+
+        // already destroyed entities are skipped
+        REQUIRE(manager->destroyEntities(half) == 0);
+
+        for (std::size_t i = 0; i < entities.size(); ++i) {
+            auto alive = i >= 2500;
+            REQUIRE(manager->isAlive(entities[i]) == alive);
+            REQUIRE(component->hasEntity(entities[i]) == alive);
+            REQUIRE(manager->hasComponent<Particle>(entities[i]) == alive);
+        }
+
+        REQUIRE(manager->destroyEntities(entities) == 2500);
+        REQUIRE(manager->view<Particle>().empty());
+    }
+
+    SECTION("Clear all entities") {
+        auto entities = manager->createEntities(100);
+        for (const auto& entity : entities) {
+            component->addEntity(entity);
+            manager->addComponent<Particle>(entity, Particle{2.0f});
+        }
+
+        manager->clearAllEntities();
+        REQUIRE(manager->getEntities().size() == 0);
+        for (const auto& entity : entities) {
+            REQUIRE_FALSE(manager->isAlive(entity));
+            REQUIRE_FALSE(component->hasEntity(entity));
+        }
+        REQUIRE(manager->view<Particle>().empty());
+
+        // entities created after clearing don't alias the old ones
+        auto entity = manager->createEntity();
+        REQUIRE(manager->isAlive(entity));
+        REQUIRE_FALSE(manager->isAlive(entities.front()));
+        manager->destroyEntity(entity);
+    }
+}
+
+TEST_CASE("EntityManager Benchmark", "[.benchmark][entity_manager]") {
+    constexpr std::size_t kCount = 100000;
+    auto manager = nxt::core::EntityManager::get();
+
+    {
+        nxt::core::StopWatch watch("createEntity");
+        watch.start();
+        nxt::core::Vector<nxt::core::Entity> entities;
+        for (std::size_t i = 0; i < kCount; ++i) {
+            entities.pushBack(manager->createEntity());
+        }
+        for (const auto& entity : entities) {
+            manager->destroyEntity(entity);
+        }
+        watch.stop();
+        WARN("createEntity + destroyEntity: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    {
+        nxt::core::StopWatch watch("createEntities");
+        watch.start();
+        auto entities = manager->createEntities(kCount);
+        manager->destroyEntities(entities);
+        watch.stop();
+        WARN("createEntities + destroyEntities: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+}
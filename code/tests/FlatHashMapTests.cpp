@@ -0,0 +1,245 @@
+#include "catch.hpp"
+
+#include "../include/Container/FlatHashMap.h"
+#include "../include/Container/Vector.h"
+#include "../include/Util/StopWatch.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+// hash sending every key to the same group, to test the probing
+struct CollidingHash {
+    std::size_t operator()(int) const noexcept {
+        return 0;
+    }
+};
+
+template<typename Map>
+std::size_t
+runMapBenchmark(const char* name, const nxt::core::Vector<uint64_t>& keys, const nxt::core::Vector<uint64_t>& misses) {
+    constexpr int kRoundCount = 20;
+
+    std::size_t sum = 0;
+    nxt::core::StopWatch watch(name);
+    watch.start();
+    for (int round = 0; round < kRoundCount; ++round) {
+        Map map;
+        for (auto key : keys) {
+            map[key] = key;
+        }
+        sum += map.size();
+    }
+    watch.stop();
+    WARN(name << " insert: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    Map map;
+    for (auto key : keys) {
+        map[key] = key;
+    }
+    watch.reset();
+    watch.start();
+    for (int round = 0; round < kRoundCount; ++round) {
+        for (auto key : keys) {
+            sum += map.find(key)->second;
+        }
+    }
+    watch.stop();
+    WARN(name << " successful find: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    watch.reset();
+    watch.start();
+    for (int round = 0; round < kRoundCount; ++round) {
+        for (auto key : misses) {
+            sum += map.count(key);
+        }
+    }
+    watch.stop();
+    WARN(name << " failed find: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    watch.reset();
+    watch.start();
+    for (int round = 0; round < kRoundCount; ++round) {
+        for (const auto& value : map) {
+            sum += value.second;
+        }
+    }
+    watch.stop();
+    WARN(name << " iteration: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    watch.reset();
+    watch.start();
+    for (auto key : keys) {
+        map.erase(key);
+    }
+    watch.stop();
+    WARN(name << " erase: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    return sum;
+}
+}  // namespace
+
+TEST_CASE("FlatHashMap Tests", "[flat_hash_map]") {
+    SECTION("insert, find and erase") {
+        nxt::core::FlatHashMap<int, std::string> map;
+        REQUIRE(map.empty());
+        REQUIRE(map.find(1) == map.end());
+        REQUIRE(map.begin() == map.end());
+
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(map.insert({i, std::to_string(i)}).second);
+        }
+        REQUIRE_FALSE(map.insert({5, "duplicate"}).second);
+        REQUIRE_FALSE(map.tryEmplace(5, "duplicate").second);
+        REQUIRE(map.size() == 100);
+        REQUIRE(map.capacity() == 128);
+        REQUIRE(map.at(5) == "5");
+        REQUIRE_THROWS_AS(map.at(100), std::out_of_range);
+
+        for (int i = 0; i < 100; i += 2) {
+            REQUIRE(map.erase(i) == 1);
+        }
+        REQUIRE(map.erase(0) == 0);
+        REQUIRE(map.size() == 50);
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(map.contains(i) == (i % 2 == 1));
+        }
+
+        std::size_t count = 0;
+        for (const auto& value : map) {
+            REQUIRE(value.second == std::to_string(value.first));
+            ++count;
+        }
+        REQUIRE(count == 50);
+
+        map[7] = "seven";
+        map[200] = "two hundred";
+        REQUIRE(map.find(7)->second == "seven");
+        REQUIRE(map.size() == 51);
+        REQUIRE(map.insertOrAssign(200, "200").second == false);
+        REQUIRE(map.at(200) == "200");
+
+        auto iter = map.erase(map.find(7));
+        REQUIRE_FALSE(map.contains(7));
+        for (; iter != map.end(); ++iter) {
+            REQUIRE(iter->first != 7);
+        }
+
+        map.clear();
+        REQUIRE(map.empty());
+        REQUIRE(map.begin() == map.end());
+        REQUIRE(map.capacity() == 128);
+    }
+
+    SECTION("random operations against std::unordered_map") {
+        nxt::core::FlatHashMap<uint32_t, uint32_t> map;
+        std::unordered_map<uint32_t, uint32_t> expected;
+        std::mt19937 random(42);
+        // few keys, so that the erased slots are reused and the table is rebuilt in place
+        for (int i = 0; i < 200000; ++i) {
+            auto key = static_cast<uint32_t>(random() % 2000);
+            if (random() % 3 == 0) {
+                REQUIRE(map.erase(key) == expected.erase(key));
+            } else {
+                map[key] = static_cast<uint32_t>(i);
+                expected[key] = static_cast<uint32_t>(i);
+            }
+        }
+        REQUIRE(map.size() == expected.size());
+        for (const auto& value : expected) {
+            auto iter = map.find(value.first);
+            REQUIRE(iter != map.end());
+            REQUIRE(iter->second == value.second);
+        }
+        REQUIRE(static_cast<std::size_t>(std::distance(map.begin(), map.end())) == expected.size());
+        REQUIRE(map.capacity() <= 4096);
+    }
+
+    SECTION("colliding hashes") {
+        nxt::core::FlatHashSet<int, CollidingHash> set;
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(set.insert(i).second);
+        }
+        for (int i = 0; i < 100; i += 3) {
+            set.erase(i);
+        }
+        for (int i = 0; i < 120; ++i) {
+            REQUIRE(set.contains(i) == (i < 100 && i % 3 != 0));
+        }
+    }
+
+    SECTION("heterogeneous lookup") {
+        nxt::core::FlatHashMap<std::string, int, nxt::core::StringHash, std::equal_to<>> map = {{"one", 1}, {"two", 2}};
+        std::string_view key = "two";
+        REQUIRE(map.find(key)->second == 2);
+        REQUIRE(map.contains("one"));
+        REQUIRE(map.count(std::string_view("three")) == 0);
+    }
+
+    SECTION("reserve and rehash") {
+        nxt::core::FlatHashSet<int> set;
+        set.reserve(100);
+        auto capacity = set.capacity();
+        REQUIRE(capacity == 128);
+        for (int i = 0; i < 100; ++i) {
+            set.insert(i);
+        }
+        REQUIRE(set.capacity() == capacity);
+
+        for (int i = 10; i < 100; ++i) {
+            set.erase(i);
+        }
+        set.rehash(0);
+        REQUIRE(set.capacity() == 16);
+        REQUIRE(set.size() == 10);
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(set.contains(i));
+        }
+
+        set.rehash(1000);
+        REQUIRE(set.capacity() == 1024);
+        REQUIRE(set.size() == 10);
+
+        set.clear();
+        set.rehash(0);
+        REQUIRE(set.capacity() == 0);
+    }
+
+    SECTION("copy and move") {
+        nxt::core::FlatHashMap<std::string, std::unique_ptr<int>> pointers;
+        for (int i = 0; i < 50; ++i) {
+            pointers.tryEmplace(std::to_string(i), std::make_unique<int>(i));
+        }
+        auto moved = std::move(pointers);
+        REQUIRE(pointers.empty());
+        REQUIRE(moved.size() == 50);
+        REQUIRE(*moved.at("42") == 42);
+
+        nxt::core::FlatHashMap<std::string, int> strings = {{"a", 1}, {"b", 2}, {"c", 3}};
+        auto copy = strings;
+        REQUIRE(copy == strings);
+        copy["d"] = 4;
+        REQUIRE(copy != strings);
+        copy = strings;
+        REQUIRE(copy == strings);
+        REQUIRE(copy.at("c") == 3);
+    }
+}
+
+TEST_CASE("FlatHashMap Benchmark", "[.benchmark][flat_hash_map]") {
+    constexpr int kCount = 1 << 18;
+
+    std::mt19937_64 random(7);
+    nxt::core::Vector<uint64_t> keys;
+    nxt::core::Vector<uint64_t> misses;
+    for (int i = 0; i < kCount; ++i) {
+        keys.pushBack(random() >> 1);
+        misses.pushBack((random() >> 1) | (uint64_t(1) << 63));
+    }
+
+    auto std_sum = runMapBenchmark<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map", keys, misses);
+    auto flat_sum = runMapBenchmark<nxt::core::FlatHashMap<uint64_t, uint64_t>>("FlatHashMap", keys, misses);
+    REQUIRE(std_sum == flat_sum);
+}
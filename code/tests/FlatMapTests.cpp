@@ -0,0 +1,193 @@
+#include "catch.hpp"
+
+#include "../include/Container/AVLTree.h"
+#include "../include/Container/FlatMap.h"
+#include "../include/Container/RedBlackTree.h"
+#include "../include/Container/Vector.h"
+#include "../include/Util/StopWatch.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace {
+// looks the keys up in map_count maps holding the same keys, many maps don't fit in the cache anymore like the maps
+// of a program which does other work between the lookups
+template<typename Map>
+std::size_t
+runLookupBenchmark(const char* name,
+                   const nxt::core::Vector<int>& keys,
+                   const nxt::core::Vector<int>& lookups,
+                   std::size_t map_count) {
+    const std::size_t round_count = std::max<std::size_t>(4000000 / map_count / lookups.size(), 1);
+
+    auto maps = std::make_unique<Map[]>(map_count);
+    for (std::size_t i = 0; i < map_count; ++i) {
+        for (auto key : keys) {
+            maps[i].insert({key, key});
+        }
+    }
+
+    std::size_t sum = 0;
+    nxt::core::StopWatch watch(name);
+    watch.start();
+    for (std::size_t round = 0; round < round_count; ++round) {
+        for (auto key : lookups) {
+            for (std::size_t i = 0; i < map_count; ++i) {
+                auto iter = maps[i].find(key);
+                if (iter != maps[i].end()) {
+                    sum += static_cast<std::size_t>((*iter).second);
+                }
+            }
+        }
+    }
+    watch.stop();
+    WARN(name << " find: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    return sum;
+}
+}  // namespace
+
+TEST_CASE("FlatMap Tests", "[flat_map]") {
+    SECTION("insert, find and erase") {
+        int values[] = {5, 8, 0, 1, 12, -5, 6};
+        int sorted_values[] = {-5, 0, 1, 5, 6, 8, 12};
+
+        nxt::core::FlatMap<int, std::string> map;
+        for (auto value : values) {
+            REQUIRE(map.insert({value, std::to_string(value)}).second);
+        }
+        REQUIRE_FALSE(map.insert({5, "duplicate"}).second);
+        REQUIRE_FALSE(map.tryEmplace(5, "duplicate").second);
+        REQUIRE(map.size() == 7);
+
+        std::size_t i = 0;
+        for (const auto& value : map) {
+            REQUIRE(value.first == sorted_values[i]);
+            REQUIRE(value.second == std::to_string(sorted_values[i]));
+            ++i;
+        }
+
+        REQUIRE(map.find(8)->second == "8");
+        REQUIRE(map.find(7) == map.end());
+        REQUIRE(map.lowerBound(7)->first == 8);
+        REQUIRE(map.upperBound(8)->first == 12);
+        REQUIRE(map.lowerBound(13) == map.end());
+        REQUIRE(map.rank(6) == 4);
+        REQUIRE(map.select(2)->first == 1);
+        REQUIRE(map.at(-5) == "-5");
+        REQUIRE_THROWS_AS(map.at(7), std::out_of_range);
+
+        map[7] = "seven";
+        REQUIRE(map.insertOrAssign(7, "7").second == false);
+        REQUIRE(map.at(7) == "7");
+        REQUIRE(map.size() == 8);
+
+        REQUIRE(map.erase(-5) == 1);
+        REQUIRE(map.erase(-5) == 0);
+        REQUIRE_FALSE(map.contains(-5));
+        auto next = map.erase(map.find(5));
+        REQUIRE(next->first == 6);
+        REQUIRE(map.begin()->first == 0);
+        REQUIRE(map.size() == 6);
+
+        map.clear();
+        REQUIRE(map.empty());
+        REQUIRE(map.begin() == map.end());
+    }
+
+    SECTION("insert sorted") {
+        nxt::core::FlatSet<int> set = {10, 20, 30, 40};
+        int batch[] = {5, 10, 15, 15, 25, 45, 50};
+        REQUIRE(set.insertSorted(std::begin(batch), std::end(batch)) == 5);
+        REQUIRE(set == nxt::core::FlatSet<int>({5, 10, 15, 20, 25, 30, 40, 45, 50}));
+
+        // a batch behind the values is appended without merging
+        int tail[] = {60, 70};
+        REQUIRE(set.insertSorted(std::begin(tail), std::end(tail)) == 2);
+        REQUIRE(set.size() == 11);
+        REQUIRE(*(set.end() - 1) == 70);
+
+        // unsorted ranges are inserted value by value
+        int unsorted[] = {3, 1, 2, 1};
+        set.insert(std::begin(unsorted), std::end(unsorted));
+        REQUIRE(set.size() == 14);
+        REQUIRE(std::is_sorted(set.begin(), set.end()));
+
+        std::mt19937 random(3);
+        nxt::core::FlatMap<int, std::unique_ptr<int>> pointers;
+        std::map<int, int> expected;
+        for (int round = 0; round < 20; ++round) {
+            nxt::core::Vector<std::pair<int, std::unique_ptr<int>>> values;
+            for (int i = 0; i < 50; ++i) {
+                values.emplaceBack(static_cast<int>(random() % 1000), nullptr);
+            }
+            std::sort(values.begin(), values.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+            });
+            for (auto& value : values) {
+                value.second = std::make_unique<int>(value.first);
+                expected.insert({value.first, value.first});
+            }
+            pointers.insertSorted(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+        }
+        REQUIRE(pointers.size() == expected.size());
+        auto expected_iter = expected.begin();
+        for (const auto& value : pointers) {
+            REQUIRE(value.first == expected_iter->first);
+            REQUIRE(*value.second == expected_iter->second);
+            ++expected_iter;
+        }
+    }
+
+    SECTION("heterogeneous lookup") {
+        nxt::core::FlatMap<std::string, int> map = {{"one", 1}, {"two", 2}, {"three", 3}};
+        std::string_view key = "two";
+        REQUIRE(map.find(key)->second == 2);
+        REQUIRE(map.contains("one"));
+        REQUIRE(map.count(std::string_view("four")) == 0);
+        REQUIRE(map.erase("three") == 1);
+        REQUIRE(map.size() == 2);
+    }
+
+    SECTION("copy and move") {
+        nxt::core::FlatMap<int, std::string> map = {{1, "a"}, {2, "b"}};
+        auto copy = map;
+        REQUIRE(copy == map);
+        copy[3] = "c";
+        REQUIRE(copy != map);
+
+        auto moved = std::move(copy);
+        REQUIRE(moved.size() == 3);
+        REQUIRE(moved.at(3) == "c");
+    }
+}
+
+TEST_CASE("FlatMap Benchmark", "[.benchmark][flat_map]") {
+    constexpr std::size_t kKeyCount = 300;
+
+    std::mt19937 random(11);
+    nxt::core::Vector<int> keys;
+    nxt::core::Vector<int> lookups;
+    for (std::size_t i = 0; i < kKeyCount; ++i) {
+        keys.pushBack(static_cast<int>(random() % 100000));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        lookups.pushBack(i % 2 == 0 ? keys[random() % kKeyCount] : static_cast<int>(random() % 100000));
+    }
+
+    for (std::size_t map_count : {1, 2048}) {
+        WARN(map_count << " maps of " << kKeyCount << " keys");
+        auto avl_sum = runLookupBenchmark<nxt::core::AVLTree<nxt::core::MappedTraits<int, int>>>(
+            "AVLTree", keys, lookups, map_count);
+        auto red_black_sum = runLookupBenchmark<nxt::core::RedBlackTree<nxt::core::MappedTraits<int, int>>>(
+            "RedBlackTree", keys, lookups, map_count);
+        auto std_sum = runLookupBenchmark<std::map<int, int>>("std::map", keys, lookups, map_count);
+        auto flat_sum = runLookupBenchmark<nxt::core::FlatMap<int, int>>("FlatMap", keys, lookups, map_count);
+        REQUIRE(avl_sum == flat_sum);
+        REQUIRE(red_black_sum == flat_sum);
+        REQUIRE(std_sum == flat_sum);
+    }
+}
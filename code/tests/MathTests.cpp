@@ -134,4 +134,22 @@ TEST_CASE("Math Tests", "[math]") {
         REQUIRE(nxt::core::rotateLeft(test_number, 4) == 0b1001'1000'1111'0011);
         REQUIRE(nxt::core::rotateLeft(test_number, 36) == 0b1001'1000'1111'0011);
     }
+
+    SECTION("countTrailingZeros Tests") {
+        REQUIRE(nxt::core::countTrailingZeros(1u) == 0);
+        REQUIRE(nxt::core::countTrailingZeros(8u) == 3);
+        REQUIRE(nxt::core::countTrailingZeros(12u) == 2);
+        REQUIRE(nxt::core::countTrailingZeros(uint8_t(0x80)) == 7);
+        REQUIRE(nxt::core::countTrailingZeros(uint64_t(1) << 40) == 40);
+        REQUIRE(nxt::core::countTrailingZeros(~uint64_t(0)) == 0);
+    }
+
+    SECTION("countLeadingZeros Tests") {
+        REQUIRE(nxt::core::countLeadingZeros(1u) == 31);
+        REQUIRE(nxt::core::countLeadingZeros(12u) == 28);
+        REQUIRE(nxt::core::countLeadingZeros(uint8_t(0x80)) == 0);
+        REQUIRE(nxt::core::countLeadingZeros(uint16_t(1)) == 15);
+        REQUIRE(nxt::core::countLeadingZeros(uint64_t(1) << 40) == 23);
+        REQUIRE(nxt::core::countLeadingZeros(~uint64_t(0)) == 0);
+    }
 }
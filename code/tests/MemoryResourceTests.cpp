@@ -0,0 +1,261 @@
+#include "catch.hpp"
+
+#include "CountingResource.h"
+
+#include "../include/Container/PageVector.h"
+#include "../include/Container/SlotMap.h"
+#include "../include/Container/Vector.h"
+#include "../include/Memory/FrameAllocator.h"
+#include "../include/Memory/MemoryResource.h"
+#include "../include/Memory/MonotonicArena.h"
+#include "../include/Memory/PoolResource.h"
+#include "../include/Util/StopWatch.h"
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace {
+using nxt::tests::CountingResource;
+
+bool
+isAligned(const void* pointer, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+}
+}  // namespace
+
+TEST_CASE("MemoryResource Tests", "[memory_resource]") {
+    SECTION("Default resource and allocator") {
+        auto resource = nxt::core::getDefaultResource();
+        REQUIRE(resource == nxt::core::getDefaultResource());
+
+        auto pointer = resource->allocate(100, 128);
+        REQUIRE(isAligned(pointer, 128));
+        resource->deallocate(pointer, 100, 128);
+
+        nxt::core::ResourceAllocator<int> default_allocator;
+        REQUIRE(default_allocator.getResource() == resource);
+
+        nxt::core::PoolResource pool;
+        nxt::core::ResourceAllocator<int> pool_allocator(&pool);
+        nxt::core::ResourceAllocator<double> rebound(pool_allocator);
+        REQUIRE(rebound.getResource() == &pool);
+        REQUIRE(rebound == pool_allocator);
+        REQUIRE(default_allocator != pool_allocator);
+    }
+
+    SECTION("Monotonic arena") {
+        CountingResource upstream;
+        {
+            nxt::core::MonotonicArena arena(256, &upstream);
+            REQUIRE(arena.getChunkCount() == 0);
+
+            auto first = arena.allocate(10, 1);
+            auto second = arena.allocate(8, 8);
+            auto third = arena.allocate(32, 32);
+            REQUIRE(isAligned(second, 8));
+            REQUIRE(isAligned(third, 32));
+            REQUIRE(static_cast<std::byte*>(second) >= static_cast<std::byte*>(first) + 10);
+            REQUIRE(upstream.allocation_count == 1);
+
+            // deallocation doesn't give the memory back
+            arena.deallocate(third, 32, 32);
+            REQUIRE(arena.allocate(32, 32) != third);
+
+            // chunks grow geometrically, oversized requests get a chunk large enough. The blocks are dropped as
+            // the arena only gives memory back on reset() and release()
+            for (int i = 0; i < 100; ++i) {
+                (void)arena.allocate(64);
+            }
+            (void)arena.allocate(10000);
+            auto chunk_count = arena.getChunkCount();
+            REQUIRE(chunk_count == upstream.allocation_count);
+            REQUIRE(chunk_count < 10);
+
+            // reset reuses every chunk without going upstream
+            arena.reset();
+            REQUIRE(arena.allocate(10, 1) == first);
+            for (int i = 0; i < 100; ++i) {
+                (void)arena.allocate(64);
+            }
+            (void)arena.allocate(10000);
+            REQUIRE(upstream.allocation_count == chunk_count);
+
+            arena.release();
+            REQUIRE(arena.getChunkCount() == 0);
+            REQUIRE(upstream.allocated_size == 0);
+
+            (void)arena.allocate(16);
+            REQUIRE(upstream.allocated_size != 0);
+        }
+        REQUIRE(upstream.allocation_count == upstream.deallocation_count);
+    }
+
+    SECTION("Pool resource") {
+        CountingResource upstream;
+        {
+            nxt::core::PoolResource pool(&upstream);
+
+            auto first = pool.allocate(24, 8);
+            auto second = pool.allocate(24, 8);
+            REQUIRE(first != second);
+            REQUIRE(isAligned(first, alignof(std::max_align_t)));
+            REQUIRE(pool.getSlabCount() == 1);
+
+            // released blocks are reused first
+            pool.deallocate(first, 24, 8);
+            REQUIRE(pool.allocate(20, 4) == first);
+
+            // large and over aligned requests go upstream
+            auto allocation_count = upstream.allocation_count;
+            auto large = pool.allocate(nxt::core::PoolResource::kMaxBlockSize + 1);
+            auto aligned = pool.allocate(8, 64);
+            REQUIRE(isAligned(aligned, 64));
+            REQUIRE(upstream.allocation_count == allocation_count + 2);
+            pool.deallocate(large, nxt::core::PoolResource::kMaxBlockSize + 1);
+            pool.deallocate(aligned, 8, 64);
+
+            nxt::core::Vector<void*> blocks;
+            for (int i = 0; i < 10000; ++i) {
+                blocks.pushBack(pool.allocate(48));
+            }
+            auto slab_count = pool.getSlabCount();
+            for (auto block : blocks) {
+                pool.deallocate(block, 48);
+            }
+            for (int i = 0; i < 10000; ++i) {
+                blocks[i] = pool.allocate(48);
+            }
+            REQUIRE(pool.getSlabCount() == slab_count);
+            for (auto block : blocks) {
+                pool.deallocate(block, 48);
+            }
+
+            pool.release();
+            REQUIRE(pool.getSlabCount() == 0);
+            REQUIRE(upstream.allocated_size == 0);
+
+            // left to the destructor of the pool, which releases the slab
+            (void)pool.allocate(48);
+        }
+        REQUIRE(upstream.allocation_count == upstream.deallocation_count);
+    }
+
+    SECTION("Containers with resources") {
+        nxt::core::PoolResource pool;
+        nxt::core::MonotonicArena arena;
+
+        using IntAllocator = nxt::core::ResourceAllocator<int>;
+        nxt::core::Vector<int, IntAllocator> vector{IntAllocator(&arena)};
+        nxt::core::PageVector<int, 32, IntAllocator> page_vector{IntAllocator(&arena)};
+        nxt::core::SlotMap<int, nxt::core::Key, 64, IntAllocator> slot_map{IntAllocator(&pool)};
+
+        nxt::core::Vector<nxt::core::Key> keys;
+        for (int i = 0; i < 1000; ++i) {
+            vector.pushBack(i);
+            page_vector.pushBack(i);
+            keys.pushBack(slot_map.insert(i));
+        }
+        REQUIRE(pool.getSlabCount() > 0);
+        REQUIRE(arena.getChunkCount() > 0);
+
+        REQUIRE(vector.size() == 1000);
+        REQUIRE(page_vector.size() == 1000);
+        REQUIRE(slot_map.size() == 1000);
+
+        bool all_equal = true;
+        for (int i = 0; i < 1000; ++i) {
+            all_equal = all_equal && vector[i] == i && page_vector[i] == i && slot_map.at(keys[i]) == i;
+        }
+        REQUIRE(all_equal);
+
+        for (int i = 0; i < 1000; i += 2) {
+            slot_map.erase(keys[i]);
+        }
+        REQUIRE(slot_map.size() == 500);
+    }
+
+    SECTION("Frame allocator") {
+        nxt::core::resetFrameArenas();
+        auto& arena = nxt::core::getFrameArena();
+        REQUIRE(&arena == &nxt::core::getFrameArena());
+
+        nxt::core::Vector<int, nxt::core::FrameAllocator<int>> values;
+        for (int i = 0; i < 1000; ++i) {
+            values.pushBack(i);
+        }
+        REQUIRE(values.back() == 999);
+        REQUIRE(nxt::core::FrameAllocator<int>() == nxt::core::FrameAllocator<double>());
+
+        // other threads have arenas of their own
+        const nxt::core::MonotonicArena* thread_arena = nullptr;
+        std::thread thread([&thread_arena]() {
+            thread_arena = &nxt::core::getFrameArena();
+            nxt::core::Vector<int, nxt::core::FrameAllocator<int>> thread_values(100, 1);
+        });
+        thread.join();
+        REQUIRE(thread_arena != &arena);
+
+        // after the tick the same memory is handed out again
+        nxt::core::resetFrameArenas();
+        auto first = arena.allocate(16);
+        nxt::core::resetFrameArenas();
+        REQUIRE(arena.allocate(16) == first);
+    }
+}
+
+TEST_CASE("MemoryResource Benchmark", "[.benchmark][memory_resource]") {
+    constexpr std::size_t kCount = 200000;
+    constexpr std::size_t kNodeSize = 48;
+
+    nxt::core::Vector<std::size_t> order;
+    for (std::size_t i = 0; i < kCount; ++i) {
+        order.pushBack((i * 7919) % kCount);
+    }
+
+    nxt::core::PoolResource pool;
+    nxt::core::MonotonicArena arena;
+    nxt::core::MemoryResource* resources[] = {nxt::core::getDefaultResource(), &pool, &arena};
+    const char* names[] = {"default: ", "PoolResource: ", "MonotonicArena: "};
+
+    // node sized blocks allocated and released in a scrambled order, like the nodes of a tree
+    for (std::size_t resource_index = 0; resource_index < 3; ++resource_index) {
+        auto resource = resources[resource_index];
+        nxt::core::Vector<void*> blocks(kCount, nullptr);
+        nxt::core::StopWatch watch("MemoryResource");
+        watch.start();
+        for (int round = 0; round < 5; ++round) {
+            for (auto index : order) {
+                blocks[index] = resource->allocate(kNodeSize);
+            }
+            for (auto block : blocks) {
+                resource->deallocate(block, kNodeSize);
+            }
+            arena.reset();
+        }
+        watch.stop();
+        WARN(names[resource_index] << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+
+    for (int allocator_index = 0; allocator_index < 2; ++allocator_index) {
+        nxt::core::StopWatch watch("Vector per frame");
+        watch.start();
+        for (int frame = 0; frame < 1000; ++frame) {
+            if (allocator_index == 0) {
+                nxt::core::Vector<int> values;
+                for (int i = 0; i < 1000; ++i) {
+                    values.pushBack(i);
+                }
+            } else {
+                nxt::core::Vector<int, nxt::core::FrameAllocator<int>> values;
+                for (int i = 0; i < 1000; ++i) {
+                    values.pushBack(i);
+                }
+                nxt::core::resetFrameArenas();
+            }
+        }
+        watch.stop();
+        WARN((allocator_index == 0 ? "Vector std::allocator: " : "Vector FrameAllocator: ")
+             << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    }
+}
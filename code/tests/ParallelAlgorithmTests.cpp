@@ -0,0 +1,156 @@
+#include "catch.hpp"
+
+#include "../include/Algorithm/ParallelSearch.h"
+#include "../include/Algorithm/ParallelSort.h"
+#include "../include/Container/Vector.h"
+#include "../include/Threading/TaskQueue.h"
+#include "../include/Util/StopWatch.h"
+
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+TEST_CASE("Parallel Algorithm Tests", "[parallel_algorithm]") {
+    nxt::core::TaskQueue task_queue("parallel_algorithm_queue");
+    task_queue.setMaxThreads(4);
+    task_queue.start();
+
+    nxt::core::ParallelPolicy policy(task_queue, 1024);
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 1000000);
+
+    constexpr std::size_t kElementCount = 200000;
+    nxt::core::Vector<int> values;
+    values.reserve(kElementCount);
+    for (std::size_t i = 0; i < kElementCount; ++i) {
+        values.pushBack(distribution(generator));
+    }
+
+    SECTION("Parallel quickSort Tests") {
+        auto expected = values;
+        nxt::core::quickSort(expected.begin(), expected.end());
+
+        nxt::core::quickSort(policy, values.begin(), values.end());
+        REQUIRE(nxt::core::isSorted(values.begin(), values.end()));
+        REQUIRE(values == expected);
+
+        // descending order with a custom comparator
+        nxt::core::quickSort(policy, values.begin(), values.end(), std::greater<>());
+        REQUIRE(nxt::core::isSorted(values.begin(), values.end(), std::greater<>()));
+
+        // lots of duplicates
+        std::uniform_int_distribution<int> small_distribution(0, 3);
+        for (auto& value : values) {
+            value = small_distribution(generator);
+        }
+        nxt::core::quickSort(policy, values.begin(), values.end());
+        REQUIRE(nxt::core::isSorted(values.begin(), values.end()));
+        REQUIRE(nxt::core::count(values.begin(), values.end(), 4) == 0);
+
+        nxt::core::quickSort(nxt::core::kSequenced, values.begin(), values.end(), std::greater<>());
+        REQUIRE(nxt::core::isSorted(values.begin(), values.end(), std::greater<>()));
+    }
+
+    SECTION("mergeSort Tests") {
+        // pair of key and original position to check that the sort is stable
+        nxt::core::Vector<std::pair<int, std::size_t>> pairs;
+        std::uniform_int_distribution<int> key_distribution(0, 100);
+        for (std::size_t i = 0; i < kElementCount; ++i) {
+            pairs.pushBack({key_distribution(generator), i});
+        }
+        auto sequential_pairs = pairs;
+
+        auto compare_keys = [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; };
+        nxt::core::mergeSort(policy, pairs.begin(), pairs.end(), compare_keys);
+        nxt::core::mergeSort(nxt::core::kSequenced, sequential_pairs.begin(), sequential_pairs.end(), compare_keys);
+
+        REQUIRE(nxt::core::isSorted(pairs.begin(), pairs.end()));
+        REQUIRE(pairs == sequential_pairs);
+
+        // odd number of merge levels ends up in the buffer before the final copy
+        nxt::core::Vector<int> small_values(values.begin(), values.begin() + 3000);
+        auto expected = small_values;
+        nxt::core::quickSort(expected.begin(), expected.end());
+        nxt::core::mergeSort(policy, small_values.begin(), small_values.end());
+        REQUIRE(small_values == expected);
+
+        nxt::core::mergeSort(policy, values.begin(), values.end());
+        REQUIRE(nxt::core::isSorted(values.begin(), values.end()));
+    }
+
+    SECTION("Parallel sort exception Tests") {
+        std::atomic<int> comparisons = 0;
+        auto throwing_compare = [&comparisons](int lhs, int rhs) {
+            if (comparisons.fetch_add(1) == 100000) {
+                throw std::runtime_error("comparison failed");
+            }
+            return lhs < rhs;
+        };
+
+        REQUIRE_THROWS_AS(nxt::core::quickSort(policy, values.begin(), values.end(), throwing_compare),
+                          std::runtime_error);
+
+        comparisons = 0;
+        REQUIRE_THROWS_AS(nxt::core::mergeSort(policy, values.begin(), values.end(), throwing_compare),
+                          std::runtime_error);
+    }
+
+    SECTION("Parallel find and count Tests") {
+        for (auto& value : values) {
+            value = value % 1000;
+        }
+        values[150000] = -1;
+        values[170000] = -1;
+
+        REQUIRE(nxt::core::find(policy, values.begin(), values.end(), -1) == values.begin() + 150000);
+        REQUIRE(nxt::core::find(policy, values.begin(), values.end(), -2) == values.end());
+        REQUIRE(nxt::core::find(nxt::core::kSequenced, values.begin(), values.end(), -1) == values.begin() + 150000);
+
+        REQUIRE(nxt::core::count(policy, values.begin(), values.end(), -1) == 2);
+        REQUIRE(nxt::core::count(policy, values.begin(), values.end(), 7) ==
+                nxt::core::count(values.begin(), values.end(), 7));
+        REQUIRE(nxt::core::count(nxt::core::kSequenced, values.begin(), values.end(), -1) == 2);
+    }
+
+    SECTION("Sequential fallback Tests") {
+        // the queue is stopped, so the parallel overloads run on the calling thread
+        task_queue.stop();
+
+        auto expected = values;
+        nxt::core::quickSort(expected.begin(), expected.end());
+        nxt::core::quickSort(policy, values.begin(), values.end());
+        REQUIRE(values == expected);
+        REQUIRE(nxt::core::count(policy, values.begin(), values.end(), values[0]) >= 1);
+    }
+}
+
+TEST_CASE("Parallel Sort Benchmark", "[.benchmark][parallel_algorithm]") {
+    nxt::core::TaskQueue task_queue("parallel_sort_benchmark");
+    task_queue.start();
+    nxt::core::ParallelPolicy policy(task_queue);
+
+    std::mt19937 generator(7);
+    constexpr std::size_t kElementCount = 10000000;
+    nxt::core::Vector<int> values;
+    values.reserve(kElementCount);
+    for (std::size_t i = 0; i < kElementCount; ++i) {
+        values.pushBack(static_cast<int>(generator()));
+    }
+
+    auto measure = [&values](const std::string& name, auto&& sort) {
+        auto copy = values;
+        nxt::core::StopWatch watch(name);
+        watch.start();
+        sort(copy.begin(), copy.end());
+        watch.stop();
+
+        REQUIRE(nxt::core::isSorted(copy.begin(), copy.end()));
+        WARN(name << ": " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    };
+
+    measure("quickSort sequential", [](auto first, auto last) { nxt::core::quickSort(first, last); });
+    measure("quickSort parallel", [&policy](auto first, auto last) { nxt::core::quickSort(policy, first, last); });
+    measure("mergeSort sequential", [](auto first, auto last) { nxt::core::mergeSort(first, last); });
+    measure("mergeSort parallel", [&policy](auto first, auto last) { nxt::core::mergeSort(policy, first, last); });
+}
@@ -0,0 +1,384 @@
+#include "catch.hpp"
+
+#include "CountingResource.h"
+
+#include "../include/Container/AVLTree.h"
+#include "../include/Container/BinarySearchTree.h"
+#include "../include/Container/RedBlackTree.h"
+#include "../include/Container/Vector.h"
+#include "../include/Memory/MemoryResource.h"
+#include "../include/Util/StopWatch.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+
+namespace {
+using nxt::tests::CountingResource;
+
+using IntTree = nxt::core::RedBlackTree<nxt::core::SimpleTraits<int>>;
+
+// a red-black tree is at most twice as deep as a perfectly balanced one
+template<typename Tree>
+bool
+isBalanced(const Tree& tree) {
+    return static_cast<double>(tree.height()) <= 2.0 * std::log2(static_cast<double>(tree.size()) + 1.0);
+}
+
+template<typename Tree>
+bool
+matches(const Tree& tree, const std::set<int>& expected) {
+    if (tree.size() != expected.size()) {
+        return false;
+    }
+
+    auto it = tree.begin();
+    for (auto value : expected) {
+        if (it == tree.end() || *it != value) {
+            return false;
+        }
+        ++it;
+    }
+    return it == tree.end();
+}
+
+template<typename Tree>
+void
+fill(Tree& tree, int count, int key_range) {
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> key_distribution(0, key_range - 1);
+    for (int i = 0; i < count; ++i) {
+        tree.insert(key_distribution(generator));
+    }
+}
+
+/**
+ * @brief Run the same mix of operations on a tree, inserting with the given probability out of 100 and erasing as
+ *        often, the rest being lookups
+ *
+ * @return Number of lookups which found their key, to compare the trees and keep the lookups from being optimized out
+ */
+template<typename Tree>
+int64_t
+runMix(Tree& tree, int operation_count, int update_percent, int key_range) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> key_distribution(0, key_range - 1);
+    std::uniform_int_distribution<int> operation_distribution(0, 99);
+
+    int64_t found_count = 0;
+    for (int i = 0; i < operation_count; ++i) {
+        auto key = key_distribution(generator);
+        auto operation = operation_distribution(generator);
+        if (operation < update_percent) {
+            tree.insert(key);
+        } else if (operation < 2 * update_percent) {
+            tree.erase(key);
+        } else {
+            found_count += tree.find(key) != tree.end() ? 1 : 0;
+        }
+    }
+    return found_count;
+}
+}  // namespace
+
+TEST_CASE("RedBlackTree Tests", "[red_black_tree]") {
+    SECTION("sorting check") {
+        int values[] = {5, 8, 0, 1, 12, -5, 6};
+        int sorted_values[] = {-5, 0, 1, 5, 6, 8, 12};
+
+        IntTree tree;
+        for (auto value : values) {
+            REQUIRE(tree.insert(value).second);
+        }
+        REQUIRE_FALSE(tree.insert(5).second);
+        REQUIRE(tree.size() == 7);
+
+        std::size_t i = 0;
+        for (const auto& value : tree) {
+            REQUIRE(value == sorted_values[i]);
+            ++i;
+        }
+
+        i = 7;
+        for (auto it = tree.end(); it != tree.begin();) {
+            --it;
+            REQUIRE(*it == sorted_values[--i]);
+        }
+
+        REQUIRE(tree.erase(-5) == 1);
+        REQUIRE(tree.erase(-10) == 0);
+        REQUIRE(tree.size() == 6);
+        REQUIRE(*tree.begin() == 0);
+        REQUIRE(*tree.lowerBound(7) == 8);
+        REQUIRE(*tree.upperBound(8) == 12);
+        REQUIRE(tree.upperBound(12) == tree.end());
+
+        tree.clear();
+        REQUIRE(tree.empty());
+        REQUIRE(tree.begin() == tree.end());
+        REQUIRE(tree.height() == 0);
+    }
+
+    SECTION("random inserts and erases") {
+        IntTree tree;
+        std::set<int> expected;
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int> distribution(0, 4999);
+
+        for (int i = 0; i < 20000; ++i) {
+            auto key = distribution(generator);
+            if (i % 3 == 2) {
+                REQUIRE(tree.erase(key) == expected.erase(key));
+            } else {
+                REQUIRE(tree.insert(key).second == expected.insert(key).second);
+            }
+
+            if (i % 1000 == 0) {
+                REQUIRE(matches(tree, expected));
+                REQUIRE(isBalanced(tree));
+                REQUIRE(tree.checkInvariants());
+            }
+        }
+        REQUIRE(matches(tree, expected));
+        REQUIRE(isBalanced(tree));
+        REQUIRE(tree.checkInvariants());
+
+        // every erase case, checked after each update on a small tree
+        IntTree small_tree;
+        bool valid = true;
+        for (int i = 0; i < 4000 && valid; ++i) {
+            auto key = distribution(generator) % 64;
+            if (i % 2 == 1) {
+                small_tree.erase(key);
+            } else {
+                small_tree.insert(key);
+            }
+            valid = small_tree.checkInvariants();
+        }
+        REQUIRE(valid);
+
+        // sequential inserts are the worst case for an unbalanced tree
+        IntTree sequential;
+        for (int i = 0; i < 100000; ++i) {
+            sequential.insert(i);
+        }
+        REQUIRE(isBalanced(sequential));
+
+        for (int i = 0; i < 100000; i += 2) {
+            REQUIRE(sequential.erase(i) == 1);
+        }
+        REQUIRE(sequential.size() == 50000);
+        REQUIRE(isBalanced(sequential));
+        REQUIRE(*sequential.begin() == 1);
+        REQUIRE(*--sequential.end() == 99999);
+
+        for (int i = 0; i < 100000; ++i) {
+            sequential.erase(i);
+        }
+        REQUIRE(sequential.empty());
+        REQUIRE(sequential.begin() == sequential.end());
+    }
+
+    SECTION("hint insert") {
+        nxt::core::RedBlackTree<nxt::core::MappedTraits<int, int>> tree;
+        for (int i = 0; i < 10000; ++i) {
+            tree.insert(tree.end(), {i * 2, i});
+        }
+        REQUIRE(tree.size() == 10000);
+        REQUIRE(isBalanced(tree));
+
+        auto it = tree.insert(tree.find(10), {9, -1});
+        REQUIRE(it->first == 9);
+        REQUIRE((++it)->first == 10);
+        REQUIRE(tree.insert(tree.begin(), {5001, -1})->first == 5001);
+        REQUIRE(tree.insert(tree.find(20), {10, -1})->second == 5);
+        REQUIRE(tree.size() == 10002);
+
+        bool all_found = true;
+        for (int i = 0; i < 10000; ++i) {
+            all_found = all_found && tree.find(i * 2)->second == i;
+        }
+        REQUIRE(all_found);
+    }
+
+    SECTION("sorted build and merge") {
+        for (int count : {1, 2, 3, 7, 8, 1000, 1023, 1024}) {
+            nxt::core::Vector<int> evens;
+            std::set<int> expected;
+            for (int i = 0; i < count; ++i) {
+                evens.pushBack(i * 2);
+                expected.insert(i * 2);
+            }
+
+            IntTree tree;
+            tree.insert(7);
+            tree.assignSorted(evens.begin(), evens.end());
+            REQUIRE(matches(tree, expected));
+            REQUIRE(isBalanced(tree));
+            REQUIRE(tree.checkInvariants());
+
+            // the colors of the built tree hold through later updates
+            for (int i = 0; i < count; i += 3) {
+                tree.erase(i * 2);
+                tree.insert(i * 2 + 1);
+                expected.erase(i * 2);
+                expected.insert(i * 2 + 1);
+            }
+            REQUIRE(matches(tree, expected));
+            REQUIRE(isBalanced(tree));
+            REQUIRE(tree.checkInvariants());
+        }
+
+        nxt::core::Vector<int> batch;
+        for (int i = 0; i < 2000; i += 3) {
+            batch.pushBack(i);
+        }
+        IntTree tree;
+        for (int i = 0; i < 1000; ++i) {
+            tree.insert(i * 2);
+        }
+        REQUIRE(tree.mergeSorted(batch.begin(), batch.end()) == 333);
+        REQUIRE(tree.size() == 1333);
+        REQUIRE(isBalanced(tree));
+        REQUIRE(tree.checkInvariants());
+
+        int unsorted[] = {5, 1, 3, 1, 4};
+        IntTree from_unsorted(std::begin(unsorted), std::end(unsorted));
+        REQUIRE(from_unsorted.size() == 4);
+        REQUIRE(*from_unsorted.begin() == 1);
+    }
+
+    SECTION("copy, move and non trivial values") {
+        CountingResource resource;
+        auto shared = std::make_shared<int>(0);
+        using Allocator = nxt::core::ResourceAllocator<std::pair<const std::string, std::shared_ptr<int>>>;
+        using Tree =
+            nxt::core::RedBlackTree<nxt::core::MappedTraits<std::string, std::shared_ptr<int>, std::less<>, Allocator>>;
+        {
+            Tree tree{Allocator(&resource)};
+            for (int i = 0; i < 2000; ++i) {
+                tree.emplace(std::to_string(i), shared);
+            }
+            REQUIRE(shared.use_count() == 2001);
+            REQUIRE(tree.find("1234") != tree.end());
+
+            for (int i = 0; i < 2000; i += 2) {
+                REQUIRE(tree.erase(std::to_string(i)) == 1);
+            }
+            REQUIRE(shared.use_count() == 1001);
+
+            auto copy_tree = tree;
+            REQUIRE(shared.use_count() == 2001);
+            REQUIRE(isBalanced(copy_tree));
+            copy_tree.erase("1");
+            REQUIRE(tree.find("1") != tree.end());
+
+            auto moved_tree = std::move(copy_tree);
+            REQUIRE(copy_tree.empty());
+            REQUIRE(moved_tree.size() == 999);
+        }
+        REQUIRE(shared.use_count() == 1);
+        REQUIRE(resource.live_count == 0);
+    }
+
+    SECTION("order statistics") {
+        nxt::core::RedBlackTree<nxt::core::SimpleTraits<int>, true> tree;
+        std::set<int> expected;
+        for (int i = 0; i < 5000; ++i) {
+            auto key = static_cast<int>((static_cast<int64_t>(i) * 7919) % 5000);
+            tree.insert(key * 2);
+            expected.insert(key * 2);
+        }
+
+        // keep the sizes through erases, hint inserts and the sorted merge
+        for (int i = 0; i < 10000; i += 6) {
+            tree.erase(i);
+            expected.erase(i);
+        }
+        for (int i = 10001; i < 10201; i += 2) {
+            tree.insert(tree.end(), i);
+            expected.insert(i);
+        }
+        nxt::core::Vector<int> batch;
+        for (int i = 1; i < 3000; i += 4) {
+            batch.pushBack(i);
+            expected.insert(i);
+        }
+        tree.mergeSorted(batch.begin(), batch.end());
+        REQUIRE(tree.size() == expected.size());
+
+        bool select_valid = true;
+        std::size_t position = 0;
+        for (auto value : expected) {
+            select_valid = select_valid && *tree.select(position) == value;
+            ++position;
+        }
+        REQUIRE(select_valid);
+        REQUIRE(tree.select(tree.size()) == tree.end());
+
+        bool rank_valid = true;
+        for (int key = -1; key < 10300; key += 7) {
+            auto expected_rank = static_cast<std::size_t>(std::distance(expected.begin(), expected.lower_bound(key)));
+            rank_valid = rank_valid && tree.rank(key) == expected_rank;
+        }
+        REQUIRE(rank_valid);
+
+        REQUIRE(tree.countRange(0, 10) == 6);
+        REQUIRE(tree.countRange(10, 0) == 0);
+        REQUIRE(tree.countRange(-100, 100000) == tree.size());
+
+        // percentiles of a live distribution
+        auto median = *tree.select(tree.size() / 2);
+        REQUIRE(tree.rank(median) == tree.size() / 2);
+
+        tree.clear();
+        REQUIRE(tree.rank(5) == 0);
+        REQUIRE(tree.select(0) == tree.end());
+    }
+}
+
+TEST_CASE("Tree Mix Benchmark", "[.benchmark][red_black_tree]") {
+    constexpr int kOperationCount = 2000000;
+    constexpr int kKeyRange = 1 << 20;
+
+    using AVL = nxt::core::AVLTree<nxt::core::SimpleTraits<int>>;
+    using RB = nxt::core::RedBlackTree<nxt::core::SimpleTraits<int>>;
+    using BST = nxt::core::BinarySearchTree<nxt::core::SimpleTraits<int>>;
+
+    // trees start half full. Write heavy: 45% inserts, 45% erases and 10% lookups, read heavy: 5% inserts, 5% erases and 90% lookups
+    for (int update_percent : {45, 5}) {
+        const char* mix = update_percent == 45 ? "write heavy" : "read heavy";
+        nxt::core::StopWatch watch("Tree Mix");
+
+        AVL avl;
+        fill(avl, kKeyRange / 2, kKeyRange);
+        watch.start();
+        auto avl_found = runMix(avl, kOperationCount, update_percent, kKeyRange);
+        watch.stop();
+        WARN("AVLTree " << mix << ": " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+        RB rb;
+        watch.reset();
+        fill(rb, kKeyRange / 2, kKeyRange);
+        watch.start();
+        auto rb_found = runMix(rb, kOperationCount, update_percent, kKeyRange);
+        watch.stop();
+        WARN("RedBlackTree " << mix << ": " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+        BST bst;
+        watch.reset();
+        fill(bst, kKeyRange / 2, kKeyRange);
+        watch.start();
+        auto bst_found = runMix(bst, kOperationCount, update_percent, kKeyRange);
+        watch.stop();
+        WARN("BinarySearchTree " << mix << ": " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+        REQUIRE(avl_found == rb_found);
+        REQUIRE(avl_found == bst_found);
+    }
+}
@@ -2,6 +2,9 @@
 
 #include "../include/Container/RingBuffer.h"
 
+#include <memory>
+#include <string>
+
 TEST_CASE("RingBuffer Tests", "[ring_buffer]") {
     SECTION("popFront() and pushBack() tests") {
         nxt::core::RingBuffer<int> ring_buffer;
@@ -111,4 +114,36 @@ TEST_CASE("RingBuffer Tests", "[ring_buffer]") {
         REQUIRE(copy_buffer_2.size() == 0);
         REQUIRE(copy_buffer_2.capacity() == 0);
     }
+
+    SECTION("growing while wrapped") {
+        nxt::core::RingBuffer<std::unique_ptr<int>> pointers;
+        nxt::core::RingBuffer<std::string> strings;
+        int next_value = 0;
+        int front_value = 0;
+        for (int round = 0; round < 6; ++round) {
+            // pops some values so that the values wrap around before the buffer grows
+            for (int i = 0; i < 5 + round * 3; ++i) {
+                pointers.pushBack(std::make_unique<int>(next_value));
+                strings.pushBack(std::string(40, static_cast<char>('a' + next_value % 26)));
+                ++next_value;
+            }
+            for (int i = 0; i < 3; ++i) {
+                REQUIRE(*pointers.front() == front_value);
+                REQUIRE(strings.front()[0] == static_cast<char>('a' + front_value % 26));
+                pointers.popFront();
+                strings.popFront();
+                ++front_value;
+            }
+        }
+
+        REQUIRE(pointers.size() == static_cast<std::size_t>(next_value - front_value));
+        REQUIRE(strings.size() == pointers.size());
+        for (; front_value < next_value; ++front_value) {
+            REQUIRE(*pointers.front() == front_value);
+            REQUIRE(strings.front()[0] == static_cast<char>('a' + front_value % 26));
+            pointers.popFront();
+            strings.popFront();
+        }
+        REQUIRE(pointers.empty());
+    }
 }
@@ -1,13 +1,74 @@
 #include "catch.hpp"
 
+#include "../include/Container/FenwickTree.h"
 #include "../include/Container/SegmentTree.h"
+#include "../include/Util/StopWatch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// checks the tree against the same operations done on a plain vector
+template<typename Op>
+bool
+checkRandomOperations(Op op, int seed) {
+    std::mt19937 generator(seed);
+    std::vector<int64_t> values(1000);
+    for (auto& value : values) {
+        value = static_cast<int64_t>(generator() % 1000);
+    }
+
+    nxt::core::SegmentTree<int64_t, Op> tree(values.begin(), values.end());
+    bool valid = true;
+    for (int i = 0; i < 5000; ++i) {
+        auto low = generator() % values.size();
+        auto high = generator() % values.size();
+        if (low > high) {
+            std::swap(low, high);
+        }
+
+        auto value = static_cast<int64_t>(generator() % 100);
+        switch (generator() % 5) {
+            case 0:
+                tree.addRange(low, high, value);
+                std::for_each(values.begin() + low, values.begin() + high + 1, [value](auto& v) { v += value; });
+                break;
+            case 1:
+                tree.assignRange(low, high, value);
+                std::fill(values.begin() + low, values.begin() + high + 1, value);
+                break;
+            case 2:
+                tree.update(low, value);
+                values[low] = value;
+                break;
+            case 3:
+                tree.pushBack(value);
+                values.push_back(value);
+                break;
+            default: {
+                auto expected = std::accumulate(values.begin() + low + 1, values.begin() + high + 1, values[low], op);
+                valid = valid && tree.query(low, high) == expected;
+                break;
+            }
+        }
+    }
+
+    auto expected = std::accumulate(values.begin() + 1, values.end(), values[0], op);
+    return valid && tree.size() == values.size() && tree.result() == expected;
+}
+}  // namespace
 
 TEST_CASE("Segment Tree Tests", "[segment_tree]") {
     SECTION("Segment Tree Tests") {
         nxt::core::SegmentTree<int, std::plus<>> segment_tree = {1, 1, 1, 1, 1};
 
-        REQUIRE(segment_tree.size() == 9);
-        REQUIRE(segment_tree.inputSize() == 5);
+        REQUIRE(segment_tree.size() == 5);
+        REQUIRE(segment_tree.capacity() == 8);
         REQUIRE(segment_tree.result() == 5);
 
         segment_tree.update(0, 2);
@@ -27,6 +88,220 @@ TEST_CASE("Segment Tree Tests", "[segment_tree]") {
         REQUIRE(segment_tree.query(2, 4) == 4);
         REQUIRE(segment_tree.query(3, 4) == 2);
         REQUIRE(segment_tree.query(4, 4) == 1);
+    }
+
+    SECTION("lazy range updates") {
+        nxt::core::SegmentTree<int, std::plus<>> tree = {1, 2, 3, 4, 5, 6, 7};
+        tree.addRange(1, 4, 10);
+        REQUIRE(tree.result() == 68);
+        REQUIRE(tree.query(0, 1) == 13);
+        REQUIRE(tree.query(4, 6) == 28);
+
+        tree.assignRange(2, 6, 1);
+        REQUIRE(tree.result() == 18);
+        REQUIRE(tree.query(1, 2) == 13);
+
+        // an addition after an assignment adds to the assigned values
+        tree.addRange(0, 3, 2);
+        REQUIRE(tree.query(3, 3) == 3);
+        REQUIRE(tree.result() == 26);
+
+        nxt::core::SegmentTree<int, nxt::core::Minimum> minimum = {5, 3, 8, 1, 9};
+        minimum.addRange(0, 2, -4);
+        REQUIRE(minimum.query(0, 2) == -1);
+        REQUIRE(minimum.result() == -1);
+        minimum.assignRange(1, 1, 7);
+        REQUIRE(minimum.query(0, 2) == 1);
+        REQUIRE(minimum.query(1, 4) == 1);
+
+        REQUIRE(checkRandomOperations(std::plus<>(), 1));
+        REQUIRE(checkRandomOperations(nxt::core::Minimum(), 2));
+        REQUIRE(checkRandomOperations(nxt::core::Maximum(), 3));
+    }
+
+    SECTION("queries on a const tree") {
+        // a full tree, so that the root covers the whole range, with stacked pending updates
+        std::vector<int64_t> values(16, 1);
+        nxt::core::SegmentTree<int64_t, std::plus<>> tree(values.begin(), values.end());
+        nxt::core::SegmentTree<int64_t, nxt::core::Minimum> minimum(values.begin(), values.end());
+        auto add = [&](std::size_t low, std::size_t high, int64_t delta) {
+            tree.addRange(low, high, delta);
+            minimum.addRange(low, high, delta);
+            std::for_each(values.begin() + low, values.begin() + high + 1, [delta](auto& v) { v += delta; });
+        };
+        auto assign = [&](std::size_t low, std::size_t high, int64_t value) {
+            tree.assignRange(low, high, value);
+            minimum.assignRange(low, high, value);
+            std::fill(values.begin() + low, values.begin() + high + 1, value);
+        };
+        add(0, 15, 2);
+        assign(4, 11, 5);
+        add(2, 9, 1);
+        add(8, 8, -7);
+
+        // queries read the pending updates without pushing them down, so asking twice gives the same answers
+        const auto& const_tree = tree;
+        const auto& const_minimum = minimum;
+        bool valid = true;
+        for (int round = 0; round < 2; ++round) {
+            for (std::size_t low = 0; low < values.size(); ++low) {
+                for (auto high = low; high < values.size(); ++high) {
+                    auto sum = std::accumulate(values.begin() + low, values.begin() + high + 1, int64_t(0));
+                    auto smallest = *std::min_element(values.begin() + low, values.begin() + high + 1);
+                    valid = valid && const_tree.query(low, high) == sum && const_minimum.query(low, high) == smallest;
+                }
+            }
+        }
+        REQUIRE(valid);
+        REQUIRE(const_tree.query(0, 15) == const_tree.result());
+
+        nxt::core::SegmentTree<int64_t, std::plus<>> single = {4};
+        single.addRange(0, 0, 3);
+        REQUIRE(single.query(0, 0) == 7);
+    }
+
+    SECTION("growing input") {
+        nxt::core::SegmentTree<std::string, std::plus<>> tree = {"a"};
+        for (char c = 'b'; c <= 'z'; ++c) {
+            tree.pushBack(std::string(1, c));
+        }
+        REQUIRE(tree.size() == 26);
+        REQUIRE(tree.capacity() == 32);
+
+        // the operation is not commutative, the order of the values is kept
+        REQUIRE(tree.result() == "abcdefghijklmnopqrstuvwxyz");
+        REQUIRE(tree.query(3, 9) == "defghij");
+        REQUIRE(tree.query(25, 25) == "z");
+
+        tree.insert(0, "_");
+        tree.insert(10, "-");
+        REQUIRE(tree.result() == "_abcdefghi-jklmnopqrstuvwxyz");
+        REQUIRE(tree.query(9, 11) == "i-j");
+
+        tree.resize(5);
+        REQUIRE(tree.result() == "_abcd");
+        tree.resize(40, "!");
+        REQUIRE(tree.size() == 40);
+        REQUIRE(tree.capacity() == 64);
+        REQUIRE(tree.query(3, 6) == "cd!!");
+
+        auto copy_tree = tree;
+        auto moved_tree = std::move(tree);
+        REQUIRE(moved_tree.result() == copy_tree.result());
+        REQUIRE(tree.empty());
+
+        nxt::core::SegmentTree<int, std::plus<>> sums = {};
+        REQUIRE(sums.empty());
+        for (int i = 1; i <= 100; ++i) {
+            sums.pushBack(i);
+            sums.addRange(0, sums.size() - 1, 1);
+        }
+        // value i got one for each of the 101 - i pushes since it was added
+        REQUIRE(sums.result() == 5050 + 5050);
+        REQUIRE(sums.query(99, 99) == 101);
+    }
+}
+
+TEST_CASE("Fenwick Tree Tests", "[segment_tree]") {
+    SECTION("prefix sums") {
+        nxt::core::FenwickTree<int> tree = {3, 1, 4, 1, 5, 9, 2, 6};
+        REQUIRE(tree.size() == 8);
+        REQUIRE(tree.prefixSum(0) == 0);
+        REQUIRE(tree.prefixSum(3) == 8);
+        REQUIRE(tree.prefixSum(8) == 31);
+        REQUIRE(tree.rangeSum(2, 5) == 19);
+        REQUIRE(tree.get(5) == 9);
+
+        tree.add(2, 10);
+        REQUIRE(tree.prefixSum(3) == 18);
+        tree.set(7, 0);
+        REQUIRE(tree.rangeSum(0, 7) == 35);
+        REQUIRE(tree.get(7) == 0);
+
+        // prefix sums 3, 4, 18, 19, 24, 33, 35, 35
+        REQUIRE(tree.lowerBound(1) == 0);
+        REQUIRE(tree.lowerBound(4) == 1);
+        REQUIRE(tree.lowerBound(5) == 2);
+        REQUIRE(tree.lowerBound(35) == 6);
+        REQUIRE(tree.lowerBound(36) == 8);
+    }
+
+    SECTION("matches a vector") {
+        std::mt19937 generator(5);
+        std::vector<int64_t> values;
+        nxt::core::FenwickTree<int64_t> tree;
+        bool valid = true;
+        for (int i = 0; i < 3000; ++i) {
+            auto value = static_cast<int64_t>(generator() % 100);
+            if (values.empty() || generator() % 3 == 0) {
+                tree.pushBack(value);
+                values.push_back(value);
+            } else {
+                auto index = generator() % values.size();
+                tree.add(index, value);
+                values[index] += value;
+            }
+
+            auto count = generator() % (values.size() + 1);
+            auto expected = std::accumulate(values.begin(), values.begin() + count, int64_t(0));
+            valid = valid && tree.prefixSum(count) == expected;
+        }
+        REQUIRE(valid);
+
+        nxt::core::FenwickTree<int64_t> built(values.begin(), values.end());
+        bool same = true;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            same = same && built.get(i) == values[i] && tree.get(i) == values[i];
+        }
+        REQUIRE(same);
+    }
+}
+
+TEST_CASE("Segment Tree Benchmark", "[.benchmark][segment_tree]") {
+    constexpr std::size_t kCount = 1 << 20;
+    constexpr int kQueryCount = 5000000;
+
+    std::vector<int64_t> values(kCount);
+    std::iota(values.begin(), values.end(), 0);
+    nxt::core::SegmentTree<int64_t, std::plus<>> tree(values.begin(), values.end());
+    nxt::core::FenwickTree<int64_t> fenwick(values.begin(), values.end());
+
+    std::mt19937 generator(9);
+    std::vector<std::size_t> bounds(2 * 4096);
+    for (auto& bound : bounds) {
+        bound = generator() % kCount;
+    }
+
+    int64_t tree_sum = 0;
+    nxt::core::StopWatch watch("Segment Tree");
+    watch.start();
+    for (int i = 0; i < kQueryCount; ++i) {
+        auto low = bounds[(2 * i) % bounds.size()];
+        auto high = bounds[(2 * i + 1) % bounds.size()];
+        tree_sum += tree.query(std::min(low, high), std::max(low, high));
+    }
+    watch.stop();
+    WARN("SegmentTree range queries: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    int64_t fenwick_sum = 0;
+    watch.reset();
+    watch.start();
+    for (int i = 0; i < kQueryCount; ++i) {
+        auto low = bounds[(2 * i) % bounds.size()];
+        auto high = bounds[(2 * i + 1) % bounds.size()];
+        fenwick_sum += fenwick.rangeSum(std::min(low, high), std::max(low, high));
+    }
+    watch.stop();
+    WARN("FenwickTree range queries: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    REQUIRE(tree_sum == fenwick_sum);
 
+    watch.reset();
+    watch.start();
+    for (int i = 0; i < kQueryCount / 10; ++i) {
+        auto low = bounds[(2 * i) % bounds.size()];
+        auto high = bounds[(2 * i + 1) % bounds.size()];
+        tree.addRange(std::min(low, high), std::max(low, high), 1);
     }
+    watch.stop();
+    WARN("SegmentTree range additions: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
 }
@@ -2,6 +2,13 @@
 
 #include "../include/Container/SkipList.h"
 #include "../include/Container/CommonTree.h"
+#include "../include/Container/Vector.h"
+#include "../include/Util/StopWatch.h"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
 
 TEST_CASE("SkipList Tests", "[skip_list]") {
     SECTION("sorting check") {
@@ -94,4 +101,193 @@ TEST_CASE("SkipList Tests", "[skip_list]") {
         REQUIRE(skip_list.size() == 0);
     }
 
+
+    SECTION("sorted build and merge") {
+        nxt::core::Vector<int> evens;
+        for (int i = 0; i < 1000; ++i) {
+            evens.pushBack(i * 2);
+        }
+
+        nxt::core::SkipList<nxt::core::SimpleTraits<int>> skip_list;
+        skip_list.insert(7);
+        skip_list.assignSorted(evens.begin(), evens.end());
+        REQUIRE(skip_list.size() == 1000);
+        REQUIRE(skip_list.find(7) == skip_list.end());
+
+        bool in_order = true;
+        int expected = 0;
+        for (auto value : skip_list) {
+            in_order = in_order && value == expected;
+            expected += 2;
+        }
+        REQUIRE(in_order);
+
+        // a large batch is merged, keys already present are skipped
+        nxt::core::Vector<int> batch;
+        for (int i = 0; i < 2000; i += 3) {
+            batch.pushBack(i);
+        }
+        auto is_odd = [](int value) { return value % 2 != 0; };
+        auto expected_inserted = std::count_if(batch.begin(), batch.end(), is_odd);
+        REQUIRE(skip_list.mergeSorted(batch.begin(), batch.end()) == static_cast<std::size_t>(expected_inserted));
+        REQUIRE(skip_list.size() == 1000 + static_cast<std::size_t>(expected_inserted));
+
+        bool merged = true;
+        int previous = -1;
+        std::size_t count = 0;
+        for (auto value : skip_list) {
+            merged = merged && value > previous && (value % 2 == 0 || value % 3 == 0);
+            previous = value;
+            ++count;
+        }
+        REQUIRE(merged);
+        REQUIRE(count == skip_list.size());
+
+        auto copy_list = skip_list;
+        REQUIRE(copy_list.size() == skip_list.size());
+        REQUIRE(copy_list.find(1998) != copy_list.end());
+
+        // a small batch is inserted value by value
+        int small_batch[] = {-1, 5, 1998, 5000};
+        REQUIRE(skip_list.mergeSorted(std::begin(small_batch), std::end(small_batch)) == 3);
+        REQUIRE(*skip_list.begin() == -1);
+
+        // the built tree keeps working with single inserts and erases
+        for (int i = 0; i < 2000; ++i) {
+            skip_list.erase(i);
+        }
+        REQUIRE(skip_list.size() == 2);
+
+        // range constructor, with sorted and unsorted input
+        nxt::core::SkipList<nxt::core::SimpleTraits<int>> from_sorted(evens.begin(), evens.end());
+        REQUIRE(from_sorted.size() == 1000);
+        int unsorted[] = {5, 1, 3, 1, 4};
+        nxt::core::SkipList<nxt::core::SimpleTraits<int>> from_unsorted(std::begin(unsorted), std::end(unsorted));
+        REQUIRE(from_unsorted.size() == 4);
+        REQUIRE(*from_unsorted.begin() == 1);
+    }
+
+    SECTION("random levels") {
+        nxt::core::RandomGenerator random;
+        std::size_t counts[5] = {};
+        for (int i = 0; i < 100000; ++i) {
+            auto level = random(4);
+            REQUIRE(level >= 1);
+            REQUIRE(level <= 4);
+            ++counts[level];
+        }
+
+        // geometric with p = 1/2, the last level takes the rest
+        REQUIRE(counts[1] > 45000);
+        REQUIRE(counts[1] < 55000);
+        REQUIRE(counts[2] > 20000);
+        REQUIRE(counts[2] < 30000);
+        REQUIRE(counts[3] + counts[4] > 20000);
+
+        nxt::core::SkipList<nxt::core::SimpleTraits<int>> skip_list;
+        for (int i = 0; i < 10000; ++i) {
+            skip_list.insert(i);
+        }
+        REQUIRE(skip_list.height() > 5);
+        REQUIRE(skip_list.height() < 30);
+
+        for (int i = 0; i < 10000; ++i) {
+            skip_list.erase(i);
+        }
+        REQUIRE(skip_list.height() == 0);
+        REQUIRE(skip_list.begin() == skip_list.end());
+    }
+
+    SECTION("finger search") {
+        nxt::core::SkipList<nxt::core::MappedTraits<int, int>> skip_list;
+        for (int i = 0; i < 5000; ++i) {
+            skip_list.insert({i * 3, i});
+        }
+
+        auto finger = skip_list.finger();
+        bool all_found = true;
+        for (int i = 0; i < 15000; ++i) {
+            auto it = skip_list.find(finger, i);
+            if (i % 3 == 0) {
+                all_found = all_found && it != skip_list.end() && it->second == i / 3;
+            } else {
+                all_found = all_found && it == skip_list.end();
+            }
+        }
+        REQUIRE(all_found);
+
+        // going backwards restarts from the head
+        REQUIRE(skip_list.find(finger, 3)->second == 1);
+        REQUIRE(skip_list.find(finger, 14997)->second == 4999);
+        REQUIRE(skip_list.find(finger, 0)->second == 0);
+
+        finger = skip_list.finger();
+        REQUIRE(skip_list.lowerBound(finger, -5)->first == 0);
+        REQUIRE(skip_list.lowerBound(finger, 7)->first == 9);
+        REQUIRE(skip_list.lowerBound(finger, 9)->first == 9);
+        REQUIRE(skip_list.lowerBound(finger, 20000) == skip_list.end());
+
+        const auto& const_list = skip_list;
+        auto const_finger = const_list.finger();
+        REQUIRE(const_list.find(const_finger, 300)->second == 100);
+    }
+
+    SECTION("random inserts and erases") {
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int> distribution(0, 2000);
+
+        nxt::core::SkipList<nxt::core::SimpleTraits<int>> skip_list;
+        std::set<int> expected;
+        for (int i = 0; i < 20000; ++i) {
+            auto value = distribution(generator);
+            if (i % 3 == 0) {
+                REQUIRE(skip_list.erase(value) == expected.erase(value));
+            } else {
+                REQUIRE(skip_list.insert(value).second == expected.insert(value).second);
+            }
+        }
+
+        REQUIRE(skip_list.size() == expected.size());
+        REQUIRE(std::equal(skip_list.begin(), skip_list.end(), expected.begin(), expected.end()));
+    }
+}
+
+TEST_CASE("SkipList Benchmark", "[.benchmark][skip_list]") {
+    constexpr int kCount = 1000000;
+
+    nxt::core::Vector<int> keys;
+    for (int i = 0; i < kCount; ++i) {
+        keys.pushBack(i);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(11));
+
+    nxt::core::SkipList<nxt::core::SimpleTraits<int>> skip_list;
+    nxt::core::StopWatch watch("SkipList");
+    watch.start();
+    for (auto key : keys) {
+        skip_list.insert(key);
+    }
+    watch.stop();
+    WARN("SkipList random inserts: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    std::size_t found = 0;
+    watch.reset();
+    watch.start();
+    for (int i = 0; i < kCount; ++i) {
+        found += skip_list.find(i) != skip_list.end() ? 1 : 0;
+    }
+    watch.stop();
+    WARN("SkipList sequential finds: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    std::size_t finger_found = 0;
+    auto finger = skip_list.finger();
+    watch.reset();
+    watch.start();
+    for (int i = 0; i < kCount; ++i) {
+        finger_found += skip_list.find(finger, i) != skip_list.end() ? 1 : 0;
+    }
+    watch.stop();
+    WARN("SkipList sequential finger finds: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    REQUIRE(found == finger_found);
 }
@@ -0,0 +1,207 @@
+#include "catch.hpp"
+
+#include "../include/Container/SlotMap.h"
+#include "../include/Container/Vector.h"
+#include "../include/Util/StopWatch.h"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+
+TEST_CASE("SlotMap Tests", "[slot_map]") {
+    SECTION("insert and erase") {
+        nxt::core::SlotMap<int> slot_map;
+        nxt::core::Vector<nxt::core::Key> keys;
+        for (int i = 0; i < 10; ++i) {
+            keys.pushBack(slot_map.insert(i));
+        }
+        REQUIRE(slot_map.size() == 10);
+
+        REQUIRE(slot_map.erase(keys[3]));
+        REQUIRE_FALSE(slot_map.erase(keys[3]));
+        REQUIRE_FALSE(slot_map.exist(keys[3]));
+        REQUIRE(slot_map.size() == 9);
+
+        // the freed slot is reused with a new generation
+        auto key = slot_map.insert(30);
+        REQUIRE(key.index == keys[3].index);
+        REQUIRE(key != keys[3]);
+        REQUIRE(slot_map.at(key) == 30);
+
+        int sum = 0;
+        for (auto value : slot_map) {
+            sum += value;
+        }
+        REQUIRE(sum == 45 - 3 + 30);
+    }
+
+    SECTION("copy") {
+        nxt::core::SlotMap<int, nxt::core::Key, 16> values;
+        nxt::core::SlotMap<std::string, nxt::core::Key, 16> strings;
+        nxt::core::Vector<nxt::core::Key> value_keys;
+        nxt::core::Vector<nxt::core::Key> string_keys;
+        for (int i = 0; i < 40; ++i) {
+            value_keys.pushBack(values.insert(i));
+            string_keys.pushBack(strings.insert(std::string(30, static_cast<char>('a' + i % 26))));
+        }
+        for (int i = 0; i < 40; i += 3) {
+            values.erase(value_keys[i]);
+            strings.erase(string_keys[i]);
+        }
+
+        auto values_copy = values;
+        auto strings_copy = strings;
+        REQUIRE(values_copy.size() == values.size());
+        REQUIRE(strings_copy.size() == strings.size());
+        for (int i = 0; i < 40; ++i) {
+            REQUIRE(values_copy.exist(value_keys[i]) == (i % 3 != 0));
+            REQUIRE(strings_copy.exist(string_keys[i]) == (i % 3 != 0));
+            if (i % 3 != 0) {
+                REQUIRE(values_copy[value_keys[i]] == i);
+                REQUIRE(strings_copy[string_keys[i]] == strings[string_keys[i]]);
+            }
+        }
+
+        // the copies keep working on their own
+        auto key = strings_copy.insert("new");
+        REQUIRE(strings_copy.at(key) == "new");
+        REQUIRE_FALSE(strings.exist(key));
+    }
+
+    SECTION("move") {
+        nxt::core::SlotMap<std::string, nxt::core::Key, 16> strings;
+        nxt::core::Vector<nxt::core::Key> keys;
+        for (int i = 0; i < 40; ++i) {
+            keys.pushBack(strings.insert(std::string(30, static_cast<char>('a' + i % 26))));
+        }
+        for (int i = 0; i < 40; i += 3) {
+            strings.erase(keys[i]);
+        }
+
+        {
+            auto moved = std::move(strings);
+            REQUIRE(moved.size() == 26);
+            REQUIRE(strings.size() == 0);
+            for (int i = 0; i < 40; ++i) {
+                REQUIRE(moved.exist(keys[i]) == (i % 3 != 0));
+                if (i % 3 != 0) {
+                    REQUIRE(moved[keys[i]] == std::string(30, static_cast<char>('a' + i % 26)));
+                }
+            }
+
+            // the moved-from map is cleared and destroyed without touching the moved slots
+            strings.clear();
+        }
+
+        // and it can be filled again
+        nxt::core::Vector<nxt::core::Key> new_keys;
+        for (int i = 0; i < 40; ++i) {
+            new_keys.pushBack(strings.emplace(std::to_string(i)));
+        }
+        REQUIRE(strings.size() == 40);
+        for (int i = 0; i < 40; ++i) {
+            REQUIRE(strings.at(new_keys[i]) == std::to_string(i));
+        }
+    }
+
+    SECTION("sparse iteration") {
+        nxt::core::SlotMap<int, nxt::core::Key, 256> slot_map;
+        nxt::core::Vector<nxt::core::Key> keys;
+        for (int i = 0; i < 5000; ++i) {
+            keys.pushBack(slot_map.insert(i));
+        }
+
+        // keep a few values spread over the words of the bitset, including the first and the last slot
+        std::mt19937 random(5);
+        nxt::core::Vector<int> expected;
+        for (int i = 0; i < 5000; ++i) {
+            if (i == 0 || i == 4999 || random() % 50 == 0) {
+                expected.pushBack(i);
+            } else {
+                slot_map.erase(keys[i]);
+            }
+        }
+        REQUIRE(slot_map.size() == expected.size());
+
+        nxt::core::Vector<int> values;
+        for (auto value : slot_map) {
+            values.pushBack(value);
+        }
+        REQUIRE(values == expected);
+
+        values.clear();
+        slot_map.forEachValid([&values](int value) { values.pushBack(value); });
+        REQUIRE(values == expected);
+
+        values.clear();
+        auto iter = slot_map.end();
+        do {
+            --iter;
+            values.pushBack(*iter);
+        } while (iter != slot_map.begin());
+        std::reverse(values.begin(), values.end());
+        REQUIRE(values == expected);
+
+        // erasing the first and the last values moves the bounds to the next valid slots
+        slot_map.erase(keys[0]);
+        slot_map.erase(keys[4999]);
+        REQUIRE(*slot_map.begin() == expected[1]);
+        REQUIRE(*std::prev(slot_map.end()) == expected[expected.size() - 2]);
+        REQUIRE(static_cast<std::size_t>(std::distance(slot_map.begin(), slot_map.end())) == expected.size() - 2);
+
+        for (auto i : expected) {
+            slot_map.erase(keys[i]);
+        }
+        REQUIRE(slot_map.size() == 0);
+        REQUIRE(slot_map.begin() == slot_map.end());
+
+        slot_map.clear();
+        auto key = slot_map.insert(7);
+        REQUIRE(slot_map.at(key) == 7);
+        REQUIRE(*slot_map.begin() == 7);
+        REQUIRE(std::next(slot_map.begin()) == slot_map.end());
+    }
+}
+
+TEST_CASE("SlotMap Benchmark", "[.benchmark][slot_map]") {
+    constexpr int kCount = 1 << 20;
+    constexpr int kRoundCount = 50;
+
+    // every stride-th value survives, a stride of 100 is like the entities after a mass despawn
+    for (int stride : {1, 100}) {
+        nxt::core::SlotMap<uint64_t> slot_map;
+        nxt::core::Vector<nxt::core::Key> keys;
+        for (int i = 0; i < kCount; ++i) {
+            keys.pushBack(slot_map.insert(static_cast<uint64_t>(i)));
+        }
+        for (int i = 0; i < kCount; ++i) {
+            if (i % stride != 0) {
+                slot_map.erase(keys[i]);
+            }
+        }
+
+        uint64_t iterator_sum = 0;
+        nxt::core::StopWatch watch("SlotMap");
+        watch.start();
+        for (int round = 0; round < kRoundCount; ++round) {
+            for (auto value : slot_map) {
+                iterator_sum += value;
+            }
+        }
+        watch.stop();
+        WARN("iterator over 1 in " << stride << " valid slots: "
+                                   << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+        uint64_t visitor_sum = 0;
+        watch.reset();
+        watch.start();
+        for (int round = 0; round < kRoundCount; ++round) {
+            slot_map.forEachValid([&visitor_sum](uint64_t value) { visitor_sum += value; });
+        }
+        watch.stop();
+        WARN("forEachValid over 1 in " << stride << " valid slots: "
+                                       << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+        REQUIRE(iterator_sum == visitor_sum);
+    }
+}
@@ -0,0 +1,177 @@
+#include "catch.hpp"
+
+#include "../include/Container/SmallVector.h"
+#include "../include/Container/Vector.h"
+#include "../include/Util/StopWatch.h"
+
+#include <memory>
+#include <string>
+
+namespace {
+std::size_t allocation_count = 0;
+
+// std::allocator which counts the allocations
+template<typename T>
+struct CountingAllocator : std::allocator<T> {
+    template<typename U>
+    struct rebind {
+        using other = CountingAllocator<U>;
+    };
+
+    CountingAllocator() = default;
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count) {
+        ++allocation_count;
+        return std::allocator<T>::allocate(count);
+    }
+};
+
+// fills lists of 0 to 8 values, like the receivers of an event
+template<typename List>
+void
+fillLists(List* lists, int list_count) {
+    for (int i = 0; i < list_count; ++i) {
+        for (int j = 0; j < i % 9; ++j) {
+            lists[i].pushBack(j);
+        }
+    }
+}
+
+template<typename List>
+std::size_t
+runListBenchmark(const char* name) {
+    constexpr int kListCount = 4096;
+    constexpr int kRoundCount = 500;
+
+    nxt::core::StopWatch watch(name);
+    allocation_count = 0;
+    watch.start();
+    for (int round = 0; round < kRoundCount; ++round) {
+        auto lists = std::make_unique<List[]>(kListCount);
+        fillLists(lists.get(), kListCount);
+    }
+    watch.stop();
+    WARN(name << " fill: " << allocation_count / kRoundCount << " allocations per round, "
+              << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    auto lists = std::make_unique<List[]>(kListCount);
+    fillLists(lists.get(), kListCount);
+    std::size_t sum = 0;
+    watch.reset();
+    watch.start();
+    for (int round = 0; round < kRoundCount * 4; ++round) {
+        for (int i = 0; i < kListCount; ++i) {
+            for (auto value : lists[i]) {
+                sum += static_cast<std::size_t>(value);
+            }
+        }
+    }
+    watch.stop();
+    WARN(name << " iteration: " << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+    return sum;
+}
+}  // namespace
+
+TEST_CASE("SmallVector Tests", "[small_vector]") {
+    SECTION("inline values") {
+        nxt::core::SmallVector<int, 4> vector;
+        REQUIRE(vector.empty());
+        REQUIRE(vector.capacity() == 4);
+        REQUIRE(vector.isInline());
+
+        for (int i = 0; i < 4; ++i) {
+            vector.pushBack(i);
+        }
+        REQUIRE(vector.isInline());
+
+        vector.pushBack(4);
+        REQUIRE_FALSE(vector.isInline());
+        REQUIRE(vector.size() == 5);
+        REQUIRE(vector.capacity() == 8);
+
+        vector.erase(vector.begin(), vector.begin() + 2);
+        vector.shrinkToFit();
+        REQUIRE(vector.isInline());
+        REQUIRE(vector == nxt::core::SmallVector<int, 4>({2, 3, 4}));
+    }
+
+    SECTION("insert and erase") {
+        nxt::core::SmallVector<std::string, 2> vector;
+        vector.insert(vector.end(), "c");
+        vector.insert(vector.begin(), "a");
+        vector.insert(vector.begin() + 1, "b");
+        vector.emplace(vector.end(), 3, 'd');
+        REQUIRE(vector.size() == 4);
+        REQUIRE(vector[0] == "a");
+        REQUIRE(vector[1] == "b");
+        REQUIRE(vector[2] == "c");
+        REQUIRE(vector[3] == "ddd");
+
+        // the inserted value may come from the vector itself
+        vector.insert(vector.begin(), vector.back());
+        REQUIRE(vector[0] == "ddd");
+
+        auto next = vector.erase(vector.begin() + 1);
+        REQUIRE(*next == "b");
+        vector.popBack();
+        REQUIRE(vector.back() == "c");
+
+        vector.resize(6, "e");
+        REQUIRE(vector.size() == 6);
+        REQUIRE(vector[5] == "e");
+        vector.resize(1);
+        REQUIRE(vector.size() == 1);
+    }
+
+    SECTION("copy and move") {
+        nxt::core::SmallVector<std::unique_ptr<int>, 2> pointers;
+        pointers.pushBack(std::make_unique<int>(1));
+
+        // inline values are moved one by one
+        auto moved = std::move(pointers);
+        REQUIRE(pointers.empty());
+        REQUIRE(moved.isInline());
+        REQUIRE(*moved[0] == 1);
+
+        // allocated values are taken with their buffer
+        moved.pushBack(std::make_unique<int>(2));
+        moved.pushBack(std::make_unique<int>(3));
+        auto buffer = moved.data();
+        pointers = std::move(moved);
+        REQUIRE(pointers.data() == buffer);
+        REQUIRE(moved.empty());
+        REQUIRE(moved.isInline());
+        REQUIRE(*pointers[2] == 3);
+
+        nxt::core::SmallVector<std::string, 3> strings = {"a", "b", "c", "d"};
+        auto copy = strings;
+        REQUIRE(copy == strings);
+        copy = nxt::core::SmallVector<std::string, 3>{"e"};
+        REQUIRE(copy.size() == 1);
+        REQUIRE_FALSE(copy < strings);
+        REQUIRE(strings < copy);
+    }
+
+    SECTION("allocations") {
+        allocation_count = 0;
+        {
+            nxt::core::SmallVector<int, 8, CountingAllocator<int>> vector;
+            for (int i = 0; i < 8; ++i) {
+                vector.pushBack(i);
+            }
+            REQUIRE(allocation_count == 0);
+
+            vector.pushBack(8);
+            REQUIRE(allocation_count == 1);
+        }
+    }
+}
+
+TEST_CASE("SmallVector Benchmark", "[.benchmark][small_vector]") {
+    auto vector_sum = runListBenchmark<nxt::core::Vector<int, CountingAllocator<int>>>("Vector");
+    auto small_sum = runListBenchmark<nxt::core::SmallVector<int, 8, CountingAllocator<int>>>("SmallVector<int, 8>");
+    REQUIRE(vector_sum == small_sum);
+}
@@ -0,0 +1,142 @@
+#include "catch.hpp"
+
+#include "../include/ECS/EntityManager.h"
+#include "../include/ECS/SparseSetComponent.h"
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+namespace {
+struct Health {
+    int value = 100;
+};
+
+struct Score {
+    int value;
+};
+}  // namespace
+
+TEST_CASE("SparseSetComponent Tests", "[sparse_set_component]") {
+    SECTION("Add, get and remove") {
+        nxt::core::SparseSetComponent<Health, 64> component("Health");
+        REQUIRE(component.getName() == "Health");
+        REQUIRE(component.empty());
+
+        nxt::core::Entity first(3, 1);
+        nxt::core::Entity second(1000, 1);
+        nxt::core::Entity third(70, 2);
+
+        component.emplace(first, Health{10});
+        component.emplace(second, Health{20});
+        auto key = component.addEntity(third);
+        REQUIRE(component.size() == 3);
+        REQUIRE(component.isValid(key));
+        REQUIRE(component.tryGet(third)->value == 100);
+        REQUIRE(component.tryGet(second)->value == 20);
+
+        // stale generation of an existing index
+        REQUIRE_FALSE(component.hasEntity(nxt::core::Entity(3, 2)));
+        REQUIRE(component.tryGet(nxt::core::Entity(3, 2)) == nullptr);
+        REQUIRE_FALSE(component.hasEntity(nxt::core::Entity(5000, 1)));
+
+        // replacing keeps a single value
+        component.emplace(first, Health{11});
+        REQUIRE(component.size() == 3);
+        REQUIRE(component.tryGet(first)->value == 11);
+
+        // swap with last keeps every remaining entity reachable
+        REQUIRE(component.removeEntity(first));
+        REQUIRE_FALSE(component.removeEntity(first));
+        REQUIRE_FALSE(component.hasEntity(first));
+        REQUIRE(component.tryGet(second)->value == 20);
+        REQUIRE(component.tryGet(third)->value == 100);
+        REQUIRE_FALSE(component.isValid(component.getKey(first)));
+
+        int sum = 0;
+        component.each([&sum](const nxt::core::Entity&, Health& health) { sum += health.value; });
+        REQUIRE(sum == 120);
+        for (auto& health : component) {
+            health.value = 1;
+        }
+        REQUIRE(component.tryGet(third)->value == 1);
+
+        component.clear();
+        REQUIRE(component.empty());
+        REQUIRE_FALSE(component.hasEntity(second));
+    }
+
+    SECTION("Many entities") {
+        nxt::core::SparseSetComponent<std::unique_ptr<int>> component;
+        for (uint32_t i = 0; i < 10000; ++i) {
+            component.emplace(nxt::core::Entity(i * 7, 1), std::make_unique<int>(static_cast<int>(i)));
+        }
+
+        nxt::core::Vector<nxt::core::Entity> removed;
+        for (uint32_t i = 0; i < 10000; i += 2) {
+            removed.pushBack(nxt::core::Entity(i * 7, 1));
+        }
+        component.removeEntities(removed.data(), removed.size());
+        REQUIRE(component.size() == 5000);
+
+        bool all_valid = true;
+        for (uint32_t i = 0; i < 10000; ++i) {
+            auto value = component.tryGet(nxt::core::Entity(i * 7, 1));
+            all_valid = all_valid && ((i % 2 == 0) ? value == nullptr : **value == static_cast<int>(i));
+        }
+        REQUIRE(all_valid);
+        REQUIRE(component.getEntities().size() == 5000);
+    }
+
+    SECTION("Entity hash") {
+        std::unordered_set<std::size_t> hashes;
+        std::hash<nxt::core::Entity> hasher;
+        for (uint32_t index = 0; index < 100; ++index) {
+            for (uint32_t generation = 1; generation < 10; ++generation) {
+                hashes.insert(hasher(nxt::core::Entity(index, generation)));
+            }
+        }
+        REQUIRE(hashes.size() == 900);
+    }
+}
+
+TEST_CASE("EntityManager SparseSetComponent Tests", "[sparse_set_component]") {
+    auto manager = nxt::core::EntityManager::get();
+    if (!manager->isComponentRegistered<Score>()) {
+        manager->registerComponent<Score>();
+    }
+    REQUIRE(manager->isComponentRegistered<Score>());
+    REQUIRE_FALSE(manager->isComponentRegistered<Health>());
+
+    auto scores = manager->getComponent<Score>();
+    REQUIRE(manager->getComponent(scores->getName()) == scores);
+
+    auto entity = manager->createEntity();
+    manager->addComponent<Score>(entity, Score{42});
+    REQUIRE(scores->contains(entity));
+    REQUIRE(manager->hasComponent<Score>(entity));
+    REQUIRE(manager->getComponent<Score>(entity)->value == 42);
+
+    // registering again keeps the storage and its values
+    manager->registerComponent<Score>();
+    REQUIRE(manager->getComponent<Score>() == scores);
+    REQUIRE(scores->contains(entity));
+
+    // forEach over a registered type iterates its sparse set
+    int visited = 0;
+    manager->forEach<Score>([&visited, entity](const nxt::core::Entity& score_entity, Score& score) {
+        REQUIRE(score_entity == entity);
+        REQUIRE(score.value == 42);
+        ++visited;
+    });
+    manager->forEach<const Score>([&visited](const Score& score) { visited += score.value; });
+    REQUIRE(visited == 43);
+
+    REQUIRE(manager->removeComponent<Score>(entity));
+    REQUIRE_FALSE(manager->hasComponent<Score>(entity));
+
+    manager->addComponent<Score>(entity, Score{7});
+    manager->destroyEntity(entity);
+    REQUIRE_FALSE(scores->contains(entity));
+    REQUIRE(scores->empty());
+}
@@ -0,0 +1,177 @@
+#include "catch.hpp"
+
+#include "../include/ECS/SystemManager.h"
+#include "../include/Threading/TaskQueue.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace {
+struct Position {
+    float x;
+};
+
+struct Velocity {
+    float x;
+};
+
+struct Health {
+    int value;
+};
+
+std::atomic<int> update_clock = 0;
+
+// records when it was updated so that the tests can check the order of conflicting systems
+template<int Id>
+class TestSystem : public nxt::core::System {
+public:
+    const std::string& getName() const noexcept override {
+        return name_;
+    }
+
+    int begin = -1;
+    int end = -1;
+
+protected:
+    bool doProjectLoad() noexcept override {
+        return true;
+    }
+
+    bool doProjectUnload() noexcept override {
+        return true;
+    }
+
+    void doUpdate(double) noexcept override {
+        begin = update_clock++;
+        std::this_thread::yield();
+        end = update_clock++;
+    }
+
+private:
+    std::string name_ = "TestSystem" + std::to_string(Id);
+};
+
+// writes Position, reads Velocity
+class MovementSystem : public TestSystem<0> {
+protected:
+    bool doRegister() noexcept override {
+        writes<Position>();
+        reads<Velocity>();
+        return true;
+    }
+};
+
+// reads Position
+class RenderSystem : public TestSystem<1> {
+protected:
+    bool doRegister() noexcept override {
+        reads<Position>();
+        return true;
+    }
+};
+
+// writes Health only
+class HealthSystem : public TestSystem<2> {
+protected:
+    bool doRegister() noexcept override {
+        writes<Health>();
+        return true;
+    }
+};
+
+// reads Velocity and Health
+class DebugSystem : public TestSystem<3> {
+protected:
+    bool doRegister() noexcept override {
+        reads<Velocity, Health>();
+        return true;
+    }
+};
+
+// doesn't declare anything, so it runs alone
+class LegacySystem : public TestSystem<4> {
+protected:
+    bool doRegister() noexcept override {
+        return true;
+    }
+};
+}  // namespace
+
+NXTCORE_REGISTER_SYSTEM_NO_EXPORT(MovementSystem)
+NXTCORE_REGISTER_SYSTEM_NO_EXPORT(RenderSystem)
+NXTCORE_REGISTER_SYSTEM_NO_EXPORT(HealthSystem)
+NXTCORE_REGISTER_SYSTEM_NO_EXPORT(DebugSystem)
+NXTCORE_REGISTER_SYSTEM_NO_EXPORT(LegacySystem)
+
+NXTCORE_DEFINE_SYSTEM(MovementSystem)
+NXTCORE_DEFINE_SYSTEM(RenderSystem)
+NXTCORE_DEFINE_SYSTEM(HealthSystem)
+NXTCORE_DEFINE_SYSTEM(DebugSystem)
+NXTCORE_DEFINE_SYSTEM(LegacySystem)
+
+TEST_CASE("SystemManager Tests", "[system_manager]") {
+    SECTION("Conflict Tests") {
+        MovementSystem movement;
+        RenderSystem render;
+        HealthSystem health;
+        DebugSystem debug;
+        LegacySystem legacy;
+        movement.onRegister();
+        render.onRegister();
+        health.onRegister();
+        debug.onRegister();
+        legacy.onRegister();
+
+        REQUIRE(movement.conflictsWith(render));
+        REQUIRE(render.conflictsWith(movement));
+        REQUIRE_FALSE(movement.conflictsWith(health));
+        REQUIRE_FALSE(movement.conflictsWith(debug));
+        REQUIRE_FALSE(render.conflictsWith(debug));
+        REQUIRE(health.conflictsWith(debug));
+        REQUIRE(legacy.isExclusive());
+        REQUIRE(legacy.conflictsWith(render));
+        REQUIRE(render.conflictsWith(legacy));
+    }
+
+    SECTION("Parallel update Tests") {
+        auto manager = nxt::core::SystemManager::get();
+        if (!manager->isSystemRegistered<MovementSystem>()) {
+            manager->registerSystem<MovementSystem>();
+            manager->registerSystem<RenderSystem>();
+            manager->registerSystem<LegacySystem>();
+            manager->registerSystem<HealthSystem>();
+            manager->registerSystem<DebugSystem>();
+        }
+        REQUIRE(manager->getSystemCount() == 5);
+        REQUIRE(manager->getSystem("TestSystem1") == manager->getSystem<RenderSystem>());
+
+        auto movement = manager->getSystem<MovementSystem>();
+        auto render = manager->getSystem<RenderSystem>();
+        auto legacy = manager->getSystem<LegacySystem>();
+        auto health = manager->getSystem<HealthSystem>();
+        auto debug = manager->getSystem<DebugSystem>();
+
+        nxt::core::TaskQueue task_queue("system_queue");
+        task_queue.start();
+        for (int frame = 0; frame < 100; ++frame) {
+            manager->update(1.0 / 60.0, task_queue);
+
+            // conflicting systems run in registration order
+            REQUIRE(movement->end < render->begin);
+            REQUIRE(health->end < debug->begin);
+
+            // the exclusive system runs alone
+            REQUIRE(render->end < legacy->begin);
+            REQUIRE(legacy->end < health->begin);
+        }
+        task_queue.stop();
+
+        // without running workers the systems are updated inline in registration order
+        manager->update(1.0 / 60.0, task_queue);
+        REQUIRE(movement->end < render->begin);
+        REQUIRE(render->end < legacy->begin);
+        REQUIRE(legacy->end < health->begin);
+        REQUIRE(health->end < debug->begin);
+    }
+}
@@ -2,11 +2,13 @@
 
 #include "../include/Threading/GenericTask.h"
 #include "../include/Threading/Task.h"
+#include "../include/Threading/TaskGraph.h"
 #include "../include/Threading/TaskQueue.h"
 
 #include <thread>
 #include <chrono>
 #include <memory_resource>
+#include <stdexcept>
 
 TEST_CASE("Task System tests", "[task]") {
     nxt::core::TaskQueue task_queue("test_queue");
@@ -146,4 +148,293 @@ TEST_CASE("Task System tests", "[task]") {
         REQUIRE(task_11->getResult() == 10);
         REQUIRE(task_12->getResult() == 10);
     }
+
+    SECTION("Work stealing Tests") {
+        constexpr int kTaskCount = 10000;
+        std::atomic<int> counter = 0;
+
+        auto increment = [&counter]() { counter.fetch_add(1); };
+
+        nxt::core::Vector<std::shared_ptr<nxt::core::Task>> tasks;
+        tasks.reserve(kTaskCount);
+        for (int i = 0; i < kTaskCount; ++i) {
+            tasks.pushBack(nxt::core::makeGenericTask(increment));
+        }
+
+        task_queue.start();
+        REQUIRE(task_queue.addTasks(tasks) == kTaskCount);
+        REQUIRE(task_queue.addTasks(tasks) == 0);
+
+        for (const auto& task : tasks) {
+            task->wait();
+        }
+
+        REQUIRE(counter == kTaskCount);
+    }
+
+    SECTION("Tasks spawned from worker threads Tests") {
+        constexpr int kChildCount = 100;
+        std::atomic<int> counter = 0;
+
+        nxt::core::Vector<std::shared_ptr<nxt::core::Task>> children;
+        children.reserve(kChildCount);
+        for (int i = 0; i < kChildCount; ++i) {
+            children.pushBack(nxt::core::makeGenericTask([&counter]() { counter.fetch_add(1); }));
+        }
+
+        auto parent = nxt::core::makeGenericTask([&task_queue, &children]() {
+            // tasks added from inside a worker go to the local deque of that worker
+            std::size_t added = 0;
+            for (const auto& child : children) {
+                added += task_queue.addTask(child) ? 1 : 0;
+            }
+            return added;
+        });
+
+        task_queue.start();
+        task_queue.addTask(parent);
+        REQUIRE(parent->getResult() == kChildCount);
+
+        for (const auto& child : children) {
+            child->wait();
+        }
+
+        REQUIRE(counter == kChildCount);
+    }
+
+    SECTION("Restarting queue Tests") {
+        std::atomic<int> counter = 0;
+        auto increment = [&counter]() { counter.fetch_add(1); };
+
+        auto task_1 = nxt::core::makeGenericTask(increment);
+        auto task_2 = nxt::core::makeGenericTask(increment);
+
+        // tasks added before start are executed once the queue starts
+        task_queue.addTask(task_1);
+        task_queue.start();
+        task_1->wait();
+
+        task_queue.stop();
+        task_queue.addTask(task_2);
+        REQUIRE(task_2->getStatus() == nxt::core::Task::Status::kQueued);
+
+        task_queue.setMaxThreads(3);
+        task_queue.start();
+        task_queue.setMaxThreads(1);
+        task_2->wait();
+
+        REQUIRE(task_queue.getMaxThreads() == 1);
+        REQUIRE(counter == 2);
+    }
+
+    SECTION("Setting max threads from a worker Tests") {
+        task_queue.setMaxThreads(1);
+        task_queue.start();
+
+        // a worker can't restart itself, so the queue keeps running and picks up the count on the next start
+        auto resize = nxt::core::makeGenericTask([&task_queue]() {
+            task_queue.setMaxThreads(2);
+            return task_queue.isRunning();
+        });
+        task_queue.addTask(resize);
+        REQUIRE(resize->getResult());
+        REQUIRE(task_queue.isRunning());
+        REQUIRE(task_queue.getMaxThreads() == 2);
+
+        auto next = nxt::core::makeGenericTask([]() { return 1; });
+        task_queue.addTask(next);
+        REQUIRE(next->getResult() == 1);
+
+        task_queue.stop();
+        task_queue.start();
+        auto after_restart = nxt::core::makeGenericTask([]() { return 2; });
+        task_queue.addTask(after_restart);
+        REQUIRE(after_restart->getResult() == 2);
+    }
+
+    SECTION("Destroying queue with pending tasks Tests") {
+        auto task = nxt::core::makeGenericTask([]() {});
+        auto successor = nxt::core::makeGenericTask([]() {});
+        REQUIRE(task->precede(successor));
+        {
+            nxt::core::TaskQueue pending_queue("pending_queue");
+            REQUIRE(pending_queue.addTask(task));
+        }
+
+        // the task never ran, waiting on it must still return
+        task->wait();
+        REQUIRE(task->getStatus() == nxt::core::Task::Status::kError);
+        successor->wait();
+        REQUIRE(successor->getStatus() == nxt::core::Task::Status::kError);
+    }
+
+    SECTION("Task continuation Tests") {
+        std::atomic<int> counter = 0;
+        auto first = nxt::core::makeGenericTask([&counter]() { return counter.fetch_add(1); });
+        auto second = nxt::core::makeGenericTask([&counter]() { return counter.fetch_add(1); });
+
+        REQUIRE(first->precede(second));
+        REQUIRE_FALSE(first->precede(first));
+        REQUIRE(second->hasPendingPredecessors());
+
+        // successors are queued by the task queue once their predecessors finish
+        REQUIRE_FALSE(task_queue.addTask(second));
+
+        task_queue.start();
+        REQUIRE(task_queue.addTask(first));
+        REQUIRE(second->getResult() == 1);
+        REQUIRE(first->getResult() == 0);
+        REQUIRE_FALSE(first->precede(second));
+    }
+
+    SECTION("Task Graph Tests") {
+        nxt::core::TaskGraph graph;
+
+        // diamond: source -> (left, right) -> sink
+        int values[] = {1, 2, 3, 4, 5, 6, 7, 8};
+        auto source = graph.emplaceTask([&values]() {
+            for (auto& value : values) {
+                value *= 2;
+            }
+        });
+        auto left = graph.emplaceTask([&values]() { return values[0] + values[1] + values[2] + values[3]; });
+        auto right = graph.emplaceTask([&values]() { return values[4] + values[5] + values[6] + values[7]; });
+        auto sink = graph.emplaceTask([&left, &right]() { return left->getResult() + right->getResult(); });
+
+        REQUIRE(graph.addDependency(source, left));
+        REQUIRE(graph.addDependency(source, right));
+        REQUIRE(graph.addDependency(left, sink));
+        REQUIRE(graph.addDependency(right, sink));
+        REQUIRE(graph.size() == 4);
+
+        // long chain, each task must observe the write of its predecessor
+        constexpr int kChainLength = 1000;
+        int chain_value = 0;
+        std::shared_ptr<nxt::core::Task> previous;
+        for (int i = 0; i < kChainLength; ++i) {
+            auto task = graph.emplaceTask([&chain_value, i]() { return chain_value++ == i; });
+            if (previous) {
+                REQUIRE(graph.addDependency(previous, task));
+            }
+            previous = task;
+        }
+
+        task_queue.start();
+        REQUIRE(graph.submit(task_queue) == 2);
+        graph.wait();
+
+        REQUIRE(sink->getResult() == 72);
+        REQUIRE(chain_value == kChainLength);
+    }
+
+    SECTION("Task Graph failure Tests") {
+        nxt::core::TaskGraph graph;
+        std::atomic<int> counter = 0;
+
+        // source -> failing -> (skipped -> skipped_chain), source -> independent, (failing, independent) -> join
+        auto source = graph.emplaceTask([&counter]() { counter.fetch_add(1); });
+        auto failing = graph.emplaceTask([]() { throw std::runtime_error("failure"); });
+        auto independent = graph.emplaceTask([&counter]() { counter.fetch_add(1); });
+        auto skipped = graph.emplaceTask([&counter]() { counter.fetch_add(100); });
+        auto join = graph.emplaceTask([&counter]() { counter.fetch_add(100); });
+        REQUIRE(graph.addDependency(source, failing));
+        REQUIRE(graph.addDependency(source, independent));
+        REQUIRE(graph.addDependency(failing, skipped));
+        REQUIRE(graph.addDependency(failing, join));
+        REQUIRE(graph.addDependency(independent, join));
+
+        std::shared_ptr<nxt::core::Task> previous = skipped;
+        for (int i = 0; i < 1000; ++i) {
+            auto task = graph.emplaceTask([&counter]() { counter.fetch_add(100); });
+            REQUIRE(graph.addDependency(previous, task));
+            previous = task;
+        }
+
+        task_queue.start();
+        REQUIRE(graph.submit(task_queue) == 1);
+        graph.wait();
+
+        REQUIRE(counter == 2);
+        REQUIRE(source->getStatus() == nxt::core::Task::Status::kFinished);
+        REQUIRE(independent->getStatus() == nxt::core::Task::Status::kFinished);
+        REQUIRE(failing->getStatus() == nxt::core::Task::Status::kError);
+        REQUIRE(skipped->getStatus() == nxt::core::Task::Status::kError);
+        REQUIRE(join->getStatus() == nxt::core::Task::Status::kError);
+        REQUIRE(previous->getStatus() == nxt::core::Task::Status::kError);
+    }
+
+    SECTION("Task pool Tests") {
+        nxt::core::TaskPool pool;
+        auto block = pool.allocate(100, alignof(std::max_align_t));
+        pool.deallocate(block, 100, alignof(std::max_align_t));
+
+        // released blocks are reused by the next allocation of the same size class
+        REQUIRE(pool.allocate(128, alignof(std::max_align_t)) == block);
+        REQUIRE(pool.getSlabCount() == 1);
+
+        auto large_block = pool.allocate(nxt::core::TaskPool::kMaxBlockSize + 1);
+        pool.deallocate(large_block, nxt::core::TaskPool::kMaxBlockSize + 1);
+        REQUIRE(pool.getSlabCount() == 1);
+
+        std::atomic<int> counter = 0;
+        task_queue.start();
+
+        std::size_t slab_count = 0;
+        for (int round = 0; round < 10; ++round) {
+            nxt::core::Vector<std::shared_ptr<nxt::core::Task>> tasks;
+            for (int i = 0; i < 1000; ++i) {
+                tasks.pushBack(task_queue.makeTask([&counter](int value) { return counter.fetch_add(value); }, 1));
+            }
+
+            REQUIRE(task_queue.addTasks(tasks) == 1000);
+            for (const auto& task : tasks) {
+                task->wait();
+            }
+
+            // memory of the finished tasks is recycled, so only the first round allocates slabs
+            if (round == 0) {
+                slab_count = task_queue.getTaskPool()->getSlabCount();
+            }
+            REQUIRE(task_queue.getTaskPool()->getSlabCount() == slab_count);
+        }
+
+        REQUIRE(counter == 10000);
+
+        // graphs created on the pool of the queue recycle the tasks of the previous graphs as well
+        for (int round = 0; round < 10; ++round) {
+            nxt::core::TaskGraph graph(task_queue.getTaskPool());
+            for (int i = 0; i < 1000; ++i) {
+                graph.emplaceTask([&counter]() { counter.fetch_add(1); });
+            }
+
+            REQUIRE(graph.submit(task_queue) == 1000);
+            graph.wait();
+            graph.clear();
+            if (round == 0) {
+                slab_count = task_queue.getTaskPool()->getSlabCount();
+            }
+            REQUIRE(task_queue.getTaskPool()->getSlabCount() == slab_count);
+        }
+
+        REQUIRE(counter == 20000);
+
+        auto task = task_queue.makeTask([]() { return 42; });
+        REQUIRE_FALSE(task->hasResult());
+        task_queue.addTask(task);
+        REQUIRE(task->getResult() == 42);
+        REQUIRE(task->hasResult());
+    }
+
+    SECTION("Task waitFor Tests") {
+        auto task = nxt::core::makeGenericTask([]() {});
+
+        // task is not queued, so waiting has to time out
+        task->waitFor(std::chrono::milliseconds(10));
+        REQUIRE(task->getStatus() == nxt::core::Task::Status::kNotQueued);
+
+        task_queue.start();
+        task_queue.addTask(task);
+        task->waitFor(std::chrono::seconds(10));
+        REQUIRE(task->getStatus() == nxt::core::Task::Status::kFinished);
+    }
 }
@@ -1,6 +1,22 @@
 #include "catch.hpp"
 
 #include "../include/Container/Vector.h"
+#include "../include/Util/StopWatch.h"
+
+#include <memory>
+#include <string>
+
+namespace {
+// holds a resource but may be moved around with memcpy
+struct RelocatableHandle {
+    using is_trivially_relocatable = std::true_type;
+
+    explicit RelocatableHandle(int value)
+        : value(std::make_unique<int>(value)) {}
+
+    std::unique_ptr<int> value;
+};
+}  // namespace
 
 TEST_CASE("Vector Tests", "[vector]") {
     SECTION("sizeof test for vector") {
@@ -145,4 +161,108 @@ TEST_CASE("Vector Tests", "[vector]") {
 
         REQUIRE(vector == copy_vector);
     }
-}
\ No newline at end of file
+
+    SECTION("relocation traits") {
+        STATIC_REQUIRE(nxt::core::IsTriviallyRelocatableV<int>);
+        STATIC_REQUIRE(nxt::core::IsTriviallyRelocatableV<std::pair<int, double>>);
+        STATIC_REQUIRE(nxt::core::IsTriviallyRelocatableV<std::pair<const int, std::unique_ptr<int>>>);
+        STATIC_REQUIRE_FALSE(nxt::core::IsTriviallyRelocatableV<std::pair<int, std::string>>);
+        STATIC_REQUIRE(nxt::core::IsTriviallyRelocatableV<std::unique_ptr<int>>);
+        STATIC_REQUIRE(nxt::core::IsTriviallyRelocatableV<RelocatableHandle>);
+        STATIC_REQUIRE_FALSE(nxt::core::IsTriviallyRelocatableV<std::string>);
+    }
+
+    SECTION("relocating values") {
+        nxt::core::Vector<std::unique_ptr<int>> vector;
+        for (int i = 0; i < 100; ++i) {
+            vector.pushBack(std::make_unique<int>(i));
+        }
+
+        // growing inserts, inserts in place and erases
+        nxt::core::Vector<std::unique_ptr<int>> inserted;
+        for (int i = 0; i < 50; ++i) {
+            inserted.insert(inserted.begin() + inserted.size() / 2, std::make_unique<int>(i));
+        }
+        REQUIRE(inserted.size() == 50);
+        REQUIRE(*inserted.front() == 1);
+        REQUIRE(*inserted.back() == 0);
+
+        vector.insert(vector.begin(), std::make_unique<int>(-1));
+        vector.insert(vector.begin() + 50, std::make_unique<int>(-2));
+        REQUIRE(vector.size() == 102);
+        REQUIRE(*vector[0] == -1);
+        REQUIRE(*vector[50] == -2);
+        REQUIRE(*vector[51] == 49);
+
+        auto next = vector.erase(vector.begin() + 10, vector.begin() + 60);
+        REQUIRE(vector.size() == 52);
+        REQUIRE(**next == 58);
+        vector.erase(vector.begin());
+        REQUIRE(*vector[0] == 0);
+
+        vector.shrinkToFit();
+        REQUIRE(vector.capacity() == vector.size());
+        bool in_order = true;
+        for (std::size_t i = 1; i < vector.size(); ++i) {
+            in_order = in_order && *vector[i - 1] < *vector[i];
+        }
+        REQUIRE(in_order);
+
+        nxt::core::Vector<RelocatableHandle> handles;
+        for (int i = 0; i < 20; ++i) {
+            handles.emplace(handles.begin(), i);
+        }
+        handles.erase(handles.begin() + 5);
+        REQUIRE(handles.size() == 19);
+        REQUIRE(*handles[0].value == 19);
+        REQUIRE(*handles[5].value == 13);
+    }
+
+    SECTION("non relocatable values") {
+        nxt::core::Vector<std::string> vector;
+        for (int i = 0; i < 20; ++i) {
+            vector.insert(vector.begin() + vector.size() / 2, std::string(30, static_cast<char>('a' + i)));
+        }
+        REQUIRE(vector.size() == 20);
+
+        // the inserted value may come from the vector itself
+        vector.insert(vector.begin(), vector[10]);
+        REQUIRE(vector[0] == vector[11]);
+        vector.insert(vector.begin() + 3, vector.back());
+        REQUIRE(vector[3] == vector.back());
+
+        vector.erase(vector.begin(), vector.begin() + 2);
+        REQUIRE(vector.size() == 20);
+        REQUIRE(vector[1] == vector.back());
+    }
+}
+
+TEST_CASE("Vector Benchmark", "[.benchmark][vector]") {
+    constexpr int kCount = 20000;
+
+    nxt::core::StopWatch watch("Vector");
+    nxt::core::Vector<std::unique_ptr<int>> vector;
+    watch.start();
+    for (int i = 0; i < kCount; ++i) {
+        vector.insert(vector.begin(), std::make_unique<int>(i));
+    }
+    while (!vector.empty()) {
+        vector.erase(vector.begin());
+    }
+    watch.stop();
+    WARN("Vector<std::unique_ptr<int>> front inserts and erases: "
+         << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+
+    nxt::core::Vector<std::string> strings;
+    watch.reset();
+    watch.start();
+    for (int i = 0; i < kCount; ++i) {
+        strings.insert(strings.begin(), std::string());
+    }
+    while (!strings.empty()) {
+        strings.erase(strings.begin());
+    }
+    watch.stop();
+    WARN("Vector<std::string> front inserts and erases: "
+         << watch.getDuration<std::chrono::milliseconds>().count() << " ms");
+}
@@ -0,0 +1,115 @@
+#include "catch.hpp"
+
+#include "../include/ECS/ArchetypeStorage.h"
+#include "../include/ECS/EntityManager.h"
+#include "../include/ECS/View.h"
+
+#include <string>
+
+namespace {
+struct Position {
+    int x;
+    int y;
+};
+
+struct Velocity {
+    int x;
+    int y;
+};
+
+struct Tag {
+    std::string name;
+};
+}  // namespace
+
+TEST_CASE("View Tests", "[view]") {
+    nxt::core::ArchetypeStorage storage;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        nxt::core::Entity entity(i, 1);
+        storage.addComponent<Position>(entity, Position{static_cast<int>(i), 0});
+        if (i % 2 == 0) {
+            storage.addComponent<Velocity>(entity, Velocity{1, 2});
+        }
+        if (i % 5 == 0) {
+            storage.addComponent<Tag>(entity, Tag{std::to_string(i)});
+        }
+    }
+
+    SECTION("each with and without entity") {
+        nxt::core::View<Position, const Velocity> view(storage);
+        REQUIRE(view.size() == 500);
+
+        view.each([](Position& position, const Velocity& velocity) {
+            position.x += velocity.x;
+            position.y += velocity.y;
+        });
+
+        bool all_valid = true;
+        int count = 0;
+        view.each([&](const nxt::core::Entity& entity, const Position& position, const Velocity&) {
+            all_valid = all_valid && entity.getIndex() % 2 == 0 &&
+                        position.x == static_cast<int>(entity.getIndex()) + 1 && position.y == 2;
+            ++count;
+        });
+        REQUIRE(all_valid);
+        REQUIRE(count == 500);
+    }
+
+    SECTION("Iteration and typed access") {
+        nxt::core::View<Tag, Position> view(storage);
+        int count = 0;
+        for (auto entity : view) {
+            REQUIRE(view.contains(entity));
+            REQUIRE(view.get<Tag>(entity).name == std::to_string(entity.getIndex()));
+            view.get<Position>(entity).y = 7;
+            ++count;
+        }
+        REQUIRE(count == 200);
+        REQUIRE(storage.getComponent<Position>(nxt::core::Entity(5, 1))->y == 7);
+        REQUIRE_FALSE(view.contains(nxt::core::Entity(1, 1)));
+
+        static_assert(std::is_same_v<decltype(nxt::core::View<const Tag>(storage).get<Tag>(nxt::core::Entity())),
+                                     const Tag&>);
+    }
+
+    SECTION("Cached query follows structural changes") {
+        nxt::core::View<Velocity, Tag> view(storage);
+        REQUIRE(view.size() == 100);
+        REQUIRE(&storage.getQuery<Velocity, Tag>() == &storage.getQuery<Velocity, Tag>());
+
+        // new archetype created after the view
+        nxt::core::Entity entity(2000, 1);
+        storage.addComponent<Tag>(entity, Tag{"new"});
+        storage.addComponent<Velocity>(entity, Velocity{0, 0});
+        REQUIRE(view.size() == 101);
+
+        for (uint32_t i = 0; i < 1000; i += 10) {
+            storage.removeEntity(nxt::core::Entity(i, 1));
+        }
+        REQUIRE(view.size() == 1);
+        REQUIRE(*view.begin() == entity);
+
+        storage.removeComponent<Tag>(entity);
+        REQUIRE(view.empty());
+        REQUIRE(view.begin() == view.end());
+    }
+}
+
+TEST_CASE("EntityManager View Tests", "[view]") {
+    auto manager = nxt::core::EntityManager::get();
+    auto first = manager->createEntity();
+    auto second = manager->createEntity();
+    manager->addComponent<Position>(first, Position{1, 1});
+    manager->addComponent<Position>(second, Position{2, 2});
+    manager->addComponent<Velocity>(second, Velocity{3, 3});
+
+    auto view = manager->view<Position, Velocity>();
+    REQUIRE(view.size() == 1);
+    view.each([](Position& position, const Velocity& velocity) { position.x += velocity.x; });
+    REQUIRE(manager->getComponent<Position>(second)->x == 5);
+    REQUIRE(manager->view<Position>().size() == 2);
+
+    manager->destroyEntity(first);
+    manager->destroyEntity(second);
+    REQUIRE(view.empty());
+}